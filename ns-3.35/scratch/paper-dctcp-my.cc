@@ -274,6 +274,7 @@ int main (int argc, char *argv[])
   Time measurementWindow = Seconds (1);
   bool enableSwitchEcn = true;
   Time progressInterval = MilliSeconds (100);
+  bool enableFlowStats = false;
 
   CommandLine cmd (__FILE__);
   cmd.AddValue ("tcpTypeId", "ns-3 TCP TypeId", tcpTypeId);
@@ -281,6 +282,7 @@ int main (int argc, char *argv[])
   cmd.AddValue ("convergenceTime", "convergence time", convergenceTime);
   cmd.AddValue ("measurementWindow", "measurement window", measurementWindow);
   cmd.AddValue ("enableSwitchEcn", "enable ECN at switches", enableSwitchEcn);
+  cmd.AddValue ("enableFlowStats", "count the packets enqueued, marked and dropped per flow at T1 and T2", enableFlowStats);
   cmd.Parse (argc, argv);
 
   Config::SetDefault ("ns3::TcpL4Protocol::SocketType", StringValue ("ns3::" + tcpTypeId));
@@ -547,6 +549,11 @@ int main (int argc, char *argv[])
   Simulator::Schedule (progressInterval, &PrintProgress, progressInterval);
   Simulator::Schedule (flowStartupWindow + convergenceTime, &CheckT1QueueSize, queueDiscs1.Get (0));
   Simulator::Schedule (flowStartupWindow + convergenceTime, &CheckT2QueueSize, queueDiscs2.Get (0));
+  if (enableFlowStats)
+    {
+      queueDiscs1.Get (0)->SetFlowStats (CreateObject<QueueDiscFlowStats> ());
+      queueDiscs2.Get (0)->SetFlowStats (CreateObject<QueueDiscFlowStats> ());
+    }
   Simulator::Stop (stopTime + TimeStep (1));
 
   Simulator::Run ();
@@ -557,6 +564,13 @@ int main (int argc, char *argv[])
   fairnessIndex.close ();
   t1QueueLength.close ();
   t2QueueLength.close ();
+  if (enableFlowStats)
+    {
+      std::ofstream t1Flows ("dctcp-example-t1-flows.dat", std::ios::out);
+      t1Flows << *queueDiscs1.Get (0)->GetFlowStats ();
+      std::ofstream t2Flows ("dctcp-example-t2-flows.dat", std::ios::out);
+      t2Flows << *queueDiscs2.Get (0)->GetFlowStats ();
+    }
   Simulator::Destroy ();
   return 0;
 }
@@ -27,193 +27,46 @@
 #include "ns3/pointer.h"
 #include "ns3/config.h"
 #include "ns3/flow-id-tag.h"
+#include "ns3/simulator.h"
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Ipv4FlowProbe");
 
-//////////////////////////////////////
-// Ipv4FlowProbeTag class implementation //
-//////////////////////////////////////
+/// Key of the flow annotations set by Ipv4FlowProbe
+static const uint32_t IPV4_ANNOTATION_KEY = 4;
 
 /**
  * \ingroup flow-monitor
  *
- * \brief Tag used to allow a fast identification of the packet
+ * \brief Check whether a packet was annotated for the given endpoints.
  *
- * This tag is added by FlowMonitor when a packet is seen for
- * the first time, and it is then used to classify the packet in
- * the following hops.
+ * Encapsulated packets keep the annotation of the inner packet, so they
+ * must not be reported by the outer header.
+ *
+ * \param annotation the flow annotation of the packet
+ * \param ipHeader the IPv4 header the packet is seen with
+ * \return true if the annotation was set for the addresses of the header
  */
-class Ipv4FlowProbeTag : public Tag
-{
-public:
-  /**
-   * \brief Get the type ID.
-   * \return the object TypeId
-   */
-  static TypeId GetTypeId (void);
-  virtual TypeId GetInstanceTypeId (void) const;
-  virtual uint32_t GetSerializedSize (void) const;
-  virtual void Serialize (TagBuffer buf) const;
-  virtual void Deserialize (TagBuffer buf);
-  virtual void Print (std::ostream &os) const;
-  Ipv4FlowProbeTag ();
-  /**
-   * \brief Consructor
-   * \param flowId the flow identifier
-   * \param packetId the packet identifier
-   * \param packetSize the packet size
-   * \param src packet source address
-   * \param dst packet destination address
-   */
-  Ipv4FlowProbeTag (uint32_t flowId, uint32_t packetId, uint32_t packetSize, Ipv4Address src, Ipv4Address dst);
-  /**
-   * \brief Set the flow identifier
-   * \param flowId the flow identifier
-   */
-  void SetFlowId (uint32_t flowId);
-  /**
-   * \brief Set the packet identifier
-   * \param packetId the packet identifier
-   */
-  void SetPacketId (uint32_t packetId);
-  /**
-   * \brief Set the packet size
-   * \param packetSize the packet size
-   */
-  void SetPacketSize (uint32_t packetSize);
-  /**
-   * \brief Set the flow identifier
-   * \returns the flow identifier
-   */
-  uint32_t GetFlowId (void) const;
-  /**
-   * \brief Set the packet identifier
-   * \returns the packet identifier
-   */
-  uint32_t GetPacketId (void) const;
-  /**
-   * \brief Get the packet size
-   * \returns the packet size
-   */
-  uint32_t GetPacketSize (void) const;
-  /**
-   * \brief Checks if the addresses stored in tag are matching
-   * the arguments.
-   *
-   * This check is important for IP over IP encapsulation.
-   *
-   * \param src Source address.
-   * \param dst Destination address.
-   * \returns True if the addresses are matching.
-   */
-  bool IsSrcDstValid (Ipv4Address src, Ipv4Address dst) const;
-private:
-  uint32_t m_flowId;      //!< flow identifier
-  uint32_t m_packetId;    //!< packet identifier
-  uint32_t m_packetSize;  //!< packet size
-  Ipv4Address m_src;      //!< IP source
-  Ipv4Address m_dst;      //!< IP destination
-};
-
-TypeId 
-Ipv4FlowProbeTag::GetTypeId (void)
-{
-  static TypeId tid = TypeId ("ns3::Ipv4FlowProbeTag")
-    .SetParent<Tag> ()
-    .SetGroupName ("FlowMonitor")
-    .AddConstructor<Ipv4FlowProbeTag> ()
-  ;
-  return tid;
-}
-TypeId 
-Ipv4FlowProbeTag::GetInstanceTypeId (void) const
-{
-  return GetTypeId ();
-}
-uint32_t 
-Ipv4FlowProbeTag::GetSerializedSize (void) const
-{
-  return 4 + 4 + 4 + 8;
-}
-void 
-Ipv4FlowProbeTag::Serialize (TagBuffer buf) const
-{
-  buf.WriteU32 (m_flowId);
-  buf.WriteU32 (m_packetId);
-  buf.WriteU32 (m_packetSize);
-
-  uint8_t tBuf[4];
-  m_src.Serialize (tBuf);
-  buf.Write (tBuf, 4);
-  m_dst.Serialize (tBuf);
-  buf.Write (tBuf, 4);
-}
-void 
-Ipv4FlowProbeTag::Deserialize (TagBuffer buf)
-{
-  m_flowId = buf.ReadU32 ();
-  m_packetId = buf.ReadU32 ();
-  m_packetSize = buf.ReadU32 ();
-
-  uint8_t tBuf[4];
-  buf.Read (tBuf, 4);
-  m_src = Ipv4Address::Deserialize (tBuf);
-  buf.Read (tBuf, 4);
-  m_dst = Ipv4Address::Deserialize (tBuf);
-}
-void 
-Ipv4FlowProbeTag::Print (std::ostream &os) const
-{
-  os << "FlowId=" << m_flowId;
-  os << " PacketId=" << m_packetId;
-  os << " PacketSize=" << m_packetSize;
-}
-Ipv4FlowProbeTag::Ipv4FlowProbeTag ()
-  : Tag () 
+static bool
+IsSrcDstValid (const PacketFlowAnnotation &annotation, const Ipv4Header &ipHeader)
 {
+  return annotation.src == ipHeader.GetSource ().Get ()
+         && annotation.dst == ipHeader.GetDestination ().Get ();
 }
 
-Ipv4FlowProbeTag::Ipv4FlowProbeTag (uint32_t flowId, uint32_t packetId, uint32_t packetSize, Ipv4Address src, Ipv4Address dst)
-  : Tag (), m_flowId (flowId), m_packetId (packetId), m_packetSize (packetSize), m_src (src), m_dst (dst)
-{
-}
-
-void
-Ipv4FlowProbeTag::SetFlowId (uint32_t id)
-{
-  m_flowId = id;
-}
-void
-Ipv4FlowProbeTag::SetPacketId (uint32_t id)
-{
-  m_packetId = id;
-}
-void
-Ipv4FlowProbeTag::SetPacketSize (uint32_t size)
-{
-  m_packetSize = size;
-}
-uint32_t
-Ipv4FlowProbeTag::GetFlowId (void) const
-{
-  return m_flowId;
-}
-uint32_t
-Ipv4FlowProbeTag::GetPacketId (void) const
-{
-  return m_packetId;
-} 
-uint32_t
-Ipv4FlowProbeTag::GetPacketSize (void) const
-{
-  return m_packetSize;
-}
-bool
-Ipv4FlowProbeTag::IsSrcDstValid (Ipv4Address src, Ipv4Address dst) const
+/**
+ * \ingroup flow-monitor
+ *
+ * \brief Check whether a packet was annotated by an Ipv4FlowProbe.
+ *
+ * \param annotation the flow annotation of the packet
+ * \return true if the annotation was set by an Ipv4FlowProbe
+ */
+static bool
+IsIpv4Annotation (const PacketFlowAnnotation &annotation)
 {
-  return ((m_src == src) && (m_dst == dst));
+  return annotation.flowId != 0 && annotation.key == IPV4_ANNOTATION_KEY;
 }
 
 ////////////////////////////////////////
@@ -299,9 +152,7 @@ Ipv4FlowProbe::SendOutgoingLogger (const Ipv4Header &ipHeader, Ptr<const Packet>
       return;
     }
 
-  Ipv4FlowProbeTag fTag;
-  bool found = ipPayload->FindFirstMatchingByteTag (fTag);
-  if (found)
+  if (IsIpv4Annotation (ipPayload->GetFlowAnnotation ()))
     {
       return;
     }
@@ -313,34 +164,40 @@ Ipv4FlowProbe::SendOutgoingLogger (const Ipv4Header &ipHeader, Ptr<const Packet>
                                      << ipHeader << *ipPayload);
       m_flowMonitor->ReportFirstTx (this, flowId, packetId, size);
 
-      // tag the packet with the flow id and packet id, so that the packet can be identified even
+      // annotate the packet with the flow id and packet id, so that the packet can be identified even
       // when Ipv4Header is not accessible at some non-IPv4 protocol layer
-      Ipv4FlowProbeTag fTag (flowId, packetId, size, ipHeader.GetSource (), ipHeader.GetDestination ());
-      ipPayload->AddByteTag (fTag);
+      PacketFlowAnnotation annotation;
+      annotation.flowId = flowId;
+      annotation.packetId = packetId;
+      annotation.size = size;
+      annotation.key = IPV4_ANNOTATION_KEY;
+      annotation.src = ipHeader.GetSource ().Get ();
+      annotation.dst = ipHeader.GetDestination ().Get ();
+      annotation.firstTxTime = Simulator::Now ();
+      ipPayload->SetFlowAnnotation (annotation);
     }
 }
 
 void
 Ipv4FlowProbe::ForwardLogger (const Ipv4Header &ipHeader, Ptr<const Packet> ipPayload, uint32_t interface)
 {
-  Ipv4FlowProbeTag fTag;
-  bool found = ipPayload->FindFirstMatchingByteTag (fTag);
+  const PacketFlowAnnotation &annotation = ipPayload->GetFlowAnnotation ();
 
-  if (found)
+  if (IsIpv4Annotation (annotation))
     {
       if (!ipHeader.IsLastFragment () || ipHeader.GetFragmentOffset () != 0)
         {
           NS_LOG_WARN ("Not counting fragmented packets");
           return;
         }
-      if (!fTag.IsSrcDstValid (ipHeader.GetSource (), ipHeader.GetDestination ()))
+      if (!IsSrcDstValid (annotation, ipHeader))
         {
           NS_LOG_LOGIC ("Not reporting encapsulated packet");
           return;
         }
 
-      FlowId flowId = fTag.GetFlowId ();
-      FlowPacketId packetId = fTag.GetPacketId ();
+      FlowId flowId = annotation.flowId;
+      FlowPacketId packetId = annotation.packetId;
 
       uint32_t size = (ipPayload->GetSize () + ipHeader.GetSerializedSize ());
       NS_LOG_DEBUG ("ReportForwarding ("<<this<<", "<<flowId<<", "<<packetId<<", "<<size<<");");
@@ -351,19 +208,18 @@ Ipv4FlowProbe::ForwardLogger (const Ipv4Header &ipHeader, Ptr<const Packet> ipPa
 void
 Ipv4FlowProbe::ForwardUpLogger (const Ipv4Header &ipHeader, Ptr<const Packet> ipPayload, uint32_t interface)
 {
-  Ipv4FlowProbeTag fTag;
-  bool found = ipPayload->FindFirstMatchingByteTag (fTag);
+  const PacketFlowAnnotation &annotation = ipPayload->GetFlowAnnotation ();
 
-  if (found)
+  if (IsIpv4Annotation (annotation))
     {
-      if (!fTag.IsSrcDstValid (ipHeader.GetSource (), ipHeader.GetDestination ()))
+      if (!IsSrcDstValid (annotation, ipHeader))
         {
           NS_LOG_LOGIC ("Not reporting encapsulated packet");
           return;
         }
 
-      FlowId flowId = fTag.GetFlowId ();
-      FlowPacketId packetId = fTag.GetPacketId ();
+      FlowId flowId = annotation.flowId;
+      FlowPacketId packetId = annotation.packetId;
 
       uint32_t size = (ipPayload->GetSize () + ipHeader.GetSerializedSize ());
       NS_LOG_DEBUG ("ReportLastRx ("<<this<<", "<<flowId<<", "<<packetId<<", "<<size<<"); "
@@ -394,13 +250,12 @@ Ipv4FlowProbe::DropLogger (const Ipv4Header &ipHeader, Ptr<const Packet> ipPaylo
     }
 #endif
 
-  Ipv4FlowProbeTag fTag;
-  bool found = ipPayload->FindFirstMatchingByteTag (fTag);
+  const PacketFlowAnnotation &annotation = ipPayload->GetFlowAnnotation ();
 
-  if (found)
+  if (IsIpv4Annotation (annotation))
     {
-      FlowId flowId = fTag.GetFlowId ();
-      FlowPacketId packetId = fTag.GetPacketId ();
+      FlowId flowId = annotation.flowId;
+      FlowPacketId packetId = annotation.packetId;
 
       uint32_t size = (ipPayload->GetSize () + ipHeader.GetSerializedSize ());
       NS_LOG_DEBUG ("Drop ("<<this<<", "<<flowId<<", "<<packetId<<", "<<size<<", " << reason 
@@ -449,17 +304,16 @@ Ipv4FlowProbe::DropLogger (const Ipv4Header &ipHeader, Ptr<const Packet> ipPaylo
 void 
 Ipv4FlowProbe::QueueDropLogger (Ptr<const Packet> ipPayload)
 {
-  Ipv4FlowProbeTag fTag;
-  bool tagFound = ipPayload->FindFirstMatchingByteTag (fTag);
+  const PacketFlowAnnotation &annotation = ipPayload->GetFlowAnnotation ();
 
-  if (!tagFound)
+  if (!IsIpv4Annotation (annotation))
     {
       return;
     }
 
-  FlowId flowId = fTag.GetFlowId ();
-  FlowPacketId packetId = fTag.GetPacketId ();
-  uint32_t size = fTag.GetPacketSize ();
+  FlowId flowId = annotation.flowId;
+  FlowPacketId packetId = annotation.packetId;
+  uint32_t size = annotation.size;
 
   NS_LOG_DEBUG ("Drop ("<<this<<", "<<flowId<<", "<<packetId<<", "<<size<<", " << DROP_QUEUE 
                         << "); ");
@@ -470,17 +324,16 @@ Ipv4FlowProbe::QueueDropLogger (Ptr<const Packet> ipPayload)
 void
 Ipv4FlowProbe::QueueDiscDropLogger (Ptr<const QueueDiscItem> item)
 {
-  Ipv4FlowProbeTag fTag;
-  bool tagFound = item->GetPacket ()->FindFirstMatchingByteTag (fTag);
+  const PacketFlowAnnotation &annotation = item->GetPacket ()->GetFlowAnnotation ();
 
-  if (!tagFound)
+  if (!IsIpv4Annotation (annotation))
     {
       return;
     }
 
-  FlowId flowId = fTag.GetFlowId ();
-  FlowPacketId packetId = fTag.GetPacketId ();
-  uint32_t size = fTag.GetPacketSize ();
+  FlowId flowId = annotation.flowId;
+  FlowPacketId packetId = annotation.packetId;
+  uint32_t size = annotation.size;
 
   NS_LOG_DEBUG ("Drop ("<<this<<", "<<flowId<<", "<<packetId<<", "<<size<<", " << DROP_QUEUE_DISC
                         << "); ");
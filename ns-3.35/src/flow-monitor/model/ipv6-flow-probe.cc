@@ -28,164 +28,29 @@
 #include "ns3/pointer.h"
 #include "ns3/config.h"
 #include "ns3/flow-id-tag.h"
+#include "ns3/simulator.h"
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Ipv6FlowProbe");
 
-//////////////////////////////////////
-// Ipv6FlowProbeTag class implementation //
-//////////////////////////////////////
+/// Key of the flow annotations set by Ipv6FlowProbe
+static const uint32_t IPV6_ANNOTATION_KEY = 6;
 
 /**
  * \ingroup flow-monitor
  *
- * \brief Tag used to allow a fast identification of the packet
+ * \brief Check whether a packet was annotated by an Ipv6FlowProbe.
  *
- * This tag is added by FlowMonitor when a packet is seen for
- * the first time, and it is then used to classify the packet in
- * the following hops.
+ * \param annotation the flow annotation of the packet
+ * \return true if the annotation was set by an Ipv6FlowProbe
  */
-class Ipv6FlowProbeTag : public Tag
-{
-public:
-  /**
-   * \brief Get the type ID.
-   * \return the object TypeId
-   */
-  static TypeId GetTypeId (void);
-  virtual TypeId GetInstanceTypeId (void) const;
-  virtual uint32_t GetSerializedSize (void) const;
-  virtual void Serialize (TagBuffer buf) const;
-  virtual void Deserialize (TagBuffer buf);
-  virtual void Print (std::ostream &os) const;
-  Ipv6FlowProbeTag ();
-  /**
-   * \brief Consructor
-   * \param flowId the flow identifier
-   * \param packetId the packet identifier
-   * \param packetSize the packet size
-   */
-  Ipv6FlowProbeTag (uint32_t flowId, uint32_t packetId, uint32_t packetSize);
-  /**
-   * \brief Set the flow identifier
-   * \param flowId the flow identifier
-   */
-  void SetFlowId (uint32_t flowId);
-  /**
-   * \brief Set the packet identifier
-   * \param packetId the packet identifier
-   */
-  void SetPacketId (uint32_t packetId);
-  /**
-   * \brief Set the packet size
-   * \param packetSize the packet size
-   */
-  void SetPacketSize (uint32_t packetSize);
-  /**
-   * \brief Set the flow identifier
-   * \returns the flow identifier
-   */
-  uint32_t GetFlowId (void) const;
-  /**
-   * \brief Set the packet identifier
-   * \returns the packet identifier
-   */
-  uint32_t GetPacketId (void) const;
-  /**
-   * \brief Get the packet size
-   * \returns the packet size
-   */
-  uint32_t GetPacketSize (void) const;
-private:
-  uint32_t m_flowId;      //!< flow identifier
-  uint32_t m_packetId;    //!< packet identifier
-  uint32_t m_packetSize;  //!< packet size
-
-};
-
-TypeId 
-Ipv6FlowProbeTag::GetTypeId (void)
-{
-  static TypeId tid = TypeId ("ns3::Ipv6FlowProbeTag")
-    .SetParent<Tag> ()
-    .SetGroupName ("FlowMonitor")
-    .AddConstructor<Ipv6FlowProbeTag> ()
-  ;
-  return tid;
-}
-TypeId 
-Ipv6FlowProbeTag::GetInstanceTypeId (void) const
-{
-  return GetTypeId ();
-}
-uint32_t 
-Ipv6FlowProbeTag::GetSerializedSize (void) const
-{
-  return 4 + 4 + 4;
-}
-void 
-Ipv6FlowProbeTag::Serialize (TagBuffer buf) const
-{
-  buf.WriteU32 (m_flowId);
-  buf.WriteU32 (m_packetId);
-  buf.WriteU32 (m_packetSize);
-}
-void 
-Ipv6FlowProbeTag::Deserialize (TagBuffer buf)
-{
-  m_flowId = buf.ReadU32 ();
-  m_packetId = buf.ReadU32 ();
-  m_packetSize = buf.ReadU32 ();
-}
-void 
-Ipv6FlowProbeTag::Print (std::ostream &os) const
-{
-  os << "FlowId=" << m_flowId;
-  os << "PacketId=" << m_packetId;
-  os << "PacketSize=" << m_packetSize;
-}
-Ipv6FlowProbeTag::Ipv6FlowProbeTag ()
-  : Tag () 
+static bool
+IsIpv6Annotation (const PacketFlowAnnotation &annotation)
 {
+  return annotation.flowId != 0 && annotation.key == IPV6_ANNOTATION_KEY;
 }
 
-Ipv6FlowProbeTag::Ipv6FlowProbeTag (uint32_t flowId, uint32_t packetId, uint32_t packetSize)
-  : Tag (), m_flowId (flowId), m_packetId (packetId), m_packetSize (packetSize)
-{
-}
-
-void
-Ipv6FlowProbeTag::SetFlowId (uint32_t id)
-{
-  m_flowId = id;
-}
-void
-Ipv6FlowProbeTag::SetPacketId (uint32_t id)
-{
-  m_packetId = id;
-}
-void
-Ipv6FlowProbeTag::SetPacketSize (uint32_t size)
-{
-  m_packetSize = size;
-}
-uint32_t
-Ipv6FlowProbeTag::GetFlowId (void) const
-{
-  return m_flowId;
-}
-uint32_t
-Ipv6FlowProbeTag::GetPacketId (void) const
-{
-  return m_packetId;
-} 
-uint32_t
-Ipv6FlowProbeTag::GetPacketSize (void) const
-{
-  return m_packetSize;
-} 
-
 ////////////////////////////////////////
 // Ipv6FlowProbe class implementation //
 ////////////////////////////////////////
@@ -268,23 +133,31 @@ Ipv6FlowProbe::SendOutgoingLogger (const Ipv6Header &ipHeader, Ptr<const Packet>
                                      << ipHeader << *ipPayload);
       m_flowMonitor->ReportFirstTx (this, flowId, packetId, size);
 
-      // tag the packet with the flow id and packet id, so that the packet can be identified even
-      // when Ipv6Header is not accessible at some non-IPv6 protocol layer
-      Ipv6FlowProbeTag fTag (flowId, packetId, size);
-      ipPayload->AddByteTag (fTag);
+      // annotate the packet with the flow id and packet id, so that the packet can be identified even
+      // when Ipv6Header is not accessible at some non-IPv6 protocol layer; as with the tags this
+      // replaces, the first annotation of a packet sent out twice is kept
+      if (!IsIpv6Annotation (ipPayload->GetFlowAnnotation ()))
+        {
+          PacketFlowAnnotation annotation;
+          annotation.flowId = flowId;
+          annotation.packetId = packetId;
+          annotation.size = size;
+          annotation.key = IPV6_ANNOTATION_KEY;
+          annotation.firstTxTime = Simulator::Now ();
+          ipPayload->SetFlowAnnotation (annotation);
+        }
     }
 }
 
 void
 Ipv6FlowProbe::ForwardLogger (const Ipv6Header &ipHeader, Ptr<const Packet> ipPayload, uint32_t interface)
 {
-  Ipv6FlowProbeTag fTag;
-  bool found = ipPayload->FindFirstMatchingByteTag (fTag);
+  const PacketFlowAnnotation &annotation = ipPayload->GetFlowAnnotation ();
 
-  if (found)
+  if (IsIpv6Annotation (annotation))
     {
-      FlowId flowId = fTag.GetFlowId ();
-      FlowPacketId packetId = fTag.GetPacketId ();
+      FlowId flowId = annotation.flowId;
+      FlowPacketId packetId = annotation.packetId;
 
       uint32_t size = (ipPayload->GetSize () + ipHeader.GetSerializedSize ());
       NS_LOG_DEBUG ("ReportForwarding ("<<this<<", "<<flowId<<", "<<packetId<<", "<<size<<");");
@@ -295,13 +168,12 @@ Ipv6FlowProbe::ForwardLogger (const Ipv6Header &ipHeader, Ptr<const Packet> ipPa
 void
 Ipv6FlowProbe::ForwardUpLogger (const Ipv6Header &ipHeader, Ptr<const Packet> ipPayload, uint32_t interface)
 {
-  Ipv6FlowProbeTag fTag;
-  bool found = ipPayload->FindFirstMatchingByteTag (fTag);
+  const PacketFlowAnnotation &annotation = ipPayload->GetFlowAnnotation ();
 
-  if (found)
+  if (IsIpv6Annotation (annotation))
     {
-      FlowId flowId = fTag.GetFlowId ();
-      FlowPacketId packetId = fTag.GetPacketId ();
+      FlowId flowId = annotation.flowId;
+      FlowPacketId packetId = annotation.packetId;
 
       uint32_t size = (ipPayload->GetSize () + ipHeader.GetSerializedSize ());
       NS_LOG_DEBUG ("ReportLastRx ("<<this<<", "<<flowId<<", "<<packetId<<", "<<size<<");");
@@ -331,13 +203,12 @@ Ipv6FlowProbe::DropLogger (const Ipv6Header &ipHeader, Ptr<const Packet> ipPaylo
     }
 #endif
 
-  Ipv6FlowProbeTag fTag;
-  bool found = ipPayload->FindFirstMatchingByteTag (fTag);
+  const PacketFlowAnnotation &annotation = ipPayload->GetFlowAnnotation ();
 
-  if (found)
+  if (IsIpv6Annotation (annotation))
     {
-      FlowId flowId = fTag.GetFlowId ();
-      FlowPacketId packetId = fTag.GetPacketId ();
+      FlowId flowId = annotation.flowId;
+      FlowPacketId packetId = annotation.packetId;
 
       uint32_t size = (ipPayload->GetSize () + ipHeader.GetSerializedSize ());
       NS_LOG_DEBUG ("Drop ("<<this<<", "<<flowId<<", "<<packetId<<", "<<size<<", " << reason 
@@ -393,17 +264,16 @@ Ipv6FlowProbe::DropLogger (const Ipv6Header &ipHeader, Ptr<const Packet> ipPaylo
 void 
 Ipv6FlowProbe::QueueDropLogger (Ptr<const Packet> ipPayload)
 {
-  Ipv6FlowProbeTag fTag;
-  bool tagFound = ipPayload->FindFirstMatchingByteTag (fTag);
+  const PacketFlowAnnotation &annotation = ipPayload->GetFlowAnnotation ();
 
-  if (!tagFound)
+  if (!IsIpv6Annotation (annotation))
     {
       return;
     }
 
-  FlowId flowId = fTag.GetFlowId ();
-  FlowPacketId packetId = fTag.GetPacketId ();
-  uint32_t size = fTag.GetPacketSize ();
+  FlowId flowId = annotation.flowId;
+  FlowPacketId packetId = annotation.packetId;
+  uint32_t size = annotation.size;
 
   NS_LOG_DEBUG ("Drop ("<<this<<", "<<flowId<<", "<<packetId<<", "<<size<<", " << DROP_QUEUE 
                         << "); ");
@@ -414,17 +284,16 @@ Ipv6FlowProbe::QueueDropLogger (Ptr<const Packet> ipPayload)
 void
 Ipv6FlowProbe::QueueDiscDropLogger (Ptr<const QueueDiscItem> item)
 {
-  Ipv6FlowProbeTag fTag;
-  bool tagFound = item->GetPacket ()->FindFirstMatchingByteTag (fTag);
+  const PacketFlowAnnotation &annotation = item->GetPacket ()->GetFlowAnnotation ();
 
-  if (!tagFound)
+  if (!IsIpv6Annotation (annotation))
     {
       return;
     }
 
-  FlowId flowId = fTag.GetFlowId ();
-  FlowPacketId packetId = fTag.GetPacketId ();
-  uint32_t size = fTag.GetPacketSize ();
+  FlowId flowId = annotation.flowId;
+  FlowPacketId packetId = annotation.packetId;
+  uint32_t size = annotation.size;
 
   NS_LOG_DEBUG ("Drop ("<<this<<", "<<flowId<<", "<<packetId<<", "<<size<<", " << DROP_QUEUE_DISC
                         << "); ");
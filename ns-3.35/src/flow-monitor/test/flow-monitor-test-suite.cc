@@ -0,0 +1,325 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/simple-channel.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/socket.h"
+#include "ns3/packet.h"
+#include "ns3/flow-monitor-helper.h"
+#include "ns3/ipv4-flow-classifier.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-gro.h"
+#include "ns3/data-rate.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup flow-monitor
+ * \defgroup flow-monitor-test FlowMonitor module tests
+ */
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief Check that the packets sent back by an echo server, which removes
+ * the byte tags of the packets it receives, are reported as a second flow.
+ */
+class FlowMonitorEchoTestCase : public TestCase
+{
+public:
+  FlowMonitorEchoTestCase ();
+  virtual ~FlowMonitorEchoTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Send a packet to the server
+   * \param socket the client socket
+   * \param to the server address
+   */
+  void Send (Ptr<Socket> socket, Address to);
+  /**
+   * Send back the packets received, as UdpEchoServer does
+   * \param socket the server socket
+   */
+  void Echo (Ptr<Socket> socket);
+  /**
+   * Receive the echoed packets
+   * \param socket the client socket
+   */
+  void Receive (Ptr<Socket> socket);
+
+  uint32_t m_nEchoed;   //!< the number of packets received by the client
+};
+
+FlowMonitorEchoTestCase::FlowMonitorEchoTestCase ()
+  : TestCase ("Check the flows of an echo client and server"),
+    m_nEchoed (0)
+{
+}
+
+FlowMonitorEchoTestCase::~FlowMonitorEchoTestCase ()
+{
+}
+
+void
+FlowMonitorEchoTestCase::Send (Ptr<Socket> socket, Address to)
+{
+  socket->SendTo (Create<Packet> (100), 0, to);
+}
+
+void
+FlowMonitorEchoTestCase::Echo (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  Address from;
+  while ((packet = socket->RecvFrom (from)))
+    {
+      packet->RemoveAllPacketTags ();
+      packet->RemoveAllByteTags ();
+      socket->SendTo (packet, 0, from);
+    }
+}
+
+void
+FlowMonitorEchoTestCase::Receive (Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+      m_nEchoed++;
+    }
+}
+
+void
+FlowMonitorEchoTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+
+  SimpleNetDeviceHelper simpleHelper;
+  simpleHelper.SetNetDevicePointToPointMode (true);
+  NetDeviceContainer devices = simpleHelper.Install (nodes, CreateObject<SimpleChannel> ());
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.0.0.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+  Ptr<Socket> server = Socket::CreateSocket (nodes.Get (1), TypeId::LookupByName ("ns3::UdpSocketFactory"));
+  NS_TEST_EXPECT_MSG_EQ (server->Bind (InetSocketAddress (Ipv4Address::GetAny (), 9)), 0, "Server bind failed");
+  server->SetRecvCallback (MakeCallback (&FlowMonitorEchoTestCase::Echo, this));
+
+  Ptr<Socket> client = Socket::CreateSocket (nodes.Get (0), TypeId::LookupByName ("ns3::UdpSocketFactory"));
+  NS_TEST_EXPECT_MSG_EQ (client->Bind (), 0, "Client bind failed");
+  client->SetRecvCallback (MakeCallback (&FlowMonitorEchoTestCase::Receive, this));
+
+  FlowMonitorHelper flowmon;
+  Ptr<FlowMonitor> monitor = flowmon.InstallAll ();
+
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Simulator::ScheduleWithContext (nodes.Get (0)->GetId (), Seconds (1 + i),
+                                      &FlowMonitorEchoTestCase::Send, this, client,
+                                      InetSocketAddress (interfaces.GetAddress (1), 9));
+    }
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_nEchoed, 3, "The client must receive the three packets back");
+
+  Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier> (flowmon.GetClassifier ());
+  FlowMonitor::FlowStatsContainer stats = monitor->GetFlowStats ();
+  NS_TEST_ASSERT_MSG_EQ (stats.size (), 2, "The requests and the replies must be two flows");
+  for (FlowMonitor::FlowStatsContainerCI i = stats.begin (); i != stats.end (); i++)
+    {
+      Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow (i->first);
+      bool request = (t.destinationPort == 9);
+      NS_TEST_EXPECT_MSG_EQ (t.sourceAddress, interfaces.GetAddress (request ? 0 : 1), "Wrong flow source");
+      NS_TEST_EXPECT_MSG_EQ (i->second.txPackets, 3, "Wrong number of packets sent");
+      NS_TEST_EXPECT_MSG_EQ (i->second.rxPackets, 3, "Wrong number of packets received");
+    }
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief Check that every TCP segment merged by the generic receive offload
+ * of the receiver is reported as received, and none as lost.
+ */
+class FlowMonitorGroTestCase : public TestCase
+{
+public:
+  FlowMonitorGroTestCase ();
+  virtual ~FlowMonitorGroTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Send data while there is room in the send buffer
+   * \param socket the client socket
+   * \param available the room in the send buffer
+   */
+  void Send (Ptr<Socket> socket, uint32_t available);
+  /**
+   * Accept a connection
+   * \param socket the accepted socket
+   * \param from the address of the client
+   */
+  void Accept (Ptr<Socket> socket, const Address &from);
+  /**
+   * Receive the data
+   * \param socket the server socket
+   */
+  void Receive (Ptr<Socket> socket);
+
+  uint32_t m_toSend;     //!< the number of bytes still to send
+  uint32_t m_received;   //!< the number of bytes received by the server
+};
+
+FlowMonitorGroTestCase::FlowMonitorGroTestCase ()
+  : TestCase ("Check the flows of a TCP transfer with generic receive offload"),
+    m_toSend (200000),
+    m_received (0)
+{
+}
+
+FlowMonitorGroTestCase::~FlowMonitorGroTestCase ()
+{
+}
+
+void
+FlowMonitorGroTestCase::Send (Ptr<Socket> socket, uint32_t available)
+{
+  while (m_toSend > 0 && socket->GetTxAvailable () > 0)
+    {
+      uint32_t size = std::min (m_toSend, socket->GetTxAvailable ());
+      int sent = socket->Send (Create<Packet> (size));
+      if (sent <= 0)
+        {
+          break;
+        }
+      m_toSend -= sent;
+    }
+}
+
+void
+FlowMonitorGroTestCase::Accept (Ptr<Socket> socket, const Address &from)
+{
+  socket->SetRecvCallback (MakeCallback (&FlowMonitorGroTestCase::Receive, this));
+}
+
+void
+FlowMonitorGroTestCase::Receive (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      m_received += packet->GetSize ();
+    }
+}
+
+void
+FlowMonitorGroTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+
+  SimpleNetDeviceHelper simpleHelper;
+  simpleHelper.SetNetDevicePointToPointMode (true);
+  simpleHelper.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("1Gbps")));
+  simpleHelper.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (1)));
+  NetDeviceContainer devices = simpleHelper.Install (nodes);
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.0.0.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+  Ptr<Ipv4Gro> gro = CreateObject<Ipv4Gro> ();
+  nodes.Get (1)->GetObject<Ipv4L3Protocol> ()->SetGro (interfaces.Get (1).second, gro);
+
+  Ptr<Socket> server = Socket::CreateSocket (nodes.Get (1), TypeId::LookupByName ("ns3::TcpSocketFactory"));
+  NS_TEST_EXPECT_MSG_EQ (server->Bind (InetSocketAddress (Ipv4Address::GetAny (), 9)), 0, "Server bind failed");
+  server->Listen ();
+  server->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                             MakeCallback (&FlowMonitorGroTestCase::Accept, this));
+
+  Ptr<Socket> client = Socket::CreateSocket (nodes.Get (0), TypeId::LookupByName ("ns3::TcpSocketFactory"));
+  NS_TEST_EXPECT_MSG_EQ (client->Bind (), 0, "Client bind failed");
+  client->SetSendCallback (MakeCallback (&FlowMonitorGroTestCase::Send, this));
+
+  FlowMonitorHelper flowmon;
+  Ptr<FlowMonitor> monitor = flowmon.InstallAll ();
+
+  Simulator::ScheduleWithContext (nodes.Get (0)->GetId (), Seconds (1),
+                                  &Socket::Connect, client,
+                                  InetSocketAddress (interfaces.GetAddress (1), 9));
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_received, 200000, "The server must receive all the data");
+  NS_TEST_EXPECT_MSG_GT (gro->GetCoalescingRatio (), 1.5, "The receive offload must merge segments");
+
+  monitor->CheckForLostPackets ();
+  Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier> (flowmon.GetClassifier ());
+  FlowMonitor::FlowStatsContainer stats = monitor->GetFlowStats ();
+  NS_TEST_ASSERT_MSG_EQ (stats.size (), 2, "The data and the ACKs must be two flows");
+  for (FlowMonitor::FlowStatsContainerCI i = stats.begin (); i != stats.end (); i++)
+    {
+      Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow (i->first);
+      bool data = (t.destinationPort == 9);
+      if (data)
+        {
+          NS_TEST_EXPECT_MSG_GT (i->second.txPackets, 200000 / 536, "Too few data packets sent");
+        }
+      NS_TEST_EXPECT_MSG_EQ (i->second.rxPackets, i->second.txPackets, "Wrong number of packets received");
+      NS_TEST_EXPECT_MSG_EQ (i->second.rxBytes, i->second.txBytes, "Wrong number of bytes received");
+      NS_TEST_EXPECT_MSG_EQ (i->second.lostPackets, 0, "No packet may be lost");
+    }
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief FlowMonitor Test Suite
+ */
+static class FlowMonitorTestSuite : public TestSuite
+{
+public:
+  FlowMonitorTestSuite ()
+    : TestSuite ("flow-monitor", UNIT)
+  {
+    AddTestCase (new FlowMonitorEchoTestCase (), TestCase::QUICK);
+    AddTestCase (new FlowMonitorGroTestCase (), TestCase::QUICK);
+  }
+} g_flowMonitorTestSuite; ///< the test suite
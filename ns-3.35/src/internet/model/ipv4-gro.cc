@@ -0,0 +1,302 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/node.h"
+#include "ipv4-gro.h"
+#include "tcp-l4-protocol.h"
+#include "tcp-option-ts.h"
+#include "tcp-tso-tag.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4Gro");
+
+NS_OBJECT_ENSURE_REGISTERED (Ipv4Gro);
+
+TypeId
+Ipv4Gro::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::Ipv4Gro")
+    .SetParent<Object> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<Ipv4Gro> ()
+    .AddAttribute ("Timeout",
+                   "Maximum time a segment is held to be merged with the following ones",
+                   TimeValue (MicroSeconds (20)),
+                   MakeTimeAccessor (&Ipv4Gro::m_timeout),
+                   MakeTimeChecker (NanoSeconds (1)))
+    .AddAttribute ("MaxSegments",
+                   "Maximum number of segments merged together",
+                   UintegerValue (64),
+                   MakeUintegerAccessor (&Ipv4Gro::m_maxSegments),
+                   MakeUintegerChecker<uint32_t> (2, 64))
+    .AddAttribute ("MaxFlows",
+                   "Maximum number of flows with held segments",
+                   UintegerValue (8),
+                   MakeUintegerAccessor (&Ipv4Gro::m_maxFlows),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddTraceSource ("Coalesced",
+                     "Merged segments delivered to IPv4",
+                     MakeTraceSourceAccessor (&Ipv4Gro::m_coalescedTrace),
+                     "ns3::Ipv4Gro::CoalescedTracedCallback")
+  ;
+  return tid;
+}
+
+Ipv4Gro::Ipv4Gro ()
+  : m_nReceived (0),
+    m_nDelivered (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Ipv4Gro::~Ipv4Gro ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+Ipv4Gro::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_flushEvent.Cancel ();
+  m_held.clear ();
+  m_deliver = MakeNullCallback<void, Ptr<Packet>, const Ipv4Header &> ();
+  Object::DoDispose ();
+}
+
+void
+Ipv4Gro::SetDeliverCallback (DeliverCallback cb)
+{
+  NS_LOG_FUNCTION (this);
+  m_deliver = cb;
+}
+
+uint64_t
+Ipv4Gro::GetNReceivedPackets (void) const
+{
+  return m_nReceived;
+}
+
+uint64_t
+Ipv4Gro::GetNDeliveredPackets (void) const
+{
+  return m_nDelivered;
+}
+
+double
+Ipv4Gro::GetCoalescingRatio (void) const
+{
+  return m_nDelivered > 0 ? static_cast<double> (m_nReceived) / m_nDelivered : 1.0;
+}
+
+bool
+Ipv4Gro::IsMergeable (Ptr<const Packet> packet, const TcpHeader &tcpHeader) const
+{
+  if (tcpHeader.GetSerializedSize () >= packet->GetSize ())
+    {
+      return false;
+    }
+  if ((tcpHeader.GetFlags () & ~TcpHeader::PSH) != TcpHeader::ACK)
+    {
+      return false;
+    }
+  // no option but timestamps, which take 12 bytes with the padding
+  return tcpHeader.GetLength () == 5
+         || (tcpHeader.GetLength () == 8 && tcpHeader.HasOption (TcpOption::TS));
+}
+
+bool
+Ipv4Gro::CanAppend (const HeldSegment &held, const Ipv4Header &ipHeader,
+                    const TcpHeader &tcpHeader, uint32_t size) const
+{
+  if (tcpHeader.GetSequenceNumber () != held.tcpHeader.GetSequenceNumber () + held.size
+      || size > held.segmentSize
+      || held.nSegments >= m_maxSegments
+      || held.size + size > 65535 - ipHeader.GetSerializedSize () - held.tcpHeader.GetSerializedSize ())
+    {
+      return false;
+    }
+  if (ipHeader.GetTos () != held.ipHeader.GetTos ()
+      || ipHeader.GetTtl () != held.ipHeader.GetTtl ()
+      || ipHeader.IsDontFragment () != held.ipHeader.IsDontFragment ())
+    {
+      return false;
+    }
+  if (tcpHeader.GetAckNumber () != held.tcpHeader.GetAckNumber ()
+      || tcpHeader.GetWindowSize () != held.tcpHeader.GetWindowSize ()
+      || tcpHeader.GetLength () != held.tcpHeader.GetLength ())
+    {
+      return false;
+    }
+  if (tcpHeader.HasOption (TcpOption::TS))
+    {
+      Ptr<const TcpOptionTS> ts = DynamicCast<const TcpOptionTS> (tcpHeader.GetOption (TcpOption::TS));
+      Ptr<const TcpOptionTS> heldTs = DynamicCast<const TcpOptionTS> (held.tcpHeader.GetOption (TcpOption::TS));
+      if (heldTs == nullptr || ts->GetTimestamp () != heldTs->GetTimestamp ()
+          || ts->GetEcho () != heldTs->GetEcho ())
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+std::size_t
+Ipv4Gro::Find (const Ipv4Header &ipHeader, const TcpHeader &tcpHeader) const
+{
+  std::size_t i = 0;
+  for (; i < m_held.size (); i++)
+    {
+      const HeldSegment &held = m_held[i];
+      if (held.tcpHeader.GetSourcePort () == tcpHeader.GetSourcePort ()
+          && held.tcpHeader.GetDestinationPort () == tcpHeader.GetDestinationPort ()
+          && held.ipHeader.GetSource () == ipHeader.GetSource ()
+          && held.ipHeader.GetDestination () == ipHeader.GetDestination ())
+        {
+          break;
+        }
+    }
+  return i;
+}
+
+void
+Ipv4Gro::Receive (Ptr<Packet> packet, const Ipv4Header &header)
+{
+  NS_LOG_FUNCTION (this << packet << header);
+  NS_ASSERT (!m_deliver.IsNull ());
+
+  m_nReceived++;
+  if (header.GetProtocol () != TcpL4Protocol::PROT_NUMBER
+      || !header.IsLastFragment () || header.GetFragmentOffset () != 0)
+    {
+      m_nDelivered++;
+      m_deliver (packet, header);
+      return;
+    }
+
+  TcpHeader tcpHeader;
+  packet->PeekHeader (tcpHeader);
+  bool mergeable = IsMergeable (packet, tcpHeader);
+  uint32_t size = packet->GetSize () - tcpHeader.GetSerializedSize ();
+
+  std::size_t i = Find (header, tcpHeader);
+  if (i < m_held.size ())
+    {
+      HeldSegment &held = m_held[i];
+      if (mergeable && CanAppend (held, header, tcpHeader, size))
+        {
+          if (held.payload == nullptr)
+            {
+              held.payload = held.packet->Copy ();
+              TcpHeader firstHeader;
+              held.payload->RemoveHeader (firstHeader);
+            }
+          Ptr<Packet> payload = packet->Copy ();
+          TcpHeader segmentHeader;
+          payload->RemoveHeader (segmentHeader);
+          held.payload->AddAtEnd (payload);
+          held.size += size;
+          held.nSegments++;
+          held.tcpHeader.SetFlags (held.tcpHeader.GetFlags () | tcpHeader.GetFlags ());
+          NS_LOG_LOGIC ("Merged segment " << tcpHeader.GetSequenceNumber () << ", " <<
+                        held.nSegments << " segments held");
+          // a short segment or PSH ends the merged segment, as in Linux
+          if (size < held.segmentSize || (tcpHeader.GetFlags () & TcpHeader::PSH)
+              || held.nSegments >= m_maxSegments)
+            {
+              Deliver (i);
+            }
+          return;
+        }
+      // deliver the held segments of the flow first, to keep the order
+      Deliver (i);
+    }
+
+  if (!mergeable || (tcpHeader.GetFlags () & TcpHeader::PSH))
+    {
+      m_nDelivered++;
+      m_deliver (packet, header);
+      return;
+    }
+
+  if (m_held.size () >= m_maxFlows)
+    {
+      Deliver (0);
+    }
+  HeldSegment held;
+  held.packet = packet;
+  held.ipHeader = header;
+  held.tcpHeader = tcpHeader;
+  held.size = size;
+  held.segmentSize = size;
+  held.nSegments = 1;
+  m_held.push_back (held);
+  if (!m_flushEvent.IsRunning ())
+    {
+      m_flushEvent = Simulator::Schedule (m_timeout, &Ipv4Gro::Flush, this);
+    }
+}
+
+void
+Ipv4Gro::Deliver (std::size_t i)
+{
+  NS_LOG_FUNCTION (this << i);
+  HeldSegment held = m_held[i];
+  m_held.erase (m_held.begin () + i);
+  if (m_held.empty ())
+    {
+      m_flushEvent.Cancel ();
+    }
+
+  m_nDelivered++;
+  if (held.nSegments == 1)
+    {
+      m_deliver (held.packet, held.ipHeader);
+      return;
+    }
+
+  // Rebuild the headers of the merged segment
+  Ptr<Packet> packet = held.payload;
+  if (Node::ChecksumEnabled ())
+    {
+      held.tcpHeader.EnableChecksums ();
+      held.tcpHeader.InitializeChecksum (held.ipHeader.GetSource (), held.ipHeader.GetDestination (),
+                                         TcpL4Protocol::PROT_NUMBER);
+    }
+  packet->AddHeader (held.tcpHeader);
+  packet->AddPacketTag (TcpTsoTag (static_cast<uint16_t> (held.segmentSize),
+                                   static_cast<uint16_t> (held.nSegments)));
+  held.ipHeader.SetPayloadSize (packet->GetSize ());
+  NS_LOG_LOGIC ("Deliver " << held.nSegments << " merged segments of " << held.size << " bytes");
+  m_coalescedTrace (held.nSegments, held.size);
+  m_deliver (packet, held.ipHeader);
+}
+
+void
+Ipv4Gro::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  while (!m_held.empty ())
+    {
+      Deliver (0);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,185 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef IPV4_GRO_H
+#define IPV4_GRO_H
+
+#include <vector>
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/callback.h"
+#include "ns3/traced-callback.h"
+#include "ns3/packet.h"
+#include "ipv4-header.h"
+#include "tcp-header.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup ipv4
+ *
+ * \brief Generic receive offload for the TCP segments received on an
+ * IPv4 interface
+ *
+ * Modelled after the Linux GRO (net/core/gro.c, net/ipv4/tcp_offload.c).
+ * The TCP data segments destined to the node are held for up to the
+ * Timeout, and the back-to-back in-order segments of a flow are merged
+ * into a single segment before TCP sees them.  A held segment
+ * is delivered when the timeout expires, when a segment that cannot be
+ * merged is received for its flow, when it reaches the maximum size or
+ * when it ends with a segment shorter than the first one.
+ *
+ * Segments are only merged if their IPv4 headers have the same TOS byte
+ * (hence the same ECN codepoint), TTL and flags, and their TCP headers the
+ * same ACK number, window and options, carry only ACK (and PSH on the last
+ * segment) and no option but timestamps.  A change of the CE codepoint
+ * thus always starts a new merged segment, and the receiver sees every
+ * CE transition.  A merged segment carries a TcpTsoTag with the number of
+ * merged segments, that TCP uses to count them for the delayed ACKs.
+ *
+ * GRO is enabled on an interface with Ipv4L3Protocol::SetGro.  The
+ * segments are routed, and reported by the LocalDeliver trace of
+ * Ipv4L3Protocol (hence to the FlowMonitor probes), one by one before they
+ * are merged.
+ */
+class Ipv4Gro : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  Ipv4Gro ();
+  virtual ~Ipv4Gro ();
+
+  /**
+   * \brief Callback to deliver a (possibly merged) packet to IPv4
+   */
+  typedef Callback<void, Ptr<Packet>, const Ipv4Header &> DeliverCallback;
+
+  /**
+   * \brief Set the callback to deliver the packets
+   * \param cb the callback
+   */
+  void SetDeliverCallback (DeliverCallback cb);
+
+  /**
+   * \brief Receive a valid packet destined to the node
+   *
+   * The packet is either held to be merged with the following segments of
+   * its flow, or delivered right away after the held segments of its flow.
+   *
+   * \param packet the packet, without the IPv4 header
+   * \param header the IPv4 header
+   */
+  void Receive (Ptr<Packet> packet, const Ipv4Header &header);
+
+  /**
+   * \brief Deliver all the held segments
+   */
+  void Flush (void);
+
+  /**
+   * \return the number of packets received
+   */
+  uint64_t GetNReceivedPackets (void) const;
+
+  /**
+   * \return the number of packets delivered
+   */
+  uint64_t GetNDeliveredPackets (void) const;
+
+  /**
+   * \return the average number of received packets per delivered packet
+   */
+  double GetCoalescingRatio (void) const;
+
+  /**
+   * TracedCallback signature for the delivery of merged segments.
+   *
+   * \param [in] nSegments the number of merged segments
+   * \param [in] size the payload size of the merged segment
+   */
+  typedef void (* CoalescedTracedCallback)(uint32_t nSegments, uint32_t size);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief The segments of a flow being merged
+   */
+  struct HeldSegment
+  {
+    Ptr<Packet> packet;      //!< First segment, with its TCP header
+    Ptr<Packet> payload;     //!< Merged payload, null while a single segment is held
+    Ipv4Header ipHeader;     //!< IPv4 header of the first segment
+    TcpHeader tcpHeader;     //!< TCP header of the first segment
+    uint32_t size;           //!< Payload size of the merged segments
+    uint32_t segmentSize;    //!< Payload size of the first segment
+    uint32_t nSegments;      //!< Number of merged segments
+  };
+
+  /**
+   * \brief Check whether a segment can be held and merged
+   * \param packet the TCP segment
+   * \param tcpHeader the TCP header of the segment
+   * \return true if the segment can be merged with other segments
+   */
+  bool IsMergeable (Ptr<const Packet> packet, const TcpHeader &tcpHeader) const;
+
+  /**
+   * \brief Check whether a segment can be appended to a held segment
+   * \param held the held segment, of the same flow
+   * \param ipHeader the IPv4 header of the segment
+   * \param tcpHeader the TCP header of the segment
+   * \param size the payload size of the segment
+   * \return true if the segment can be appended
+   */
+  bool CanAppend (const HeldSegment &held, const Ipv4Header &ipHeader,
+                  const TcpHeader &tcpHeader, uint32_t size) const;
+
+  /**
+   * \brief Find the held segment of the flow of a packet
+   * \param ipHeader the IPv4 header of the packet
+   * \param tcpHeader the TCP header of the packet
+   * \return the index of the held segment, or the number of held segments if none
+   */
+  std::size_t Find (const Ipv4Header &ipHeader, const TcpHeader &tcpHeader) const;
+
+  /**
+   * \brief Deliver a held segment and remove it
+   * \param i the index of the held segment
+   */
+  void Deliver (std::size_t i);
+
+  Time m_timeout;                    //!< Maximum time a segment is held
+  uint32_t m_maxSegments;            //!< Maximum number of merged segments
+  uint32_t m_maxFlows;               //!< Maximum number of flows with held segments
+  DeliverCallback m_deliver;         //!< Callback to deliver the packets
+  std::vector<HeldSegment> m_held;   //!< Held segments, by arrival of the first segment
+  EventId m_flushEvent;              //!< Timeout of the held segments
+  uint64_t m_nReceived;              //!< Number of received packets
+  uint64_t m_nDelivered;             //!< Number of delivered packets
+  TracedCallback<uint32_t, uint32_t> m_coalescedTrace; //!< Trace of the merged segments
+};
+
+} // namespace ns3
+
+#endif /* IPV4_GRO_H */
@@ -30,6 +30,7 @@
 #include "ns3/node.h"
 #include "ns3/pointer.h"
 #include "ns3/traffic-control-layer.h"
+#include "ipv4-gro.h"
 
 
 namespace ns3 {
@@ -85,6 +86,11 @@ Ipv4Interface::DoDispose (void)
   m_device = 0;
   m_tc = 0;
   m_cache = 0;
+  if (m_gro != 0)
+    {
+      m_gro->Dispose ();
+      m_gro = 0;
+    }
   Object::DoDispose ();
 }
 
@@ -162,6 +168,19 @@ Ipv4Interface::GetArpCache () const
   return m_cache;
 }
 
+void
+Ipv4Interface::SetGro (Ptr<Ipv4Gro> gro)
+{
+  NS_LOG_FUNCTION (this << gro);
+  m_gro = gro;
+}
+
+Ptr<Ipv4Gro>
+Ipv4Interface::GetGro (void) const
+{
+  return m_gro;
+}
+
 /**
  * These are IP interface states and may be distinct from 
  * NetDevice states, such as found in real implementations
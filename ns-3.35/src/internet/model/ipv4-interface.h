@@ -32,6 +32,7 @@ class NetDevice;
 class Packet;
 class Node;
 class ArpCache;
+class Ipv4Gro;
 class Ipv4InterfaceAddress;
 class Ipv4Address;
 class Ipv4Header;
@@ -93,6 +94,20 @@ public:
    */
   Ptr<ArpCache> GetArpCache () const;
 
+  /**
+   * \brief Set the generic receive offload stage of this interface
+   *
+   * Use Ipv4L3Protocol::SetGro, which connects the stage to IPv4.
+   *
+   * \param gro the receive offload stage, or null to disable it
+   */
+  void SetGro (Ptr<Ipv4Gro> gro);
+
+  /**
+   * \return the generic receive offload stage of this interface, if any
+   */
+  Ptr<Ipv4Gro> GetGro (void) const;
+
   /**
    * \param metric configured routing metric (cost) of this interface
    *
@@ -239,6 +254,7 @@ private:
   Ptr<NetDevice> m_device; //!< The associated NetDevice
   Ptr<TrafficControlLayer> m_tc; //!< The associated TrafficControlLayer
   Ptr<ArpCache> m_cache; //!< ARP cache
+  Ptr<Ipv4Gro> m_gro; //!< Generic receive offload stage
 };
 
 } // namespace ns3
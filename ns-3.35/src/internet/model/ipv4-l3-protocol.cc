@@ -43,6 +43,9 @@
 #include "icmpv4-l4-protocol.h"
 #include "ipv4-interface.h"
 #include "ipv4-raw-socket-impl.h"
+#include "tcp-l4-protocol.h"
+#include "tcp-tso-tag.h"
+#include "ipv4-gro.h"
 
 namespace ns3 {
 
@@ -86,6 +89,12 @@ Ipv4L3Protocol::GetTypeId (void)
                    TimeValue (Seconds (1)),
                    MakeTimeAccessor (&Ipv4L3Protocol::m_purge),
                    MakeTimeChecker (Seconds (0)))
+    .AddAttribute ("IdentificationBuckets",
+                   "Number of identification counters the {src, dst, proto} "
+                   "tuples are hashed into, rounded up to a power of two",
+                   UintegerValue (2048),
+                   MakeUintegerAccessor (&Ipv4L3Protocol::m_identificationBuckets),
+                   MakeUintegerChecker<uint32_t> (1, 1 << 20))
     .AddTraceSource ("Tx",
                      "Send ipv4 packet to outgoing interface.",
                      MakeTraceSourceAccessor (&Ipv4L3Protocol::m_txTrace),
@@ -130,6 +139,7 @@ Ipv4L3Protocol::GetTypeId (void)
 }
 
 Ipv4L3Protocol::Ipv4L3Protocol()
+  : m_identificationBuckets (2048)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -840,7 +850,7 @@ Ipv4L3Protocol::Send (Ptr<Packet> packet,
               route->SetGateway (Ipv4Address::GetAny ());
               route->SetSource (source);
               route->SetOutputDevice (outInterface->GetDevice ());
-              DecreaseIdentification (source, destination, protocol);
+              DecreaseIdentification (ipHeader);
               Send (pktCopyWithTags, source, destination, protocol, route);
             }
         }
@@ -867,7 +877,7 @@ Ipv4L3Protocol::Send (Ptr<Packet> packet,
               route->SetGateway (Ipv4Address::GetAny ());
               route->SetSource (source);
               route->SetOutputDevice (outInterface->GetDevice ());
-              DecreaseIdentification (source, destination, protocol);
+              DecreaseIdentification (ipHeader);
               Send (pktCopyWithTags, source, destination, protocol, route);
               return;
             }
@@ -889,27 +899,51 @@ Ipv4L3Protocol::Send (Ptr<Packet> packet,
     }
   if (newRoute)
     {
-      DecreaseIdentification (source, destination, protocol);
+      DecreaseIdentification (ipHeader);
       Send (pktCopyWithTags, source, destination, protocol, newRoute);
     }
   else
     {
       NS_LOG_WARN ("No route to host.  Drop.");
       m_dropTrace (ipHeader, packet, DROP_NO_ROUTE, m_node->GetObject<Ipv4> (), 0);
-      DecreaseIdentification (source, destination, protocol);
+      DecreaseIdentification (ipHeader);
     }
 }
 
 void
-Ipv4L3Protocol::DecreaseIdentification (Ipv4Address source,
-                                        Ipv4Address destination,
-                                        uint8_t protocol)
+Ipv4L3Protocol::DecreaseIdentification (const Ipv4Header &ipHeader)
 {
-  uint64_t src = source.Get ();
-  uint64_t dst = destination.Get ();
-  uint64_t srcDst = dst | (src << 32);
-  std::pair<uint64_t, uint8_t> key = std::make_pair (srcDst, protocol);
-  m_identification[key]--;
+  uint16_t &identification = GetIdentificationCounter (ipHeader.GetSource (), ipHeader.GetDestination (),
+                                                       ipHeader.GetProtocol ());
+  if (identification == static_cast<uint16_t> (ipHeader.GetIdentification () + 1))
+    {
+      identification--;
+    }
+}
+
+uint16_t &
+Ipv4L3Protocol::GetIdentificationCounter (Ipv4Address source,
+                                          Ipv4Address destination,
+                                          uint8_t protocol)
+{
+  if (m_identification.empty ())
+    {
+      uint32_t size = 1;
+      while (size < m_identificationBuckets)
+        {
+          size <<= 1;
+        }
+      m_identification.assign (size, 0);
+    }
+  // 64-bit finalizer of MurmurHash3
+  uint64_t h = (static_cast<uint64_t> (source.Get ()) << 32) | destination.Get ();
+  h ^= static_cast<uint64_t> (protocol) * 0x9e3779b97f4a7c15ULL;
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return m_identification[h & (m_identification.size () - 1)];
 }
 
 Ipv4Header
@@ -931,16 +965,13 @@ Ipv4L3Protocol::BuildHeader (
   ipHeader.SetTtl (ttl);
   ipHeader.SetTos (tos);
 
-  uint64_t src = source.Get ();
-  uint64_t dst = destination.Get ();
-  uint64_t srcDst = dst | (src << 32);
-  std::pair<uint64_t, uint8_t> key = std::make_pair (srcDst, protocol);
+  uint16_t &identification = GetIdentificationCounter (source, destination, protocol);
 
   if (mayFragment == true)
     {
       ipHeader.SetMayFragment ();
-      ipHeader.SetIdentification (m_identification[key]);
-      m_identification[key]++;
+      ipHeader.SetIdentification (identification);
+      identification++;
     }
   else
     {
@@ -949,8 +980,8 @@ Ipv4L3Protocol::BuildHeader (
       // identification requirement:
       // >> Originating sources MAY set the IPv4 ID field of atomic datagrams
       //    to any value.
-      ipHeader.SetIdentification (m_identification[key]);
-      m_identification[key]++;
+      ipHeader.SetIdentification (identification);
+      identification++;
     }
   if (Node::ChecksumEnabled ())
     {
@@ -993,7 +1024,18 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
   if (outInterface->IsUp ())
     {
       NS_LOG_LOGIC ("Send to " << targetLabel << " " << target);
-      if ( packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu () )
+      // A TCP super-segment is split by the traffic control layer, not fragmented;
+      // reserve the identification of the segments after the first one
+      TcpTsoTag tsoTag;
+      bool superSegment = ipHeader.GetProtocol () == TcpL4Protocol::PROT_NUMBER
+        && packet->PeekPacketTag (tsoTag);
+      if (superSegment && tsoTag.GetNSegments () > 1)
+        {
+          GetIdentificationCounter (ipHeader.GetSource (), ipHeader.GetDestination (),
+                                    ipHeader.GetProtocol ()) += tsoTag.GetNSegments () - 1;
+        }
+      if (!superSegment
+          && packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu () )
         {
           std::list<Ipv4PayloadHeaderPair> listFragments;
           DoFragmentation (packet, ipHeader, outInterface->GetDevice ()->GetMtu (), listFragments);
@@ -1111,6 +1153,28 @@ Ipv4L3Protocol::LocalDeliver (Ptr<const Packet> packet, Ipv4Header const&ip, uin
 
   m_localDeliverTrace (ipHeader, p, iif);
 
+  // The receive offload stage merges the segments after the trace, so that
+  // the flow probes see every received segment
+  Ptr<Ipv4Gro> gro = m_interfaces[iif]->GetGro ();
+  if (gro != 0)
+    {
+      gro->Receive (p, ipHeader);
+      return;
+    }
+
+  DeliverToProtocol (p, ipHeader, iif);
+}
+
+void
+Ipv4L3Protocol::GroDeliver (uint32_t iif, Ptr<Packet> p, const Ipv4Header &ipHeader)
+{
+  NS_LOG_FUNCTION (this << iif << p << ipHeader);
+  DeliverToProtocol (p, ipHeader, iif);
+}
+
+void
+Ipv4L3Protocol::DeliverToProtocol (Ptr<Packet> p, const Ipv4Header &ipHeader, uint32_t iif)
+{
   Ptr<IpL4Protocol> protocol = GetProtocol (ipHeader.GetProtocol (), iif);
   if (protocol != 0)
     {
@@ -1394,6 +1458,22 @@ Ipv4L3Protocol::GetNetDevice (uint32_t i)
   return GetInterface (i)->GetDevice ();
 }
 
+void
+Ipv4L3Protocol::SetGro (uint32_t i, Ptr<Ipv4Gro> gro)
+{
+  NS_LOG_FUNCTION (this << i << gro);
+  Ptr<Ipv4Interface> interface = GetInterface (i);
+  if (interface->GetGro () != 0)
+    {
+      interface->GetGro ()->Flush ();
+    }
+  if (gro != 0)
+    {
+      gro->SetDeliverCallback (MakeCallback (&Ipv4L3Protocol::GroDeliver, this).Bind (i));
+    }
+  interface->SetGro (gro);
+}
+
 void 
 Ipv4L3Protocol::SetIpForward (bool forward) 
 {
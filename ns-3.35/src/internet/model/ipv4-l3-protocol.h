@@ -36,12 +36,14 @@
 #include "ns3/simulator.h"
 
 class Ipv4L3ProtocolTestCase;
+class Ipv4IdentificationTestCase;
 
 namespace ns3 {
 
 class Packet;
 class NetDevice;
 class Ipv4Interface;
+class Ipv4Gro;
 class Ipv4Address;
 class Ipv4Header;
 class Ipv4RoutingTableEntry;
@@ -210,6 +212,19 @@ public:
 
   Ptr<NetDevice> GetNetDevice (uint32_t i);
 
+  /**
+   * \brief Enable or disable the generic receive offload on an interface
+   *
+   * The packets received on the interface and delivered to the node go
+   * through the given Ipv4Gro, which merges the back-to-back TCP segments
+   * of a flow before they reach TCP.  The merge happens after the
+   * LocalDeliver trace, which still reports every received segment.
+   *
+   * \param i the interface index
+   * \param gro the receive offload stage, or null to disable it
+   */
+  void SetGro (uint32_t i, Ptr<Ipv4Gro> gro);
+
   /**
    * \brief Check if an IPv4 address is unicast according to the node.
    *
@@ -276,6 +291,12 @@ private:
    */
   friend class ::Ipv4L3ProtocolTestCase;
 
+  /**
+   * \brief Ipv4IdentificationTestCase test case.
+   * \relates Ipv4IdentificationTestCase
+   */
+  friend class ::Ipv4IdentificationTestCase;
+
   /**
    * \brief Copy constructor.
    *
@@ -298,14 +319,31 @@ private:
   virtual bool GetWeakEsModel (void) const;
 
   /**
-   * \brief Decrease the identification value for a dropped or recursed packet
+   * \brief Give back the identification of a dropped or recursed packet
+   *
+   * The counter of the tuple is shared with other tuples, so it is only
+   * decreased if no identification was taken from it since the packet's.
+   *
+   * \param ipHeader the header built for the packet
+   */
+  void DecreaseIdentification (const Ipv4Header &ipHeader);
+
+  /**
+   * \brief Get the identification counter of a {src, dst, proto} tuple
+   *
+   * As in Linux (ip_idents), the tuples are hashed into a fixed number of
+   * counters: the lookup takes constant time and the memory is bounded.
+   * The tuples sharing a counter still get increasing identifications, so
+   * that they stay unique within each tuple until the counter wraps.
+   *
    * \param source source IPv4 address
    * \param destination destination IPv4 address
    * \param protocol L4 protocol
+   * \return a reference to the counter
    */
-  void DecreaseIdentification (Ipv4Address source,
-                               Ipv4Address destination,
-                               uint8_t protocol);
+  uint16_t & GetIdentificationCounter (Ipv4Address source,
+                                       Ipv4Address destination,
+                                       uint8_t protocol);
 
   /**
    * \brief Construct an IPv4 header.
@@ -368,6 +406,22 @@ private:
    */
   void LocalDeliver (Ptr<const Packet> p, Ipv4Header const&ip, uint32_t iif);
 
+  /**
+   * \brief Deliver a packet coming out of the receive offload stage of an interface
+   * \param iif the interface index
+   * \param p the packet, without the IPv4 header
+   * \param ipHeader the IPv4 header
+   */
+  void GroDeliver (uint32_t iif, Ptr<Packet> p, const Ipv4Header &ipHeader);
+
+  /**
+   * \brief Hand a locally delivered packet to its layer 4 protocol
+   * \param p the packet, without the IPv4 header
+   * \param ipHeader the IPv4 header
+   * \param iif the interface index
+   */
+  void DeliverToProtocol (Ptr<Packet> p, const Ipv4Header &ipHeader, uint32_t iif);
+
   /**
    * \brief Fallback when no route is found.
    * \param p packet
@@ -466,7 +520,8 @@ private:
   Ipv4InterfaceList m_interfaces; //!< List of IPv4 interfaces.
   Ipv4InterfaceReverseContainer m_reverseInterfacesContainer; //!< Container of NetDevice / Interface index associations.
   uint8_t m_defaultTtl;  //!< Default TTL
-  std::map<std::pair<uint64_t, uint8_t>, uint16_t> m_identification; //!< Identification (for each {src, dst, proto} tuple)
+  std::vector<uint16_t> m_identification; //!< Identification counters, indexed by the hash of the {src, dst, proto} tuple
+  uint32_t m_identificationBuckets;       //!< Requested number of identification counters
   Ptr<Node> m_node; //!< Node attached to stack.
 
   /// Trace of sent packets
@@ -20,6 +20,9 @@
 #include "ipv4-queue-disc-item.h"
 #include "ns3/tcp-header.h"
 #include "ns3/udp-header.h"
+#include "ns3/node.h"
+#include "tcp-l4-protocol.h"
+#include "tcp-tso-tag.h"
 
 namespace ns3 {
 
@@ -31,6 +34,11 @@ Ipv4QueueDiscItem::Ipv4QueueDiscItem (Ptr<Packet> p, const Address& addr,
     m_header (header),
     m_headerAdded (false)
 {
+  TcpTsoTag tsoTag;
+  if (header.GetProtocol () == TcpL4Protocol::PROT_NUMBER && p->PeekPacketTag (tsoTag))
+    {
+      SetSegmentSize (tsoTag.GetSegmentSize ());
+    }
 }
 
 Ipv4QueueDiscItem::~Ipv4QueueDiscItem ()
@@ -166,4 +174,99 @@ Ipv4QueueDiscItem::Hash (uint32_t perturbation) const
   return hash;
 }
 
+bool
+Ipv4QueueDiscItem::GetFiveTuple (FiveTuple &tuple) const
+{
+  NS_LOG_FUNCTION (this);
+
+  uint8_t prot = m_header.GetProtocol ();
+  uint16_t fragOffset = m_header.GetFragmentOffset ();
+
+  tuple.source = m_header.GetSource ();
+  tuple.destination = m_header.GetDestination ();
+  tuple.protocol = prot;
+  tuple.sourcePort = 0;
+  tuple.destinationPort = 0;
+
+  if (prot == 6 && fragOffset == 0) // TCP
+    {
+      TcpHeader tcpHdr;
+      GetPacket ()->PeekHeader (tcpHdr);
+      tuple.sourcePort = tcpHdr.GetSourcePort ();
+      tuple.destinationPort = tcpHdr.GetDestinationPort ();
+    }
+  else if (prot == 17 && fragOffset == 0) // UDP
+    {
+      UdpHeader udpHdr;
+      GetPacket ()->PeekHeader (udpHdr);
+      tuple.sourcePort = udpHdr.GetSourcePort ();
+      tuple.destinationPort = udpHdr.GetDestinationPort ();
+    }
+  return true;
+}
+
+void
+Ipv4QueueDiscItem::Segment (std::vector<Ptr<QueueDiscItem> > &segments)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (m_headerAdded, "The header must be added before segmenting the packet");
+
+  uint16_t segmentSize = GetSegmentSize ();
+  if (m_header.GetProtocol () != TcpL4Protocol::PROT_NUMBER || segmentSize == 0)
+    {
+      segments.push_back (this);
+      return;
+    }
+
+  // The header in the packet is the serialized m_header, which is used below
+  Ptr<Packet> p = GetPacket ()->Copy ();
+  Ipv4Header ipHeader;
+  p->RemoveHeader (ipHeader);
+  TcpTsoTag tsoTag;
+  p->RemovePacketTag (tsoTag);
+  TcpHeader tcpHeader;
+  p->RemoveHeader (tcpHeader);
+
+  uint32_t size = p->GetSize ();
+  uint8_t flags = tcpHeader.GetFlags ();
+  uint16_t id = m_header.GetIdentification ();
+  for (uint32_t offset = 0; offset < size; offset += segmentSize, ++id)
+    {
+      uint32_t length = std::min<uint32_t> (segmentSize, size - offset);
+      Ptr<Packet> segment = p->CreateFragment (offset, length);
+
+      TcpHeader segmentTcpHeader = tcpHeader;
+      segmentTcpHeader.SetSequenceNumber (tcpHeader.GetSequenceNumber () + offset);
+      uint8_t segmentFlags = flags;
+      if (offset > 0)
+        {
+          segmentFlags &= ~TcpHeader::CWR;
+        }
+      if (offset + length < size)
+        {
+          segmentFlags &= ~(TcpHeader::FIN | TcpHeader::PSH);
+        }
+      segmentTcpHeader.SetFlags (segmentFlags);
+      if (Node::ChecksumEnabled ())
+        {
+          segmentTcpHeader.EnableChecksums ();
+          segmentTcpHeader.InitializeChecksum (m_header.GetSource (), m_header.GetDestination (),
+                                               TcpL4Protocol::PROT_NUMBER);
+        }
+      segment->AddHeader (segmentTcpHeader);
+
+      Ipv4Header segmentIpHeader = m_header;
+      segmentIpHeader.SetPayloadSize (segment->GetSize ());
+      segmentIpHeader.SetIdentification (id);
+
+      Ptr<Ipv4QueueDiscItem> item = Create<Ipv4QueueDiscItem> (segment, GetAddress (), GetProtocol (),
+                                                                segmentIpHeader);
+      item->SetTxQueueIndex (GetTxQueueIndex ());
+      item->SetTimeStamp (GetTimeStamp ());
+      item->AddHeader ();
+      segments.push_back (item);
+    }
+  NS_LOG_LOGIC ("Split a super-segment of " << size << " bytes into segments of " << segmentSize << " bytes");
+}
+
 } // namespace ns3
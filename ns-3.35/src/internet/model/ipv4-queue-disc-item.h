@@ -95,6 +95,30 @@ public:
    */
   virtual uint32_t Hash (uint32_t perturbation) const;
 
+  /**
+   * \brief Get the packet's 5-tuple
+   *
+   * Gets the fields the Hash method computes the hash of: the source and
+   * destination IP addresses, the protocol number and, if the transport
+   * protocol is either UDP or TCP, the source and destination port
+   *
+   * \param tuple the packet's 5-tuple
+   * \return true
+   */
+  virtual bool GetFiveTuple (FiveTuple &tuple) const;
+
+  /**
+   * \brief Split a TCP super-segment into segments of the segment size
+   *
+   * Each segment is a new item carrying a copy of the IPv4 header, with its
+   * own identification and payload length, and of the TCP header, with its
+   * own sequence number.  CWR is only kept on the first segment, FIN and PSH
+   * only on the last one.  The header must have been added to the packet.
+   *
+   * \param segments the vector the segments are appended to
+   */
+  virtual void Segment (std::vector<Ptr<QueueDiscItem> > &segments);
+
 private:
   /**
    * \brief Default constructor
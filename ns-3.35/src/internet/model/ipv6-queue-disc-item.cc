@@ -164,4 +164,34 @@ Ipv6QueueDiscItem::Hash (uint32_t perturbation) const
   return hash;
 }
 
+bool
+Ipv6QueueDiscItem::GetFiveTuple (FiveTuple &tuple) const
+{
+  NS_LOG_FUNCTION (this);
+
+  uint8_t prot = m_header.GetNextHeader ();
+
+  tuple.source = m_header.GetSource ();
+  tuple.destination = m_header.GetDestination ();
+  tuple.protocol = prot;
+  tuple.sourcePort = 0;
+  tuple.destinationPort = 0;
+
+  if (prot == 6) // TCP
+    {
+      TcpHeader tcpHdr;
+      GetPacket ()->PeekHeader (tcpHdr);
+      tuple.sourcePort = tcpHdr.GetSourcePort ();
+      tuple.destinationPort = tcpHdr.GetDestinationPort ();
+    }
+  else if (prot == 17) // UDP
+    {
+      UdpHeader udpHdr;
+      GetPacket ()->PeekHeader (udpHdr);
+      tuple.sourcePort = udpHdr.GetSourcePort ();
+      tuple.destinationPort = udpHdr.GetDestinationPort ();
+    }
+  return true;
+}
+
 } // namespace ns3
@@ -95,6 +95,18 @@ public:
    */
   virtual uint32_t Hash (uint32_t perturbation) const;
 
+  /**
+   * \brief Get the packet's 5-tuple
+   *
+   * Gets the fields the Hash method computes the hash of: the source and
+   * destination IP addresses, the protocol number and, if the transport
+   * protocol is either UDP or TCP, the source and destination port
+   *
+   * \param tuple the packet's 5-tuple
+   * \return true
+   */
+  virtual bool GetFiveTuple (FiveTuple &tuple) const;
+
 private:
   /**
    * \brief Default constructor
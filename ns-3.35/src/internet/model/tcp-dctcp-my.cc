@@ -13,6 +13,10 @@
 #include "ns3/log.h"
 #include "ns3/abort.h"
 #include "ns3/tcp-socket-state.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+#include <algorithm>
+#include <limits>
 
 
 // In ns-3, a congestion control algorithm is implemented by providing a
@@ -32,6 +36,9 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("TcpDctcpMy");
 NS_OBJECT_ENSURE_REGISTERED (TcpDctcpMy);
 
+// alpha is scaled by 2^10 in fixed-point mode, as in Linux
+static const uint32_t DCTCP_MAX_ALPHA = 1024;
+
 
 /////////////////////////////////////////
 // TcpDctcpMy c++ class common methods //
@@ -53,6 +60,17 @@ TypeId TcpDctcpMy::GetTypeId ()
                    BooleanValue (true),     // set to false in testing
                    MakeBooleanAccessor (&TcpDctcpMy::useECT0),
                    MakeBooleanChecker ())
+    .AddAttribute ("UseFixedPoint",
+                   "Compute alpha with the 10-bit fixed-point arithmetic of Linux "
+                   "from the acked byte counts, instead of double precision",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpDctcpMy::useFixedPoint),
+                   MakeBooleanChecker ())
+    .AddAttribute ("DctcpShiftG",
+                   "Estimation gain as a shift, g = 1/2^DctcpShiftG, in fixed-point mode",
+                   UintegerValue (4),       // dctcp_shift_g in Linux
+                   MakeUintegerAccessor (&TcpDctcpMy::shiftG),
+                   MakeUintegerChecker<uint32_t> (0, 10))
     .AddTraceSource ("DctcpAlpha",
                      "Update sender-side congestion estimate variables",
                      MakeTraceSourceAccessor (&TcpDctcpMy::traceDctcpAlpha),
@@ -71,6 +89,7 @@ TcpDctcpMy::TcpDctcpMy ()
     initialized (false),
     alpha(1.0),
     // g is provided as an attribute
+    fracLast (0.0),
     CEState (false),
     holdingDelayedACK (false),
     seqDelayedACK (SequenceNumber32 (0)),
@@ -78,7 +97,10 @@ TcpDctcpMy::TcpDctcpMy ()
     bytesACKedAll (0),
     bytesACKedECE (0),
     seqNextSend (SequenceNumber32 (0)),
-    seqNextSendValid (false)
+    seqNextSendValid (false),
+    alphaFixed (DCTCP_MAX_ALPHA),
+    priorLastAckedSeq (SequenceNumber32 (0)),
+    priorAckEvent (std::numeric_limits<uint64_t>::max ())
 {
   NS_LOG_FUNCTION (this);
 }
@@ -88,6 +110,7 @@ TcpDctcpMy::TcpDctcpMy (const TcpDctcpMy& sock)
     initialized (sock.initialized),
     alpha (sock.alpha),
     g (sock.g),
+    fracLast (sock.fracLast),
     CEState (sock.CEState),
     holdingDelayedACK (sock.holdingDelayedACK),
     seqDelayedACK (sock.seqDelayedACK),
@@ -96,7 +119,12 @@ TcpDctcpMy::TcpDctcpMy (const TcpDctcpMy& sock)
     bytesACKedECE (sock.bytesACKedECE),
     seqNextSend (sock.seqNextSend),
     seqNextSendValid (sock.seqNextSendValid),
-    useECT0 (sock.useECT0)
+    useECT0 (sock.useECT0),
+    useFixedPoint (sock.useFixedPoint),
+    shiftG (sock.shiftG),
+    alphaFixed (sock.alphaFixed),
+    priorLastAckedSeq (sock.priorLastAckedSeq),
+    priorAckEvent (sock.priorAckEvent)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -164,11 +192,7 @@ void
 TcpDctcpMy::FlushDelayedACK (Ptr<TcpSocketState> tcb, bool setECE)
 {
   if (holdingDelayedACK && seqDelayedACKValid) {
-    SequenceNumber32 seqCurrent = tcb->m_rxBuffer->NextRxSequence ();
-    tcb->m_rxBuffer->SetNextRxSequence (seqDelayedACK);
-    tcb->m_sendEmptyPacketCallback (setECE ? (TcpHeader::ACK | TcpHeader::ECE)
-                                           :  TcpHeader::ACK);
-    tcb->m_rxBuffer->SetNextRxSequence (seqCurrent);
+    tcb->m_sendAckCallback (seqDelayedACK, setECE ? TcpHeader::ECE : 0);
   }
 }
 
@@ -232,6 +256,11 @@ TcpDctcpMy::PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked,
 {
   NS_LOG_FUNCTION (this << tcb << segmentsAcked << rtt);
 
+  if (useFixedPoint) {
+    UpdateAlphaFixed (tcb, segmentsAcked);
+    return;
+  }
+
   // step 1~3, section 3.3, RFC 8257: accumulate the number of bytes ACKed
   bytesACKedAll += segmentsAcked * tcb->m_segmentSize;
   if (tcb->m_ecnState == TcpSocketState::ECN_ECE_RCVD)
@@ -254,6 +283,7 @@ TcpDctcpMy::PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked,
 
   // step 6, section 3.3, RFC 8257: a = (1-g) * a + g * F
   alpha = (1.0 - g) * alpha + g * fracF;
+  fracLast = fracF;
   traceDctcpAlpha (bytesACKedECE, bytesACKedAll, alpha);
   NS_LOG_INFO (this << "fracF " << fracF << ", alpha " << alpha);
 
@@ -264,6 +294,68 @@ TcpDctcpMy::PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked,
   bytesACKedAll = 0;
 }
 
+// Same as above, with the integer arithmetic of dctcp_update_alpha () in
+// Linux: bytes are counted from the advance of the cumulative ACK (a dupack
+// counts as one segment) and alpha is a 10-bit fixed-point number.  The
+// socket may call PktsAcked more than once while processing an ACK, so a
+// call that neither is the first of its ACK nor advances the cumulative ACK
+// is ignored.
+void
+TcpDctcpMy::UpdateAlphaFixed (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked)
+{
+  uint64_t ackEvent = Simulator::GetEventCount ();
+  uint32_t ackedBytes = tcb->m_segmentSize;
+  if (!seqNextSendValid) {
+    // no previous ACK to count the bytes from
+    ackedBytes = segmentsAcked * tcb->m_segmentSize;
+    seqNextSend = tcb->m_nextTxSequence;
+    seqNextSendValid = true;
+  } else if (tcb->m_lastAckedSeq > priorLastAckedSeq) {
+    ackedBytes = tcb->m_lastAckedSeq - priorLastAckedSeq;
+  } else if (ackEvent == priorAckEvent) {
+    return;   // the bytes of this ACK are already counted
+  }
+  priorLastAckedSeq = tcb->m_lastAckedSeq;
+  priorAckEvent = ackEvent;
+
+  bytesACKedAll += ackedBytes;
+  if (tcb->m_ecnState == TcpSocketState::ECN_ECE_RCVD)
+    bytesACKedECE += ackedBytes;
+
+  if (tcb->m_lastAckedSeq < seqNextSend)
+    return;   // not yet the end of current observation window
+
+  // a = (1-g) * a + g * F, with g = 1/2^shiftG; as min_not_zero () in
+  // Linux, a small alpha whose decay rounds to zero drops to zero
+  uint32_t decay = alphaFixed >> shiftG;
+  alphaFixed -= (decay > 0) ? decay : alphaFixed;
+  if (bytesACKedECE > 0) {
+    uint64_t bytesECE = static_cast<uint64_t> (bytesACKedECE) << (10 - shiftG);
+    bytesECE /= std::max (1U, bytesACKedAll);
+    alphaFixed = std::min (alphaFixed + static_cast<uint32_t> (bytesECE), DCTCP_MAX_ALPHA);
+  }
+  alpha = static_cast<double> (alphaFixed) / DCTCP_MAX_ALPHA;
+  fracLast = static_cast<double> (bytesACKedECE) / std::max (1U, bytesACKedAll);
+  traceDctcpAlpha (bytesACKedECE, bytesACKedAll, alpha);
+  NS_LOG_INFO (this << "alpha " << alphaFixed << "/" << DCTCP_MAX_ALPHA);
+
+  seqNextSend = tcb->m_nextTxSequence;
+  bytesACKedECE = 0;
+  bytesACKedAll = 0;
+}
+
+double
+TcpDctcpMy::GetAlpha (void) const
+{
+  return alpha;
+}
+
+double
+TcpDctcpMy::GetEceFraction (void) const
+{
+  return fracLast;
+}
+
 // Congestion op: set window size after a loss event.
 uint32_t
 TcpDctcpMy::GetSsThresh (Ptr<const TcpSocketState> tcb,
@@ -272,6 +364,11 @@ TcpDctcpMy::GetSsThresh (Ptr<const TcpSocketState> tcb,
   NS_LOG_FUNCTION (this << tcb << bytesInFlight);
 
   // step 9, section 3.3, RFC 8257: cwnd = cwnd * (1 - a / 2)
+  if (useFixedPoint) {
+    uint32_t cwnd = tcb->m_cWnd;
+    uint32_t reduction = static_cast<uint32_t> ((static_cast<uint64_t> (cwnd) * alphaFixed) >> 11);
+    return std::max (cwnd - reduction, 2 * tcb->m_segmentSize);
+  }
   return static_cast<uint32_t> ((1.0 - alpha / 2.0) * tcb->m_cWnd);
 }
 
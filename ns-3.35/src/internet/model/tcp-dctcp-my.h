@@ -62,6 +62,19 @@ public:
   virtual void PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked, const Time &rtt);
   virtual uint32_t GetSsThresh (Ptr<const TcpSocketState> tcb, uint32_t bytesInFlight);
 
+  /**
+   * \brief Get the current congestion estimate
+   * \return alpha, between 0 and 1
+   */
+  double GetAlpha (void) const;
+
+  /**
+   * \brief Get the fraction of bytes acked with ECE in the last complete
+   * observation window
+   * \return the ECE fraction F, between 0 and 1
+   */
+  double GetEceFraction (void) const;
+
   /**
    * TracedCallback signature for DCTCP update of congestion state
    *
@@ -76,10 +89,12 @@ private:
   void UpdateDelayedACK (Ptr<TcpSocketState> tcb);
   void CEStateOn (Ptr<TcpSocketState> tcb);
   void CEStateOff (Ptr<TcpSocketState> tcb);
+  void UpdateAlphaFixed (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked);
 
   bool initialized;                 //!< Whether DCTCP has been initialized
   double alpha;                     //!< Current estimate of network congestion
   double g;                         //!< Estimation gain
+  double fracLast;                  //!< ECE fraction of the last observation window
   bool CEState;                     //!< DCTCP.CE state
   bool holdingDelayedACK;           //!< Is there delayed ACK held
   SequenceNumber32 seqDelayedACK;   //!< Sequence number of first byte whose ACK is held delayed
@@ -89,6 +104,11 @@ private:
   SequenceNumber32 seqNextSend;     //!< Sequence number of the next byte in tx sequence
   bool seqNextSendValid;            //!< Is seqNextSend valid
   bool useECT0;                     //!< True if using ECT(0), false if using ECT(1)
+  bool useFixedPoint;               //!< Use the Linux fixed-point arithmetic for alpha
+  uint32_t shiftG;                  //!< Estimation gain as a shift, g = 1/2^shiftG (fixed-point mode)
+  uint32_t alphaFixed;              //!< Alpha scaled by 1024 (fixed-point mode)
+  SequenceNumber32 priorLastAckedSeq; //!< Highest acked sequence at the previous ACK (fixed-point mode)
+  uint64_t priorAckEvent;           //!< Simulator event of the previous ACK (fixed-point mode)
 
   TracedCallback<uint32_t, uint32_t, double> traceDctcpAlpha;
 };
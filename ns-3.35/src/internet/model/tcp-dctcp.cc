@@ -180,16 +180,8 @@ TcpDctcp::CeState0to1 (Ptr<TcpSocketState> tcb)
   NS_LOG_FUNCTION (this << tcb);
   if (!m_ceState && m_delayedAckReserved && m_priorRcvNxtFlag)
     {
-      SequenceNumber32 tmpRcvNxt;
-      /* Save current NextRxSequence. */
-      tmpRcvNxt = tcb->m_rxBuffer->NextRxSequence ();
-
       /* Generate previous ACK without ECE */
-      tcb->m_rxBuffer->SetNextRxSequence (m_priorRcvNxt);
-      tcb->m_sendEmptyPacketCallback (TcpHeader::ACK);
-
-      /* Recover current RcvNxt. */
-      tcb->m_rxBuffer->SetNextRxSequence (tmpRcvNxt);
+      tcb->m_sendAckCallback (m_priorRcvNxt, 0);
     }
 
   if (m_priorRcvNxtFlag == false)
@@ -207,16 +199,8 @@ TcpDctcp::CeState1to0 (Ptr<TcpSocketState> tcb)
   NS_LOG_FUNCTION (this << tcb);
   if (m_ceState && m_delayedAckReserved && m_priorRcvNxtFlag)
     {
-      SequenceNumber32 tmpRcvNxt;
-      /* Save current NextRxSequence. */
-      tmpRcvNxt = tcb->m_rxBuffer->NextRxSequence ();
-
       /* Generate previous ACK with ECE */
-      tcb->m_rxBuffer->SetNextRxSequence (m_priorRcvNxt);
-      tcb->m_sendEmptyPacketCallback (TcpHeader::ACK | TcpHeader::ECE);
-
-      /* Recover current RcvNxt. */
-      tcb->m_rxBuffer->SetNextRxSequence (tmpRcvNxt);
+      tcb->m_sendAckCallback (m_priorRcvNxt, TcpHeader::ECE);
     }
 
   if (m_priorRcvNxtFlag == false)
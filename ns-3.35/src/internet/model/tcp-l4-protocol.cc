@@ -41,6 +41,7 @@
 #include "ipv6-routing-protocol.h"
 #include "tcp-socket-factory-impl.h"
 #include "tcp-socket-base.h"
+#include "tcp-timer-wheel.h"
 #include "tcp-congestion-ops.h"
 #include "tcp-cubic.h"
 #include "tcp-recovery-ops.h"
@@ -92,12 +93,22 @@ TcpL4Protocol::GetTypeId (void)
                    ObjectVectorValue (),
                    MakeObjectVectorAccessor (&TcpL4Protocol::m_sockets),
                    MakeObjectVectorChecker<TcpSocketBase> ())
+    .AddAttribute ("TimerWheel",
+                   "Arm the retransmission, delayed ACK, persist and TIME_WAIT "
+                   "timers of the sockets in a per-node timing wheel instead of "
+                   "scheduling one simulator event per timer. The wheel "
+                   "granularity is set by ns3::TcpTimerWheel::Granularity; "
+                   "sockets whose ClockGranularity is finer keep using the simulator.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpL4Protocol::m_useTimerWheel),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
 TcpL4Protocol::TcpL4Protocol ()
-  : m_endPoints (new Ipv4EndPointDemux ()), m_endPoints6 (new Ipv6EndPointDemux ())
+  : m_endPoints (new Ipv4EndPointDemux ()), m_endPoints6 (new Ipv6EndPointDemux ()),
+    m_useTimerWheel (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -175,6 +186,12 @@ TcpL4Protocol::DoDispose (void)
       m_endPoints6 = 0;
     }
 
+  if (m_timerWheel != nullptr)
+    {
+      m_timerWheel->Dispose ();
+      m_timerWheel = nullptr;
+    }
+
   m_node = 0;
   m_downTarget.Nullify ();
   m_downTarget6.Nullify ();
@@ -219,6 +236,16 @@ TcpL4Protocol::CreateSocket (void)
   return CreateSocket (m_congestionTypeId, m_recoveryTypeId);
 }
 
+Ptr<TcpTimerWheel>
+TcpL4Protocol::GetTimerWheel (void)
+{
+  if (m_useTimerWheel && m_timerWheel == nullptr)
+    {
+      m_timerWheel = CreateObject<TcpTimerWheel> ();
+    }
+  return m_timerWheel;
+}
+
 Ipv4EndPoint *
 TcpL4Protocol::Allocate (void)
 {
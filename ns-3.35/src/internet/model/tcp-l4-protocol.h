@@ -38,6 +38,7 @@ class Ipv4EndPointDemux;
 class Ipv6EndPointDemux;
 class Ipv4Interface;
 class TcpSocketBase;
+class TcpTimerWheel;
 class Ipv4EndPoint;
 class Ipv6EndPoint;
 class NetDevice;
@@ -128,6 +129,16 @@ public:
     */
   Ptr<Socket> CreateSocket (TypeId congestionTypeId);
 
+  /**
+   * \brief Get the timing wheel shared by the timers of the sockets
+   *
+   * The wheel is created on first use when the TimerWheel attribute is set.
+   *
+   * \return the timing wheel, or nullptr if the sockets use the simulator
+   * for their timers
+   */
+  Ptr<TcpTimerWheel> GetTimerWheel (void);
+
   /**
    * \brief Allocate an IPv4 Endpoint
    * \return the Endpoint
@@ -321,6 +332,8 @@ private:
   TypeId m_congestionTypeId;       //!< The socket TypeId
   TypeId m_recoveryTypeId;         //!< The recovery TypeId
   std::vector<Ptr<TcpSocketBase> > m_sockets;      //!< list of sockets
+  bool m_useTimerWheel;            //!< Whether the sockets arm their timers in a timing wheel
+  Ptr<TcpTimerWheel> m_timerWheel; //!< Timing wheel of the sockets
   IpL4Protocol::DownTargetCallback m_downTarget;   //!< Callback to send packets over IPv4
   IpL4Protocol::DownTargetCallback6 m_downTarget6; //!< Callback to send packets over IPv6
 
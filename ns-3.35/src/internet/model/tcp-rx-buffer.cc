@@ -113,9 +113,9 @@ TcpRxBuffer::MaxRxSequence (void) const
     { // No data allowed beyond FIN
       return m_finSeq;
     }
-  else if (m_data.size () && m_nextRxSeq > m_data.begin ()->first)
+  else if (!m_inOrder.empty ())
     { // No data allowed beyond Rx window allowed
-      return m_data.begin ()->first + SequenceNumber32 (m_maxBuffer);
+      return m_inOrderSeq + SequenceNumber32 (m_maxBuffer);
     }
   return m_nextRxSeq + SequenceNumber32 (m_maxBuffer);
 }
@@ -149,14 +149,50 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
 
   // Trim packet to fit Rx window specification
   if (headSeq < m_nextRxSeq) headSeq = m_nextRxSeq;
-  if (m_data.size ())
+  if (!m_inOrder.empty () || !m_data.empty ())
     {
-      SequenceNumber32 maxSeq = m_data.begin ()->first + SequenceNumber32 (m_maxBuffer);
+      SequenceNumber32 firstSeq = m_inOrder.empty () ? m_data.begin ()->first : m_inOrderSeq;
+      SequenceNumber32 maxSeq = firstSeq + SequenceNumber32 (m_maxBuffer);
       if (maxSeq < tailSeq) tailSeq = maxSeq;
       if (tailSeq < headSeq) headSeq = tailSeq;
     }
-  // Remove overlapped bytes from packet
-  BufIterator i = m_data.begin ();
+
+  if (headSeq == m_nextRxSeq && m_data.empty ())
+    {
+      // Fast path: in-order data and nothing out of order, so no overlap is
+      // possible. Queue it for delivery without touching the reordering map.
+      if (headSeq >= tailSeq)
+        {
+          NS_LOG_LOGIC ("Nothing to buffer");
+          return false;
+        }
+      uint32_t length = static_cast<uint32_t> (tailSeq - headSeq);
+      if (length == pktSize)
+        {
+          p = p->Copy ();
+        }
+      else
+        {
+          p = p->CreateFragment (static_cast<uint32_t> (headSeq - tcph.GetSequenceNumber ()), length);
+        }
+      m_size += length;
+      AppendInOrder (p);
+      NS_LOG_LOGIC ("Appended in-order packet, occupancy=" << m_size << " nextRxSeq=" << m_nextRxSeq);
+      if (m_gotFin && m_nextRxSeq == m_finSeq)
+        { // Account for the FIN packet
+          ++m_nextRxSeq;
+        }
+      return true;
+    }
+
+  // Remove overlapped bytes from packet. The out-of-order blocks do not
+  // overlap, so only the one starting at or before headSeq and the ones
+  // that follow it can overlap the new packet.
+  BufIterator i = m_data.upper_bound (headSeq);
+  if (i != m_data.begin ())
+    {
+      --i;
+    }
   while (i != m_data.end () && i->first <= tailSeq)
     {
       SequenceNumber32 lastByteSeq = i->first + SequenceNumber32 (i->second->GetSize ());
@@ -205,19 +241,12 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
   NS_LOG_LOGIC ("Buffered packet of seqno=" << headSeq << " len=" << p->GetSize ());
   // Update variables
   m_size += p->GetSize ();      // Occupancy
-  for (i = m_data.begin (); i != m_data.end (); ++i)
+  // Move the blocks that became contiguous to the delivery queue
+  while (!m_data.empty () && m_data.begin ()->first == m_nextRxSeq)
     {
-      if (i->first < m_nextRxSeq)
-        {
-          continue;
-        }
-      else if (i->first > m_nextRxSeq)
-        {
-          break;
-        };
-      m_nextRxSeq = i->first + SequenceNumber32 (i->second->GetSize ());
-      m_availBytes += i->second->GetSize ();
-      ClearSackList (m_nextRxSeq);
+      i = m_data.begin ();
+      AppendInOrder (i->second);
+      m_data.erase (i);
     }
   NS_LOG_LOGIC ("Updated buffer occupancy=" << m_size << " nextRxSeq=" << m_nextRxSeq);
   if (m_gotFin && m_nextRxSeq == m_finSeq)
@@ -227,6 +256,23 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
   return true;
 }
 
+void
+TcpRxBuffer::AppendInOrder (Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION (this << p);
+  if (m_inOrder.empty ())
+    {
+      m_inOrderSeq = m_nextRxSeq;
+    }
+  m_inOrder.push_back (p);
+  m_nextRxSeq = m_nextRxSeq + SequenceNumber32 (p->GetSize ());
+  m_availBytes += p->GetSize ();
+  if (!m_sackList.empty ())
+    {
+      ClearSackList (m_nextRxSeq);
+    }
+}
+
 uint32_t
 TcpRxBuffer::GetSackListSize () const
 {
@@ -368,28 +414,42 @@ TcpRxBuffer::Extract (uint32_t maxSize)
   uint32_t extractSize = std::min (maxSize, m_availBytes);
   NS_LOG_LOGIC ("Requested to extract " << extractSize << " bytes from TcpRxBuffer of size=" << m_size);
   if (extractSize == 0) return nullptr;  // No contiguous block to return
-  NS_ASSERT (m_data.size ()); // At least we have something to extract
-  Ptr<Packet> outPkt = Create<Packet> (); // The packet that contains all the data to return
-  BufIterator i;
+  NS_ASSERT (!m_inOrder.empty ()); // At least we have something to extract
+  Ptr<Packet> outPkt = nullptr; // The packet that contains all the data to return
   while (extractSize)
     { // Check the buffered data for delivery
-      i = m_data.begin ();
-      NS_ASSERT (i->first <= m_nextRxSeq); // in-sequence data expected
+      Ptr<Packet> p = m_inOrder.front ();
       // Check if we send the whole pkt or just a partial
-      uint32_t pktSize = i->second->GetSize ();
+      uint32_t pktSize = p->GetSize ();
       if (pktSize <= extractSize)
         { // Whole packet is extracted
-          outPkt->AddAtEnd (i->second);
-          m_data.erase (i);
+          m_inOrder.pop_front ();
+          if (outPkt == nullptr)
+            {
+              // The buffer holds the only reference: hand the packet over,
+              // stripped of what does not belong to the byte stream
+              outPkt = p;
+              outPkt->RemoveAllPacketTags ();
+              outPkt->SetFlowAnnotation (PacketFlowAnnotation ());
+            }
+          else
+            {
+              outPkt->AddAtEnd (p);
+            }
+          m_inOrderSeq += pktSize;
           m_size -= pktSize;
           m_availBytes -= pktSize;
           extractSize -= pktSize;
         }
       else
         { // Partial is extracted and done
-          outPkt->AddAtEnd (i->second->CreateFragment (0, extractSize));
-          m_data[i->first + SequenceNumber32 (extractSize)] = i->second->CreateFragment (extractSize, pktSize - extractSize);
-          m_data.erase (i);
+          if (outPkt == nullptr)
+            {
+              outPkt = Create<Packet> ();
+            }
+          outPkt->AddAtEnd (p->CreateFragment (0, extractSize));
+          p->RemoveAtStart (extractSize);
+          m_inOrderSeq += extractSize;
           m_size -= extractSize;
           m_availBytes -= extractSize;
           extractSize = 0;
@@ -401,7 +461,7 @@ TcpRxBuffer::Extract (uint32_t maxSize)
       return nullptr;
     }
   NS_LOG_LOGIC ("Extracted " << outPkt->GetSize ( ) << " bytes, bufsize=" << m_size
-                             << ", num pkts in buffer=" << m_data.size ());
+                             << ", num pkts in buffer=" << m_inOrder.size () + m_data.size ());
   return outPkt;
 }
 
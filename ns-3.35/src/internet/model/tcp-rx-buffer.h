@@ -22,6 +22,7 @@
 #define TCP_RX_BUFFER_H
 
 #include <map>
+#include <deque>
 #include "ns3/traced-value.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/sequence-number.h"
@@ -53,6 +54,12 @@ class Packet;
  * To store data, use Add; for retrieving a certain amount of ordered data, use
  * the method Extract.
  *
+ * In-sequence data is kept in a delivery queue, and a segment that arrives in
+ * order while nothing is buffered out of order is appended to it directly.
+ * Only out-of-order segments go through the reordering map, which holds
+ * non-overlapping blocks indexed by their first sequence number; once the
+ * hole before them is filled, they move to the delivery queue.
+ *
  * SACK list
  * ---------
  *
@@ -215,6 +222,16 @@ private:
    */
   void ClearSackList (const SequenceNumber32 &seq);
 
+  /**
+   * \brief Append in-sequence data to the delivery queue
+   *
+   * Advances the next expected sequence and the available bytes, and
+   * removes the SACK blocks that are now below it.
+   *
+   * \param p the data, starting at NextRxSequence
+   */
+  void AppendInOrder (Ptr<Packet> p);
+
   TcpOptionSack::SackList m_sackList; //!< Sack list (updated constantly)
 
   /// container for data stored in the buffer
@@ -225,7 +242,9 @@ private:
   uint32_t m_size;                           //!< Number of total data bytes in the buffer, not necessarily contiguous
   uint32_t m_maxBuffer;                      //!< Upper bound of the number of data bytes in buffer (RCV.WND)
   uint32_t m_availBytes;                     //!< Number of bytes available to read, i.e. contiguous block at head
-  std::map<SequenceNumber32, Ptr<Packet> > m_data; //!< Corresponding data (may be null)
+  std::deque<Ptr<Packet> > m_inOrder;        //!< In-sequence data ready to be extracted
+  SequenceNumber32 m_inOrderSeq;             //!< Seqnum of the first byte in m_inOrder
+  std::map<SequenceNumber32, Ptr<Packet> > m_data; //!< Out-of-order data, by first sequence number
 };
 
 } //namespace ns3
@@ -59,6 +59,7 @@
 #include "tcp-congestion-ops.h"
 #include "tcp-recovery-ops.h"
 #include "ns3/tcp-rate-ops.h"
+#include "tcp-tso-tag.h"
 
 #include <math.h>
 #include <algorithm>
@@ -147,6 +148,12 @@ TcpSocketBase::GetTypeId (void)
                    BooleanValue (true),
                    MakeBooleanAccessor (&TcpSocketBase::m_limitedTx),
                    MakeBooleanChecker ())
+    .AddAttribute ("TsoSegments",
+                   "Maximum number of full-sized segments sent to IPv4 as a single super-segment, "
+                   "which is split into segments before reaching the wire (1 disables segmentation offload)",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&TcpSocketBase::m_tsoSegments),
+                   MakeUintegerChecker<uint32_t> (1, 64))
     .AddAttribute ("UseEcn", "Parameter to set ECN functionality",
                    EnumValue (TcpSocketState::Off),
                    MakeEnumAccessor (&TcpSocketBase::SetUseEcn),
@@ -262,6 +269,7 @@ TcpSocketBase::TcpSocketBase (void)
   m_pacingTimer.SetFunction (&TcpSocketBase::NotifyPacingPerformed, this);
 
   m_tcb->m_sendEmptyPacketCallback = MakeCallback (&TcpSocketBase::SendEmptyPacket, this);
+  m_tcb->m_sendAckCallback = MakeCallback (&TcpSocketBase::SendAck, this);
 
   bool ok;
 
@@ -309,6 +317,7 @@ TcpSocketBase::TcpSocketBase (void)
 TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
   : TcpSocket (sock),
     //copy object::m_tid and socket::callbacks
+    m_timerWheel (sock.m_timerWheel),
     m_dupAckCount (sock.m_dupAckCount),
     m_delAckCount (0),
     m_delAckMaxCount (sock.m_delAckMaxCount),
@@ -350,6 +359,7 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
     m_recoverActive (sock.m_recoverActive),
     m_retxThresh (sock.m_retxThresh),
     m_limitedTx (sock.m_limitedTx),
+    m_tsoSegments (sock.m_tsoSegments),
     m_isFirstPartialAck (sock.m_isFirstPartialAck),
     m_txTrace (sock.m_txTrace),
     m_rxTrace (sock.m_rxTrace),
@@ -397,6 +407,10 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
     {
       m_tcb->m_sendEmptyPacketCallback = MakeCallback (&TcpSocketBase::SendEmptyPacket, this);
     }
+  if (m_tcb->m_sendAckCallback.IsNull ())
+    {
+      m_tcb->m_sendAckCallback = MakeCallback (&TcpSocketBase::SendAck, this);
+    }
 
   bool ok;
 
@@ -481,6 +495,7 @@ void
 TcpSocketBase::SetTcp (Ptr<TcpL4Protocol> tcp)
 {
   m_tcp = tcp;
+  m_timerWheel = tcp->GetTimerWheel ();
 }
 
 /* Set an RTT estimator with this socket */
@@ -1371,17 +1386,16 @@ TcpSocketBase::DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
     }
 
 
-  if (m_rWnd.Get () == 0 && m_persistEvent.IsExpired ())
+  if (m_rWnd.Get () == 0 && !m_persistTimer.IsRunning ())
     { // Zero window: Enter persist state to send 1 byte to probe
       NS_LOG_LOGIC (this << " Enter zerowindow persist state");
       NS_LOG_LOGIC (this << " Cancelled ReTxTimeout event which was set to expire at " <<
-                    (Simulator::Now () + Simulator::GetDelayLeft (m_retxEvent)).GetSeconds ());
-      m_retxEvent.Cancel ();
+                    m_retxTimer.GetExpiration ().GetSeconds ());
+      m_retxTimer.Cancel ();
       NS_LOG_LOGIC ("Schedule persist timeout at time " <<
                     Simulator::Now ().GetSeconds () << " to expire at time " <<
                     (Simulator::Now () + m_persistTimeout).GetSeconds ());
-      m_persistEvent = Simulator::Schedule (m_persistTimeout, &TcpSocketBase::PersistTimeout, this);
-      NS_ASSERT (m_persistTimeout == Simulator::GetDelayLeft (m_persistEvent));
+      ResetTimer (m_persistTimer, m_persistTimeout, &TcpSocketBase::PersistTimeout);
     }
 
   // TCP state machine code in different process functions
@@ -1435,11 +1449,11 @@ TcpSocketBase::DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
       break;
     }
 
-  if (m_rWnd.Get () != 0 && m_persistEvent.IsRunning ())
+  if (m_rWnd.Get () != 0 && m_persistTimer.IsRunning ())
     { // persist probes end, the other end has increased the window
       NS_ASSERT (m_connected);
       NS_LOG_LOGIC (this << " Leaving zerowindow persist state");
-      m_persistEvent.Cancel ();
+      StopTimer (m_persistTimer);
 
       SendPendingData (m_connected);
     }
@@ -2223,7 +2237,7 @@ TcpSocketBase::ProcessSynSent (Ptr<Packet> packet, const TcpHeader& tcpHeader)
       m_tcb->m_congState = TcpSocketState::CA_OPEN;
       m_state = ESTABLISHED;
       m_connected = true;
-      m_retxEvent.Cancel ();
+      m_retxTimer.Cancel ();
       m_delAckCount = m_delAckMaxCount;
       ReceivedData (packet, tcpHeader);
       Simulator::ScheduleNow (&TcpSocketBase::ConnectionSucceeded, this);
@@ -2262,7 +2276,7 @@ TcpSocketBase::ProcessSynSent (Ptr<Packet> packet, const TcpHeader& tcpHeader)
       m_tcb->m_congState = TcpSocketState::CA_OPEN;
       m_state = ESTABLISHED;
       m_connected = true;
-      m_retxEvent.Cancel ();
+      m_retxTimer.Cancel ();
       m_tcb->m_rxBuffer->SetNextRxSequence (tcpHeader.GetSequenceNumber () + SequenceNumber32 (1));
       m_tcb->m_highTxMark = ++m_tcb->m_nextTxSequence;
       m_txBuffer->SetHeadSequence (m_tcb->m_nextTxSequence);
@@ -2323,7 +2337,7 @@ TcpSocketBase::ProcessSynRcvd (Ptr<Packet> packet, const TcpHeader& tcpHeader,
       m_tcb->m_congState = TcpSocketState::CA_OPEN;
       m_state = ESTABLISHED;
       m_connected = true;
-      m_retxEvent.Cancel ();
+      m_retxTimer.Cancel ();
       m_tcb->m_highTxMark = ++m_tcb->m_nextTxSequence;
       m_txBuffer->SetHeadSequence (m_tcb->m_nextTxSequence);
       if (m_endPoint)
@@ -2373,7 +2387,7 @@ TcpSocketBase::ProcessSynRcvd (Ptr<Packet> packet, const TcpHeader& tcpHeader,
       if (tcpHeader.GetSequenceNumber () == m_tcb->m_rxBuffer->NextRxSequence ())
         { // In-sequence FIN before connection complete. Set up connection and close.
           m_connected = true;
-          m_retxEvent.Cancel ();
+          m_retxTimer.Cancel ();
           m_tcb->m_highTxMark = ++m_tcb->m_nextTxSequence;
           m_txBuffer->SetHeadSequence (m_tcb->m_nextTxSequence);
           if (m_endPoint)
@@ -2641,7 +2655,7 @@ TcpSocketBase::Destroy (void)
       m_tcp->RemoveSocket (this);
     }
   NS_LOG_LOGIC (this << " Cancelled ReTxTimeout event which was set to expire at " <<
-                (Simulator::Now () + Simulator::GetDelayLeft (m_retxEvent)).GetSeconds ());
+                m_retxTimer.GetExpiration ().GetSeconds ());
   CancelAllTimers ();
 }
 
@@ -2657,7 +2671,7 @@ TcpSocketBase::Destroy6 (void)
       m_tcp->RemoveSocket (this);
     }
   NS_LOG_LOGIC (this << " Cancelled ReTxTimeout event which was set to expire at " <<
-                (Simulator::Now () + Simulator::GetDelayLeft (m_retxEvent)).GetSeconds ());
+                m_retxTimer.GetExpiration ().GetSeconds ());
   CancelAllTimers ();
 }
 
@@ -2666,6 +2680,22 @@ void
 TcpSocketBase::SendEmptyPacket (uint8_t flags)
 {
   NS_LOG_FUNCTION (this << static_cast<uint32_t> (flags));
+  DoSendEmptyPacket (flags, m_tcb->m_rxBuffer->NextRxSequence ());
+}
+
+/* Send a pure ACK for the given sequence number */
+void
+TcpSocketBase::SendAck (SequenceNumber32 ackNumber, uint8_t flags)
+{
+  NS_LOG_FUNCTION (this << ackNumber << static_cast<uint32_t> (flags));
+  NS_ASSERT ((flags & (TcpHeader::SYN | TcpHeader::FIN | TcpHeader::RST)) == 0);
+  DoSendEmptyPacket (flags | TcpHeader::ACK, ackNumber);
+}
+
+void
+TcpSocketBase::DoSendEmptyPacket (uint8_t flags, SequenceNumber32 ackNumber)
+{
+  NS_LOG_FUNCTION (this << static_cast<uint32_t> (flags) << ackNumber);
 
   if (m_endPoint == nullptr && m_endPoint6 == nullptr)
     {
@@ -2674,7 +2704,6 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
     }
 
   Ptr<Packet> p = Create<Packet> ();
-  TcpHeader header;
   SequenceNumber32 s = m_tcb->m_nextTxSequence;
 
   if (flags & TcpHeader::FIN)
@@ -2688,20 +2717,39 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
 
   AddSocketTags (p);
 
+  // A pure ACK without SACK blocks patches the template, the other packets
+  // are built from scratch
+  bool useTemplate = (flags & TcpHeader::ACK)
+    && (flags & (TcpHeader::SYN | TcpHeader::FIN | TcpHeader::RST)) == 0
+    && !(m_sackEnabled && m_tcb->m_rxBuffer->GetSackListSize () > 0);
+  TcpHeader emptyHeader;
+  TcpHeader &header = useTemplate ? GetAckHeader () : emptyHeader;
+
   header.SetFlags (flags);
   header.SetSequenceNumber (s);
-  header.SetAckNumber (m_tcb->m_rxBuffer->NextRxSequence ());
-  if (m_endPoint != nullptr)
+  header.SetAckNumber (ackNumber);
+  if (useTemplate)
     {
-      header.SetSourcePort (m_endPoint->GetLocalPort ());
-      header.SetDestinationPort (m_endPoint->GetPeerPort ());
+      if (m_ackTimestamp != nullptr)
+        {
+          m_ackTimestamp->SetTimestamp (TcpOptionTS::NowToTsValue ());
+          m_ackTimestamp->SetEcho (m_timestampToEcho);
+        }
     }
   else
     {
-      header.SetSourcePort (m_endPoint6->GetLocalPort ());
-      header.SetDestinationPort (m_endPoint6->GetPeerPort ());
+      if (m_endPoint != nullptr)
+        {
+          header.SetSourcePort (m_endPoint->GetLocalPort ());
+          header.SetDestinationPort (m_endPoint->GetPeerPort ());
+        }
+      else
+        {
+          header.SetSourcePort (m_endPoint6->GetLocalPort ());
+          header.SetDestinationPort (m_endPoint6->GetPeerPort ());
+        }
+      AddOptions (header);
     }
-  AddOptions (header);
 
   // RFC 6298, clause 2.4
   m_rto = Max (m_rtt->GetEstimate () + Max (m_clockGranularity, m_rtt->GetVariation () * 4), m_minRto);
@@ -2749,11 +2797,17 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
 
       windowSize = AdvertisedWindowSize (false);
     }
+  else if (ackNumber < m_tcb->m_rxBuffer->NextRxSequence () && !m_tcb->m_rxBuffer->GotFin ())
+    {
+      // The right edge of the window does not depend on the sequence acknowledged
+      uint32_t w = static_cast<uint32_t> (m_tcb->m_rxBuffer->MaxRxSequence () - ackNumber);
+      windowSize = static_cast<uint16_t> (std::min<uint32_t> (w >> m_rcvWindShift, m_maxWinSize));
+    }
   header.SetWindowSize (windowSize);
 
   if (flags & TcpHeader::ACK)
     { // If sending an ACK, cancel the delay ACK as well
-      m_delAckEvent.Cancel ();
+      StopTimer (m_delAckTimer);
       m_delAckCount = 0;
       if (m_highTxAck < header.GetAckNumber ())
         {
@@ -2763,7 +2817,7 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
         {
           AddOptionSack (header);
         }
-      NS_LOG_INFO ("Sending a pure ACK, acking seq " << m_tcb->m_rxBuffer->NextRxSequence ());
+      NS_LOG_INFO ("Sending a pure ACK, acking seq " << ackNumber);
     }
 
   m_txTrace (p, header, this);
@@ -2780,7 +2834,8 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
     }
 
 
-  if (m_retxEvent.IsExpired () && (hasSyn || hasFin) && !isAck )
+  if (!m_retxTimer.IsRunning ()
+      && (hasSyn || hasFin) && !isAck )
     { // Retransmit SYN / SYN+ACK / FIN / FIN+ACK to guard against lost
       NS_LOG_LOGIC ("Schedule retransmission timeout at time "
                     << Simulator::Now ().GetSeconds () << " to expire at time "
@@ -2789,6 +2844,40 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
     }
 }
 
+TcpHeader &
+TcpSocketBase::GetAckHeader (void)
+{
+  uint16_t localPort;
+  uint16_t peerPort;
+  if (m_endPoint != nullptr)
+    {
+      localPort = m_endPoint->GetLocalPort ();
+      peerPort = m_endPoint->GetPeerPort ();
+    }
+  else
+    {
+      localPort = m_endPoint6->GetLocalPort ();
+      peerPort = m_endPoint6->GetPeerPort ();
+    }
+
+  if (m_ackHeader.GetSourcePort () != localPort
+      || m_ackHeader.GetDestinationPort () != peerPort
+      || (m_ackTimestamp != nullptr) != m_timestampEnabled)
+    {
+      NS_LOG_LOGIC ("Building the template of the pure ACKs");
+      m_ackHeader = TcpHeader ();
+      m_ackHeader.SetSourcePort (localPort);
+      m_ackHeader.SetDestinationPort (peerPort);
+      m_ackTimestamp = nullptr;
+      if (m_timestampEnabled)
+        {
+          m_ackTimestamp = CreateObject<TcpOptionTS> ();
+          m_ackHeader.AppendOption (m_ackTimestamp);
+        }
+    }
+  return m_ackHeader;
+}
+
 /* This function closes the endpoint completely. Called upon RST_TX action. */
 void
 TcpSocketBase::SendRST (void)
@@ -3075,7 +3164,7 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
 
   if (withAck)
     {
-      m_delAckEvent.Cancel ();
+      StopTimer (m_delAckTimer);
       m_delAckCount = 0;
     }
 
@@ -3121,20 +3210,27 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
   header.SetWindowSize (AdvertisedWindowSize ());
   AddOptions (header);
 
-  if (m_retxEvent.IsExpired ())
+  if (!m_retxTimer.IsRunning ())
     {
       // Schedules retransmit timeout. m_rto should be already doubled.
 
       NS_LOG_LOGIC (this << " SendDataPacket Schedule ReTxTimeout at time " <<
                     Simulator::Now ().GetSeconds () << " to expire at time " <<
                     (Simulator::Now () + m_rto.Get ()).GetSeconds () );
-      m_retxEvent = Simulator::Schedule (m_rto, &TcpSocketBase::ReTxTimeout, this);
+      ResetTimer (m_retxTimer, m_rto, &TcpSocketBase::ReTxTimeout);
     }
 
   m_txTrace (p, header, this);
 
-  if (m_endPoint)
+  if (m_tsoBatch && !isRetransmission)
     {
+      AddTsoSegment (p, header);
+      NS_LOG_DEBUG ("Add segment of size " << sz << " with remaining data " <<
+                    remainingData << " to the super-segment. Header " << header);
+    }
+  else if (m_endPoint)
+    {
+      SendTsoPacket ();
       m_tcp->SendPacket (p, header, m_endPoint->GetLocalAddress (),
                          m_endPoint->GetPeerAddress (), m_boundnetdevice);
       NS_LOG_DEBUG ("Send segment of size " << sz << " with remaining data " <<
@@ -3209,6 +3305,11 @@ TcpSocketBase::SendPendingData (bool withAck)
       return false; // Is this the right way to handle this condition?
     }
 
+  // With segmentation offload, the new segments are gathered into
+  // super-segments, which are sent when no more segment can be appended
+  bool tsoBatch = !m_tsoBatch && m_tsoSegments > 1 && m_endPoint != nullptr;
+  m_tsoBatch = m_tsoBatch || tsoBatch;
+
   uint32_t nPacketsSent = 0;
   uint32_t availableWindow = AvailableWindow ();
 
@@ -3338,6 +3439,12 @@ TcpSocketBase::SendPendingData (bool withAck)
       // loop again!
     }
 
+  if (tsoBatch)
+    {
+      m_tsoBatch = false;
+      SendTsoPacket ();
+    }
+
   if (nPacketsSent > 0)
     {
       if (!m_sackEnabled)
@@ -3358,6 +3465,67 @@ TcpSocketBase::SendPendingData (bool withAck)
   return nPacketsSent;
 }
 
+void
+TcpSocketBase::AddTsoSegment (Ptr<Packet> p, const TcpHeader &header)
+{
+  NS_LOG_FUNCTION (this << p << header);
+
+  if (m_tsoPacket != nullptr)
+    {
+      uint32_t segmentSize = m_tcb->m_segmentSize;
+      uint32_t maxSegments = std::min<uint32_t> (m_tsoSegments,
+                                                 (65535 - 60 - m_tsoHeader.GetSerializedSize ()) / segmentSize);
+      TcpHeader expected = m_tsoHeader;
+      expected.SetSequenceNumber (m_tsoHeader.GetSequenceNumber () + m_tsoPacket->GetSize ());
+      expected.SetFlags ((m_tsoHeader.GetFlags () & ~TcpHeader::CWR) | (header.GetFlags () & TcpHeader::FIN));
+      if (m_tsoNSegments < maxSegments
+          && m_tsoPacket->GetSize () == m_tsoNSegments * segmentSize
+          && p->GetSize () <= segmentSize
+          && (m_tsoHeader.GetFlags () & TcpHeader::FIN) == 0
+          && header == expected
+          && header.GetSerializedSize () == m_tsoHeader.GetSerializedSize ())
+        {
+          if (m_tsoNSegments == 1)
+            {
+              // the first segment was passed to the Tx trace, do not modify it
+              m_tsoPacket = m_tsoPacket->Copy ();
+            }
+          m_tsoPacket->AddAtEnd (p);
+          m_tsoHeader.SetFlags (m_tsoHeader.GetFlags () | (header.GetFlags () & TcpHeader::FIN));
+          ++m_tsoNSegments;
+          return;
+        }
+      SendTsoPacket ();
+    }
+
+  m_tsoPacket = p;
+  m_tsoHeader = header;
+  m_tsoNSegments = 1;
+}
+
+void
+TcpSocketBase::SendTsoPacket (void)
+{
+  if (m_tsoPacket == nullptr)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this << m_tsoNSegments);
+
+  Ptr<Packet> p = m_tsoPacket;
+  m_tsoPacket = nullptr;
+  if (m_tsoNSegments > 1)
+    {
+      p->AddPacketTag (TcpTsoTag (static_cast<uint16_t> (m_tcb->m_segmentSize),
+                                  static_cast<uint16_t> (m_tsoNSegments)));
+    }
+  m_tcp->SendPacket (p, m_tsoHeader, m_endPoint->GetLocalAddress (),
+                     m_endPoint->GetPeerAddress (), m_boundnetdevice);
+  NS_LOG_DEBUG ("Send super-segment of " << m_tsoNSegments << " segments and size " <<
+                p->GetSize () << " via TcpL4Protocol to " << m_endPoint->GetPeerAddress () <<
+                ". Header " << m_tsoHeader);
+}
+
 uint32_t
 TcpSocketBase::UnAckDataCount () const
 {
@@ -3436,6 +3604,18 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
   NS_LOG_DEBUG ("Data segment, seq=" << tcpHeader.GetSequenceNumber () <<
                 " pkt size=" << p->GetSize () );
 
+  // Segments merged by the receive offload count as many segments for the
+  // delayed ACKs
+  uint32_t nSegments = 1;
+  if (p->GetSize () > m_tcb->m_segmentSize)
+    {
+      TcpTsoTag tsoTag;
+      if (p->RemovePacketTag (tsoTag))
+        {
+          nSegments = tsoTag.GetNSegments ();
+        }
+    }
+
   // Put into Rx buffer
   SequenceNumber32 expectedSeq = m_tcb->m_rxBuffer->NextRxSequence ();
   if (!m_tcb->m_rxBuffer->Add (p, tcpHeader))
@@ -3489,9 +3669,10 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
     }
   else
     { // In-sequence packet: ACK if delayed ack count allows
-      if (++m_delAckCount >= m_delAckMaxCount)
+      m_delAckCount += nSegments;
+      if (m_delAckCount >= m_delAckMaxCount)
         {
-          m_delAckEvent.Cancel ();
+          StopTimer (m_delAckTimer);
           m_delAckCount = 0;
           m_congestionControl->CwndEvent (m_tcb, TcpSocketState::CA_EVENT_NON_DELAYED_ACK);
           if (m_tcb->m_ecnState == TcpSocketState::ECN_CE_RCVD || m_tcb->m_ecnState == TcpSocketState::ECN_SENDING_ECE)
@@ -3506,17 +3687,16 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
               SendEmptyPacket (TcpHeader::ACK);
             }
         }
-      else if (!m_delAckEvent.IsExpired ())
+      else if (m_delAckTimer.IsRunning ())
         {
           m_congestionControl->CwndEvent (m_tcb, TcpSocketState::CA_EVENT_DELAYED_ACK);
         }
-      else if (m_delAckEvent.IsExpired ())
+      else
         {
           m_congestionControl->CwndEvent (m_tcb, TcpSocketState::CA_EVENT_DELAYED_ACK);
-          m_delAckEvent = Simulator::Schedule (m_delAckTimeout,
-                                               &TcpSocketBase::DelAckTimeout, this);
+          ResetTimer (m_delAckTimer, m_delAckTimeout, &TcpSocketBase::DelAckTimeout);
           NS_LOG_LOGIC (this << " scheduled delayed ACK at " <<
-                        (Simulator::Now () + Simulator::GetDelayLeft (m_delAckEvent)).GetSeconds ());
+                        m_delAckTimer.GetExpiration ().GetSeconds ());
         }
     }
 }
@@ -3588,17 +3768,14 @@ TcpSocketBase::NewAck (SequenceNumber32 const& ack, bool resetRTO)
 
   if (m_state != SYN_RCVD && resetRTO)
     { // Set RTO unless the ACK is received in SYN_RCVD state
-      NS_LOG_LOGIC (this << " Cancelled ReTxTimeout event which was set to expire at " <<
-                    (Simulator::Now () + Simulator::GetDelayLeft (m_retxEvent)).GetSeconds ());
-      m_retxEvent.Cancel ();
       // On receiving a "New" ack we restart retransmission timer .. RFC 6298
       // RFC 6298, clause 2.4
       m_rto = Max (m_rtt->GetEstimate () + Max (m_clockGranularity, m_rtt->GetVariation () * 4), m_minRto);
 
-      NS_LOG_LOGIC (this << " Schedule ReTxTimeout at time " <<
+      NS_LOG_LOGIC (this << " Restart ReTxTimeout at time " <<
                     Simulator::Now ().GetSeconds () << " to expire at time " <<
                     (Simulator::Now () + m_rto.Get ()).GetSeconds ());
-      m_retxEvent = Simulator::Schedule (m_rto, &TcpSocketBase::ReTxTimeout, this);
+      ResetTimer (m_retxTimer, m_rto, &TcpSocketBase::ReTxTimeout);
     }
 
   // Note the highest ACK and tell app to send more
@@ -3616,8 +3793,8 @@ TcpSocketBase::NewAck (SequenceNumber32 const& ack, bool resetRTO)
   if (m_txBuffer->Size () == 0 && m_state != FIN_WAIT_1 && m_state != CLOSING)
     { // No retransmit timer if no data to retransmit
       NS_LOG_LOGIC (this << " Cancelled ReTxTimeout event which was set to expire at " <<
-                    (Simulator::Now () + Simulator::GetDelayLeft (m_retxEvent)).GetSeconds ());
-      m_retxEvent.Cancel ();
+                    m_retxTimer.GetExpiration ().GetSeconds ());
+      m_retxTimer.Cancel ();
     }
 }
 
@@ -3842,7 +4019,7 @@ TcpSocketBase::PersistTimeout ()
   NS_LOG_LOGIC ("Schedule persist timeout at time "
                 << Simulator::Now ().GetSeconds () << " to expire at time "
                 << (Simulator::Now () + m_persistTimeout).GetSeconds ());
-  m_persistEvent = Simulator::Schedule (m_persistTimeout, &TcpSocketBase::PersistTimeout, this);
+  ResetTimer (m_persistTimer, m_persistTimeout, &TcpSocketBase::PersistTimeout);
 }
 
 void
@@ -3880,14 +4057,128 @@ TcpSocketBase::DoRetransmit ()
   NS_ASSERT (sz > 0);
 }
 
+TcpSocketBase::LazyTimer::LazyTimer (EventId *event)
+  : m_event (event),
+    m_deadline (),
+    m_uid (0)
+{
+}
+
+bool
+TcpSocketBase::LazyTimer::IsArmed (void) const
+{
+  return !m_deadline.IsZero ()
+         && (m_wheelTimer.IsPending () || (m_event->IsRunning () && m_event->GetUid () == m_uid));
+}
+
+bool
+TcpSocketBase::LazyTimer::IsRunning (void) const
+{
+  if (!m_deadline.IsZero ())
+    {
+      return IsArmed ();
+    }
+  // the event may be scheduled directly, e.g., for a SYN retransmission,
+  // or still be pending after the timer was stopped
+  return m_event->IsRunning () && m_event->GetUid () != m_uid;
+}
+
+void
+TcpSocketBase::LazyTimer::Cancel (void)
+{
+  m_event->Cancel ();
+  m_deadline = Time (0);
+  m_wheelTimer.Cancel ();
+}
+
+Time
+TcpSocketBase::LazyTimer::GetExpiration (void) const
+{
+  if (IsArmed ())
+    {
+      // the pending event may expire before the deadline
+      return m_deadline;
+    }
+  if (IsRunning ())
+    {
+      // the event is not driven by the timer, e.g., a SYN retransmission
+      return Simulator::Now () + Simulator::GetDelayLeft (*m_event);
+    }
+  return Time (0);
+}
+
+void
+TcpSocketBase::ResetTimer (LazyTimer &timer, Time delay, TimerHandler timeout)
+{
+  NS_LOG_FUNCTION (this << delay);
+  EventId &event = *timer.m_event;
+  timer.m_deadline = Simulator::Now () + delay;
+  if (m_timerWheel != nullptr && m_timerWheel->GetGranularity () <= m_clockGranularity)
+    {
+      // Drop any SYN/FIN retransmission still scheduled on the event
+      event.Cancel ();
+      if (timer.m_wheelTimer.IsPending () && timer.m_wheelTimer.GetExpiration () <= timer.m_deadline)
+        {
+          ++m_avoidedTimerReschedules;
+          return;
+        }
+      if (!timer.m_wheelTimer.HasFunction ())
+        {
+          timer.m_wheelTimer.SetFunction (MakeCallback (&TcpSocketBase::TimerExpired, this)
+                                          .TwoBind (&timer, timeout));
+        }
+      m_timerWheel->Schedule (timer.m_wheelTimer, delay);
+      return;
+    }
+  if (event.IsRunning () && event.GetUid () == timer.m_uid
+      && Simulator::GetDelayLeft (event) <= delay)
+    {
+      // The pending event expires first and will catch up with the deadline
+      ++m_avoidedTimerReschedules;
+      return;
+    }
+  event.Cancel ();
+  event = Simulator::Schedule (delay, &TcpSocketBase::TimerExpired, this, &timer, timeout);
+  timer.m_uid = event.GetUid ();
+}
+
+void
+TcpSocketBase::StopTimer (LazyTimer &timer)
+{
+  if (!timer.m_deadline.IsZero ())
+    {
+      timer.m_deadline = Time (0);
+      ++m_avoidedTimerReschedules;
+    }
+}
+
+void
+TcpSocketBase::TimerExpired (LazyTimer *timer, TimerHandler timeout)
+{
+  NS_LOG_FUNCTION (this);
+  if (timer->m_deadline.IsZero ())
+    {
+      // Stopped while the event was pending
+      return;
+    }
+  Time now = Simulator::Now ();
+  if (now < timer->m_deadline)
+    {
+      ResetTimer (*timer, timer->m_deadline - now, timeout);
+      return;
+    }
+  timer->m_deadline = Time (0);
+  (this->*timeout) ();
+}
+
 void
 TcpSocketBase::CancelAllTimers ()
 {
-  m_retxEvent.Cancel ();
-  m_persistEvent.Cancel ();
-  m_delAckEvent.Cancel ();
+  m_retxTimer.Cancel ();
+  m_persistTimer.Cancel ();
+  m_delAckTimer.Cancel ();
   m_lastAckEvent.Cancel ();
-  m_timewaitEvent.Cancel ();
+  m_timewaitTimer.Cancel ();
   m_sendPendingDataEvent.Cancel ();
   m_pacingTimer.Cancel ();
 }
@@ -3909,8 +4200,8 @@ TcpSocketBase::TimeWait ()
     }
   // Move from TIME_WAIT to CLOSED after 2*MSL. Max segment lifetime is 2 min
   // according to RFC793, p.28
-  m_timewaitEvent = Simulator::Schedule (Seconds (2 * m_msl),
-                                         &TcpSocketBase::CloseAndNotify, this);
+  ResetTimer (m_timewaitTimer, Seconds (2 * m_msl),
+              &TcpSocketBase::CloseAndNotify);
 }
 
 /* Below are the attribute get/set functions */
@@ -4428,6 +4719,24 @@ TcpSocketBase::SetRecoveryAlgorithm (Ptr<TcpRecoveryOps> recovery)
   m_recoveryOps = recovery;
 }
 
+Ptr<TcpCongestionOps>
+TcpSocketBase::GetCongestionControlAlgorithm (void) const
+{
+  return m_congestionControl;
+}
+
+Ptr<const TcpSocketState>
+TcpSocketBase::GetTcb (void) const
+{
+  return m_tcb;
+}
+
+TcpSocket::TcpStates_t
+TcpSocketBase::GetState (void) const
+{
+  return m_state;
+}
+
 Ptr<TcpSocketBase>
 TcpSocketBase::Fork (void)
 {
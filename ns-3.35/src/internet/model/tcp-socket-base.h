@@ -32,6 +32,9 @@
 #include "ns3/data-rate.h"
 #include "ns3/node.h"
 #include "ns3/tcp-socket-state.h"
+#include "ns3/tcp-timer-wheel.h"
+#include "ns3/tcp-header.h"
+#include "ns3/tcp-option-ts.h"
 
 namespace ns3 {
 
@@ -317,6 +320,16 @@ public:
    */
   uint32_t GetRetxThresh (void) const { return m_retxThresh; }
 
+  /**
+   * \brief Get the number of timer reschedules avoided by lazy rearming
+   *
+   * Counts the times the retransmission, delayed ACK and persist timers
+   * were rearmed or stopped without touching the scheduler.
+   *
+   * \return the number of avoided reschedules
+   */
+  uint64_t GetAvoidedTimerReschedules (void) const { return m_avoidedTimerReschedules; }
+
   /**
    * \brief Callback pointer for pacing rate trace chaining
    */
@@ -453,6 +466,24 @@ public:
    */
   void SetRecoveryAlgorithm (Ptr<TcpRecoveryOps> recovery);
 
+  /**
+   * \brief Get the congestion control algorithm of this socket
+   * \return the congestion control algorithm
+   */
+  Ptr<TcpCongestionOps> GetCongestionControlAlgorithm (void) const;
+
+  /**
+   * \brief Get the congestion state of this socket
+   * \return the transmission control block
+   */
+  Ptr<const TcpSocketState> GetTcb (void) const;
+
+  /**
+   * \brief Get the TCP state of this socket
+   * \return the TCP state
+   */
+  TcpStates_t GetState (void) const;
+
   /**
    * \brief Mark ECT(0) codepoint
    *
@@ -780,6 +811,31 @@ protected:
    */
   virtual uint32_t SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool withAck);
 
+  /**
+   * \brief Append a segment to the pending super-segment, sending the
+   *        pending super-segment first if the segment cannot be appended
+   *
+   * Only called by SendDataPacket while SendPendingData runs with
+   * segmentation offload enabled.  A segment is appended if it starts where
+   * the pending super-segment ends, the pending data is a whole number of
+   * full-sized segments without FIN, the headers only differ in the
+   * sequence number and in the CWR and FIN flags (CWR may only be set on
+   * the first segment and FIN on the last one), and the super-segment has
+   * room for another segment.
+   *
+   * \param p the segment payload
+   * \param header the segment header
+   */
+  void AddTsoSegment (Ptr<Packet> p, const TcpHeader &header);
+
+  /**
+   * \brief Send the pending super-segment, if any, to TcpL4Protocol
+   *
+   * A super-segment carrying more than one segment is tagged with a
+   * TcpTsoTag, so that it is split into segments before reaching the wire.
+   */
+  void SendTsoPacket (void);
+
   /**
    * \brief Send a empty packet that carries a flag, e.g., ACK
    *
@@ -787,6 +843,42 @@ protected:
    */
   virtual void SendEmptyPacket (uint8_t flags);
 
+  /**
+   * \brief Send a pure ACK for an explicit sequence number
+   *
+   * Used by the congestion controls (e.g., DCTCP) that acknowledge the data
+   * received before the current segment with a different ECE flag.  The
+   * receive buffer is left untouched.
+   *
+   * \param ackNumber the sequence number to acknowledge
+   * \param flags the flags to set besides ACK, e.g., ECE
+   */
+  void SendAck (SequenceNumber32 ackNumber, uint8_t flags);
+
+  /**
+   * \brief Send an empty packet acknowledging the given sequence number
+   *
+   * Shared by SendEmptyPacket and SendAck. The advertised window is
+   * extended by the data received after the sequence acknowledged, so that
+   * its right edge does not move back.
+   *
+   * \param flags the packet's flags
+   * \param ackNumber the sequence number to acknowledge
+   */
+  void DoSendEmptyPacket (uint8_t flags, SequenceNumber32 ackNumber);
+
+  /**
+   * \brief Get the template of the pure ACKs
+   *
+   * The template keeps the connection ports and, if timestamps are enabled,
+   * the timestamp option, so that a pure ACK only patches the sequence
+   * numbers, the flags, the window and the timestamp of the template.  The
+   * template is built again if the ports or the timestamp setting changed.
+   *
+   * \return the template of the pure ACKs
+   */
+  TcpHeader &GetAckHeader (void);
+
   /**
    * \brief Send reset and tear down this socket
    */
@@ -1079,6 +1171,101 @@ protected:
    */
   virtual void PersistTimeout (void);
 
+  /**
+   * \brief State of a lazily rearmed timer
+   *
+   * The timer is driven by an event of the socket, or by an entry in the
+   * timing wheel of the TCP protocol.  With lazy rearming, the pending event
+   * may expire before the timer does, and may still be scheduled after the
+   * timer is stopped, so the event alone does not tell the state of the
+   * timer.
+   */
+  class LazyTimer
+  {
+  public:
+    /**
+     * \brief Constructor
+     * \param event the event of the timer, which is also used to schedule
+     *        retransmissions that are not driven by the timer (SYN, FIN)
+     */
+    explicit LazyTimer (EventId *event);
+
+    /**
+     * \brief Check whether the timer, or an event scheduled directly on
+     * its event, will expire
+     * \return true if the timer is running
+     */
+    bool IsRunning (void) const;
+
+    /**
+     * \brief Stop the timer and cancel its pending event
+     */
+    void Cancel (void);
+
+    /**
+     * \brief Get the time at which the timer expires
+     * \return the expiration time, zero if the timer is not running
+     */
+    Time GetExpiration (void) const;
+
+  private:
+    friend class TcpSocketBase;
+
+    LazyTimer (const LazyTimer &) = delete;
+    LazyTimer & operator = (const LazyTimer &) = delete;
+
+    /**
+     * \return true if the timer itself is armed
+     */
+    bool IsArmed (void) const;
+
+    EventId  *m_event;   //!< Event of the timer
+    Time     m_deadline; //!< Expiration time, zero if the timer is stopped
+    uint32_t m_uid;      //!< Uid of the event scheduled for this timer
+    TcpTimerWheel::Timer m_wheelTimer; //!< Entry of the timer in the timing wheel
+  };
+
+  /// Timeout method called when a lazily rearmed timer expires
+  typedef void (TcpSocketBase::*TimerHandler) (void);
+
+  /**
+   * \brief Arm a timer to expire after the given delay
+   *
+   * As in Linux, timers are rearmed lazily: if the pending event of the
+   * timer expires no later than the new deadline, only the deadline is
+   * moved, and the event reschedules itself when it expires early.
+   *
+   * The timer is armed in the timing wheel of the TCP protocol if there is
+   * one and its granularity is not coarser than the clock granularity;
+   * otherwise a simulator event is scheduled.
+   *
+   * \param timer the timer
+   * \param delay the delay before the timer expires
+   * \param timeout the method to call on expiration
+   */
+  void ResetTimer (LazyTimer &timer, Time delay, TimerHandler timeout);
+
+  /**
+   * \brief Stop a timer without cancelling its pending event
+   *
+   * The event is ignored when it expires, or reused if the timer is armed
+   * again before.
+   *
+   * \param timer the timer
+   */
+  void StopTimer (LazyTimer &timer);
+
+  /**
+   * \brief Expiration of the event of a lazily rearmed timer
+   *
+   * Reschedules the event if the deadline has moved, otherwise calls the
+   * timeout method.
+   *
+   * \param timer the timer
+   * \param timeout the method to call on expiration
+   */
+  void TimerExpired (LazyTimer *timer, TimerHandler timeout);
+
   /**
    * \brief Retransmit the first segment marked as lost, without considering
    * available window nor pacing.
@@ -1248,6 +1435,12 @@ public:
   EventId           m_delAckEvent   {}; //!< Delayed ACK timeout event
   EventId           m_persistEvent  {}; //!< Persist event: Send 1 byte to probe for a non-zero Rx window
   EventId           m_timewaitEvent {}; //!< TIME_WAIT expiration event: Move this socket to CLOSED state
+  Ptr<TcpTimerWheel> m_timerWheel   {nullptr}; //!< Timing wheel of the TCP protocol, if any
+  LazyTimer         m_retxTimer     {&m_retxEvent};     //!< Retransmission timer
+  LazyTimer         m_delAckTimer   {&m_delAckEvent};   //!< Delayed ACK timer
+  LazyTimer         m_persistTimer  {&m_persistEvent};  //!< Persist timer
+  LazyTimer         m_timewaitTimer {&m_timewaitEvent}; //!< TIME_WAIT timer
+  uint64_t          m_avoidedTimerReschedules {0}; //!< Timer reschedules avoided by lazy rearming
 
   // ACK management
   uint32_t          m_dupAckCount {0};     //!< Dupack counter
@@ -1301,6 +1494,8 @@ public:
   uint16_t         m_maxWinSize              {0};  //!< Maximum window size to advertise
   uint32_t         m_bytesAckedNotProcessed  {0};  //!< Bytes acked, but not processed
   SequenceNumber32 m_highTxAck               {0};  //!< Highest ack sent
+  TcpHeader        m_ackHeader               {};   //!< Template of the pure ACKs
+  Ptr<TcpOptionTS> m_ackTimestamp            {nullptr}; //!< Timestamp option of the pure ACKs template
   TracedValue<uint32_t> m_rWnd               {0};  //!< Receiver window (RCV.WND in RFC793)
   TracedValue<uint32_t> m_advWnd             {0};  //!< Advertised Window size
   TracedValue<SequenceNumber32> m_highRxMark {0};  //!< Highest seqno received
@@ -1324,6 +1519,13 @@ public:
   uint32_t               m_retxThresh {3};   //!< Fast Retransmit threshold
   bool                   m_limitedTx  {true}; //!< perform limited transmit
 
+  // Segmentation offload
+  uint32_t    m_tsoSegments  {1};       //!< Maximum number of segments of a super-segment
+  bool        m_tsoBatch     {false};   //!< True while SendPendingData gathers segments
+  Ptr<Packet> m_tsoPacket    {nullptr}; //!< Payload of the pending super-segment
+  TcpHeader   m_tsoHeader    {};        //!< Header of the pending super-segment
+  uint32_t    m_tsoNSegments {0};       //!< Number of segments of the pending super-segment
+
   // Transmission Control Block
   Ptr<TcpSocketState>    m_tcb;               //!< Congestion control information
   Ptr<TcpCongestionOps>  m_congestionControl; //!< Congestion control
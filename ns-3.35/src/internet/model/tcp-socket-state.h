@@ -233,6 +233,12 @@ public:
    * Callback to send an empty packet
    */
   Callback <void, uint8_t> m_sendEmptyPacketCallback;
+
+  /**
+   * Callback to send a pure ACK that acknowledges the given sequence number
+   * with the given flags, without changing the receive buffer
+   */
+  Callback <void, SequenceNumber32, uint8_t> m_sendAckCallback;
 };
 
 namespace TracedValueCallback {
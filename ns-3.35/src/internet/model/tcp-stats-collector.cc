@@ -0,0 +1,347 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "tcp-stats-collector.h"
+#include "tcp-socket-base.h"
+#include "tcp-dctcp-my.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpStatsCollector");
+
+NS_OBJECT_ENSURE_REGISTERED (TcpStatsCollector);
+
+TcpStatsSketch::TcpStatsSketch ()
+  : m_buckets ((MAX_EXPONENT - MIN_EXPONENT + 1) * SUB_BUCKETS, 0),
+    m_zeroWeight (0),
+    m_count (0),
+    m_weight (0),
+    m_sum (0),
+    m_min (0),
+    m_max (0)
+{
+}
+
+uint32_t
+TcpStatsSketch::GetBucket (double value)
+{
+  int exponent;
+  double mantissa = std::frexp (value, &exponent);
+  if (exponent < MIN_EXPONENT)
+    {
+      return 0;
+    }
+  if (exponent > MAX_EXPONENT)
+    {
+      return (MAX_EXPONENT - MIN_EXPONENT + 1) * SUB_BUCKETS - 1;
+    }
+  // the mantissa is in [0.5, 1)
+  uint32_t sub = std::min (static_cast<uint32_t> ((mantissa - 0.5) * 2 * SUB_BUCKETS), SUB_BUCKETS - 1);
+  return (exponent - MIN_EXPONENT) * SUB_BUCKETS + sub;
+}
+
+double
+TcpStatsSketch::GetBucketValue (uint32_t bucket)
+{
+  int exponent = static_cast<int> (bucket / SUB_BUCKETS) + MIN_EXPONENT;
+  double mantissa = 0.5 + (bucket % SUB_BUCKETS + 0.5) / (2 * SUB_BUCKETS);
+  return std::ldexp (mantissa, exponent);
+}
+
+void
+TcpStatsSketch::Add (double value, double weight)
+{
+  if (weight <= 0)
+    {
+      return;
+    }
+  value = std::max (value, 0.0);
+  if (m_count == 0)
+    {
+      m_min = value;
+      m_max = value;
+    }
+  else
+    {
+      m_min = std::min (m_min, value);
+      m_max = std::max (m_max, value);
+    }
+  m_count++;
+  m_weight += weight;
+  m_sum += value * weight;
+  if (value > 0)
+    {
+      m_buckets[GetBucket (value)] += weight;
+    }
+  else
+    {
+      m_zeroWeight += weight;
+    }
+}
+
+void
+TcpStatsSketch::Clear (void)
+{
+  std::fill (m_buckets.begin (), m_buckets.end (), 0);
+  m_zeroWeight = 0;
+  m_count = 0;
+  m_weight = 0;
+  m_sum = 0;
+  m_min = 0;
+  m_max = 0;
+}
+
+uint64_t
+TcpStatsSketch::GetCount (void) const
+{
+  return m_count;
+}
+
+double
+TcpStatsSketch::GetWeight (void) const
+{
+  return m_weight;
+}
+
+double
+TcpStatsSketch::GetMean (void) const
+{
+  return m_count > 0 ? m_sum / m_weight : 0;
+}
+
+double
+TcpStatsSketch::GetMin (void) const
+{
+  return m_min;
+}
+
+double
+TcpStatsSketch::GetMax (void) const
+{
+  return m_max;
+}
+
+double
+TcpStatsSketch::GetQuantile (double q) const
+{
+  if (m_count == 0)
+    {
+      return 0;
+    }
+  double rank = q * m_weight;
+  double seen = m_zeroWeight;
+  if (m_zeroWeight > 0 && seen >= rank)
+    {
+      return 0;
+    }
+  for (uint32_t i = 0; i < m_buckets.size (); i++)
+    {
+      seen += m_buckets[i];
+      if (m_buckets[i] > 0 && seen >= rank)
+        {
+          return std::min (std::max (GetBucketValue (i), m_min), m_max);
+        }
+    }
+  return m_max;
+}
+
+TypeId
+TcpStatsCollector::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpStatsCollector")
+    .SetParent<Object> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<TcpStatsCollector> ()
+    .AddAttribute ("SamplingInterval",
+                   "Time between two samples of the sockets",
+                   TimeValue (MilliSeconds (1)),
+                   MakeTimeAccessor (&TcpStatsCollector::m_samplingInterval),
+                   MakeTimeChecker (NanoSeconds (1)))
+    .AddAttribute ("ReportInterval",
+                   "Time between two reports of the aggregated statistics",
+                   TimeValue (MilliSeconds (100)),
+                   MakeTimeAccessor (&TcpStatsCollector::m_reportInterval),
+                   MakeTimeChecker (NanoSeconds (1)))
+    .AddAttribute ("FileName",
+                   "Name of the file the reports are written to, none if empty",
+                   StringValue (""),
+                   MakeStringAccessor (&TcpStatsCollector::m_fileName),
+                   MakeStringChecker ())
+  ;
+  return tid;
+}
+
+TcpStatsCollector::TcpStatsCollector ()
+  : m_nReports (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpStatsCollector::~TcpStatsCollector ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TcpStatsCollector::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_sampleEvent.Cancel ();
+  m_reportEvent.Cancel ();
+  m_sockets.clear ();
+  if (m_file.is_open ())
+    {
+      m_file.close ();
+    }
+  Object::DoDispose ();
+}
+
+std::string
+TcpStatsCollector::GetMetricName (Metric metric)
+{
+  switch (metric)
+    {
+    case CWND:
+      return "cwnd";
+    case ALPHA:
+      return "alpha";
+    case ECE_FRACTION:
+      return "ece";
+    case RTT:
+      return "rtt";
+    default:
+      NS_ABORT_MSG ("Unknown metric");
+    }
+  return "";
+}
+
+void
+TcpStatsCollector::AddSocket (Ptr<TcpSocketBase> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  SocketStats stats;
+  stats.socket = socket;
+  stats.dctcp = DynamicCast<TcpDctcpMy> (socket->GetCongestionControlAlgorithm ());
+  stats.connected = false;
+  m_sockets.push_back (stats);
+  if (!m_sampleEvent.IsRunning ())
+    {
+      m_sampleEvent = Simulator::Schedule (m_samplingInterval, &TcpStatsCollector::Sample, this);
+      m_reportEvent = Simulator::Schedule (m_reportInterval, &TcpStatsCollector::Report, this);
+    }
+}
+
+const TcpStatsSketch &
+TcpStatsCollector::GetReport (Metric metric) const
+{
+  NS_ASSERT (metric < N_METRICS);
+  return m_reports[metric];
+}
+
+uint32_t
+TcpStatsCollector::GetNReports (void) const
+{
+  return m_nReports;
+}
+
+void
+TcpStatsCollector::Sample (void)
+{
+  NS_LOG_FUNCTION (this);
+  double weight = m_samplingInterval.GetSeconds ();
+  bool done = true;
+  for (std::vector<SocketStats>::iterator it = m_sockets.begin (); it != m_sockets.end (); it++)
+    {
+      TcpSocket::TcpStates_t state = it->socket->GetState ();
+      if (state < TcpSocket::ESTABLISHED || state >= TcpSocket::TIME_WAIT)
+        {
+          // a listening socket never connects, its connections are forked
+          done = done && (it->connected || state == TcpSocket::LISTEN);
+          continue;
+        }
+      it->connected = true;
+      done = false;
+      Ptr<const TcpSocketState> tcb = it->socket->GetTcb ();
+      m_sketches[CWND].Add (tcb->m_cWnd.Get (), weight);
+      if (tcb->m_lastRtt.Get ().IsStrictlyPositive ())
+        {
+          m_sketches[RTT].Add (tcb->m_lastRtt.Get ().GetSeconds (), weight);
+        }
+      if (it->dctcp != nullptr)
+        {
+          m_sketches[ALPHA].Add (it->dctcp->GetAlpha (), weight);
+          m_sketches[ECE_FRACTION].Add (it->dctcp->GetEceFraction (), weight);
+        }
+    }
+  if (done)
+    {
+      NS_LOG_LOGIC ("No socket left to sample, stop sampling");
+      m_reportEvent.Cancel ();
+      Report ();
+      m_reportEvent.Cancel ();
+      return;
+    }
+  m_sampleEvent = Simulator::Schedule (m_samplingInterval, &TcpStatsCollector::Sample, this);
+}
+
+void
+TcpStatsCollector::Report (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_fileName.empty () && !m_file.is_open ())
+    {
+      m_file.open (m_fileName.c_str ());
+      NS_ABORT_MSG_UNLESS (m_file.is_open (), "Cannot open " << m_fileName);
+      m_file << "time";
+      for (uint32_t i = 0; i < N_METRICS; i++)
+        {
+          std::string name = GetMetricName (static_cast<Metric> (i));
+          m_file << " " << name << ".count " << name << ".mean " << name << ".min "
+                 << name << ".max " << name << ".p50 " << name << ".p90 " << name << ".p99";
+        }
+      m_file << std::endl;
+    }
+
+  for (uint32_t i = 0; i < N_METRICS; i++)
+    {
+      std::swap (m_reports[i], m_sketches[i]);
+      m_sketches[i].Clear ();
+    }
+  m_nReports++;
+
+  if (m_file.is_open ())
+    {
+      m_file << Simulator::Now ().GetSeconds ();
+      for (uint32_t i = 0; i < N_METRICS; i++)
+        {
+          const TcpStatsSketch &report = m_reports[i];
+          m_file << " " << report.GetCount () << " " << report.GetMean () << " "
+                 << report.GetMin () << " " << report.GetMax () << " "
+                 << report.GetQuantile (0.5) << " " << report.GetQuantile (0.9) << " "
+                 << report.GetQuantile (0.99);
+        }
+      m_file << std::endl;
+    }
+  m_reportEvent = Simulator::Schedule (m_reportInterval, &TcpStatsCollector::Report, this);
+}
+
+} // namespace ns3
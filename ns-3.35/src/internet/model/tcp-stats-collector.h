@@ -0,0 +1,232 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_STATS_COLLECTOR_H
+#define TCP_STATS_COLLECTOR_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+
+namespace ns3 {
+
+class TcpSocketBase;
+class TcpDctcpMy;
+
+/**
+ * \ingroup tcp
+ *
+ * \brief Sketch of a distribution of weighted non-negative values
+ *
+ * Keeps the count, weighted sum, minimum and maximum of the values, and a
+ * log-linear histogram of their weights with 16 buckets per power of two,
+ * which gives the quantiles within about 3% of the true value.  With the
+ * time a sample stands for as its weight, the mean and the quantiles are
+ * time-weighted.
+ */
+class TcpStatsSketch
+{
+public:
+  TcpStatsSketch ();
+
+  /**
+   * \brief Add a value
+   * \param value the value, negative values count as zero
+   * \param weight the weight of the value; a value with a weight that is
+   * not positive is ignored
+   */
+  void Add (double value, double weight = 1);
+
+  /**
+   * \brief Remove all the values
+   */
+  void Clear (void);
+
+  /**
+   * \return the number of values
+   */
+  uint64_t GetCount (void) const;
+
+  /**
+   * \return the sum of the weights of the values
+   */
+  double GetWeight (void) const;
+
+  /**
+   * \return the weighted mean of the values, or 0 if there is none
+   */
+  double GetMean (void) const;
+
+  /**
+   * \return the smallest value, or 0 if there is none
+   */
+  double GetMin (void) const;
+
+  /**
+   * \return the largest value, or 0 if there is none
+   */
+  double GetMax (void) const;
+
+  /**
+   * \brief Get an approximate weighted quantile of the values
+   * \param q the quantile, between 0 and 1
+   * \return the quantile, or 0 if there is no value
+   */
+  double GetQuantile (double q) const;
+
+private:
+  static const int MIN_EXPONENT = -40;  //!< Smallest power of two with its own buckets
+  static const int MAX_EXPONENT = 63;   //!< Largest power of two with its own buckets
+  static const uint32_t SUB_BUCKETS = 16; //!< Buckets per power of two
+
+  /**
+   * \brief Get the bucket of a positive value
+   * \param value the value
+   * \return the index of the bucket
+   */
+  static uint32_t GetBucket (double value);
+
+  /**
+   * \brief Get the value at the middle of a bucket
+   * \param bucket the index of the bucket
+   * \return the value
+   */
+  static double GetBucketValue (uint32_t bucket);
+
+  std::vector<double> m_buckets;    //!< Weights of the positive values per bucket
+  double m_zeroWeight;              //!< Weight of the values equal to zero
+  uint64_t m_count;                 //!< Number of values
+  double m_weight;                  //!< Sum of the weights
+  double m_sum;                     //!< Weighted sum of the values
+  double m_min;                     //!< Smallest value
+  double m_max;                     //!< Largest value
+};
+
+/**
+ * \ingroup tcp
+ *
+ * \brief Collect aggregated congestion statistics of a set of TCP sockets
+ *
+ * Every SamplingInterval, the collector reads from each of its sockets with
+ * an established connection (or one being closed) the congestion window,
+ * the last RTT sample and, for TcpDctcpMy, alpha and the fraction of bytes
+ * acked with ECE in the last observation window.  Each sample is weighted
+ * by the sampling interval, the time it stands for, so that the statistics
+ * are time-weighted.  No trace source of the sockets is connected, so the
+ * cost does not depend on how often the metrics change.
+ *
+ * Every ReportInterval the samples of all the sockets are summarized
+ * (count, mean, minimum, maximum and the 50th, 90th and 99th percentiles
+ * of each metric), written as a row of FileName, if set, and reset.  The
+ * first line of the file names the columns.  The sampling stops, with a
+ * last report, once every socket either was closed after its connection or
+ * is listening, as a listening socket never connects itself.
+ */
+class TcpStatsCollector : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TcpStatsCollector ();
+  virtual ~TcpStatsCollector ();
+
+  /**
+   * \brief The metrics collected
+   */
+  enum Metric
+  {
+    CWND = 0,        //!< Congestion window, in bytes
+    ALPHA,           //!< DCTCP congestion estimate
+    ECE_FRACTION,    //!< Fraction of the bytes acked with ECE (DCTCP)
+    RTT,             //!< Last RTT sample, in seconds
+    N_METRICS        //!< Number of metrics
+  };
+
+  /**
+   * \brief Add a socket to sample
+   *
+   * The alpha and ECE fraction are sampled if the congestion control of
+   * the socket, when it is added, is TcpDctcpMy.
+   *
+   * \param socket the socket
+   */
+  void AddSocket (Ptr<TcpSocketBase> socket);
+
+  /**
+   * \brief Get the sketch of a metric over the last complete report interval
+   * \param metric the metric
+   * \return the sketch
+   */
+  const TcpStatsSketch & GetReport (Metric metric) const;
+
+  /**
+   * \return the number of reports made
+   */
+  uint32_t GetNReports (void) const;
+
+  /**
+   * \brief Get the name of a metric, as used in the column names
+   * \param metric the metric
+   * \return the name of the metric
+   */
+  static std::string GetMetricName (Metric metric);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief A sampled socket
+   */
+  struct SocketStats
+  {
+    Ptr<TcpSocketBase> socket;            //!< The socket
+    Ptr<TcpDctcpMy> dctcp;                //!< Its DCTCP congestion control, if any
+    bool connected;                       //!< Whether a connection was seen
+  };
+
+  /**
+   * \brief Sample the sockets
+   */
+  void Sample (void);
+
+  /**
+   * \brief Summarize the interval and start a new interval
+   */
+  void Report (void);
+
+  Time m_samplingInterval;                       //!< Time between two samples
+  Time m_reportInterval;                         //!< Time between two reports
+  std::string m_fileName;                        //!< Name of the output file
+  std::ofstream m_file;                          //!< Output file
+  std::vector<SocketStats> m_sockets;            //!< Sampled sockets
+  TcpStatsSketch m_sketches[N_METRICS];          //!< Samples of the current interval
+  TcpStatsSketch m_reports[N_METRICS];           //!< Samples of the last complete interval
+  uint32_t m_nReports;                           //!< Number of reports made
+  EventId m_sampleEvent;                         //!< Next sample
+  EventId m_reportEvent;                         //!< Next report
+};
+
+} // namespace ns3
+
+#endif /* TCP_STATS_COLLECTOR_H */
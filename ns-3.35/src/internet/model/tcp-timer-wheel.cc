@@ -0,0 +1,355 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "tcp-timer-wheel.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpTimerWheel");
+
+NS_OBJECT_ENSURE_REGISTERED (TcpTimerWheel);
+
+TcpTimerWheel::Timer::Timer ()
+  : m_wheel (nullptr),
+    m_prev (nullptr),
+    m_next (nullptr),
+    m_tick (0),
+    m_slot (0)
+{
+}
+
+TcpTimerWheel::Timer::Timer (const Timer &o)
+  : m_wheel (nullptr),
+    m_prev (nullptr),
+    m_next (nullptr),
+    m_tick (0),
+    m_slot (0)
+{
+}
+
+TcpTimerWheel::Timer &
+TcpTimerWheel::Timer::operator = (const Timer &o)
+{
+  if (m_wheel != nullptr)
+    {
+      m_wheel->Cancel (*this);
+    }
+  m_function = Callback<void> ();
+  return *this;
+}
+
+TcpTimerWheel::Timer::~Timer ()
+{
+  if (m_wheel != nullptr)
+    {
+      m_wheel->Cancel (*this);
+    }
+}
+
+void
+TcpTimerWheel::Timer::SetFunction (Callback<void> function)
+{
+  m_function = function;
+}
+
+bool
+TcpTimerWheel::Timer::HasFunction (void) const
+{
+  return !m_function.IsNull ();
+}
+
+bool
+TcpTimerWheel::Timer::IsPending (void) const
+{
+  return m_wheel != nullptr;
+}
+
+Time
+TcpTimerWheel::Timer::GetExpiration (void) const
+{
+  NS_ASSERT (m_wheel != nullptr);
+  return m_wheel->m_granularity * static_cast<int64_t> (m_tick);
+}
+
+void
+TcpTimerWheel::Timer::Cancel (void)
+{
+  if (m_wheel != nullptr)
+    {
+      m_wheel->Cancel (*this);
+    }
+}
+
+TypeId
+TcpTimerWheel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpTimerWheel")
+    .SetParent<Object> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<TcpTimerWheel> ()
+    .AddAttribute ("Granularity",
+                   "Duration of a tick of the wheel",
+                   TimeValue (MilliSeconds (1)),
+                   MakeTimeAccessor (&TcpTimerWheel::SetGranularity,
+                                     &TcpTimerWheel::GetGranularity),
+                   MakeTimeChecker (NanoSeconds (1)))
+    .AddAttribute ("Slots",
+                   "Number of slots of the wheel, rounded up to a power of two",
+                   UintegerValue (512),
+                   MakeUintegerAccessor (&TcpTimerWheel::m_requestedSlots),
+                   MakeUintegerChecker<uint32_t> (64))
+  ;
+  return tid;
+}
+
+TcpTimerWheel::TcpTimerWheel ()
+  : m_granularity (MilliSeconds (1)),
+    m_requestedSlots (512),
+    m_nSlots (0),
+    m_lastTick (0),
+    m_nextTick (0),
+    m_nTimers (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpTimerWheel::~TcpTimerWheel ()
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (m_nTimers == 0, "Timer wheel destroyed with armed timers");
+}
+
+void
+TcpTimerWheel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  // The timers are owned by the sockets, which unlink them when destroyed
+  m_event.Cancel ();
+  Object::DoDispose ();
+}
+
+void
+TcpTimerWheel::SetGranularity (Time granularity)
+{
+  NS_LOG_FUNCTION (this << granularity);
+  NS_ABORT_MSG_IF (m_nTimers > 0, "Cannot change the granularity of a wheel with armed timers");
+  NS_ABORT_MSG_IF (!granularity.IsStrictlyPositive (), "The granularity must be positive");
+  m_granularity = granularity;
+}
+
+Time
+TcpTimerWheel::GetGranularity (void) const
+{
+  return m_granularity;
+}
+
+uint32_t
+TcpTimerWheel::GetNTimers (void) const
+{
+  return m_nTimers;
+}
+
+void
+TcpTimerWheel::Initialize (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_nSlots = 64;
+  while (m_nSlots < m_requestedSlots)
+    {
+      m_nSlots <<= 1;
+    }
+  m_slots.assign (m_nSlots + 1, nullptr);
+  m_occupied.assign (m_nSlots / 64, 0);
+}
+
+void
+TcpTimerWheel::Link (Timer &timer, uint32_t slot)
+{
+  timer.m_wheel = this;
+  timer.m_slot = slot;
+  timer.m_prev = nullptr;
+  timer.m_next = m_slots[slot];
+  if (timer.m_next != nullptr)
+    {
+      timer.m_next->m_prev = &timer;
+    }
+  m_slots[slot] = &timer;
+  if (slot < m_nSlots)
+    {
+      m_occupied[slot / 64] |= (uint64_t) 1 << (slot % 64);
+    }
+}
+
+void
+TcpTimerWheel::Unlink (Timer &timer)
+{
+  uint32_t slot = timer.m_slot;
+  if (timer.m_prev != nullptr)
+    {
+      timer.m_prev->m_next = timer.m_next;
+    }
+  else
+    {
+      m_slots[slot] = timer.m_next;
+    }
+  if (timer.m_next != nullptr)
+    {
+      timer.m_next->m_prev = timer.m_prev;
+    }
+  if (slot < m_nSlots && m_slots[slot] == nullptr)
+    {
+      m_occupied[slot / 64] &= ~((uint64_t) 1 << (slot % 64));
+    }
+  timer.m_wheel = nullptr;
+  timer.m_prev = nullptr;
+  timer.m_next = nullptr;
+}
+
+void
+TcpTimerWheel::Schedule (Timer &timer, Time delay)
+{
+  NS_LOG_FUNCTION (this << &timer << delay);
+  NS_ASSERT (timer.HasFunction ());
+  NS_ASSERT (timer.m_wheel == nullptr || timer.m_wheel == this);
+
+  if (m_slots.empty ())
+    {
+      Initialize ();
+    }
+  if (timer.m_wheel != nullptr)
+    {
+      Unlink (timer);
+      --m_nTimers;
+    }
+
+  int64_t granularity = m_granularity.GetTimeStep ();
+  int64_t now = Simulator::Now ().GetTimeStep ();
+  uint64_t tick = (now + std::max<int64_t> (delay.GetTimeStep (), 0) + granularity - 1) / granularity;
+  // Never expire a timer in the tick being processed
+  tick = std::max (tick, std::max (m_lastTick, static_cast<uint64_t> (now / granularity)) + 1);
+
+  timer.m_tick = tick;
+  Link (timer, tick & (m_nSlots - 1));
+  ++m_nTimers;
+
+  if (!m_event.IsRunning () || tick < m_nextTick)
+    {
+      ScheduleTick (tick);
+    }
+}
+
+void
+TcpTimerWheel::Cancel (Timer &timer)
+{
+  NS_LOG_FUNCTION (this << &timer);
+  if (timer.m_wheel == nullptr)
+    {
+      return;
+    }
+  NS_ASSERT (timer.m_wheel == this);
+  Unlink (timer);
+  --m_nTimers;
+  if (m_nTimers == 0)
+    {
+      m_event.Cancel ();
+    }
+}
+
+void
+TcpTimerWheel::ScheduleTick (uint64_t tick)
+{
+  m_event.Cancel ();
+  m_nextTick = tick;
+  Time at = m_granularity * static_cast<int64_t> (tick);
+  m_event = Simulator::Schedule (at - Simulator::Now (), &TcpTimerWheel::Expire, this);
+}
+
+void
+TcpTimerWheel::ScheduleNext (void)
+{
+  if (m_nTimers == 0)
+    {
+      return;
+    }
+  uint64_t base = std::max (m_lastTick,
+                            static_cast<uint64_t> (Simulator::Now ().GetTimeStep () / m_granularity.GetTimeStep ()));
+  // Find the first occupied slot after the current one, wrapping around
+  uint32_t start = (base + 1) & (m_nSlots - 1);
+  uint32_t nWords = m_nSlots / 64;
+  for (uint32_t i = 0; i <= nWords; ++i)
+    {
+      uint32_t word = (start / 64 + i) % nWords;
+      uint64_t bits = m_occupied[word];
+      if (i == 0)
+        {
+          bits &= ~(uint64_t) 0 << (start % 64);
+        }
+      else if (i == nWords)
+        {
+          bits &= ((uint64_t) 1 << (start % 64)) - 1;
+        }
+      if (bits != 0)
+        {
+          uint32_t slot = word * 64 + __builtin_ctzll (bits);
+          uint32_t distance = (slot - start) & (m_nSlots - 1);
+          ScheduleTick (base + 1 + distance);
+          return;
+        }
+    }
+  NS_ASSERT_MSG (false, "Armed timers but no occupied slot");
+}
+
+void
+TcpTimerWheel::Expire (void)
+{
+  NS_LOG_FUNCTION (this << m_nextTick);
+  uint64_t tick = m_nextTick;
+  m_lastTick = tick;
+
+  // Move the due timers to the expiring list first, so that the functions
+  // can arm and cancel any timer, including the ones expiring in this batch.
+  // Both lists are built by pushing at the front, so the timers expire in
+  // the order they were armed.
+  Timer *next = nullptr;
+  for (Timer *timer = m_slots[tick & (m_nSlots - 1)]; timer != nullptr; timer = next)
+    {
+      next = timer->m_next;
+      if (timer->m_tick <= tick)
+        {
+          Unlink (*timer);
+          Link (*timer, m_nSlots);
+        }
+    }
+
+  while (m_slots[m_nSlots] != nullptr)
+    {
+      Timer *timer = m_slots[m_nSlots];
+      Unlink (*timer);
+      --m_nTimers;
+      // Copy the function, the timer may be destroyed by its own function
+      Callback<void> function = timer->m_function;
+      function ();
+    }
+
+  ScheduleNext ();
+}
+
+} // namespace ns3
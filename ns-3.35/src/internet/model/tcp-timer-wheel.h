@@ -0,0 +1,203 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_TIMER_WHEEL_H
+#define TCP_TIMER_WHEEL_H
+
+#include <stdint.h>
+#include <vector>
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/callback.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcp
+ *
+ * \brief A hashed timing wheel for the timers of the TCP sockets of a node
+ *
+ * TCP sockets keep several timers (retransmission, delayed ACK, persist,
+ * TIME_WAIT) that are armed far more often than they expire.  Scheduling
+ * each of them in the simulator makes the scheduler hold one event per
+ * timer and per connection.  The wheel instead hashes every timer into one
+ * of a fixed number of slots, by its expiration time rounded up to the
+ * wheel granularity, and keeps a single simulator event, for the earliest
+ * occupied slot.  The timers of a slot that are due expire in one batch;
+ * timers further away than a revolution of the wheel stay in their slot
+ * until their round comes.
+ *
+ * Timers are intrusive list nodes owned by their user, so arming, moving
+ * and cancelling a timer are O(1) and do not allocate memory.
+ */
+class TcpTimerWheel : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief A timer armed in a TcpTimerWheel
+   *
+   * A copy of a timer has no function and is not armed.  A timer that is
+   * destroyed while armed is removed from its wheel.
+   */
+  class Timer
+  {
+  public:
+    Timer ();
+    /**
+     * \brief Copy constructor
+     * \param o the timer to copy (ignored)
+     */
+    Timer (const Timer &o);
+    /**
+     * \brief Assignment, which cancels the timer
+     * \param o the timer to copy (ignored)
+     * \return this timer
+     */
+    Timer & operator = (const Timer &o);
+    ~Timer ();
+
+    /**
+     * \brief Set the function called when the timer expires
+     * \param function the function
+     */
+    void SetFunction (Callback<void> function);
+
+    /**
+     * \return true if a function was set
+     */
+    bool HasFunction (void) const;
+
+    /**
+     * \return true if the timer is armed in a wheel
+     */
+    bool IsPending (void) const;
+
+    /**
+     * \return the expiration time of a pending timer
+     */
+    Time GetExpiration (void) const;
+
+    /**
+     * \brief Disarm the timer, if it is armed
+     */
+    void Cancel (void);
+
+  private:
+    friend class TcpTimerWheel;
+
+    TcpTimerWheel *m_wheel;   //!< Wheel the timer is armed in, nullptr if not armed
+    Timer *m_prev;            //!< Previous timer in the slot
+    Timer *m_next;            //!< Next timer in the slot
+    uint64_t m_tick;          //!< Expiration tick
+    uint32_t m_slot;          //!< Slot index
+    Callback<void> m_function; //!< Function called on expiration
+  };
+
+  TcpTimerWheel ();
+  virtual ~TcpTimerWheel ();
+
+  /**
+   * \brief Set the duration of a tick; timers expire on tick boundaries
+   * \param granularity the tick duration
+   */
+  void SetGranularity (Time granularity);
+
+  /**
+   * \return the duration of a tick
+   */
+  Time GetGranularity (void) const;
+
+  /**
+   * \brief Arm a timer, moving it if it is already armed
+   *
+   * The timer expires at the first tick boundary at or after
+   * Now () + delay, and always after the current tick.
+   *
+   * \param timer the timer, whose function must be set
+   * \param delay the delay before expiration
+   */
+  void Schedule (Timer &timer, Time delay);
+
+  /**
+   * \brief Disarm a timer, if it is armed
+   * \param timer the timer
+   */
+  void Cancel (Timer &timer);
+
+  /**
+   * \return the number of armed timers
+   */
+  uint32_t GetNTimers (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Allocate the slots on first use
+   */
+  void Initialize (void);
+
+  /**
+   * \brief Insert a timer in a slot
+   * \param timer the timer
+   * \param slot the slot index
+   */
+  void Link (Timer &timer, uint32_t slot);
+
+  /**
+   * \brief Remove a timer from its slot
+   * \param timer the timer
+   */
+  void Unlink (Timer &timer);
+
+  /**
+   * \brief Expire the due timers of the current slot
+   */
+  void Expire (void);
+
+  /**
+   * \brief Schedule the simulator event for the earliest occupied slot
+   */
+  void ScheduleNext (void);
+
+  /**
+   * \brief Schedule the simulator event at the given tick
+   * \param tick the tick
+   */
+  void ScheduleTick (uint64_t tick);
+
+  Time m_granularity;                 //!< Duration of a tick
+  uint32_t m_requestedSlots;          //!< Number of slots set by the attribute
+  uint32_t m_nSlots;                  //!< Number of slots, a power of two, zero until the first timer is armed
+  std::vector<Timer *> m_slots;       //!< Heads of the slot lists; the extra last one holds expiring timers
+  std::vector<uint64_t> m_occupied;   //!< Bitmap of the non-empty slots
+  uint64_t m_lastTick;                //!< Last expired tick
+  uint64_t m_nextTick;                //!< Tick of the pending simulator event
+  uint32_t m_nTimers;                 //!< Number of armed timers
+  EventId m_event;                    //!< Simulator event of the next occupied slot
+};
+
+} // namespace ns3
+
+#endif /* TCP_TIMER_WHEEL_H */
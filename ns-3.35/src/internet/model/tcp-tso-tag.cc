@@ -0,0 +1,102 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "tcp-tso-tag.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (TcpTsoTag);
+
+TcpTsoTag::TcpTsoTag ()
+  : m_segmentSize (0),
+    m_nSegments (0)
+{
+}
+
+TcpTsoTag::TcpTsoTag (uint16_t segmentSize, uint16_t nSegments)
+  : m_segmentSize (segmentSize),
+    m_nSegments (nSegments)
+{
+}
+
+void
+TcpTsoTag::SetSegmentSize (uint16_t segmentSize)
+{
+  m_segmentSize = segmentSize;
+}
+
+uint16_t
+TcpTsoTag::GetSegmentSize (void) const
+{
+  return m_segmentSize;
+}
+
+void
+TcpTsoTag::SetNSegments (uint16_t nSegments)
+{
+  m_nSegments = nSegments;
+}
+
+uint16_t
+TcpTsoTag::GetNSegments (void) const
+{
+  return m_nSegments;
+}
+
+TypeId
+TcpTsoTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpTsoTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<TcpTsoTag> ()
+  ;
+  return tid;
+}
+
+TypeId
+TcpTsoTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+TcpTsoTag::GetSerializedSize (void) const
+{
+  return 4;
+}
+
+void
+TcpTsoTag::Serialize (TagBuffer i) const
+{
+  i.WriteU16 (m_segmentSize);
+  i.WriteU16 (m_nSegments);
+}
+
+void
+TcpTsoTag::Deserialize (TagBuffer i)
+{
+  m_segmentSize = i.ReadU16 ();
+  m_nSegments = i.ReadU16 ();
+}
+
+void
+TcpTsoTag::Print (std::ostream &os) const
+{
+  os << "TSO segments=" << m_nSegments << " size=" << m_segmentSize;
+}
+
+} // namespace ns3
@@ -0,0 +1,88 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_TSO_TAG_H
+#define TCP_TSO_TAG_H
+
+#include "ns3/tag.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcp
+ *
+ * \brief Mark a TCP super-segment, to be split in segments of the given
+ * size before it reaches the wire
+ *
+ * The tag is added by TcpSocketBase when segmentation offload is enabled
+ * (see the TsoSegments attribute) and the segment carries more than one
+ * MSS of data.  IPv4 does not fragment a tagged packet larger than the
+ * MTU, and marks the queue disc item so that it is split when it is handed
+ * to the device (see QueueDiscItem::Segment).
+ */
+class TcpTsoTag : public Tag
+{
+public:
+  TcpTsoTag ();
+
+  /**
+   * \brief Constructor
+   * \param segmentSize the size of the segments
+   * \param nSegments the number of segments
+   */
+  TcpTsoTag (uint16_t segmentSize, uint16_t nSegments);
+
+  /**
+   * \brief Set the size of the segments
+   * \param segmentSize the size of the payload of each segment
+   */
+  void SetSegmentSize (uint16_t segmentSize);
+
+  /**
+   * \return the size of the payload of each segment
+   */
+  uint16_t GetSegmentSize (void) const;
+
+  /**
+   * \brief Set the number of segments
+   * \param nSegments the number of segments
+   */
+  void SetNSegments (uint16_t nSegments);
+
+  /**
+   * \return the number of segments
+   */
+  uint16_t GetNSegments (void) const;
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer i) const;
+  virtual void Deserialize (TagBuffer i);
+  virtual void Print (std::ostream &os) const;
+
+private:
+  uint16_t m_segmentSize; //!< Size of the payload of each segment
+  uint16_t m_nSegments;   //!< Number of segments
+};
+
+} // namespace ns3
+
+#endif /* TCP_TSO_TAG_H */
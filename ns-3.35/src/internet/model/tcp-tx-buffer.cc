@@ -296,7 +296,7 @@ TcpTxBuffer::GetNewSegment (uint32_t numBytes)
   NS_ASSERT (it != m_appList.end ());
 
   m_appList.erase (it);
-  m_sentList.insert (m_sentList.end (), item);
+  IndexSet (item->m_startSeq, m_sentList.insert (m_sentList.end (), item));
   m_sentSize += item->m_packet->GetSize ();
 
   return item;
@@ -310,36 +310,33 @@ TcpTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &s
   NS_ASSERT (numBytes <= m_sentSize);
   NS_ASSERT (m_sentList.size () >= 1);
 
-  auto it = m_sentList.begin ();
   bool listEdited = false;
   uint32_t s = numBytes;
 
   // Avoid to merge different packet for this retransmission if flags are
   // different.
-  for (; it != m_sentList.end(); ++it)
+  auto index = IndexLowerBound (seq);
+  if (index != m_sentIndex.end () && index->seq == seq)
     {
-      if ((*it)->m_startSeq == seq)
+      auto it = index->item;
+      auto next = it;
+      next++;
+      if (next != m_sentList.end ())
         {
-          auto next = it;
-          next++;
-          if (next != m_sentList.end ())
+          // Next is not sacked and have the same value for m_lost ... there is the possibility to merge
+          if ((! (*next)->m_sacked) && ((*it)->m_lost == (*next)->m_lost))
             {
-              // Next is not sacked and have the same value for m_lost ... there is the possibility to merge
-              if ((! (*next)->m_sacked) && ((*it)->m_lost == (*next)->m_lost))
-                {
-                  s = std::min(s, (*it)->m_packet->GetSize () + (*next)->m_packet->GetSize ());
-                }
-              else
-                {
-                  // Next is sacked... better to retransmit only the first segment
-                  s = std::min(s, (*it)->m_packet->GetSize ());
-                }
+              s = std::min(s, (*it)->m_packet->GetSize () + (*next)->m_packet->GetSize ());
             }
           else
             {
+              // Next is sacked... better to retransmit only the first segment
               s = std::min(s, (*it)->m_packet->GetSize ());
             }
-          break;
+        }
+      else
+        {
+          s = std::min(s, (*it)->m_packet->GetSize ());
         }
     }
 
@@ -397,6 +394,77 @@ TcpTxBuffer::SplitItems (TcpTxItem *t1, TcpTxItem *t2, uint32_t size) const
   NS_LOG_INFO ("Split of size " << size << " result: t1 " << *t1 << " t2 " << *t2);
 }
 
+TcpTxItem*
+TcpTxBuffer::SplitItemInList (PacketList &list, PacketList::iterator it, uint32_t size) const
+{
+  TcpTxItem *firstPart = new TcpTxItem ();
+  SplitItems (firstPart, *it, size);
+
+  // insert firstPart before the split item
+  PacketList::iterator first = list.insert (it, firstPart);
+  if (&list == &m_sentList)
+    {
+      IndexSet (firstPart->m_startSeq, first);
+      IndexSet ((*it)->m_startSeq, it);
+    }
+  return firstPart;
+}
+
+TcpTxBuffer::SentIndex::iterator
+TcpTxBuffer::IndexLowerBound (const SequenceNumber32 &seq) const
+{
+  return std::lower_bound (m_sentIndex.begin (), m_sentIndex.end (), seq,
+                           [] (const SentIndexEntry &entry, const SequenceNumber32 &s)
+                           { return entry.seq < s; });
+}
+
+void
+TcpTxBuffer::IndexSet (const SequenceNumber32 &seq, PacketList::iterator item) const
+{
+  // items are mostly added at the tail of the sent list
+  if (m_sentIndex.empty () || m_sentIndex.back ().seq < seq)
+    {
+      m_sentIndex.push_back ({seq, item});
+      return;
+    }
+  auto index = IndexLowerBound (seq);
+  if (index != m_sentIndex.end () && index->seq == seq)
+    {
+      index->item = item;
+    }
+  else
+    {
+      m_sentIndex.insert (index, {seq, item});
+    }
+}
+
+void
+TcpTxBuffer::IndexErase (const SequenceNumber32 &seq) const
+{
+  // items are mostly removed from the head of the sent list
+  if (!m_sentIndex.empty () && m_sentIndex.front ().seq == seq)
+    {
+      m_sentIndex.pop_front ();
+      return;
+    }
+  auto index = IndexLowerBound (seq);
+  if (index != m_sentIndex.end () && index->seq == seq)
+    {
+      m_sentIndex.erase (index);
+    }
+}
+
+TcpTxBuffer::PacketList::iterator
+TcpTxBuffer::FindSentItem (const SequenceNumber32 &seq) const
+{
+  NS_ASSERT (!m_sentIndex.empty ());
+  auto index = std::upper_bound (m_sentIndex.begin (), m_sentIndex.end (), seq,
+                                 [] (const SequenceNumber32 &s, const SentIndexEntry &entry)
+                                 { return s < entry.seq; });
+  NS_ASSERT_MSG (index != m_sentIndex.begin (), "Sequence " << seq << " before the sent list");
+  return (--index)->item;
+}
+
 TcpTxItem*
 TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listStartFrom,
                                 uint32_t numBytes, const SequenceNumber32 &seq,
@@ -437,6 +505,13 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
   PacketList::iterator it = list.begin ();
   SequenceNumber32 beginOfCurrentPacket = listStartFrom;
 
+  if (&list == &m_sentList && !m_sentIndex.empty () && seq >= listStartFrom)
+    {
+      // Skip the items before the one containing seq
+      it = FindSentItem (seq);
+      beginOfCurrentPacket = (*it)->m_startSeq;
+    }
+
   while (it != list.end ())
     {
       currentItem = *it;
@@ -467,11 +542,7 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
                            " searching for " << seq <<
                            " and now we recurse because packet ends at "
                                         << beginOfCurrentPacket + currentPacket->GetSize ());
-              TcpTxItem *firstPart = new TcpTxItem ();
-              SplitItems (firstPart, currentItem, seq - beginOfCurrentPacket);
-
-              // insert firstPart before currentItem
-              list.insert (it, firstPart);
+              SplitItemInList (list, it, seq - beginOfCurrentPacket);
               if (listEdited)
                 {
                   *listEdited = true;
@@ -533,11 +604,7 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
             {
               // the end is inside the current packet, but it isn't exactly
               // the packet end. Just fragment, fix the list, and return.
-              TcpTxItem *firstPart = new TcpTxItem ();
-              SplitItems (firstPart, currentItem, numBytes);
-
-              // insert firstPart before currentItem
-              list.insert (it, firstPart);
+              TcpTxItem *firstPart = SplitItemInList (list, it, numBytes);
               if (listEdited)
                 {
                   *listEdited = true;
@@ -566,6 +633,10 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
                                    // in the previous if
 
           MergeItems (currentItem, next);
+          if (&list == &m_sentList)
+            {
+              IndexErase (next->m_startSeq);
+            }
           list.erase (it);
 
           delete next;
@@ -708,6 +779,7 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq,
 
           RemoveFromCounts (item, pktSize);
 
+          IndexErase (item->m_startSeq);
           i = m_sentList.erase (i);
           NS_LOG_INFO ("Removed " << *item << " lost: " << m_lostOut <<
                        " retrans: " << m_retrans << " sacked: " << m_sackedOut <<
@@ -727,7 +799,10 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq,
           NS_LOG_INFO (*item);
           // PacketTags are preserved when fragmenting
           item->m_packet = item->m_packet->CreateFragment (offset, pktSize);
+          // the item stays the first one, its entry stays at the head
+          NS_ASSERT (m_sentIndex.front ().seq == item->m_startSeq);
           item->m_startSeq += offset;
+          m_sentIndex.front ().seq = item->m_startSeq;
           m_size -= offset;
           m_sentSize -= offset;
           m_firstByteSeq += offset;
@@ -791,15 +866,22 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list,
 
   for (auto option_it = list.begin (); option_it != list.end (); ++option_it)
     {
-      PacketList::iterator item_it = m_sentList.begin ();
-      SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-
       if (m_firstByteSeq + m_sentSize < (*option_it).first)
         {
           NS_LOG_INFO ("Not updating scoreboard, the option block is outside the sent list");
           return bytesSacked;
         }
 
+      // Only the items starting inside the block can be sacked
+      PacketList::iterator item_it = m_sentList.end ();
+      SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
+      auto index = IndexLowerBound ((*option_it).first);
+      if (index != m_sentIndex.end ())
+        {
+          item_it = index->item;
+          beginOfCurrentPacket = (*item_it)->m_startSeq;
+        }
+
       while (item_it != m_sentList.end ())
         {
           uint32_t pktSize = (*item_it)->m_packet->GetSize ();
@@ -930,35 +1012,32 @@ TcpTxBuffer::IsLost (const SequenceNumber32 &seq) const
 {
   NS_LOG_FUNCTION (this << seq);
 
-  SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-  PacketList::const_iterator it;
-
   if (seq >= m_highestSack.second)
     {
       return false;
     }
 
-  // In theory, using a map and hints when inserting elements can improve
-  // performance
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  // Start from the first item beginning at or after seq
+  auto index = IndexLowerBound (seq);
+  PacketList::const_iterator it = m_sentList.end ();
+  if (index != m_sentIndex.end ())
     {
-      // Search for the right iterator before calling IsLost()
-      if (beginOfCurrentPacket >= seq)
-        {
-          if ((*it)->m_lost == true)
-            {
-              NS_LOG_INFO ("seq=" << seq << " is lost because of lost flag");
-              return true;
-            }
+      it = index->item;
+    }
 
-          if ((*it)->m_sacked == true)
-            {
-              NS_LOG_INFO ("seq=" << seq << " is not lost because of sacked flag");
-              return false;
-            }
+  for (; it != m_sentList.end (); ++it)
+    {
+      if ((*it)->m_lost == true)
+        {
+          NS_LOG_INFO ("seq=" << seq << " is lost because of lost flag");
+          return true;
         }
 
-      beginOfCurrentPacket += (*it)->m_packet->GetSize ();
+      if ((*it)->m_sacked == true)
+        {
+          NS_LOG_INFO ("seq=" << seq << " is not lost because of sacked flag");
+          return false;
+        }
     }
 
   return false;
@@ -1249,6 +1328,7 @@ TcpTxBuffer::ResetSentList ()
       m_sentList.pop_back ();
     }
 
+  m_sentIndex.clear ();
   m_sentSize = 0;
   m_lostOut = 0;
   m_retrans = 0;
@@ -1264,6 +1344,8 @@ TcpTxBuffer::ResetLastSegmentSent ()
     {
       TcpTxItem *item = m_sentList.back ();
 
+      NS_ASSERT (m_sentIndex.back ().seq == item->m_startSeq);
+      m_sentIndex.pop_back ();
       m_sentList.pop_back ();
       m_sentSize -= item->m_packet->GetSize ();
       if (item->m_retrans)
@@ -1438,8 +1520,12 @@ TcpTxBuffer::ConsistencyCheck () const
   uint32_t lost = 0;
   uint32_t retrans = 0;
 
-  for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  NS_ASSERT_MSG (m_sentIndex.size () == m_sentList.size (), "Sent index out of sync");
+  auto index = m_sentIndex.begin ();
+  for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it, ++index)
     {
+      NS_ASSERT_MSG (index->item == it && index->seq == (*it)->m_startSeq,
+                     "Item " << *(*it) << " not in the sent index");
       if ((*it)->m_sacked)
         {
           sacked += (*it)->m_packet->GetSize ();
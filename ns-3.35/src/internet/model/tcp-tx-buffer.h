@@ -22,6 +22,7 @@
 #ifndef TCP_TX_BUFFER_H
 #define TCP_TX_BUFFER_H
 
+#include <deque>
 #include "ns3/object.h"
 #include "ns3/traced-value.h"
 #include "ns3/sequence-number.h"
@@ -70,8 +71,16 @@ class Packet;
  * associated with every segment sent. This is done through the use of the
  * class TcpTxItem: instead of storing a list of packets, we store a list of
  * TcpTxItem. Each item has different flags (check the corresponding
- * documentation) and maintaining the scoreboard is a matter of travelling the
- * list and set the SACK flag on the corresponding segment sent.
+ * documentation) and maintaining the scoreboard is a matter of finding the
+ * corresponding segments sent and setting their SACK flag.
+ *
+ * The items of the SentList are also indexed by their starting sequence
+ * number, in a double-ended array kept sorted, so that SACK blocks,
+ * retransmissions and IsLost queries locate their first item with a binary
+ * search instead of walking the list from the head. Transmissions append to
+ * the tail of the index and cumulative ACKs remove from its head, without
+ * allocating per item. The items themselves stay in the list, so pointers
+ * to them (e.g., the ones handed to the rate sampling) remain valid.
  *
  * Item properties
  * ---------------
@@ -412,6 +421,14 @@ private:
 
   typedef std::list<TcpTxItem*> PacketList; //!< container for data stored in the buffer
 
+  /// Entry of the index of the sent list
+  struct SentIndexEntry
+  {
+    SequenceNumber32 seq;        //!< Starting sequence of the item
+    PacketList::iterator item;   //!< The item in m_sentList
+  };
+  typedef std::deque<SentIndexEntry> SentIndex; //!< sent items sorted by starting sequence
+
   /**
    * \brief Update the lost count
    *
@@ -563,6 +580,46 @@ private:
                                 uint32_t numBytes, const SequenceNumber32 &requestedSeq,
                                 bool *listEdited = nullptr) const;
 
+  /**
+   * \brief Split the head of an item of a list in a new item
+   *
+   * The new item holds the first "size" bytes and is inserted before the
+   * split one. If the list is the sent list, the index is updated.
+   *
+   * \param list the list
+   * \param it the item to split
+   * \param size size of the new item
+   * \return the new item
+   */
+  TcpTxItem* SplitItemInList (PacketList &list, PacketList::iterator it, uint32_t size) const;
+
+  /**
+   * \brief Find the first index entry starting at or after a sequence
+   * \param seq the sequence
+   * \return the entry, or the end of the index
+   */
+  SentIndex::iterator IndexLowerBound (const SequenceNumber32 &seq) const;
+
+  /**
+   * \brief Set the item starting at a sequence in the index
+   * \param seq the starting sequence of the item
+   * \param item the item in m_sentList
+   */
+  void IndexSet (const SequenceNumber32 &seq, PacketList::iterator item) const;
+
+  /**
+   * \brief Remove the item starting at a sequence from the index
+   * \param seq the starting sequence of the item
+   */
+  void IndexErase (const SequenceNumber32 &seq) const;
+
+  /**
+   * \brief Find the sent item that contains a sequence
+   * \param seq the sequence, which must be inside the sent list
+   * \return the iterator of the item in m_sentList
+   */
+  PacketList::iterator FindSentItem (const SequenceNumber32 &seq) const;
+
   /**
    * \brief Merge two TcpTxItem
    *
@@ -602,6 +659,7 @@ private:
 
   PacketList m_appList;  //!< Buffer for application data
   PacketList m_sentList; //!< Buffer for sent (but not acked) data
+  mutable SentIndex m_sentIndex; //!< Items of m_sentList by starting sequence
   uint32_t m_maxBuffer;  //!< Max number of data bytes in buffer (SND.WND)
   uint32_t m_size;       //!< Size of all data in this buffer
   uint32_t m_sentSize;   //!< Size of sent (and not discarded) segments
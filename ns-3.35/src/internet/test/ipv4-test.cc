@@ -24,12 +24,15 @@
 #include "ns3/log.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/node.h"
+#include "ns3/uinteger.h"
 
 #include "ns3/ipv4-l3-protocol.h"
 #include "ns3/arp-l3-protocol.h"
 #include "ns3/ipv4-interface.h"
 #include "ns3/loopback-net-device.h"
 
+#include <set>
+
 using namespace ns3;
 
 /**
@@ -134,6 +137,150 @@ Ipv4L3ProtocolTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 identification counters Test
+ *
+ * Check that the identifications built for each {src, dst, proto} tuple
+ * increase, that distinct tuples are spread over the hashed counters, and
+ * that the number of counters stays bounded with many peers.
+ */
+class Ipv4IdentificationTestCase : public TestCase
+{
+public:
+  Ipv4IdentificationTestCase ();
+  virtual ~Ipv4IdentificationTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Check that the identifications of interleaved tuples increase
+   * \param buckets the number of identification counters
+   */
+  void CheckMonotonic (uint32_t buckets);
+
+  /**
+   * \brief Build the header of a packet that may be fragmented
+   * \param ipv4 the IPv4 protocol
+   * \param source the source address
+   * \param destination the destination address
+   * \param protocol the L4 protocol
+   * \return the identification of the header
+   */
+  uint16_t GetNextIdentification (Ptr<Ipv4L3Protocol> ipv4, Ipv4Address source,
+                                  Ipv4Address destination, uint8_t protocol);
+};
+
+Ipv4IdentificationTestCase::Ipv4IdentificationTestCase () :
+  TestCase ("Verify the hashed IPv4 identification counters")
+{
+}
+
+Ipv4IdentificationTestCase::~Ipv4IdentificationTestCase ()
+{
+}
+
+uint16_t
+Ipv4IdentificationTestCase::GetNextIdentification (Ptr<Ipv4L3Protocol> ipv4, Ipv4Address source,
+                                                   Ipv4Address destination, uint8_t protocol)
+{
+  return ipv4->BuildHeader (source, destination, protocol, 100, 64, 0, true).GetIdentification ();
+}
+
+void
+Ipv4IdentificationTestCase::CheckMonotonic (uint32_t buckets)
+{
+  Ptr<Ipv4L3Protocol> ipv4 = CreateObject<Ipv4L3Protocol> ();
+  ipv4->SetAttribute ("IdentificationBuckets", UintegerValue (buckets));
+
+  const uint32_t nTuples = 12;
+  Ipv4Address source ("10.0.0.1");
+  std::vector<int32_t> last (nTuples, -1);
+  for (uint32_t round = 0; round < 100; round++)
+    {
+      for (uint32_t i = 0; i < nTuples; i++)
+        {
+          Ipv4Address destination (Ipv4Address ("10.1.0.1").Get () + i / 3);
+          uint8_t protocol = (i % 3 == 0) ? 6 : ((i % 3 == 1) ? 17 : 1);
+          int32_t id = GetNextIdentification (ipv4, source, destination, protocol);
+          NS_TEST_ASSERT_MSG_GT (id, last[i], "Identification of tuple " << i << " did not increase with "
+                                 << buckets << " counters");
+          last[i] = id;
+        }
+    }
+  // a dropped packet gives its identification back
+  Ipv4Address destination ("10.1.0.1");
+  Ipv4Header header = ipv4->BuildHeader (source, destination, 6, 100, 64, 0, true);
+  ipv4->DecreaseIdentification (header);
+  NS_TEST_ASSERT_MSG_EQ (GetNextIdentification (ipv4, source, destination, 6), header.GetIdentification (),
+                         "Identification not given back");
+
+  // unless another tuple sharing the counter took an identification since,
+  // which would otherwise be issued twice
+  Ipv4Address other ("10.2.0.1");
+  header = ipv4->BuildHeader (source, destination, 6, 100, 64, 0, true);
+  if (&ipv4->GetIdentificationCounter (source, destination, 6) == &ipv4->GetIdentificationCounter (source, other, 6))
+    {
+      uint16_t otherId = GetNextIdentification (ipv4, source, other, 6);
+      ipv4->DecreaseIdentification (header);
+      NS_TEST_ASSERT_MSG_GT (GetNextIdentification (ipv4, source, other, 6), otherId,
+                             "Identification of a tuple sharing the counter issued twice with "
+                             << buckets << " counters");
+    }
+}
+
+void
+Ipv4IdentificationTestCase::DoRun (void)
+{
+  // with a single counter, all the tuples share it
+  CheckMonotonic (1);
+  CheckMonotonic (2048);
+
+  // distinct tuples, even differing only by the protocol or the direction,
+  // have their own counter in a large enough table
+  Ptr<Ipv4L3Protocol> ipv4 = CreateObject<Ipv4L3Protocol> ();
+  Ipv4Address a ("10.0.0.1");
+  Ipv4Address b ("10.0.0.2");
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      GetNextIdentification (ipv4, a, b, 6);
+    }
+  NS_TEST_ASSERT_MSG_EQ (GetNextIdentification (ipv4, a, b, 6), 10, "Wrong identification");
+  NS_TEST_ASSERT_MSG_EQ (GetNextIdentification (ipv4, a, b, 17), 0, "Protocols share a counter");
+  NS_TEST_ASSERT_MSG_EQ (GetNextIdentification (ipv4, b, a, 6), 0, "Directions share a counter");
+  NS_TEST_ASSERT_MSG_EQ (GetNextIdentification (ipv4, a, Ipv4Address ("10.0.0.3"), 6), 0,
+                         "Destinations share a counter");
+  NS_TEST_ASSERT_MSG_EQ (GetNextIdentification (ipv4, Ipv4Address ("10.0.0.3"), b, 6), 0,
+                         "Sources share a counter");
+
+  // many peers of a host: the tuples spread over the counters as with a
+  // random hash, 1000 tuples in 2048 counters fill 791 of them on average
+  std::set<uint16_t *> counters;
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      counters.insert (&ipv4->GetIdentificationCounter (a, Ipv4Address (b.Get () + i), 6));
+    }
+  NS_TEST_ASSERT_MSG_GT (counters.size (), 740, "Too many tuples share a counter");
+
+  // the table does not grow with the number of peers
+  NS_TEST_ASSERT_MSG_EQ (ipv4->m_identification.size (), 2048, "Wrong number of counters");
+  for (uint32_t i = 0; i < 100000; i++)
+    {
+      GetNextIdentification (ipv4, Ipv4Address (a.Get () + i % 97), Ipv4Address (b.Get () + i), 17);
+    }
+  NS_TEST_ASSERT_MSG_EQ (ipv4->m_identification.size (), 2048, "The table grew with the peers");
+
+  // the number of counters is rounded up to a power of two
+  Ptr<Ipv4L3Protocol> small = CreateObject<Ipv4L3Protocol> ();
+  small->SetAttribute ("IdentificationBuckets", UintegerValue (100));
+  GetNextIdentification (small, a, b, 6);
+  NS_TEST_ASSERT_MSG_EQ (small->m_identification.size (), 128, "Wrong number of counters");
+
+  Simulator::Destroy ();
+}
+
   
 /**
  * \ingroup internet-test
@@ -148,6 +295,7 @@ public:
     TestSuite ("ipv4-protocol", UNIT)
   {
     AddTestCase (new Ipv4L3ProtocolTestCase (), TestCase::QUICK);
+    AddTestCase (new Ipv4IdentificationTestCase (), TestCase::QUICK);
   }
 };
 
@@ -18,6 +18,7 @@
 #include "ns3/tcp-dctcp-my.h"
 #include "ns3/tcp-linux-reno.h"
 #include "ns3/tcp-tx-buffer.h"
+#include "ns3/tcp-option-ts.h"
 #include "ns3/config.h"
 
 using namespace ns3;
@@ -37,9 +38,10 @@ public:
    * \brief Constructor
    *
    * \param testCase Test case number
+   * \param useFixedPoint Whether DCTCP uses the fixed-point arithmetic
    * \param desc Description about the test
    */
-  TcpDctcpMyCodePointsTest (uint8_t testCase, const std::string &desc);
+  TcpDctcpMyCodePointsTest (uint8_t testCase, bool useFixedPoint, const std::string &desc);
 
 protected:
   virtual void Tx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
@@ -54,14 +56,16 @@ private:
   uint32_t m_receiverSent;    //!< Number of packets sent by the receiver
   uint32_t m_senderReceived;  //!< Number of packets received by the sender
   uint8_t m_testCase;         //!< Test type
+  bool m_useFixedPoint;       //!< Whether DCTCP uses the fixed-point arithmetic
 };
 
-TcpDctcpMyCodePointsTest::TcpDctcpMyCodePointsTest (uint8_t testCase, const std::string &desc)
+TcpDctcpMyCodePointsTest::TcpDctcpMyCodePointsTest (uint8_t testCase, bool useFixedPoint, const std::string &desc)
   : TcpGeneralTest (desc),
     m_senderSent (0),
     m_receiverSent (0),
     m_senderReceived (0),
-    m_testCase (testCase)
+    m_testCase (testCase),
+    m_useFixedPoint (useFixedPoint)
 {
 }
 
@@ -162,6 +166,7 @@ TcpDctcpMyCodePointsTest::ConfigureEnvironment ()
 {
   TcpGeneralTest::ConfigureEnvironment ();
   Config::SetDefault ("ns3::TcpDctcpMy::UseEct0", BooleanValue (false));
+  Config::SetDefault ("ns3::TcpDctcpMy::UseFixedPoint", BooleanValue (m_useFixedPoint));
 }
 
 /**
@@ -257,7 +262,7 @@ TcpDctcpMyCongestedRouter::SendDataPacket (SequenceNumber32 seq, uint32_t maxSiz
 
   if (withAck)
     {
-      m_delAckEvent.Cancel ();
+      m_delAckTimer.Cancel ();
       m_delAckCount = 0;
     }
 
@@ -413,14 +418,14 @@ TcpDctcpMyCongestedRouter::SendDataPacket (SequenceNumber32 seq, uint32_t maxSiz
   header.SetWindowSize (AdvertisedWindowSize ());
   AddOptions (header);
 
-  if (m_retxEvent.IsExpired ())
+  if (!m_retxTimer.IsRunning ())
     {
       // Schedules retransmit timeout. m_rto should be already doubled.
 
       NS_LOG_LOGIC (this << " SendDataPacket Schedule ReTxTimeout at time " <<
                     Simulator::Now ().GetSeconds () << " to expire at time " <<
                     (Simulator::Now () + m_rto.Get ()).GetSeconds () );
-      m_retxEvent = Simulator::Schedule (m_rto, &TcpDctcpMyCongestedRouter::ReTxTimeout, this);
+      ResetTimer (m_retxTimer, m_rto, static_cast<TimerHandler> (&TcpDctcpMyCongestedRouter::ReTxTimeout));
     }
 
   m_txTrace (p, header, this);
@@ -515,11 +520,13 @@ public:
    * \param highTxMark high tx mark
    * \param lastAckedSeq last acked seq
    * \param rtt RTT
+   * \param useFixedPoint Whether DCTCP uses the fixed-point arithmetic
    * \param name Name of the test
    */
   TcpDctcpMyToLinuxReno (uint32_t cWnd, uint32_t segmentSize, uint32_t ssThresh,
                      uint32_t segmentsAcked, SequenceNumber32 highTxMark,
-                     SequenceNumber32 lastAckedSeq, Time rtt, const std::string &name);
+                     SequenceNumber32 lastAckedSeq, Time rtt, bool useFixedPoint,
+                     const std::string &name);
 
 private:
   virtual void DoRun (void);
@@ -534,12 +541,14 @@ private:
   Time m_rtt;                             //!< rtt
   SequenceNumber32 m_highTxMark;          //!< high tx mark
   SequenceNumber32 m_lastAckedSeq;        //!< last acked seq
+  bool m_useFixedPoint;                   //!< Whether DCTCP uses the fixed-point arithmetic
   Ptr<TcpSocketState> m_state;            //!< state
 };
 
 TcpDctcpMyToLinuxReno::TcpDctcpMyToLinuxReno (uint32_t cWnd, uint32_t segmentSize, uint32_t ssThresh,
                                       uint32_t segmentsAcked, SequenceNumber32 highTxMark,
-                                      SequenceNumber32 lastAckedSeq, Time rtt, const std::string &name)
+                                      SequenceNumber32 lastAckedSeq, Time rtt, bool useFixedPoint,
+                                      const std::string &name)
   : TestCase (name),
     m_cWnd (cWnd),
     m_segmentSize (segmentSize),
@@ -547,7 +556,8 @@ TcpDctcpMyToLinuxReno::TcpDctcpMyToLinuxReno (uint32_t cWnd, uint32_t segmentSiz
     m_ssThresh (ssThresh),
     m_rtt (rtt),
     m_highTxMark (highTxMark),
-    m_lastAckedSeq (lastAckedSeq)
+    m_lastAckedSeq (lastAckedSeq),
+    m_useFixedPoint (useFixedPoint)
 {
 }
 
@@ -577,6 +587,7 @@ TcpDctcpMyToLinuxReno::ExecuteTest ()
   state->m_lastAckedSeq = m_lastAckedSeq;
 
   Ptr<TcpDctcpMy> cong = CreateObject <TcpDctcpMy> ();
+  cong->SetAttribute ("UseFixedPoint", BooleanValue (m_useFixedPoint));
   cong->IncreaseWindow (m_state, m_segmentsAcked);
 
   Ptr<TcpLinuxReno> LinuxRenoCong = CreateObject <TcpLinuxReno> ();
@@ -586,6 +597,172 @@ TcpDctcpMyToLinuxReno::ExecuteTest ()
                          "cWnd has not updated correctly");
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that the ACK sent for an explicit sequence number, used by
+ * DCTCP on the CE transitions, acknowledges that sequence number with the
+ * requested flags and leaves the receive buffer untouched. The ACKs patch
+ * the same header template, so they carry the same timestamp option object,
+ * updated to the current time.
+ */
+class TcpDctcpMySendAckTest : public TcpGeneralTest
+{
+public:
+  /**
+   * \brief Constructor
+   * \param desc Description about the test
+   */
+  TcpDctcpMySendAckTest (const std::string &desc);
+
+protected:
+  virtual void Tx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
+  virtual void Rx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
+  virtual void FinalChecks ();
+
+private:
+  bool m_expectAck;           //!< True while the explicit ACK is being sent
+  uint32_t m_nAcksSent;       //!< Number of explicit ACKs sent
+  Ptr<const TcpOption> m_ts;  //!< Timestamp option of the first explicit ACK
+};
+
+TcpDctcpMySendAckTest::TcpDctcpMySendAckTest (const std::string &desc)
+  : TcpGeneralTest (desc),
+    m_expectAck (false),
+    m_nAcksSent (0)
+{
+}
+
+void
+TcpDctcpMySendAckTest::Tx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  if (who == RECEIVER && m_expectAck)
+    {
+      NS_TEST_ASSERT_MSG_EQ (h.GetAckNumber (), SequenceNumber32 (1), "Wrong sequence number acknowledged");
+      NS_TEST_ASSERT_MSG_EQ (unsigned (h.GetFlags ()), unsigned (TcpHeader::ACK | TcpHeader::ECE), "Wrong flags");
+      NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 0, "The ACK should carry no data");
+      Ptr<const TcpOption> ts = h.GetOption (TcpOption::TS);
+      NS_TEST_ASSERT_MSG_NE (ts, 0, "The ACK should carry a timestamp");
+      NS_TEST_ASSERT_MSG_EQ (DynamicCast<const TcpOptionTS> (ts)->GetTimestamp (), TcpOptionTS::NowToTsValue (),
+                             "The timestamp of the template was not updated");
+      if (m_ts == nullptr)
+        {
+          m_ts = ts;
+        }
+      NS_TEST_ASSERT_MSG_EQ (ts, m_ts, "The ACK header template was not reused");
+      m_nAcksSent++;
+    }
+}
+
+void
+TcpDctcpMySendAckTest::Rx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  if (who != RECEIVER || p->GetSize () == 0 || h.GetSequenceNumber () == SequenceNumber32 (1))
+    {
+      return;
+    }
+  Ptr<TcpRxBuffer> rxBuffer = GetRxBuffer (RECEIVER);
+  SequenceNumber32 nextRxSeq = rxBuffer->NextRxSequence ();
+  m_expectAck = true;
+  GetTcb (RECEIVER)->m_sendAckCallback (SequenceNumber32 (1), TcpHeader::ECE);
+  m_expectAck = false;
+  NS_TEST_ASSERT_MSG_EQ (rxBuffer->NextRxSequence (), nextRxSeq, "The receive buffer should not change");
+}
+
+void
+TcpDctcpMySendAckTest::FinalChecks ()
+{
+  NS_TEST_ASSERT_MSG_GT (m_nAcksSent, 1, "Not enough explicit ACKs were sent");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the fixed-point alpha and ssthresh against the Linux arithmetic
+ */
+class TcpDctcpMyFixedPointTest : public TestCase
+{
+public:
+  TcpDctcpMyFixedPointTest ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Record the alpha at the end of an observation window
+   * \param bytesMarked bytes marked in the window
+   * \param bytesAcked bytes acked in the window
+   * \param alpha the new alpha
+   */
+  void AlphaUpdated (uint32_t bytesMarked, uint32_t bytesAcked, double alpha);
+
+  std::vector<double> m_alpha;     //!< Traced alpha values
+};
+
+TcpDctcpMyFixedPointTest::TcpDctcpMyFixedPointTest ()
+  : TestCase ("DCTCP fixed-point alpha follows the Linux arithmetic")
+{
+}
+
+void
+TcpDctcpMyFixedPointTest::AlphaUpdated (uint32_t bytesMarked, uint32_t bytesAcked, double alpha)
+{
+  m_alpha.push_back (alpha);
+}
+
+void
+TcpDctcpMyFixedPointTest::DoRun (void)
+{
+  Ptr<TcpSocketState> state = CreateObject <TcpSocketState> ();
+  state->m_segmentSize = 1000;
+  state->m_cWnd = 10000;
+  state->m_nextTxSequence = SequenceNumber32 (10001);
+  state->m_lastAckedSeq = SequenceNumber32 (1);
+
+  Ptr<TcpDctcpMy> cong = CreateObject <TcpDctcpMy> ();
+  cong->SetAttribute ("UseFixedPoint", BooleanValue (true));
+  cong->TraceConnectWithoutContext ("DctcpAlpha", MakeCallback (&TcpDctcpMyFixedPointTest::AlphaUpdated, this));
+
+  // first half of the window marked
+  state->m_lastAckedSeq = SequenceNumber32 (5001);
+  state->m_ecnState = TcpSocketState::ECN_ECE_RCVD;
+  cong->PktsAcked (state, 5, Time (0));
+  NS_TEST_ASSERT_MSG_EQ (m_alpha.size (), 0, "alpha updated before the end of the window");
+
+  state->m_nextTxSequence = SequenceNumber32 (20001);
+  state->m_lastAckedSeq = SequenceNumber32 (10001);
+  state->m_ecnState = TcpSocketState::ECN_IDLE;
+  cong->PktsAcked (state, 5, Time (0));
+  // alpha = 1024 - (1024 >> 4) + (5000 << 6) / 10000 = 992
+  NS_TEST_ASSERT_MSG_EQ (m_alpha.size (), 1, "alpha not updated at the end of the window");
+  NS_TEST_ASSERT_MSG_EQ (m_alpha[0], 992.0 / 1024, "Wrong alpha");
+  // ssthresh = cwnd - ((cwnd * 992) >> 11)
+  NS_TEST_ASSERT_MSG_EQ (cong->GetSsThresh (state, 10000), 5157, "Wrong ssthresh");
+
+  // a window without marks
+  state->m_nextTxSequence = SequenceNumber32 (30001);
+  state->m_lastAckedSeq = SequenceNumber32 (20001);
+  cong->PktsAcked (state, 10, Time (0));
+  // alpha = 992 - (992 >> 4) = 930
+  NS_TEST_ASSERT_MSG_EQ (m_alpha.size (), 2, "alpha not updated at the end of the window");
+  NS_TEST_ASSERT_MSG_EQ (m_alpha[1], 930.0 / 1024, "Wrong alpha");
+
+  // half of the window marked, the bytes of an ACK passed twice to
+  // PktsAcked are counted once
+  state->m_lastAckedSeq = SequenceNumber32 (25001);
+  state->m_ecnState = TcpSocketState::ECN_ECE_RCVD;
+  cong->PktsAcked (state, 5, Time (0));
+  cong->PktsAcked (state, 5, Time (0));
+  state->m_lastAckedSeq = SequenceNumber32 (30001);
+  state->m_ecnState = TcpSocketState::ECN_IDLE;
+  cong->PktsAcked (state, 5, Time (0));
+  // alpha = 930 - (930 >> 4) + (5000 << 6) / 10000 = 904
+  NS_TEST_ASSERT_MSG_EQ (m_alpha.size (), 3, "alpha not updated at the end of the window");
+  NS_TEST_ASSERT_MSG_EQ (m_alpha[2], 904.0 / 1024, "Wrong alpha");
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -597,12 +774,18 @@ class TcpDctcpMyTestSuite : public TestSuite
 public:
   TcpDctcpMyTestSuite () : TestSuite ("tcp-dctcp-my-test", UNIT)
   {
-    AddTestCase (new TcpDctcpMyToLinuxReno (2 * 1446, 1446, 4 * 1446, 2, SequenceNumber32 (4753), SequenceNumber32 (3216), MilliSeconds (100), "DCTCP falls to New Reno for slowstart"), TestCase::QUICK);
-    AddTestCase (new TcpDctcpMyCodePointsTest (1, "ECT Test : Check if ECT is set on Syn, Syn+Ack, Ack and Data packets for DCTCP packets"),
-                 TestCase::QUICK);
-    AddTestCase (new TcpDctcpMyCodePointsTest (2, "ECT Test : Check if ECT is not set on Syn, Syn+Ack and Ack but set on Data packets for non-DCTCP but ECN enabled traffic"),TestCase::QUICK);
-    AddTestCase (new TcpDctcpMyCodePointsTest (3, "ECE Functionality Test: ECE should only be sent by receiver when it receives CE flags"),
-                 TestCase::QUICK);
+    for (bool useFixedPoint : {false, true})
+      {
+        std::string arith = useFixedPoint ? " (fixed-point)" : "";
+        AddTestCase (new TcpDctcpMyToLinuxReno (2 * 1446, 1446, 4 * 1446, 2, SequenceNumber32 (4753), SequenceNumber32 (3216), MilliSeconds (100), useFixedPoint, "DCTCP falls to New Reno for slowstart" + arith), TestCase::QUICK);
+        AddTestCase (new TcpDctcpMyCodePointsTest (1, useFixedPoint, "ECT Test : Check if ECT is set on Syn, Syn+Ack, Ack and Data packets for DCTCP packets" + arith),
+                     TestCase::QUICK);
+        AddTestCase (new TcpDctcpMyCodePointsTest (2, useFixedPoint, "ECT Test : Check if ECT is not set on Syn, Syn+Ack and Ack but set on Data packets for non-DCTCP but ECN enabled traffic" + arith),TestCase::QUICK);
+        AddTestCase (new TcpDctcpMyCodePointsTest (3, useFixedPoint, "ECE Functionality Test: ECE should only be sent by receiver when it receives CE flags" + arith),
+                     TestCase::QUICK);
+      }
+    AddTestCase (new TcpDctcpMySendAckTest ("ACK for an explicit sequence number"), TestCase::QUICK);
+    AddTestCase (new TcpDctcpMyFixedPointTest, TestCase::QUICK);
   }
 };
 
@@ -270,7 +270,7 @@ TcpDctcpCongestedRouter::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize,
 
   if (withAck)
     {
-      m_delAckEvent.Cancel ();
+      m_delAckTimer.Cancel ();
       m_delAckCount = 0;
     }
 
@@ -426,14 +426,14 @@ TcpDctcpCongestedRouter::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize,
   header.SetWindowSize (AdvertisedWindowSize ());
   AddOptions (header);
 
-  if (m_retxEvent.IsExpired ())
+  if (!m_retxTimer.IsRunning ())
     {
       // Schedules retransmit timeout. m_rto should be already doubled.
 
       NS_LOG_LOGIC (this << " SendDataPacket Schedule ReTxTimeout at time " <<
                     Simulator::Now ().GetSeconds () << " to expire at time " <<
                     (Simulator::Now () + m_rto.Get ()).GetSeconds () );
-      m_retxEvent = Simulator::Schedule (m_rto, &TcpDctcpCongestedRouter::ReTxTimeout, this);
+      ResetTimer (m_retxTimer, m_rto, static_cast<TimerHandler> (&TcpDctcpCongestedRouter::ReTxTimeout));
     }
 
   m_txTrace (p, header, this);
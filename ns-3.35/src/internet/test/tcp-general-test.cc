@@ -811,17 +811,17 @@ TcpGeneralTest::GetRWnd (SocketWho who)
     }
 }
 
-EventId
-TcpGeneralTest::GetPersistentEvent (SocketWho who)
+bool
+TcpGeneralTest::IsPersistentTimerRunning (SocketWho who)
 {
   if (who == SENDER)
     {
-      return DynamicCast<TcpSocketMsgBase> (m_senderSocket)->m_persistEvent;
+      return DynamicCast<TcpSocketMsgBase> (m_senderSocket)->m_persistTimer.IsRunning ();
     }
   else if (who == RECEIVER)
     {
 
-      return DynamicCast<TcpSocketMsgBase> (m_receiverSocket)->m_persistEvent;
+      return DynamicCast<TcpSocketMsgBase> (m_receiverSocket)->m_persistTimer.IsRunning ();
     }
   else
     {
@@ -1298,10 +1298,10 @@ TcpSocketSmallAcks::SendEmptyPacket (uint8_t flags)
 
   if (flags & TcpHeader::ACK)
     { // If sending an ACK, cancel the delay ACK as well
-      m_delAckEvent.Cancel ();
+      m_delAckTimer.Cancel ();
       m_delAckCount = 0;
     }
-  if (m_retxEvent.IsExpired () && (hasSyn || hasFin) && !isAck )
+  if (!m_retxTimer.IsRunning () && (hasSyn || hasFin) && !isAck )
     { // Retransmit SYN / SYN+ACK / FIN / FIN+ACK to guard against lost
       NS_LOG_LOGIC ("Schedule retransmission timeout at time "
                     << Simulator::Now ().GetSeconds () << " to expire at time "
@@ -552,12 +552,12 @@ protected:
   uint32_t GetRWnd (SocketWho who);
 
   /**
-   * \brief Get the persistent event of the selected socket
+   * \brief Check whether the persist timer of the selected socket is running
    *
    * \param who socket where check the parameter
-   * \return the persistent event in the selected socket
+   * \return true if the persist timer of the selected socket is running
    */
-  EventId GetPersistentEvent (SocketWho who);
+  bool IsPersistentTimerRunning (SocketWho who);
 
   /**
    * \brief Get the persistent timeout of the selected socket
@@ -0,0 +1,220 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "tcp-general-test.h"
+#include "ns3/node.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-gro.h"
+#include "ns3/tcp-l4-protocol.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpGroTestSuite");
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that the receiver of a bulk transfer gets the whole stream
+ * in order with the generic receive offload enabled, and that segments are
+ * actually merged.
+ */
+class TcpGroTestCase : public TcpGeneralTest
+{
+public:
+  TcpGroTestCase ();
+
+protected:
+  virtual void ConfigureEnvironment ();
+  virtual void ConfigureProperties ();
+  virtual void Rx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who);
+  virtual void FinalChecks ();
+
+private:
+  Ptr<Ipv4Gro> m_gro;              //!< Receive offload of the receiver
+  uint32_t m_rxBytes;              //!< Data bytes received
+  uint32_t m_nMerged;              //!< Merged segments received
+  SequenceNumber32 m_nextRxSeq;    //!< Sequence number of the next expected segment
+};
+
+TcpGroTestCase::TcpGroTestCase ()
+  : TcpGeneralTest ("TCP transfer with generic receive offload"),
+    m_rxBytes (0),
+    m_nMerged (0),
+    m_nextRxSeq (1)
+{
+}
+
+void
+TcpGroTestCase::ConfigureEnvironment ()
+{
+  TcpGeneralTest::ConfigureEnvironment ();
+  SetAppPktCount (200);
+  SetPropagationDelay (MilliSeconds (50));
+}
+
+void
+TcpGroTestCase::ConfigureProperties ()
+{
+  TcpGeneralTest::ConfigureProperties ();
+  SetInitialCwnd (SENDER, 10);
+  SetSegmentSize (SENDER, 500);
+  SetSegmentSize (RECEIVER, 500);
+  m_gro = CreateObject<Ipv4Gro> ();
+  GetReceiverSocket ()->GetNode ()->GetObject<Ipv4L3Protocol> ()->SetGro (1, m_gro);
+}
+
+void
+TcpGroTestCase::Rx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  if (who != RECEIVER || p->GetSize () == 0)
+    {
+      return;
+    }
+  NS_TEST_ASSERT_MSG_EQ (h.GetSequenceNumber (), m_nextRxSeq, "Received a segment out of order");
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize () % 500, 0, "Received a segment of the wrong size");
+  if (p->GetSize () > 500)
+    {
+      m_nMerged++;
+    }
+  m_nextRxSeq += p->GetSize ();
+  m_rxBytes += p->GetSize ();
+}
+
+void
+TcpGroTestCase::FinalChecks ()
+{
+  NS_TEST_ASSERT_MSG_EQ (m_rxBytes, 200 * 500, "Not all the data was received");
+  NS_TEST_ASSERT_MSG_GT (m_nMerged, 0, "No merged segment was received");
+  NS_TEST_ASSERT_MSG_GT (m_gro->GetCoalescingRatio (), 1.0, "No segment was merged");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that segments with a different ECN codepoint are never
+ * merged together, so that TCP sees every CE transition.
+ */
+class Ipv4GroEcnTestCase : public TestCase
+{
+public:
+  Ipv4GroEcnTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Receive a segment in the receive offload
+   * \param seq the sequence number of the segment
+   * \param ecn the ECN codepoint of the segment
+   */
+  void SendSegment (uint32_t seq, Ipv4Header::EcnType ecn);
+
+  /**
+   * \brief Record a packet delivered by the receive offload
+   * \param packet the packet
+   * \param header the IPv4 header
+   */
+  void Deliver (Ptr<Packet> packet, const Ipv4Header &header);
+
+  Ptr<Ipv4Gro> m_gro;                           //!< The receive offload
+  std::vector<uint32_t> m_sizes;                //!< Payload sizes of the delivered packets
+  std::vector<Ipv4Header::EcnType> m_ecn;       //!< ECN codepoints of the delivered packets
+};
+
+Ipv4GroEcnTestCase::Ipv4GroEcnTestCase ()
+  : TestCase ("Generic receive offload keeps the CE transitions")
+{
+}
+
+void
+Ipv4GroEcnTestCase::SendSegment (uint32_t seq, Ipv4Header::EcnType ecn)
+{
+  Ptr<Packet> p = Create<Packet> (100);
+  TcpHeader tcpHeader;
+  tcpHeader.SetSourcePort (1000);
+  tcpHeader.SetDestinationPort (2000);
+  tcpHeader.SetSequenceNumber (SequenceNumber32 (seq));
+  tcpHeader.SetFlags (TcpHeader::ACK);
+  p->AddHeader (tcpHeader);
+
+  Ipv4Header ipHeader;
+  ipHeader.SetSource (Ipv4Address ("10.1.1.1"));
+  ipHeader.SetDestination (Ipv4Address ("10.1.1.2"));
+  ipHeader.SetProtocol (TcpL4Protocol::PROT_NUMBER);
+  ipHeader.SetEcn (ecn);
+  ipHeader.SetPayloadSize (p->GetSize ());
+  m_gro->Receive (p, ipHeader);
+}
+
+void
+Ipv4GroEcnTestCase::Deliver (Ptr<Packet> packet, const Ipv4Header &header)
+{
+  TcpHeader tcpHeader;
+  packet->PeekHeader (tcpHeader);
+  m_sizes.push_back (packet->GetSize () - tcpHeader.GetSerializedSize ());
+  m_ecn.push_back (header.GetEcn ());
+}
+
+void
+Ipv4GroEcnTestCase::DoRun (void)
+{
+  m_gro = CreateObject<Ipv4Gro> ();
+  m_gro->SetDeliverCallback (MakeCallback (&Ipv4GroEcnTestCase::Deliver, this));
+
+  Ipv4Header::EcnType ecn[] = {Ipv4Header::ECN_ECT0, Ipv4Header::ECN_ECT0, Ipv4Header::ECN_CE,
+                               Ipv4Header::ECN_CE, Ipv4Header::ECN_CE, Ipv4Header::ECN_ECT0};
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      Simulator::Schedule (MicroSeconds (i), &Ipv4GroEcnTestCase::SendSegment, this, 1 + i * 100, ecn[i]);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_sizes.size (), 3, "Segments with a different ECN codepoint were merged");
+  NS_TEST_ASSERT_MSG_EQ (m_sizes[0], 200, "Wrong size of the first merged segment");
+  NS_TEST_ASSERT_MSG_EQ (m_ecn[0], Ipv4Header::ECN_ECT0, "Wrong ECN codepoint of the first merged segment");
+  NS_TEST_ASSERT_MSG_EQ (m_sizes[1], 300, "Wrong size of the CE merged segment");
+  NS_TEST_ASSERT_MSG_EQ (m_ecn[1], Ipv4Header::ECN_CE, "Wrong ECN codepoint of the CE merged segment");
+  NS_TEST_ASSERT_MSG_EQ (m_sizes[2], 100, "Wrong size of the last segment");
+  NS_TEST_ASSERT_MSG_EQ (m_ecn[2], Ipv4Header::ECN_ECT0, "Wrong ECN codepoint of the last segment");
+  NS_TEST_ASSERT_MSG_EQ (m_gro->GetNReceivedPackets (), 6, "Wrong number of received packets");
+  NS_TEST_ASSERT_MSG_EQ (m_gro->GetNDeliveredPackets (), 3, "Wrong number of delivered packets");
+  m_gro->Dispose ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Generic receive offload TestSuite
+ */
+class TcpGroTestSuite : public TestSuite
+{
+public:
+  TcpGroTestSuite ()
+    : TestSuite ("tcp-gro", UNIT)
+  {
+    AddTestCase (new TcpGroTestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GroEcnTestCase, TestCase::QUICK);
+  }
+};
+
+static TcpGroTestSuite g_tcpGroTestSuite; //!< Static variable for test initialization
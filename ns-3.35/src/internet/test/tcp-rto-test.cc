@@ -504,6 +504,59 @@ TcpTimeRtoTest::FinalChecks ()
 }
 
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that the lazily rearmed retransmission timer does not fire
+ * while ACKs keep arriving
+ *
+ * Every new ACK restarts the retransmission timer.  On a lossless path the
+ * pending event is only moved forward, so no RTO must expire and the
+ * sender must have avoided rescheduling its timers.
+ */
+class TcpLazyRtoRearmTest : public TcpGeneralTest
+{
+public:
+  /**
+   * \brief Constructor.
+   * \param congControl Congestion control type.
+   * \param msg Test description.
+   */
+  TcpLazyRtoRearmTest (TypeId &congControl, const std::string &msg);
+
+protected:
+  virtual void AfterRTOExpired (const Ptr<const TcpSocketState> tcb, SocketWho who);
+  virtual void FinalChecks ();
+  virtual void ConfigureEnvironment ();
+};
+
+TcpLazyRtoRearmTest::TcpLazyRtoRearmTest (TypeId &congControl, const std::string &desc)
+  : TcpGeneralTest (desc)
+{
+  m_congControlTypeId = congControl;
+}
+
+void
+TcpLazyRtoRearmTest::ConfigureEnvironment ()
+{
+  TcpGeneralTest::ConfigureEnvironment ();
+  SetAppPktCount (100);
+}
+
+void
+TcpLazyRtoRearmTest::AfterRTOExpired (const Ptr<const TcpSocketState> tcb, SocketWho who)
+{
+  NS_TEST_ASSERT_MSG_EQ (true, false, "RTO expired on a lossless path");
+}
+
+void
+TcpLazyRtoRearmTest::FinalChecks ()
+{
+  NS_TEST_ASSERT_MSG_GT (GetSenderSocket ()->GetAvoidedTimerReschedules (), 0,
+                         "The retransmission timer has never been rearmed lazily");
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -530,6 +583,7 @@ public:
         minRto = Seconds (0.005);
         AddTestCase (new TcpSsThreshRtoTest ((*it), seqToDrop, minRto, (*it).GetName () + " RTO ssthresh testing, set to half of BytesInFlight"), TestCase::QUICK);
         AddTestCase (new TcpTimeRtoTest ((*it), (*it).GetName () + " RTO timing testing"), TestCase::QUICK);
+        AddTestCase (new TcpLazyRtoRearmTest ((*it), (*it).GetName () + " RTO lazy rearm testing"), TestCase::QUICK);
       }
   }
 };
@@ -44,6 +44,11 @@ private:
    * \brief Test the SACK list update.
    */
   void TestUpdateSACKList ();
+
+  /**
+   * \brief Test the extraction of in-order and reordered data.
+   */
+  void TestExtract ();
 };
 
 TcpRxBufferTestCase::TcpRxBufferTestCase ()
@@ -55,6 +60,7 @@ void
 TcpRxBufferTestCase::DoRun ()
 {
   TestUpdateSACKList ();
+  TestExtract ();
 }
 
 void
@@ -338,6 +344,53 @@ TcpRxBufferTestCase::TestUpdateSACKList ()
                          "SACK list should contain no element");
 }
 
+void
+TcpRxBufferTestCase::TestExtract ()
+{
+  TcpRxBuffer rxBuf;
+  TcpHeader h;
+  rxBuf.SetNextRxSequence (SequenceNumber32 (1));
+  rxBuf.SetMaxBufferSize (1000);
+
+  // In order, then a partial extraction
+  h.SetSequenceNumber (SequenceNumber32 (1));
+  rxBuf.Add (Create<Packet> (100), h);
+  h.SetSequenceNumber (SequenceNumber32 (101));
+  rxBuf.Add (Create<Packet> (100), h);
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Available (), 200, "Wrong available bytes");
+
+  Ptr<Packet> p = rxBuf.Extract (150);
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 150, "Wrong extracted size");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), 50, "Wrong buffer occupancy");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.MaxRxSequence (), SequenceNumber32 (1151),
+                         "The window does not start at the first byte not extracted");
+
+  // Duplicate, overlapping the in-order data
+  h.SetSequenceNumber (SequenceNumber32 (151));
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Add (Create<Packet> (50), h), false, "Duplicate data buffered");
+
+  // Out of order, overlapping each other, then the hole is filled
+  h.SetSequenceNumber (SequenceNumber32 (301));
+  rxBuf.Add (Create<Packet> (100), h);
+  h.SetSequenceNumber (SequenceNumber32 (351));
+  rxBuf.Add (Create<Packet> (100), h);
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), 200, "Wrong buffer occupancy");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Available (), 50, "Out-of-order data available");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.GetSackListSize (), 1, "Contiguous blocks not merged");
+
+  h.SetSequenceNumber (SequenceNumber32 (201));
+  rxBuf.Add (Create<Packet> (150), h);
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.NextRxSequence (), SequenceNumber32 (451),
+                         "Sequence number differs from expected");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Available (), 300, "Wrong available bytes");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.GetSackListSize (), 0, "SACK list should be empty");
+
+  p = rxBuf.Extract (1000);
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 300, "Wrong extracted size");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), 0, "Buffer not empty");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Extract (1000), nullptr, "Extracted from an empty buffer");
+}
+
 void
 TcpRxBufferTestCase::DoTeardown ()
 {
@@ -0,0 +1,184 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "tcp-general-test.h"
+#include "ns3/log.h"
+#include "ns3/test.h"
+#include "ns3/nstime.h"
+#include "ns3/tcp-dctcp-my.h"
+#include "ns3/tcp-stats-collector.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpStatsCollectorTestSuite");
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the summary statistics and quantiles of TcpStatsSketch
+ */
+class TcpStatsSketchTestCase : public TestCase
+{
+public:
+  TcpStatsSketchTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpStatsSketchTestCase::TcpStatsSketchTestCase ()
+  : TestCase ("Check the quantiles of the statistics sketch")
+{
+}
+
+void
+TcpStatsSketchTestCase::DoRun (void)
+{
+  TcpStatsSketch sketch;
+  NS_TEST_ASSERT_MSG_EQ (sketch.GetQuantile (0.5), 0, "Quantile of an empty sketch");
+
+  for (uint32_t i = 1; i <= 1000; i++)
+    {
+      sketch.Add (i);
+    }
+  NS_TEST_ASSERT_MSG_EQ (sketch.GetCount (), 1000, "Wrong count");
+  NS_TEST_ASSERT_MSG_EQ_TOL (sketch.GetMean (), 500.5, 1e-9, "Wrong mean");
+  NS_TEST_ASSERT_MSG_EQ (sketch.GetMin (), 1, "Wrong minimum");
+  NS_TEST_ASSERT_MSG_EQ (sketch.GetMax (), 1000, "Wrong maximum");
+  NS_TEST_ASSERT_MSG_EQ_TOL (sketch.GetQuantile (0.5), 500, 500 * 0.032, "Wrong median");
+  NS_TEST_ASSERT_MSG_EQ_TOL (sketch.GetQuantile (0.9), 900, 900 * 0.032, "Wrong 90th percentile");
+  NS_TEST_ASSERT_MSG_EQ_TOL (sketch.GetQuantile (0.99), 990, 990 * 0.032, "Wrong 99th percentile");
+  NS_TEST_ASSERT_MSG_EQ (sketch.GetQuantile (1), 1000, "Wrong maximum quantile");
+
+  // small values, as alpha or the RTT
+  sketch.Clear ();
+  NS_TEST_ASSERT_MSG_EQ (sketch.GetCount (), 0, "Sketch not cleared");
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      sketch.Add (i < 50 ? 0 : 1e-4);
+    }
+  NS_TEST_ASSERT_MSG_EQ (sketch.GetQuantile (0.25), 0, "Wrong quantile of the zeros");
+  NS_TEST_ASSERT_MSG_EQ_TOL (sketch.GetQuantile (0.75), 1e-4, 1e-4 * 0.032, "Wrong quantile of small values");
+  NS_TEST_ASSERT_MSG_EQ_TOL (sketch.GetMean (), 5e-5, 1e-12, "Wrong mean");
+
+  // weighted values, as the time each value was held
+  sketch.Clear ();
+  sketch.Add (10, 0.9);
+  sketch.Add (1000, 0.1);
+  sketch.Add (5000, 0);
+  NS_TEST_ASSERT_MSG_EQ (sketch.GetCount (), 2, "Value with a zero weight not ignored");
+  NS_TEST_ASSERT_MSG_EQ_TOL (sketch.GetWeight (), 1, 1e-12, "Wrong weight");
+  NS_TEST_ASSERT_MSG_EQ_TOL (sketch.GetMean (), 109, 1e-9, "Wrong weighted mean");
+  NS_TEST_ASSERT_MSG_EQ (sketch.GetMax (), 1000, "Wrong maximum");
+  NS_TEST_ASSERT_MSG_EQ_TOL (sketch.GetQuantile (0.5), 10, 10 * 0.032, "Wrong weighted median");
+  NS_TEST_ASSERT_MSG_EQ_TOL (sketch.GetQuantile (0.95), 1000, 1000 * 0.032, "Wrong weighted 95th percentile");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that the collector samples the congestion state of a DCTCP
+ * sender, and that it stops, letting the simulation end, once the
+ * connection is closed even if a socket (the listening one) never connects.
+ */
+class TcpStatsCollectorTestCase : public TcpGeneralTest
+{
+public:
+  TcpStatsCollectorTestCase ();
+
+protected:
+  virtual void ConfigureEnvironment ();
+  virtual void ConfigureProperties ();
+  virtual void FinalChecks ();
+
+private:
+  Ptr<TcpStatsCollector> m_collector;  //!< The collector
+};
+
+TcpStatsCollectorTestCase::TcpStatsCollectorTestCase ()
+  : TcpGeneralTest ("Collect the statistics of a DCTCP sender")
+{
+}
+
+void
+TcpStatsCollectorTestCase::ConfigureEnvironment ()
+{
+  TcpGeneralTest::ConfigureEnvironment ();
+  SetCongestionControl (TcpDctcpMy::GetTypeId ());
+  SetAppPktCount (100);
+  SetPropagationDelay (MilliSeconds (5));
+}
+
+void
+TcpStatsCollectorTestCase::ConfigureProperties ()
+{
+  TcpGeneralTest::ConfigureProperties ();
+  m_collector = CreateObject<TcpStatsCollector> ();
+  m_collector->SetAttribute ("SamplingInterval", TimeValue (MilliSeconds (1)));
+  m_collector->SetAttribute ("ReportInterval", TimeValue (Seconds (100)));
+  m_collector->AddSocket (GetSenderSocket ());
+  m_collector->AddSocket (GetReceiverSocket ());
+}
+
+void
+TcpStatsCollectorTestCase::FinalChecks ()
+{
+  // the connection lasts less than a report interval: a single report is
+  // made when the sender closes
+  NS_TEST_ASSERT_MSG_EQ (m_collector->GetNReports (), 1, "Wrong number of reports");
+
+  const TcpStatsSketch &cwnd = m_collector->GetReport (TcpStatsCollector::CWND);
+  NS_TEST_ASSERT_MSG_GT (cwnd.GetCount (), 10, "The congestion window was not sampled");
+  NS_TEST_ASSERT_MSG_EQ_TOL (cwnd.GetWeight (), cwnd.GetCount () * 1e-3, 1e-9, "Samples not weighted by the sampling interval");
+  NS_TEST_ASSERT_MSG_GT (cwnd.GetWeight (), 0.01, "The connection lasts at least an RTT");
+  NS_TEST_ASSERT_MSG_LT (cwnd.GetWeight (), Simulator::Now ().GetSeconds (), "Time accounted after the close");
+  NS_TEST_ASSERT_MSG_GT (cwnd.GetMin (), 0, "Wrong minimum congestion window");
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (cwnd.GetMean (), cwnd.GetMin (), "Mean below the minimum");
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (cwnd.GetMean (), cwnd.GetMax (), "Mean above the maximum");
+
+  const TcpStatsSketch &alpha = m_collector->GetReport (TcpStatsCollector::ALPHA);
+  NS_TEST_ASSERT_MSG_EQ_TOL (alpha.GetWeight (), cwnd.GetWeight (), 1e-9, "alpha not sampled with the window");
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (alpha.GetMax (), 1.0, "alpha above 1");
+  // without congestion, alpha decays from its initial value of 1
+  NS_TEST_ASSERT_MSG_LT (alpha.GetMin (), 1.0, "alpha did not decay");
+  NS_TEST_ASSERT_MSG_EQ (m_collector->GetReport (TcpStatsCollector::ECE_FRACTION).GetMax (), 0,
+                         "ECE without congestion");
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (m_collector->GetReport (TcpStatsCollector::RTT).GetMin (), 0.01,
+                         "RTT below the propagation delay");
+  m_collector->Dispose ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TCP statistics collector TestSuite
+ */
+class TcpStatsCollectorTestSuite : public TestSuite
+{
+public:
+  TcpStatsCollectorTestSuite ()
+    : TestSuite ("tcp-stats-collector", UNIT)
+  {
+    AddTestCase (new TcpStatsSketchTestCase, TestCase::QUICK);
+    AddTestCase (new TcpStatsCollectorTestCase, TestCase::QUICK);
+  }
+};
+
+static TcpStatsCollectorTestSuite g_tcpStatsCollectorTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,239 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include "ns3/tcp-timer-wheel.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpTimerWheelTestSuite");
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the expiration times of the timers and the batching of the
+ * timers of a slot in a single simulator event
+ */
+class TcpTimerWheelExpirationTestCase : public TestCase
+{
+public:
+  TcpTimerWheelExpirationTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Record the expiration of a timer
+   * \param i the timer index
+   */
+  void Expired (uint32_t i);
+
+  std::vector<Time> m_expired; //!< Expiration time of each timer, zero if not expired
+};
+
+TcpTimerWheelExpirationTestCase::TcpTimerWheelExpirationTestCase ()
+  : TestCase ("TcpTimerWheel expiration times")
+{
+}
+
+void
+TcpTimerWheelExpirationTestCase::Expired (uint32_t i)
+{
+  m_expired[i] = Simulator::Now ();
+}
+
+void
+TcpTimerWheelExpirationTestCase::DoRun (void)
+{
+  Ptr<TcpTimerWheel> wheel = CreateObject<TcpTimerWheel> ();
+  wheel->SetGranularity (MilliSeconds (1));
+
+  // Delays, the last one longer than a revolution of the 512-slot wheel
+  std::vector<Time> delays = { MicroSeconds (500), MilliSeconds (1), MicroSeconds (2300),
+                               MilliSeconds (200), MilliSeconds (700) };
+  std::vector<Time> expected = { MilliSeconds (1), MilliSeconds (1), MilliSeconds (3),
+                                 MilliSeconds (200), MilliSeconds (700) };
+  const uint32_t nBatch = 100;
+
+  std::vector<TcpTimerWheel::Timer> timers (delays.size () + nBatch);
+  m_expired.assign (timers.size (), Time (0));
+  for (uint32_t i = 0; i < timers.size (); ++i)
+    {
+      timers[i].SetFunction (MakeCallback (&TcpTimerWheelExpirationTestCase::Expired, this).Bind (i));
+    }
+  for (uint32_t i = 0; i < delays.size (); ++i)
+    {
+      wheel->Schedule (timers[i], delays[i]);
+    }
+  // A batch of timers expiring in the same tick, at 50 ms
+  for (uint32_t i = delays.size (); i < timers.size (); ++i)
+    {
+      wheel->Schedule (timers[i], MicroSeconds (49001 + i));
+    }
+  NS_TEST_ASSERT_MSG_EQ (wheel->GetNTimers (), timers.size (), "Wrong number of armed timers");
+  NS_TEST_ASSERT_MSG_EQ (timers[2].GetExpiration (), MilliSeconds (3), "Wrong expiration time");
+
+  Simulator::Stop (MilliSeconds (45));
+  Simulator::Run ();
+  uint64_t events = Simulator::GetEventCount ();
+  Simulator::Stop (MilliSeconds (10));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (Simulator::GetEventCount () - events, 2,
+                         "The batch should expire in one event (plus the stop event)");
+  Simulator::Run ();
+
+  for (uint32_t i = 0; i < delays.size (); ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_expired[i], expected[i], "Wrong expiration of timer " << i);
+    }
+  for (uint32_t i = delays.size (); i < timers.size (); ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_expired[i], MilliSeconds (50), "Wrong expiration of timer " << i);
+    }
+  NS_TEST_ASSERT_MSG_EQ (wheel->GetNTimers (), 0, "Timers left in the wheel");
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check moving, cancelling and destroying armed timers, also from
+ * the function of a timer expiring in the same batch
+ */
+class TcpTimerWheelCancelTestCase : public TestCase
+{
+public:
+  TcpTimerWheelCancelTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /// Expiration of the first timer: cancel the second one and rearm itself once
+  void ExpiredFirst (void);
+  /// Expiration of the second timer
+  void ExpiredSecond (void);
+  /// Expiration of the moved timer
+  void ExpiredMoved (void);
+  /// Expiration of a timer that must not expire
+  void ExpiredNever (void);
+
+  Ptr<TcpTimerWheel> m_wheel;      //!< The wheel
+  TcpTimerWheel::Timer m_first;    //!< First timer of the batch
+  TcpTimerWheel::Timer m_second;   //!< Second timer of the batch
+  uint32_t m_nFirst;               //!< Number of expirations of the first timer
+  Time m_movedExpired;             //!< Expiration time of the moved timer
+};
+
+TcpTimerWheelCancelTestCase::TcpTimerWheelCancelTestCase ()
+  : TestCase ("TcpTimerWheel cancel and move"),
+    m_nFirst (0)
+{
+}
+
+void
+TcpTimerWheelCancelTestCase::ExpiredFirst (void)
+{
+  if (m_nFirst++ == 0)
+    {
+      m_wheel->Cancel (m_second);
+      m_wheel->Schedule (m_first, Seconds (0));
+    }
+}
+
+void
+TcpTimerWheelCancelTestCase::ExpiredSecond (void)
+{
+  NS_TEST_EXPECT_MSG_EQ (true, false, "Timer cancelled by a timer of the same batch expired");
+}
+
+void
+TcpTimerWheelCancelTestCase::ExpiredMoved (void)
+{
+  m_movedExpired = Simulator::Now ();
+}
+
+void
+TcpTimerWheelCancelTestCase::ExpiredNever (void)
+{
+  NS_TEST_EXPECT_MSG_EQ (true, false, "Cancelled timer expired");
+}
+
+void
+TcpTimerWheelCancelTestCase::DoRun (void)
+{
+  m_wheel = CreateObject<TcpTimerWheel> ();
+  m_wheel->SetGranularity (MilliSeconds (10));
+
+  // Timers of the same tick expire in the order they were armed
+  m_first.SetFunction (MakeCallback (&TcpTimerWheelCancelTestCase::ExpiredFirst, this));
+  m_second.SetFunction (MakeCallback (&TcpTimerWheelCancelTestCase::ExpiredSecond, this));
+  m_wheel->Schedule (m_first, MilliSeconds (20));
+  m_wheel->Schedule (m_second, MilliSeconds (20));
+
+  TcpTimerWheel::Timer moved;
+  moved.SetFunction (MakeCallback (&TcpTimerWheelCancelTestCase::ExpiredMoved, this));
+  m_wheel->Schedule (moved, Seconds (1));
+  m_wheel->Schedule (moved, MilliSeconds (35));
+
+  TcpTimerWheel::Timer cancelled;
+  cancelled.SetFunction (MakeCallback (&TcpTimerWheelCancelTestCase::ExpiredNever, this));
+  m_wheel->Schedule (cancelled, MilliSeconds (5));
+  m_wheel->Cancel (cancelled);
+
+  TcpTimerWheel::Timer *destroyed = new TcpTimerWheel::Timer;
+  destroyed->SetFunction (MakeCallback (&TcpTimerWheelCancelTestCase::ExpiredNever, this));
+  m_wheel->Schedule (*destroyed, MilliSeconds (5));
+  delete destroyed;
+
+  // A copy of an armed timer is not armed
+  TcpTimerWheel::Timer copy (moved);
+  NS_TEST_ASSERT_MSG_EQ (copy.IsPending (), false, "Copy of an armed timer is armed");
+  NS_TEST_ASSERT_MSG_EQ (m_wheel->GetNTimers (), 3, "Wrong number of armed timers");
+
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_nFirst, 2, "The first timer was not rearmed from its function");
+  NS_TEST_EXPECT_MSG_EQ (m_movedExpired, MilliSeconds (40), "Wrong expiration of the moved timer");
+  NS_TEST_EXPECT_MSG_EQ (m_wheel->GetNTimers (), 0, "Timers left in the wheel");
+  Simulator::Destroy ();
+  m_wheel = nullptr;
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TcpTimerWheel TestSuite
+ */
+class TcpTimerWheelTestSuite : public TestSuite
+{
+public:
+  TcpTimerWheelTestSuite ()
+    : TestSuite ("tcp-timer-wheel", UNIT)
+  {
+    AddTestCase (new TcpTimerWheelExpirationTestCase, TestCase::QUICK);
+    AddTestCase (new TcpTimerWheelCancelTestCase, TestCase::QUICK);
+  }
+};
+
+static TcpTimerWheelTestSuite g_tcpTimerWheelTestSuite; //!< Static variable for test initialization
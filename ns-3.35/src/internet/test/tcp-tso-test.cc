@@ -0,0 +1,149 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "tcp-general-test.h"
+#include "ns3/node.h"
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/ipv4-l3-protocol.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpTsoTestSuite");
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that the super-segments sent with segmentation offload are
+ * split into segments of the segment size before reaching the (MTU-limited)
+ * channel, and that the receiver gets the same stream of segments as
+ * without segmentation offload.
+ */
+class TcpTsoTestCase : public TcpGeneralTest
+{
+public:
+  /**
+   * \brief Constructor
+   * \param tsoSegments value of the TsoSegments attribute of the sender
+   */
+  TcpTsoTestCase (uint32_t tsoSegments);
+
+protected:
+  virtual void ConfigureEnvironment ();
+  virtual void ConfigureProperties ();
+  virtual void Rx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who);
+  virtual void FinalChecks ();
+
+  /**
+   * \brief Record a packet sent by the IPv4 layer of the sender
+   * \param p the packet, with the IPv4 header
+   * \param ipv4 the IPv4 protocol
+   * \param interface the interface index
+   */
+  void Ipv4Tx (Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface);
+
+private:
+  uint32_t m_tsoSegments;          //!< TsoSegments attribute of the sender
+  uint32_t m_nSuperSegments;       //!< Packets larger than the MTU sent by IPv4
+  uint32_t m_nRxSegments;          //!< Data segments received
+  SequenceNumber32 m_nextRxSeq;    //!< Sequence number of the next expected segment
+};
+
+TcpTsoTestCase::TcpTsoTestCase (uint32_t tsoSegments)
+  : TcpGeneralTest ("TCP segmentation offload with " + std::to_string (tsoSegments) + " segments"),
+    m_tsoSegments (tsoSegments),
+    m_nSuperSegments (0),
+    m_nRxSegments (0),
+    m_nextRxSeq (1)
+{
+}
+
+void
+TcpTsoTestCase::ConfigureEnvironment ()
+{
+  TcpGeneralTest::ConfigureEnvironment ();
+  SetAppPktCount (200);
+  SetPropagationDelay (MilliSeconds (50));
+}
+
+void
+TcpTsoTestCase::ConfigureProperties ()
+{
+  TcpGeneralTest::ConfigureProperties ();
+  SetInitialCwnd (SENDER, 10);
+  SetSegmentSize (RECEIVER, 500);
+  GetSenderSocket ()->SetAttribute ("TsoSegments", UintegerValue (m_tsoSegments));
+  GetSenderSocket ()->GetNode ()->GetObject<Ipv4L3Protocol> ()->TraceConnectWithoutContext (
+    "Tx", MakeCallback (&TcpTsoTestCase::Ipv4Tx, this));
+}
+
+void
+TcpTsoTestCase::Ipv4Tx (Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  if (p->GetSize () > 1500)
+    {
+      m_nSuperSegments++;
+    }
+}
+
+void
+TcpTsoTestCase::Rx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  if (who != RECEIVER || p->GetSize () == 0)
+    {
+      return;
+    }
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 500, "Received a segment of the wrong size");
+  NS_TEST_ASSERT_MSG_EQ (h.GetSequenceNumber (), m_nextRxSeq, "Received a segment out of order");
+  m_nextRxSeq += p->GetSize ();
+  m_nRxSegments++;
+}
+
+void
+TcpTsoTestCase::FinalChecks ()
+{
+  NS_TEST_ASSERT_MSG_EQ (m_nRxSegments, 200, "Not all the segments were received");
+  if (m_tsoSegments > 1)
+    {
+      NS_TEST_ASSERT_MSG_GT (m_nSuperSegments, 0, "No super-segment was sent");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_nSuperSegments, 0, "Super-segment sent without segmentation offload");
+    }
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TCP segmentation offload TestSuite
+ */
+class TcpTsoTestSuite : public TestSuite
+{
+public:
+  TcpTsoTestSuite ()
+    : TestSuite ("tcp-tso", UNIT)
+  {
+    AddTestCase (new TcpTsoTestCase (1), TestCase::QUICK);
+    AddTestCase (new TcpTsoTestCase (8), TestCase::QUICK);
+    AddTestCase (new TcpTsoTestCase (64), TestCase::QUICK);
+  }
+};
+
+static TcpTsoTestSuite g_tcpTsoTestSuite; //!< Static variable for test initialization
@@ -53,6 +53,8 @@ private:
   /** \brief Test the logic of merging items in GetTransmittedSegment()
    * which is triggered by CopyFromSequence()*/
   void TestMergeItemsWhenGetTransmittedSegment ();
+  /** \brief Test the scoreboard when the sent items are split and discarded */
+  void TestSackOnSplitItems ();
   /**
    * \brief Callback to provide a value of receiver window
    * \returns the receiver window size
@@ -101,6 +103,15 @@ TcpTxBufferTestCase::DoRun ()
   Simulator::Schedule (Seconds (0.0),
                          &TcpTxBufferTestCase::TestMergeItemsWhenGetTransmittedSegment, this);
 
+  /*
+   * Case for the sequence lookup of the sent items:
+   *  -> SACK blocks and lost queries that match items split by a retransmission
+   *  -> retransmissions stopping before a sacked item
+   *  -> discards that fragment the head item
+   */
+  Simulator::Schedule (Seconds (0.0),
+                       &TcpTxBufferTestCase::TestSackOnSplitItems, this);
+
   Simulator::Run ();
   Simulator::Destroy ();
 }
@@ -385,6 +396,65 @@ TcpTxBufferTestCase::TestMergeItemsWhenGetTransmittedSegment ()
   txBuf.CopyFromSequence (2000, SequenceNumber32(1));
 }
 
+void
+TcpTxBufferTestCase::TestSackOnSplitItems ()
+{
+  Ptr<TcpTxBuffer> txBuf = CreateObject<TcpTxBuffer> ();
+  txBuf->SetRWndCallback (MakeCallback (&TcpTxBufferTestCase::GetRWnd, this));
+  txBuf->SetHeadSequence (SequenceNumber32 (1));
+  txBuf->SetSegmentSize (1000);
+  txBuf->SetDupAckThresh (3);
+
+  txBuf->Add (Create<Packet> (10000));
+  for (uint8_t i = 0; i < 10 ; ++i)
+    {
+      txBuf->CopyFromSequence (1000, SequenceNumber32 ((i * 1000) + 1));
+    }
+
+  // Retransmit the second half of the third segment, splitting it
+  TcpTxItem *item = txBuf->CopyFromSequence (500, SequenceNumber32 (2501));
+  NS_TEST_ASSERT_MSG_EQ (item->GetSeqSize (), 500, "Wrong size of the split item");
+  NS_TEST_ASSERT_MSG_EQ (item->IsRetrans (), true, "Split item not retransmitted");
+
+  Ptr<TcpOptionSack> sack = CreateObject<TcpOptionSack> ();
+  sack->AddSackBlock (TcpOptionSack::SackBlock (SequenceNumber32 (3001), SequenceNumber32 (6001)));
+  txBuf->Update (sack->GetSackList ());
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetSacked (), 3000, "Wrong sacked bytes");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetLost (), 3000, "Wrong lost bytes");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->IsLost (SequenceNumber32 (2001)), true, "First half not lost");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->IsLost (SequenceNumber32 (2501)), true, "Second half not lost");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->IsLost (SequenceNumber32 (6001)), false, "Lost above the SACK");
+
+  // SACK the first half only
+  sack = CreateObject<TcpOptionSack> ();
+  sack->AddSackBlock (TcpOptionSack::SackBlock (SequenceNumber32 (2001), SequenceNumber32 (2501)));
+  txBuf->Update (sack->GetSackList ());
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetSacked (), 3500, "Wrong sacked bytes");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetLost (), 2500, "Wrong lost bytes");
+
+  // The retransmission of the second half cannot be merged with the sacked data
+  item = txBuf->CopyFromSequence (1000, SequenceNumber32 (2501));
+  NS_TEST_ASSERT_MSG_EQ (item->GetSeqSize (), 500, "Merged with a sacked item");
+
+  // Fragment the head item
+  txBuf->DiscardUpTo (SequenceNumber32 (1501));
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetLost (), 1000, "Wrong lost bytes after the discard");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->IsLost (SequenceNumber32 (1501)), true, "Head not lost");
+  item = txBuf->CopyFromSequence (1000, SequenceNumber32 (1501));
+  NS_TEST_ASSERT_MSG_EQ (item->GetSeqSize (), 500, "Wrong size of the fragmented head");
+
+  txBuf->DiscardUpTo (SequenceNumber32 (6001));
+  NS_TEST_ASSERT_MSG_EQ (txBuf->Size (), 4000, "Wrong size after the discard");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetSacked (), 0, "Sacked bytes after the discard");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetLost (), 0, "Lost bytes after the discard");
+
+  sack = CreateObject<TcpOptionSack> ();
+  sack->AddSackBlock (TcpOptionSack::SackBlock (SequenceNumber32 (8001), SequenceNumber32 (9001)));
+  txBuf->Update (sack->GetSackList ());
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetSacked (), 1000, "Wrong sacked bytes");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->IsLost (SequenceNumber32 (6001)), false, "Lost with one SACK");
+}
+
 void
 TcpTxBufferTestCase::TestTransmittedBlock ()
 {
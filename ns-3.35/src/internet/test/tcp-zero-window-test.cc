@@ -241,8 +241,7 @@ TcpZeroWindowTest::ProcessedAck (const Ptr<const TcpSocketState> tcb,
     {
       if (h.GetFlags () & TcpHeader::SYN)
         {
-          EventId persistentEvent = GetPersistentEvent (SENDER);
-          NS_TEST_ASSERT_MSG_EQ (persistentEvent.IsRunning (), true,
+          NS_TEST_ASSERT_MSG_EQ (IsPersistentTimerRunning (SENDER), true,
                                  "Persistent event not started");
         }
     }
@@ -397,6 +397,69 @@ AsciiTraceHelper::DefaultReceiveSinkWithContext (Ptr<OutputStreamWrapper> stream
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
+BinaryTraceHelper::BinaryTraceHelper ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+}
+
+BinaryTraceHelper::~BinaryTraceHelper ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+}
+
+Ptr<BinaryTraceFile>
+BinaryTraceHelper::CreateFile (std::string filename, PcapHelper::DataLinkType dataLinkType)
+{
+  NS_LOG_FUNCTION (filename << dataLinkType);
+
+  Ptr<BinaryTraceFile> file = CreateObject<BinaryTraceFile> ();
+  file->Open (filename, dataLinkType);
+  NS_ABORT_MSG_IF (file->Fail (), "Unable to Open " << filename);
+  Simulator::ScheduleDestroy (&BinaryTraceFile::Close, file);
+  return file;
+}
+
+std::string
+BinaryTraceHelper::GetFilenameFromDevice (std::string prefix, Ptr<NetDevice> device, bool useObjectNames)
+{
+  NS_LOG_FUNCTION (prefix << device << useObjectNames);
+
+  //
+  // Same naming rules as the ascii traces, with a different extension.
+  //
+  AsciiTraceHelper asciiTraceHelper;
+  std::string filename = asciiTraceHelper.GetFilenameFromDevice (prefix, device, useObjectNames);
+  return filename.substr (0, filename.size () - 3) + ".btr";
+}
+
+void
+BinaryTraceHelper::DefaultEnqueueSink (Ptr<BinaryTraceFile> file, uint32_t nodeId, uint32_t deviceId, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (file << nodeId << deviceId << p);
+  file->Write (Simulator::Now (), nodeId, deviceId, BinaryTraceRecord::ENQUEUE, p);
+}
+
+void
+BinaryTraceHelper::DefaultDropSink (Ptr<BinaryTraceFile> file, uint32_t nodeId, uint32_t deviceId, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (file << nodeId << deviceId << p);
+  file->Write (Simulator::Now (), nodeId, deviceId, BinaryTraceRecord::DROP, p);
+}
+
+void
+BinaryTraceHelper::DefaultDequeueSink (Ptr<BinaryTraceFile> file, uint32_t nodeId, uint32_t deviceId, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (file << nodeId << deviceId << p);
+  file->Write (Simulator::Now (), nodeId, deviceId, BinaryTraceRecord::DEQUEUE, p);
+}
+
+void
+BinaryTraceHelper::DefaultReceiveSink (Ptr<BinaryTraceFile> file, uint32_t nodeId, uint32_t deviceId, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (file << nodeId << deviceId << p);
+  file->Write (Simulator::Now (), nodeId, deviceId, BinaryTraceRecord::RECEIVE, p);
+}
+
 void 
 PcapHelperForDevice::EnablePcap (std::string prefix, Ptr<NetDevice> nd, bool promiscuous, bool explicitFilename)
 {
@@ -650,5 +713,100 @@ AsciiTraceHelperForDevice::EnableAsciiImpl (
     }
 }
 
-} // namespace ns3
+//
+// Public API
+//
+void
+BinaryTraceHelperForDevice::EnableBinary (std::string prefix, Ptr<NetDevice> nd, bool explicitFilename)
+{
+  EnableBinaryInternal (Ptr<BinaryTraceFile> (), prefix, nd, explicitFilename);
+}
+
+//
+// Public API
+//
+void
+BinaryTraceHelperForDevice::EnableBinary (Ptr<BinaryTraceFile> file, Ptr<NetDevice> nd)
+{
+  EnableBinaryInternal (file, std::string (), nd, false);
+}
+
+//
+// Public API
+//
+void
+BinaryTraceHelperForDevice::EnableBinary (std::string prefix, NetDeviceContainer d)
+{
+  for (NetDeviceContainer::Iterator i = d.Begin (); i != d.End (); ++i)
+    {
+      EnableBinaryInternal (Ptr<BinaryTraceFile> (), prefix, *i, false);
+    }
+}
+
+//
+// Public API
+//
+void
+BinaryTraceHelperForDevice::EnableBinary (Ptr<BinaryTraceFile> file, NetDeviceContainer d)
+{
+  for (NetDeviceContainer::Iterator i = d.Begin (); i != d.End (); ++i)
+    {
+      EnableBinaryInternal (file, std::string (), *i, false);
+    }
+}
+
+//
+// Public API
+//
+void
+BinaryTraceHelperForDevice::EnableBinary (std::string prefix, NodeContainer n)
+{
+  NetDeviceContainer devs;
+  for (NodeContainer::Iterator i = n.Begin (); i != n.End (); ++i)
+    {
+      Ptr<Node> node = *i;
+      for (uint32_t j = 0; j < node->GetNDevices (); ++j)
+        {
+          devs.Add (node->GetDevice (j));
+        }
+    }
+  EnableBinary (prefix, devs);
+}
 
+//
+// Public API
+//
+void
+BinaryTraceHelperForDevice::EnableBinary (Ptr<BinaryTraceFile> file, NodeContainer n)
+{
+  NetDeviceContainer devs;
+  for (NodeContainer::Iterator i = n.Begin (); i != n.End (); ++i)
+    {
+      Ptr<Node> node = *i;
+      for (uint32_t j = 0; j < node->GetNDevices (); ++j)
+        {
+          devs.Add (node->GetDevice (j));
+        }
+    }
+  EnableBinary (file, devs);
+}
+
+//
+// Public API
+//
+void
+BinaryTraceHelperForDevice::EnableBinaryAll (std::string prefix)
+{
+  EnableBinary (prefix, NodeContainer::GetGlobal ());
+}
+
+//
+// Public API
+//
+void
+BinaryTraceHelperForDevice::EnableBinaryAll (Ptr<BinaryTraceFile> file)
+{
+  EnableBinary (file, NodeContainer::GetGlobal ());
+}
+
+} // namespace ns3
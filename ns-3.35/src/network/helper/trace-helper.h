@@ -25,6 +25,7 @@
 #include "ns3/simulator.h"
 #include "ns3/pcap-file-wrapper.h"
 #include "ns3/output-stream-wrapper.h"
+#include "ns3/binary-trace-file.h"
 
 namespace ns3 {
 
@@ -546,6 +547,92 @@ AsciiTraceHelper::HookDefaultReceiveSinkWithContext (
                  << tracename << "\"");
 }
 
+/**
+ * \brief Manage binary trace files for device models
+ *
+ * Binary traces record the same '+', '-', 'd' and 'r' events as the ascii
+ * traces, but as fixed-size BinaryTraceRecord entries instead of printed
+ * packets, which keeps the per-event cost and the file size small.  Use
+ * BinaryTraceReader (or the binary-trace-to-ascii utility) to read them.
+ */
+
+class BinaryTraceHelper
+{
+public:
+  /**
+   * @brief Create a binary trace helper.
+   */
+  BinaryTraceHelper ();
+
+  /**
+   * @brief Destroy a binary trace helper.
+   */
+  ~BinaryTraceHelper ();
+
+  /**
+   * @brief Let the binary trace helper figure out a reasonable filename to
+   * use for a binary trace file associated with a device.
+   * 
+   * @param prefix prefix string
+   * @param device NetDevice
+   * @param useObjectNames use node and device names instead of indexes
+   * @returns file name
+   */
+  std::string GetFilenameFromDevice (std::string prefix, Ptr<NetDevice> device, bool useObjectNames = true);
+
+  /**
+   * @brief Create and initialize a binary trace file.
+   *
+   * The file is closed when the simulator is destroyed, so that its record
+   * count is written even if trace sources keep a reference to it.
+   * 
+   * @param filename file name
+   * @param dataLinkType data link type of packet data
+   * @returns a smart pointer to the binary trace file
+   */
+  Ptr<BinaryTraceFile> CreateFile (std::string filename, PcapHelper::DataLinkType dataLinkType);
+
+  /**
+   * @brief Basic Enqueue default trace sink, recording a '+' event.
+   *
+   * @param file the output file
+   * @param nodeId the node id of the traced device
+   * @param deviceId the interface index of the traced device
+   * @param p the packet
+   */
+  static void DefaultEnqueueSink (Ptr<BinaryTraceFile> file, uint32_t nodeId, uint32_t deviceId, Ptr<const Packet> p);
+
+  /**
+   * @brief Basic Drop default trace sink, recording a 'd' event.
+   *
+   * @param file the output file
+   * @param nodeId the node id of the traced device
+   * @param deviceId the interface index of the traced device
+   * @param p the packet
+   */
+  static void DefaultDropSink (Ptr<BinaryTraceFile> file, uint32_t nodeId, uint32_t deviceId, Ptr<const Packet> p);
+
+  /**
+   * @brief Basic Dequeue default trace sink, recording a '-' event.
+   *
+   * @param file the output file
+   * @param nodeId the node id of the traced device
+   * @param deviceId the interface index of the traced device
+   * @param p the packet
+   */
+  static void DefaultDequeueSink (Ptr<BinaryTraceFile> file, uint32_t nodeId, uint32_t deviceId, Ptr<const Packet> p);
+
+  /**
+   * @brief Basic Receive default trace sink, recording an 'r' event.
+   *
+   * @param file the output file
+   * @param nodeId the node id of the traced device
+   * @param deviceId the interface index of the traced device
+   * @param p the packet
+   */
+  static void DefaultReceiveSink (Ptr<BinaryTraceFile> file, uint32_t nodeId, uint32_t deviceId, Ptr<const Packet> p);
+};
+
 /**
  * \brief Base class providing common user-level pcap operations for helpers
  * representing net devices.
@@ -866,6 +953,111 @@ private:
   void EnableAsciiImpl (Ptr<OutputStreamWrapper> stream, std::string prefix, Ptr<NetDevice> nd, bool explicitFilename);
 };
 
+/**
+ * \brief Base class providing common user-level binary trace operations for
+ * helpers representing net devices.
+ */
+class BinaryTraceHelperForDevice
+{
+public:
+  /**
+   * @brief Construct a BinaryTraceHelperForDevice.
+   */
+  BinaryTraceHelperForDevice () {}
+
+  /**
+   * @brief Destroy a BinaryTraceHelperForDevice.
+   */
+  virtual ~BinaryTraceHelperForDevice () {}
+
+  /**
+   * @brief Enable binary trace output on the indicated net device.
+   *
+   * The implementation is expected to use a provided Ptr<BinaryTraceFile>
+   * if it is non-null, so that many devices can share one file (each record
+   * carries its node and device ids).  Otherwise, it is expected to use the
+   * prefix to create one file per net device.
+   *
+   * @param file A BinaryTraceFile to use when writing trace data, or null.
+   * @param prefix Filename prefix to use for binary trace files.
+   * @param nd Net device for which you want to enable tracing
+   * @param explicitFilename Treat the prefix as an explicit filename if true
+   */
+  virtual void EnableBinaryInternal (Ptr<BinaryTraceFile> file,
+                                     std::string prefix,
+                                     Ptr<NetDevice> nd,
+                                     bool explicitFilename) = 0;
+
+  /**
+   * @brief Enable binary trace output on the indicated net device.
+   *
+   * @param prefix Filename prefix to use for binary trace files.
+   * @param nd Net device for which you want to enable tracing.
+   * @param explicitFilename Treat the prefix as an explicit filename if true
+   */
+  void EnableBinary (std::string prefix, Ptr<NetDevice> nd, bool explicitFilename = false);
+
+  /**
+   * @brief Enable binary trace output on the indicated net device.
+   *
+   * @param file A BinaryTraceFile to use when writing trace data.
+   * @param nd Net device for which you want to enable tracing.
+   */
+  void EnableBinary (Ptr<BinaryTraceFile> file, Ptr<NetDevice> nd);
+
+  /**
+   * @brief Enable binary trace output on each device in the container which
+   * is of the appropriate type.
+   *
+   * @param prefix Filename prefix to use for binary trace files.
+   * @param d container of devices
+   */
+  void EnableBinary (std::string prefix, NetDeviceContainer d);
+
+  /**
+   * @brief Enable binary trace output on each device in the container which
+   * is of the appropriate type.
+   *
+   * @param file A BinaryTraceFile to use when writing trace data.
+   * @param d container of devices
+   */
+  void EnableBinary (Ptr<BinaryTraceFile> file, NetDeviceContainer d);
+
+  /**
+   * @brief Enable binary trace output on each device (which is of the
+   * appropriate type) in the nodes provided in the container.
+   *
+   * @param prefix Filename prefix to use for binary trace files.
+   * @param n container of nodes.
+   */
+  void EnableBinary (std::string prefix, NodeContainer n);
+
+  /**
+   * @brief Enable binary trace output on each device (which is of the
+   * appropriate type) in the nodes provided in the container.
+   *
+   * @param file A BinaryTraceFile to use when writing trace data.
+   * @param n container of nodes.
+   */
+  void EnableBinary (Ptr<BinaryTraceFile> file, NodeContainer n);
+
+  /**
+   * @brief Enable binary trace output on each device (which is of the
+   * appropriate type) in the set of all nodes created in the simulation.
+   *
+   * @param prefix Filename prefix to use for binary trace files.
+   */
+  void EnableBinaryAll (std::string prefix);
+
+  /**
+   * @brief Enable binary trace output on each device (which is of the
+   * appropriate type) in the set of all nodes created in the simulation.
+   *
+   * @param file A BinaryTraceFile to use when writing trace data.
+   */
+  void EnableBinaryAll (Ptr<BinaryTraceFile> file);
+};
+
 } // namespace ns3
 
 #endif /* TRACE_HELPER_H */
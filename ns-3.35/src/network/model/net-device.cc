@@ -19,6 +19,8 @@
  */
 
 #include "ns3/log.h"
+#include "ns3/packet-burst.h"
+#include "ns3/net-device-queue-interface.h"
 #include "net-device.h"
 
 namespace ns3 {
@@ -41,4 +43,26 @@ NetDevice::~NetDevice ()
   NS_LOG_FUNCTION (this);
 }
 
+uint32_t
+NetDevice::SendBatch (Ptr<PacketBurst> burst, const Address& dest, uint16_t protocolNumber)
+{
+  NS_LOG_FUNCTION (this << burst << dest << protocolNumber);
+
+  // Devices with several transmission queues pick the queue of each packet,
+  // so the caller only batches packets for single queue devices
+  Ptr<NetDeviceQueueInterface> ndqi = GetObject<NetDeviceQueueInterface> ();
+  Ptr<NetDeviceQueue> txq = ndqi ? ndqi->GetTxQueue (0) : 0;
+  uint32_t nSent = 0;
+  for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); i++)
+    {
+      if (txq && txq->IsStopped ())
+        {
+          break;
+        }
+      Send (*i, dest, protocolNumber);
+      nSent++;
+    }
+  return nSent;
+}
+
 } // namespace ns3
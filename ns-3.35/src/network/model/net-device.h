@@ -34,6 +34,7 @@ namespace ns3 {
 
 class Node;
 class Channel;
+class PacketBurst;
 
 /**
  * \ingroup network
@@ -260,6 +261,24 @@ public:
    * \return whether the Send operation succeeded 
    */
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber) = 0;
+  /**
+   * \param burst packets sent from above down to Network Device
+   * \param dest mac address of the destination of every packet (already resolved)
+   * \param protocolNumber identifies the type of payload contained in
+   *        every packet of the burst.
+   *
+   *  Called from higher layer to send several packets into Network Device
+   *  to the specified destination Address, in order.  The packets are
+   *  handed to the device as if Send was called on each of them, but the
+   *  device stops accepting packets as soon as its transmission queue is
+   *  stopped, so that the caller can keep the remaining packets.
+   *
+   *  The default implementation calls Send on each packet; devices can
+   *  override it to amortize the per-packet work over the burst.
+   *
+   * \return the number of packets consumed from the front of the burst
+   */
+  virtual uint32_t SendBatch (Ptr<PacketBurst> burst, const Address& dest, uint16_t protocolNumber);
   /**
    * \returns the node base class which contains this network
    *          interface.
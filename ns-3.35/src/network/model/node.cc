@@ -137,6 +137,7 @@ Node::AddDevice (Ptr<NetDevice> device)
   device->SetReceiveCallback (MakeCallback (&Node::NonPromiscReceiveFromDevice, this));
   Simulator::ScheduleWithContext (GetId (), Seconds (0.0), 
                                   &NetDevice::Initialize, device);
+  UpdateDispatchTables ();
   NotifyDeviceAdded (device);
   return index;
 }
@@ -187,6 +188,8 @@ Node::DoDispose ()
   NS_LOG_FUNCTION (this);
   m_deviceAdditionListeners.clear ();
   m_handlers.clear ();
+  m_dispatch.clear ();
+  m_promiscHandlers.clear ();
   for (std::vector<Ptr<NetDevice> >::iterator i = m_devices.begin ();
        i != m_devices.end (); i++)
     {
@@ -257,6 +260,7 @@ Node::RegisterProtocolHandler (ProtocolHandler handler,
     }
 
   m_handlers.push_back (entry);
+  UpdateDispatchTables ();
 }
 
 void
@@ -272,6 +276,35 @@ Node::UnregisterProtocolHandler (ProtocolHandler handler)
           break;
         }
     }
+  UpdateDispatchTables ();
+}
+
+void
+Node::UpdateDispatchTables (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_dispatch.assign (m_devices.size (), ProtocolDispatchTable ());
+  m_promiscHandlers.clear ();
+
+  // Handlers are visited in registration order and appended, so that each
+  // table calls its handlers in the same order as a scan of m_handlers would
+  for (ProtocolHandlerList::const_iterator i = m_handlers.begin ();
+       i != m_handlers.end (); i++)
+    {
+      if (i->promiscuous)
+        {
+          m_promiscHandlers.push_back (*i);
+          continue;
+        }
+      for (uint32_t index = 0; index < m_devices.size (); index++)
+        {
+          if (i->device != 0 && i->device != m_devices[index])
+            {
+              continue;
+            }
+          m_dispatch[index].Add (i->protocol, i->handler);
+        }
+    }
 }
 
 bool
@@ -312,22 +345,30 @@ Node::ReceiveFromDevice (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16
                         << ") Packet UID " << packet->GetUid ());
   bool found = false;
 
-  for (ProtocolHandlerList::iterator i = m_handlers.begin ();
-       i != m_handlers.end (); i++)
+  if (promiscuous)
     {
-      if (i->device == 0 ||
-          (i->device != 0 && i->device == device))
+      for (ProtocolHandlerList::iterator i = m_promiscHandlers.begin ();
+           i != m_promiscHandlers.end (); i++)
         {
-          if (i->protocol == 0 || 
-              i->protocol == protocol)
+          if ((i->device == 0 || i->device == device)
+              && (i->protocol == 0 || i->protocol == protocol))
             {
-              if (promiscuous == i->promiscuous)
-                {
-                  i->handler (device, packet, protocol, from, to, packetType);
-                  found = true;
-                }
+              i->handler (device, packet, protocol, from, to, packetType);
+              found = true;
             }
         }
+      return found;
+    }
+
+  uint32_t index = device->GetIfIndex ();
+  NS_ASSERT_MSG (index < m_dispatch.size () && m_devices[index] == device,
+                 "Received packet from a device not attached to node " << GetId ());
+  const std::vector<ProtocolHandler> &handlers = m_dispatch[index].Lookup (protocol);
+  for (std::vector<ProtocolHandler>::const_iterator i = handlers.begin ();
+       i != handlers.end (); i++)
+    {
+      (*i) (device, packet, protocol, from, to, packetType);
+      found = true;
     }
   return found;
 }
@@ -27,6 +27,7 @@
 #include "ns3/callback.h"
 #include "ns3/ptr.h"
 #include "ns3/net-device.h"
+#include "ns3/protocol-dispatch-table.h"
 
 namespace ns3 {
 
@@ -279,6 +280,14 @@ private:
 
   /// Typedef for protocol handlers container
   typedef std::vector<struct Node::ProtocolHandlerEntry> ProtocolHandlerList;
+
+  /**
+   * \brief Rebuild the per-device dispatch tables from m_handlers.
+   *
+   * Called whenever a handler or a device is added or removed, so that
+   * ReceiveFromDevice does not need to match every registered handler.
+   */
+  void UpdateDispatchTables (void);
   /// Typedef for NetDevice addition listeners container
   typedef std::vector<DeviceAdditionListener> DeviceAdditionListenerList;
 
@@ -287,6 +296,8 @@ private:
   std::vector<Ptr<NetDevice> > m_devices; //!< Devices associated to this node
   std::vector<Ptr<Application> > m_applications; //!< Applications associated to this node
   ProtocolHandlerList m_handlers; //!< Protocol handlers in the node
+  std::vector<ProtocolDispatchTable> m_dispatch; //!< Non-promiscuous dispatch tables, indexed by interface index
+  ProtocolHandlerList m_promiscHandlers; //!< Promiscuous protocol handlers in the node
   DeviceAdditionListenerList m_deviceAdditionListeners; //!< Device addition listeners in the node
 };
 
@@ -28,6 +28,17 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Packet");
 
+PacketFlowAnnotation::PacketFlowAnnotation ()
+  : flowId (0),
+    packetId (0),
+    size (0),
+    key (0),
+    src (0),
+    dst (0),
+    firstTxTime ()
+{
+}
+
 uint32_t Packet::m_globalUid = 0;
 
 TypeId 
@@ -146,7 +157,8 @@ Packet::Packet (const Packet &o)
   : m_buffer (o.m_buffer),
     m_byteTagList (o.m_byteTagList),
     m_packetTagList (o.m_packetTagList),
-    m_metadata (o.m_metadata)
+    m_metadata (o.m_metadata),
+    m_flowAnnotation (o.m_flowAnnotation)
 {
   o.m_nixVector ? m_nixVector = o.m_nixVector->Copy ()
     : m_nixVector = 0;
@@ -165,6 +177,7 @@ Packet::operator = (const Packet &o)
   m_metadata = o.m_metadata;
   o.m_nixVector ? m_nixVector = o.m_nixVector->Copy () 
     : m_nixVector = 0;
+  m_flowAnnotation = o.m_flowAnnotation;
   return *this;
 }
 
@@ -237,6 +250,7 @@ Packet::CreateFragment (uint32_t start, uint32_t length) const
   // through Create because it is private.
   Ptr<Packet> ret = Ptr<Packet> (new Packet (buffer, byteTagList, m_packetTagList, metadata), false);
   ret->SetNixVector (GetNixVector ());
+  ret->m_flowAnnotation = m_flowAnnotation;
   return ret;
 }
 
@@ -252,6 +266,19 @@ Packet::GetNixVector (void) const
   return m_nixVector;
 } 
 
+void
+Packet::SetFlowAnnotation (const PacketFlowAnnotation &annotation) const
+{
+  NS_LOG_FUNCTION (this << annotation.flowId << annotation.packetId);
+  const_cast<Packet *> (this)->m_flowAnnotation = annotation;
+}
+
+const PacketFlowAnnotation &
+Packet::GetFlowAnnotation (void) const
+{
+  return m_flowAnnotation;
+}
+
 void
 Packet::AddHeader (const Header &header)
 {
@@ -372,6 +399,8 @@ Packet::RemoveAllByteTags (void)
 {
   NS_LOG_FUNCTION (this);
   m_byteTagList.RemoveAll ();
+  // the flow annotation stands for a byte tag, e.g., for the flow probes
+  m_flowAnnotation = PacketFlowAnnotation ();
 }
 
 uint32_t 
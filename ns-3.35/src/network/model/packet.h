@@ -34,6 +34,7 @@
 #include "ns3/assert.h"
 #include "ns3/ptr.h"
 #include "ns3/deprecated.h"
+#include "ns3/nstime.h"
 
 namespace ns3 {
 
@@ -179,6 +180,31 @@ private:
   const struct PacketTagList::TagData *m_current;  //!< actual position over the set of tags in a packet
 };
 
+/**
+ * \ingroup packet
+ * \brief Fixed-width flow annotation carried by a packet
+ *
+ * The annotation is stored by value in the Packet object, next to the
+ * tag lists: it is copied along with the packet (Packet::Copy,
+ * Packet::CreateFragment) and read or written in constant time. It is meant
+ * for per-hop flow tracking, such as the one done by the FlowMonitor
+ * probes, which would otherwise have to search a byte tag at every hop.
+ *
+ * A packet whose flow id is zero carries no annotation.
+ */
+struct PacketFlowAnnotation
+{
+  PacketFlowAnnotation ();
+
+  uint32_t flowId;    //!< Flow identifier, zero if the packet is not annotated
+  uint32_t packetId;  //!< Packet identifier within the flow
+  uint32_t size;      //!< Size of the packet when it was annotated, in bytes
+  uint32_t key;       //!< Value defined by the annotating module, e.g., to tell its annotations apart
+  uint32_t src;       //!< Source endpoint the packet was annotated for, e.g., an IPv4 address
+  uint32_t dst;       //!< Destination endpoint the packet was annotated for, e.g., an IPv4 address
+  Time firstTxTime;   //!< Time at which the packet was first transmitted
+};
+
 /**
  * \ingroup packet
  * \brief network packets
@@ -611,6 +637,8 @@ public:
 
   /**
    * \brief Remove all byte tags stored in this packet.
+   *
+   * The flow annotation of the packet is cleared as well.
    */
   void RemoveAllByteTags (void);
 
@@ -706,6 +734,28 @@ public:
    */
   Ptr<NixVector> GetNixVector (void) const; 
 
+  /**
+   * \brief Set the flow annotation of the packet.
+   *
+   * As for tags, this is a const operation so that a trace sink can
+   * annotate the packets it is given. Unlike byte tags, the annotation
+   * follows the packet rather than its bytes: fragments and copies get the
+   * annotation of the packet they come from, and AddAtEnd keeps the
+   * annotation of the packet it is called on. As byte tags, the annotation
+   * is removed by RemoveAllByteTags, e.g., when an application sends back
+   * the packet it received.
+   *
+   * \param annotation the flow annotation
+   */
+  void SetFlowAnnotation (const PacketFlowAnnotation &annotation) const;
+  /**
+   * \brief Get the flow annotation of the packet.
+   *
+   * \returns the flow annotation, whose flow id is zero if the packet was
+   *          never annotated
+   */
+  const PacketFlowAnnotation & GetFlowAnnotation (void) const;
+
   /**
    * TracedCallback signature for Ptr<Packet>
    *
@@ -787,6 +837,8 @@ private:
   /* Please see comments above about nix-vector */
   Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
 
+  PacketFlowAnnotation m_flowAnnotation; //!< the packet's flow annotation
+
   static uint32_t m_globalUid; //!< Global counter of packets Uid
 };
 
@@ -0,0 +1,71 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "protocol-dispatch-table.h"
+
+namespace ns3 {
+
+void
+ProtocolDispatchTable::Clear (void)
+{
+  m_protocols.clear ();
+  m_others.clear ();
+}
+
+void
+ProtocolDispatchTable::Add (uint16_t protocol, ProtocolHandler handler)
+{
+  if (protocol == 0)
+    {
+      for (std::vector<ProtocolEntry>::iterator j = m_protocols.begin ();
+           j != m_protocols.end (); j++)
+        {
+          j->handlers.push_back (handler);
+        }
+      m_others.push_back (handler);
+      return;
+    }
+  std::vector<ProtocolEntry>::iterator j = m_protocols.begin ();
+  while (j != m_protocols.end () && j->protocol != protocol)
+    {
+      j++;
+    }
+  if (j == m_protocols.end ())
+    {
+      // The handlers for any protocol registered so far come first
+      ProtocolEntry entry;
+      entry.protocol = protocol;
+      entry.handlers = m_others;
+      j = m_protocols.insert (j, entry);
+    }
+  j->handlers.push_back (handler);
+}
+
+const std::vector<ProtocolDispatchTable::ProtocolHandler> &
+ProtocolDispatchTable::Lookup (uint16_t protocol) const
+{
+  for (std::vector<ProtocolEntry>::const_iterator i = m_protocols.begin ();
+       i != m_protocols.end (); i++)
+    {
+      if (i->protocol == protocol)
+        {
+          return i->handlers;
+        }
+    }
+  return m_others;
+}
+
+} // namespace ns3
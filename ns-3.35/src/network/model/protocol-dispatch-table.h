@@ -0,0 +1,87 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef PROTOCOL_DISPATCH_TABLE_H
+#define PROTOCOL_DISPATCH_TABLE_H
+
+#include <vector>
+
+#include "ns3/callback.h"
+#include "ns3/ptr.h"
+#include "ns3/net-device.h"
+
+namespace ns3 {
+
+class Packet;
+class Address;
+
+/**
+ * \ingroup network
+ *
+ * \brief The receive handlers of one device, grouped by protocol.
+ *
+ * The handlers registered for a protocol are kept in their own entry, and
+ * the handlers registered for any protocol (protocol number 0) are merged
+ * into every entry and also kept alone for the protocols with no entry.
+ * Each entry calls its handlers in registration order, so that a lookup
+ * returns the same handlers, in the same order, as a scan of all the
+ * registered handlers would.
+ *
+ * Used by Node and TrafficControlLayer to demultiplex received packets.
+ */
+class ProtocolDispatchTable
+{
+public:
+  /**
+   * Handler of the received packets, with the same signature as
+   * Node::ProtocolHandler.
+   */
+  typedef Callback<void, Ptr<NetDevice>, Ptr<const Packet>, uint16_t, const Address &,
+                   const Address &, NetDevice::PacketType> ProtocolHandler;
+
+  /**
+   * \brief Remove all the handlers.
+   */
+  void Clear (void);
+  /**
+   * \brief Append a handler.
+   * \param protocol the protocol number of the handler, or 0 for any protocol
+   * \param handler the handler
+   */
+  void Add (uint16_t protocol, ProtocolHandler handler);
+  /**
+   * \brief Get the handlers of a protocol.
+   * \param protocol the protocol number of the received packet
+   * \return the handlers to call, in registration order
+   */
+  const std::vector<ProtocolHandler> & Lookup (uint16_t protocol) const;
+
+private:
+  /**
+   * \brief Handlers of one protocol, in registration order.
+   */
+  struct ProtocolEntry
+  {
+    uint16_t protocol;                      //!< the protocol number
+    std::vector<ProtocolHandler> handlers;  //!< the handlers to call
+  };
+
+  std::vector<ProtocolEntry> m_protocols;   //!< per-protocol handlers
+  std::vector<ProtocolHandler> m_others;    //!< handlers of the other protocols
+};
+
+} // namespace ns3
+
+#endif /* PROTOCOL_DISPATCH_TABLE_H */
@@ -0,0 +1,240 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+
+#include "ns3/log.h"
+#include "ns3/test.h"
+#include "ns3/uinteger.h"
+#include "ns3/packet.h"
+#include "ns3/binary-trace-file.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("binary-trace-file-test-suite");
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Build a PPP frame carrying an IPv4/TCP segment with the given
+ * sequence number and a 100 bytes payload.
+ *
+ * \param seq the TCP sequence number
+ * \return the frame
+ */
+static Ptr<Packet>
+CreatePppTcpFrame (uint32_t seq)
+{
+  uint8_t frame[2 + 20 + 20 + 100] = {
+    0x00, 0x21,                                     // PPP, IPv4
+    0x45, 0x03, 0x00, 0x8c, 0x00, 0x07, 0x40, 0x00, // ver/ihl, tos (CE), len 140, id 7, DF
+    0x40, 0x06, 0x00, 0x00, 0x0a, 0x01, 0x01, 0x01, // ttl 64, TCP, cksum, 10.1.1.1
+    0x0a, 0x01, 0x02, 0x02,                         // 10.1.2.2
+    0xc0, 0x01, 0x13, 0x88, 0x00, 0x00, 0x00, 0x00, // 49153 > 5000, seq
+    0x00, 0x00, 0x00, 0x02, 0x50, 0x50, 0x80, 0x00, // ack 2, off 5, ACK|ECE, win 32768
+    0x00, 0x00, 0x00, 0x00,
+  };
+  frame[26] = seq >> 24;
+  frame[27] = seq >> 16;
+  frame[28] = seq >> 8;
+  frame[29] = seq;
+  return Create<Packet> (frame, sizeof (frame));
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Check that records written across several chunks are read back
+ * with the header fields decoded.
+ */
+class BinaryTraceWriteReadTestCase : public TestCase
+{
+public:
+  BinaryTraceWriteReadTestCase ();
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  std::string m_testFilename; //!< File name
+};
+
+BinaryTraceWriteReadTestCase::BinaryTraceWriteReadTestCase ()
+  : TestCase ("Check that BinaryTraceReader reads back what BinaryTraceFile wrote")
+{
+}
+
+void
+BinaryTraceWriteReadTestCase::DoSetup (void)
+{
+  std::stringstream filename;
+  filename << rand ();
+  m_testFilename = CreateTempDirFilename (filename.str () + ".btr");
+}
+
+void
+BinaryTraceWriteReadTestCase::DoTeardown (void)
+{
+  if (remove (m_testFilename.c_str ()))
+    {
+      NS_LOG_ERROR ("Failed to delete file " << m_testFilename);
+    }
+}
+
+void
+BinaryTraceWriteReadTestCase::DoRun (void)
+{
+  const uint32_t nRecords = 1000;
+
+  // A small chunk size, so that the file is grown and remapped many times
+  Ptr<BinaryTraceFile> file = CreateObject<BinaryTraceFile> ();
+  file->SetAttribute ("ChunkSize", UintegerValue (4096));
+  file->Open (m_testFilename, 9);
+  NS_TEST_ASSERT_MSG_EQ (file->Fail (), false, "Open (" << m_testFilename << ") returns error");
+
+  for (uint32_t i = 0; i < nRecords; ++i)
+    {
+      file->Write (MicroSeconds (i), 3, 1,
+                   (i % 2) ? BinaryTraceRecord::DEQUEUE : BinaryTraceRecord::ENQUEUE,
+                   CreatePppTcpFrame (1000 * i));
+    }
+  NS_TEST_ASSERT_MSG_EQ (file->GetNRecords (), nRecords, "Wrong number of records written");
+  file->Close ();
+  NS_TEST_ASSERT_MSG_EQ (file->Fail (), false, "Close () returns error");
+
+  BinaryTraceReader reader;
+  NS_TEST_ASSERT_MSG_EQ (reader.Open (m_testFilename), true, "Unable to read back " << m_testFilename);
+  NS_TEST_ASSERT_MSG_EQ (reader.GetNRecords (), nRecords, "Wrong number of records read");
+  NS_TEST_ASSERT_MSG_EQ (reader.GetDataLinkType (), 9, "Wrong data link type");
+
+  for (uint32_t i = 0; i < nRecords; ++i)
+    {
+      const BinaryTraceRecord &r = reader.GetRecord (i);
+      NS_TEST_EXPECT_MSG_EQ (r.time, 1000 * (int64_t) i, "Wrong time in record " << i);
+      NS_TEST_EXPECT_MSG_EQ (r.sequence, 1000 * i, "Wrong sequence number in record " << i);
+    }
+
+  const BinaryTraceRecord &r = reader.GetRecord (0);
+  NS_TEST_EXPECT_MSG_EQ (r.event, BinaryTraceRecord::ENQUEUE, "Wrong event");
+  NS_TEST_EXPECT_MSG_EQ (r.nodeId, 3, "Wrong node id");
+  NS_TEST_EXPECT_MSG_EQ (r.deviceId, 1, "Wrong device id");
+  NS_TEST_EXPECT_MSG_EQ (r.size, 142, "Wrong packet size");
+  NS_TEST_EXPECT_MSG_EQ (r.fields, (BinaryTraceRecord::HAS_IPV4 | BinaryTraceRecord::HAS_TCP), "Wrong decoded fields");
+  NS_TEST_EXPECT_MSG_EQ ((r.tos & 0x3), 3, "Wrong ECN codepoint");
+  NS_TEST_EXPECT_MSG_EQ (r.source, 0x0a010101, "Wrong source address");
+  NS_TEST_EXPECT_MSG_EQ (r.destination, 0x0a010202, "Wrong destination address");
+  NS_TEST_EXPECT_MSG_EQ (r.sourcePort, 49153, "Wrong source port");
+  NS_TEST_EXPECT_MSG_EQ (r.destinationPort, 5000, "Wrong destination port");
+  NS_TEST_EXPECT_MSG_EQ (r.ack, 2, "Wrong ack number");
+  NS_TEST_EXPECT_MSG_EQ (r.tcpFlags, 0x50, "Wrong TCP flags");
+  NS_TEST_EXPECT_MSG_EQ (r.payloadSize, 100, "Wrong payload size");
+
+  std::ostringstream oss;
+  reader.GetRecord (1).Print (oss, reader.GetDataLinkType ());
+  NS_TEST_EXPECT_MSG_EQ (oss.str (),
+                         "- 1e-06 /NodeList/3/DeviceList/1 "
+                         "ns3::PppHeader (Point-to-Point Protocol: IP (0x0021)) "
+                         "ns3::Ipv4Header (tos 0x3 DSCP Default ECN CE ttl 64 id 7 protocol 6 "
+                         "offset (bytes) 0 flags [DF] length: 140 10.1.1.1 > 10.1.2.2) "
+                         "ns3::TcpHeader (49153 > 5000 [ACK|ECE] Seq=1000 Ack=2 Win=32768) "
+                         "Payload (size=100)",
+                         "Wrong ascii conversion");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Check that a file that was never closed can still be read.
+ */
+class BinaryTraceUnclosedTestCase : public TestCase
+{
+public:
+  BinaryTraceUnclosedTestCase ();
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  std::string m_testFilename; //!< File name
+};
+
+BinaryTraceUnclosedTestCase::BinaryTraceUnclosedTestCase ()
+  : TestCase ("Check that BinaryTraceReader reads a file that was not closed")
+{
+}
+
+void
+BinaryTraceUnclosedTestCase::DoSetup (void)
+{
+  std::stringstream filename;
+  filename << rand ();
+  m_testFilename = CreateTempDirFilename (filename.str () + ".btr");
+}
+
+void
+BinaryTraceUnclosedTestCase::DoTeardown (void)
+{
+  if (remove (m_testFilename.c_str ()))
+    {
+      NS_LOG_ERROR ("Failed to delete file " << m_testFilename);
+    }
+}
+
+void
+BinaryTraceUnclosedTestCase::DoRun (void)
+{
+  Ptr<BinaryTraceFile> file = CreateObject<BinaryTraceFile> ();
+  file->Open (m_testFilename, 9);
+  for (uint32_t i = 0; i < 10; ++i)
+    {
+      file->Write (MicroSeconds (i), 0, 1, BinaryTraceRecord::RECEIVE, CreatePppTcpFrame (i));
+    }
+
+  // The mapping is shared, so the records are visible before Close ()
+  BinaryTraceReader reader;
+  NS_TEST_ASSERT_MSG_EQ (reader.Open (m_testFilename), true, "Unable to read " << m_testFilename);
+  NS_TEST_EXPECT_MSG_EQ (reader.GetNRecords (), 10, "Wrong number of records in an unclosed file");
+  reader.Close ();
+  file->Close ();
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Binary trace file TestSuite
+ */
+class BinaryTraceFileTestSuite : public TestSuite
+{
+public:
+  BinaryTraceFileTestSuite ();
+};
+
+BinaryTraceFileTestSuite::BinaryTraceFileTestSuite ()
+  : TestSuite ("binary-trace-file", UNIT)
+{
+  AddTestCase (new BinaryTraceWriteReadTestCase, TestCase::QUICK);
+  AddTestCase (new BinaryTraceUnclosedTestCase, TestCase::QUICK);
+}
+
+static BinaryTraceFileTestSuite binaryTraceFileTestSuite; //!< Static variable for test initialization
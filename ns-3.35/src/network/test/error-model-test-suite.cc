@@ -25,6 +25,8 @@
  *         James P.G. Sterbenz <jpgs@ittc.ku.edu>, director 
  */
 
+#include <cmath>
+
 #include "ns3/test.h"
 #include "ns3/simple-net-device.h"
 #include "ns3/simple-channel.h"
@@ -37,6 +39,7 @@
 #include "ns3/error-model.h"
 #include "ns3/pointer.h"
 #include "ns3/double.h"
+#include "ns3/boolean.h"
 #include "ns3/string.h"
 #include "ns3/rng-seed-manager.h"
 #include "ns3/queue.h"
@@ -271,6 +274,113 @@ BurstErrorModelSimple::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_drops, 260 , "Wrong number of drops.");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that the skip-ahead mode of RateErrorModel and BurstErrorModel
+ * corrupts packets at the same rate as the per-packet decision.
+ */
+class ErrorModelSkipAhead : public TestCase
+{
+public:
+  ErrorModelSkipAhead ();
+  virtual ~ErrorModelSkipAhead ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Count the packets corrupted by a model.
+   * \param em The error model.
+   * \param n The number of packets to submit.
+   * \param size The size of the packets.
+   * \return The number of corrupted packets.
+   */
+  uint32_t CountCorrupt (Ptr<ErrorModel> em, uint32_t n, uint32_t size);
+  /**
+   * Check the number of packets corrupted by a RateErrorModel, in both modes.
+   * \param unit The error unit.
+   * \param rate The error rate.
+   * \param n The number of packets to submit.
+   * \param size The size of the packets.
+   * \param per The expected packet error rate.
+   */
+  void CheckRate (std::string unit, double rate, uint32_t n, uint32_t size, double per);
+};
+
+ErrorModelSkipAhead::ErrorModelSkipAhead ()
+  : TestCase ("Skip-ahead mode of RateErrorModel and BurstErrorModel")
+{
+}
+
+ErrorModelSkipAhead::~ErrorModelSkipAhead ()
+{
+}
+
+uint32_t
+ErrorModelSkipAhead::CountCorrupt (Ptr<ErrorModel> em, uint32_t n, uint32_t size)
+{
+  uint32_t corrupt = 0;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      if (em->IsCorrupt (Create<Packet> (size)))
+        {
+          corrupt++;
+        }
+    }
+  return corrupt;
+}
+
+void
+ErrorModelSkipAhead::CheckRate (std::string unit, double rate, uint32_t n, uint32_t size, double per)
+{
+  // Four standard deviations of the binomial number of corrupted packets
+  double tolerance = 4 * std::sqrt (n * per * (1 - per));
+
+  for (bool skipAhead : {false, true})
+    {
+      Ptr<RateErrorModel> em = CreateObject<RateErrorModel> ();
+      em->SetAttribute ("ErrorRate", DoubleValue (rate));
+      em->SetAttribute ("ErrorUnit", StringValue (unit));
+      em->SetAttribute ("SkipAhead", BooleanValue (skipAhead));
+      em->AssignStreams (skipAhead ? 60 : 61);
+      NS_TEST_EXPECT_MSG_EQ_TOL (CountCorrupt (em, n, size), n * per, tolerance,
+                                 "Wrong number of corrupted packets for " << unit
+                                 << " with SkipAhead=" << skipAhead);
+    }
+}
+
+void
+ErrorModelSkipAhead::DoRun (void)
+{
+  RngSeedManager::SetSeed (7);
+  RngSeedManager::SetRun (2);
+
+  CheckRate ("ERROR_UNIT_PACKET", 0.01, 100000, 1000, 0.01);
+  CheckRate ("ERROR_UNIT_BYTE", 0.001, 10000, 1000, 1 - std::pow (1 - 0.001, 1000));
+  CheckRate ("ERROR_UNIT_BIT", 1e-5, 20000, 1000, 1 - std::pow (1 - 1e-5, 8000));
+
+  // A rate of zero never corrupts, a rate of one always does
+  Ptr<RateErrorModel> em = CreateObject<RateErrorModel> ();
+  em->SetAttribute ("SkipAhead", BooleanValue (true));
+  em->SetRate (0.0);
+  NS_TEST_EXPECT_MSG_EQ (CountCorrupt (em, 1000, 1000), 0, "Corruption with a zero error rate");
+  em->SetRate (1.0);
+  NS_TEST_EXPECT_MSG_EQ (CountCorrupt (em, 1000, 1000), 1000, "No corruption with an error rate of one");
+
+  // With single-packet bursts, a burst error model corrupts packets at the burst rate
+  for (bool skipAhead : {false, true})
+    {
+      Ptr<BurstErrorModel> burst = CreateObject<BurstErrorModel> ();
+      burst->SetAttribute ("ErrorRate", DoubleValue (0.01));
+      burst->SetAttribute ("BurstSize", StringValue ("ns3::ConstantRandomVariable[Constant=1]"));
+      burst->SetAttribute ("SkipAhead", BooleanValue (skipAhead));
+      burst->AssignStreams (skipAhead ? 62 : 63);
+      NS_TEST_EXPECT_MSG_EQ_TOL (CountCorrupt (burst, 100000, 1000), 1000, 4 * std::sqrt (100000 * 0.01 * 0.99),
+                                 "Wrong number of burst error events with SkipAhead=" << skipAhead);
+    }
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -292,6 +402,7 @@ ErrorModelTestSuite::ErrorModelTestSuite ()
 {
   AddTestCase (new ErrorModelSimple, TestCase::QUICK);
   AddTestCase (new BurstErrorModelSimple, TestCase::QUICK);
+  AddTestCase (new ErrorModelSkipAhead, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
@@ -0,0 +1,176 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <string>
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/simple-net-device.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Check that Node delivers received packets to the handlers that
+ * match the device, the protocol and the promiscuous flag, in registration
+ * order.
+ */
+class NodeDispatchTestCase : public TestCase
+{
+public:
+  NodeDispatchTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Protocol handler recording its tag.
+   * \param tag the handler tag
+   * \param device the receiving device
+   * \param p the packet
+   * \param protocol the protocol number
+   * \param from the source address
+   * \param to the destination address
+   * \param packetType the packet type
+   */
+  void Handler (std::string tag, Ptr<NetDevice> device, Ptr<const Packet> p,
+                uint16_t protocol, const Address &from, const Address &to,
+                NetDevice::PacketType packetType);
+
+  /**
+   * \brief Protocol handler recording the tag "u".
+   * \param device the receiving device
+   * \param p the packet
+   * \param protocol the protocol number
+   * \param from the source address
+   * \param to the destination address
+   * \param packetType the packet type
+   */
+  void Untagged (Ptr<NetDevice> device, Ptr<const Packet> p,
+                 uint16_t protocol, const Address &from, const Address &to,
+                 NetDevice::PacketType packetType);
+
+  /**
+   * \brief Let a device receive a packet and return the handlers called.
+   * \param device the receiving device
+   * \param protocol the protocol number
+   * \param to the destination address
+   * \return the tags of the handlers called, in order
+   */
+  std::string Deliver (Ptr<SimpleNetDevice> device, uint16_t protocol, Mac48Address to);
+
+  std::string m_calls; //!< Tags of the handlers called
+};
+
+NodeDispatchTestCase::NodeDispatchTestCase ()
+  : TestCase ("Check the receive dispatch of Node")
+{
+}
+
+void
+NodeDispatchTestCase::Handler (std::string tag, Ptr<NetDevice> device, Ptr<const Packet> p,
+                               uint16_t protocol, const Address &from, const Address &to,
+                               NetDevice::PacketType packetType)
+{
+  m_calls += tag;
+}
+
+void
+NodeDispatchTestCase::Untagged (Ptr<NetDevice> device, Ptr<const Packet> p,
+                                uint16_t protocol, const Address &from, const Address &to,
+                                NetDevice::PacketType packetType)
+{
+  m_calls += "u";
+}
+
+std::string
+NodeDispatchTestCase::Deliver (Ptr<SimpleNetDevice> device, uint16_t protocol, Mac48Address to)
+{
+  m_calls = "";
+  Simulator::ScheduleWithContext (device->GetNode ()->GetId (), Seconds (0),
+                                  &SimpleNetDevice::Receive, device, Create<Packet> (100),
+                                  protocol, to, Mac48Address ("00:00:00:00:00:99"));
+  Simulator::Run ();
+  return m_calls;
+}
+
+void
+NodeDispatchTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<SimpleNetDevice> dev0 = CreateObject<SimpleNetDevice> ();
+  dev0->SetAddress (Mac48Address ("00:00:00:00:00:01"));
+  node->AddDevice (dev0);
+
+  node->RegisterProtocolHandler (MakeCallback (&NodeDispatchTestCase::Handler, this).Bind (std::string ("a")),
+                                 0, 0, false);
+  node->RegisterProtocolHandler (MakeCallback (&NodeDispatchTestCase::Handler, this).Bind (std::string ("b")),
+                                 0x0800, dev0, false);
+  node->RegisterProtocolHandler (MakeCallback (&NodeDispatchTestCase::Handler, this).Bind (std::string ("c")),
+                                 0x0806, 0, false);
+  node->RegisterProtocolHandler (MakeCallback (&NodeDispatchTestCase::Handler, this).Bind (std::string ("d")),
+                                 0, dev0, false);
+  node->RegisterProtocolHandler (MakeCallback (&NodeDispatchTestCase::Handler, this).Bind (std::string ("p")),
+                                 0x0800, 0, true);
+
+  // A device added after the handlers gets the non-promiscuous handlers for
+  // any device; the promiscuous mode is only enabled at registration time
+  Ptr<SimpleNetDevice> dev1 = CreateObject<SimpleNetDevice> ();
+  dev1->SetAddress (Mac48Address ("00:00:00:00:00:02"));
+  node->AddDevice (dev1);
+
+  Mac48Address to0 ("00:00:00:00:00:01");
+  Mac48Address to1 ("00:00:00:00:00:02");
+  NS_TEST_EXPECT_MSG_EQ (Deliver (dev0, 0x0800, to0), "abdp", "Wrong handlers for IPv4 on dev0");
+  NS_TEST_EXPECT_MSG_EQ (Deliver (dev0, 0x0806, to0), "acd", "Wrong handlers for ARP on dev0");
+  NS_TEST_EXPECT_MSG_EQ (Deliver (dev0, 0x86dd, to0), "ad", "Wrong handlers for IPv6 on dev0");
+  NS_TEST_EXPECT_MSG_EQ (Deliver (dev1, 0x0800, to1), "a", "Wrong handlers for IPv4 on dev1");
+  NS_TEST_EXPECT_MSG_EQ (Deliver (dev1, 0x0806, to1), "ac", "Wrong handlers for ARP on dev1");
+  // Packets for another host only reach the promiscuous handlers
+  NS_TEST_EXPECT_MSG_EQ (Deliver (dev0, 0x0800, to1), "p", "Wrong handlers for another host");
+
+  // Removing a handler updates the dispatch of every device
+  node->RegisterProtocolHandler (MakeCallback (&NodeDispatchTestCase::Untagged, this), 0x0800, 0, false);
+  NS_TEST_EXPECT_MSG_EQ (Deliver (dev1, 0x0800, to1), "au", "Wrong handlers after registration");
+  node->UnregisterProtocolHandler (MakeCallback (&NodeDispatchTestCase::Untagged, this));
+  NS_TEST_EXPECT_MSG_EQ (Deliver (dev1, 0x0800, to1), "a", "Wrong handlers after unregistration");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Node receive dispatch TestSuite
+ */
+class NodeDispatchTestSuite : public TestSuite
+{
+public:
+  NodeDispatchTestSuite ();
+};
+
+NodeDispatchTestSuite::NodeDispatchTestSuite ()
+  : TestSuite ("node-dispatch", UNIT)
+{
+  AddTestCase (new NodeDispatchTestCase, TestCase::QUICK);
+}
+
+static NodeDispatchTestSuite nodeDispatchTestSuite; //!< Static variable for test initialization
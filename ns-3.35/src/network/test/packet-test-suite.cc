@@ -1158,6 +1158,74 @@ PacketTagListTest::DoRun (void)
     
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Packet flow annotation unit tests.
+ */
+class PacketFlowAnnotationTest : public TestCase
+{
+public:
+  PacketFlowAnnotationTest ();
+private:
+  void DoRun (void);
+};
+
+PacketFlowAnnotationTest::PacketFlowAnnotationTest ()
+  : TestCase ("Packet flow annotation")
+{
+}
+
+void
+PacketFlowAnnotationTest::DoRun (void)
+{
+  Ptr<Packet> p = Create<Packet> (1000);
+  NS_TEST_EXPECT_MSG_EQ (p->GetFlowAnnotation ().flowId, 0, "A new packet must not be annotated");
+
+  PacketFlowAnnotation annotation;
+  annotation.flowId = 7;
+  annotation.packetId = 42;
+  annotation.size = 1020;
+  annotation.key = 0x1234;
+  annotation.src = 0x0a000001;
+  annotation.dst = 0x0a000002;
+  annotation.firstTxTime = MicroSeconds (3);
+  Ptr<const Packet> c = p;
+  c->SetFlowAnnotation (annotation);
+
+  // copies, fragments and headers keep the annotation
+  Ptr<Packet> copy = p->Copy ();
+  Ptr<Packet> fragment = p->CreateFragment (500, 100);
+  copy->AddHeader (ATestHeader<10> ());
+  const PacketFlowAnnotation &a = copy->GetFlowAnnotation ();
+  NS_TEST_EXPECT_MSG_EQ (a.flowId, 7, "Wrong flow id in copy");
+  NS_TEST_EXPECT_MSG_EQ (a.packetId, 42, "Wrong packet id in copy");
+  NS_TEST_EXPECT_MSG_EQ (a.size, 1020, "Wrong size in copy");
+  NS_TEST_EXPECT_MSG_EQ (a.key, 0x1234, "Wrong key in copy");
+  NS_TEST_EXPECT_MSG_EQ (a.src, 0x0a000001, "Wrong source in copy");
+  NS_TEST_EXPECT_MSG_EQ (a.dst, 0x0a000002, "Wrong destination in copy");
+  NS_TEST_EXPECT_MSG_EQ (a.firstTxTime, MicroSeconds (3), "Wrong first transmission time in copy");
+  NS_TEST_EXPECT_MSG_EQ (fragment->GetFlowAnnotation ().packetId, 42, "Wrong packet id in fragment");
+
+  // changing the annotation of a copy does not change the original
+  annotation.packetId = 43;
+  copy->SetFlowAnnotation (annotation);
+  NS_TEST_EXPECT_MSG_EQ (p->GetFlowAnnotation ().packetId, 42, "Annotation shared between copies");
+
+  // concatenation keeps the annotation of the packet appended to
+  Ptr<Packet> other = Create<Packet> (100);
+  other->AddAtEnd (p);
+  NS_TEST_EXPECT_MSG_EQ (other->GetFlowAnnotation ().flowId, 0, "Annotation taken from appended packet");
+  p->AddAtEnd (other);
+  NS_TEST_EXPECT_MSG_EQ (p->GetFlowAnnotation ().packetId, 42, "Annotation lost by AddAtEnd");
+
+  // the annotation goes away with the byte tags
+  p->RemoveAllByteTags ();
+  NS_TEST_EXPECT_MSG_EQ (p->GetFlowAnnotation ().flowId, 0, "Annotation kept by RemoveAllByteTags");
+  NS_TEST_EXPECT_MSG_EQ (copy->GetFlowAnnotation ().flowId, 7, "Annotation removed from a copy");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1175,6 +1243,7 @@ PacketTestSuite::PacketTestSuite ()
 {
   AddTestCase (new PacketTest, TestCase::QUICK);
   AddTestCase (new PacketTagListTest, TestCase::QUICK);
+  AddTestCase (new PacketFlowAnnotationTest, TestCase::QUICK);
 }
 
 static PacketTestSuite g_packetTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,569 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstddef>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/uinteger.h"
+#include "ipv4-address.h"
+#include "binary-trace-file.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BinaryTraceFile");
+
+NS_OBJECT_ENSURE_REGISTERED (BinaryTraceFile);
+
+namespace {
+
+/// The file header, padded to BinaryTraceFile::HEADER_SIZE bytes
+struct BinaryTraceFileHeader
+{
+  uint32_t magic;         //!< BinaryTraceFile::MAGIC
+  uint16_t version;       //!< BinaryTraceFile::VERSION
+  uint16_t recordSize;    //!< sizeof (BinaryTraceRecord)
+  uint32_t dataLinkType;  //!< pcap data link type of the traced packets
+  uint32_t reserved0;     //!< Padding, always zero
+  uint64_t nRecords;      //!< Number of records, zero until the file is closed
+  uint8_t reserved1[40];  //!< Padding, always zero
+};
+
+/// The pcap data link types that can be decoded, see PcapHelper::DataLinkType
+enum
+{
+  LINK_EN10MB = 1,
+  LINK_PPP = 9,
+  LINK_RAW = 101
+};
+
+/// Largest link header + IPv4 header with options + TCP header without options
+const uint32_t DECODE_BYTES = 14 + 60 + 20;
+
+uint16_t
+ReadU16 (const uint8_t *p)
+{
+  return static_cast<uint16_t> ((p[0] << 8) | p[1]);
+}
+
+uint32_t
+ReadU32 (const uint8_t *p)
+{
+  return (static_cast<uint32_t> (p[0]) << 24) | (static_cast<uint32_t> (p[1]) << 16)
+         | (static_cast<uint32_t> (p[2]) << 8) | p[3];
+}
+
+const char *
+DscpToString (uint8_t dscp)
+{
+  switch (dscp)
+    {
+    case 0x00: return "Default";
+    case 0x08: return "CS1";
+    case 0x0A: return "AF11";
+    case 0x0C: return "AF12";
+    case 0x0E: return "AF13";
+    case 0x10: return "CS2";
+    case 0x12: return "AF21";
+    case 0x14: return "AF22";
+    case 0x16: return "AF23";
+    case 0x18: return "CS3";
+    case 0x1A: return "AF31";
+    case 0x1C: return "AF32";
+    case 0x1E: return "AF33";
+    case 0x20: return "CS4";
+    case 0x22: return "AF41";
+    case 0x24: return "AF42";
+    case 0x26: return "AF43";
+    case 0x28: return "CS5";
+    case 0x2E: return "EF";
+    case 0x30: return "CS6";
+    case 0x38: return "CS7";
+    default: return "Unrecognized DSCP";
+    }
+}
+
+const char *
+EcnToString (uint8_t ecn)
+{
+  switch (ecn)
+    {
+    case 0: return "Not-ECT";
+    case 1: return "ECT (1)";
+    case 2: return "ECT (0)";
+    default: return "CE";
+    }
+}
+
+std::string
+TcpFlagsToString (uint8_t flags)
+{
+  static const char *flagNames[8] = { "FIN", "SYN", "RST", "PSH", "ACK", "URG", "ECE", "CWR" };
+  std::string s;
+  for (uint8_t i = 0; i < 8; ++i)
+    {
+      if (flags & (1 << i))
+        {
+          if (!s.empty ())
+            {
+              s += "|";
+            }
+          s += flagNames[i];
+        }
+    }
+  return s;
+}
+
+} // unnamed namespace
+
+void
+BinaryTraceRecord::Print (std::ostream &os, uint32_t dataLinkType) const
+{
+  os << static_cast<char> (event) << " " << NanoSeconds (time).GetSeconds ()
+     << " /NodeList/" << nodeId << "/DeviceList/" << deviceId;
+
+  if (dataLinkType == LINK_PPP && (fields & HAS_IPV4))
+    {
+      os << " ns3::PppHeader (Point-to-Point Protocol: IP (0x0021))";
+    }
+  if (fields & HAS_IPV4)
+    {
+      const char *flags = "none";
+      if ((fragment & 0x2000) && (fragment & 0x4000))
+        {
+          flags = "MF|DF";
+        }
+      else if (fragment & 0x4000)
+        {
+          flags = "DF";
+        }
+      else if (fragment & 0x2000)
+        {
+          flags = "MF";
+        }
+      os << " ns3::Ipv4Header ("
+         << "tos 0x" << std::hex << static_cast<uint32_t> (tos) << std::dec << " "
+         << "DSCP " << DscpToString (tos >> 2) << " "
+         << "ECN " << EcnToString (tos & 0x3) << " "
+         << "ttl " << static_cast<uint32_t> (ttl) << " "
+         << "id " << identification << " "
+         << "protocol " << static_cast<uint32_t> (protocol) << " "
+         << "offset (bytes) " << (fragment & 0x1fff) * 8 << " "
+         << "flags [" << flags << "] "
+         << "length: " << size - (dataLinkType == LINK_PPP ? 2 : dataLinkType == LINK_EN10MB ? 14 : 0)
+         << " " << Ipv4Address (source) << " > " << Ipv4Address (destination) << ")";
+    }
+  if (fields & HAS_TCP)
+    {
+      os << " ns3::TcpHeader (" << sourcePort << " > " << destinationPort;
+      if (tcpFlags != 0)
+        {
+          os << " [" << TcpFlagsToString (tcpFlags) << "]";
+        }
+      os << " Seq=" << sequence << " Ack=" << ack << " Win=" << window << ")";
+    }
+  else if (fields & HAS_UDP)
+    {
+      os << " ns3::UdpHeader (length: " << payloadSize + 8 << " "
+         << sourcePort << " > " << destinationPort << ")";
+    }
+  if (fields & (HAS_TCP | HAS_UDP))
+    {
+      if (payloadSize > 0)
+        {
+          os << " Payload (size=" << payloadSize << ")";
+        }
+    }
+  else
+    {
+      os << " Payload (size=" << size << ")";
+    }
+}
+
+TypeId
+BinaryTraceFile::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::BinaryTraceFile")
+    .SetParent<Object> ()
+    .SetGroupName ("Network")
+    .AddConstructor<BinaryTraceFile> ()
+    .AddAttribute ("ChunkSize",
+                   "Size of the file regions mapped in memory at a time, "
+                   "rounded up to a multiple of the page size",
+                   UintegerValue (4 * 1024 * 1024),
+                   MakeUintegerAccessor (&BinaryTraceFile::m_chunkSize),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+BinaryTraceFile::BinaryTraceFile ()
+  : m_fd (-1),
+    m_fail (false),
+    m_dataLinkType (0),
+    m_chunkSize (0),
+    m_chunk (0),
+    m_chunkOffset (0),
+    m_chunkUsed (0),
+    m_nRecords (0)
+{
+  NS_LOG_FUNCTION (this);
+  static_assert (sizeof (BinaryTraceRecord) == 64, "Binary trace records must be 64 bytes");
+  static_assert (sizeof (BinaryTraceFileHeader) == HEADER_SIZE, "Binary trace header must be HEADER_SIZE bytes");
+}
+
+BinaryTraceFile::~BinaryTraceFile ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+void
+BinaryTraceFile::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+  Object::DoDispose ();
+}
+
+void
+BinaryTraceFile::Open (std::string const &filename, uint32_t dataLinkType)
+{
+  NS_LOG_FUNCTION (this << filename << dataLinkType);
+  Close ();
+
+  long pageSize = sysconf (_SC_PAGESIZE);
+  m_chunkSize = ((m_chunkSize + pageSize - 1) / pageSize) * pageSize;
+
+  m_filename = filename;
+  m_dataLinkType = dataLinkType;
+  m_nRecords = 0;
+  m_chunk = 0;
+  m_chunkOffset = 0;
+  m_chunkUsed = 0;
+  m_fd = open (filename.c_str (), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  m_fail = (m_fd < 0);
+  if (m_fail || !MapNextChunk ())
+    {
+      return;
+    }
+
+  BinaryTraceFileHeader *header = reinterpret_cast<BinaryTraceFileHeader *> (m_chunk);
+  std::memset (header, 0, HEADER_SIZE);
+  header->magic = MAGIC;
+  header->version = VERSION;
+  header->recordSize = sizeof (BinaryTraceRecord);
+  header->dataLinkType = dataLinkType;
+  m_chunkUsed = HEADER_SIZE;
+}
+
+void
+BinaryTraceFile::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_fd < 0)
+    {
+      return;
+    }
+
+  uint64_t fileSize = m_chunkOffset + m_chunkUsed;
+  UnmapChunk ();
+  if (!m_fail)
+    {
+      m_fail = (pwrite (m_fd, &m_nRecords, sizeof (m_nRecords),
+                        offsetof (BinaryTraceFileHeader, nRecords)) != sizeof (m_nRecords))
+        || (ftruncate (m_fd, fileSize) != 0);
+    }
+  close (m_fd);
+  m_fd = -1;
+}
+
+bool
+BinaryTraceFile::Fail (void) const
+{
+  return m_fail;
+}
+
+uint64_t
+BinaryTraceFile::GetNRecords (void) const
+{
+  return m_nRecords;
+}
+
+bool
+BinaryTraceFile::MapNextChunk (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint64_t offset = (m_chunk == 0) ? 0 : m_chunkOffset + m_chunkSize;
+  UnmapChunk ();
+
+  if (ftruncate (m_fd, offset + m_chunkSize) != 0)
+    {
+      NS_LOG_WARN ("Unable to grow " << m_filename);
+      m_fail = true;
+      return false;
+    }
+  void *chunk = mmap (0, m_chunkSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, offset);
+  if (chunk == MAP_FAILED)
+    {
+      NS_LOG_WARN ("Unable to map " << m_filename << " at offset " << offset);
+      m_fail = true;
+      return false;
+    }
+  m_chunk = static_cast<uint8_t *> (chunk);
+  m_chunkOffset = offset;
+  m_chunkUsed = 0;
+  return true;
+}
+
+void
+BinaryTraceFile::UnmapChunk (void)
+{
+  if (m_chunk != 0)
+    {
+      munmap (m_chunk, m_chunkSize);
+      m_chunk = 0;
+    }
+}
+
+void
+BinaryTraceFile::Write (Time t, uint32_t nodeId, uint32_t deviceId,
+                        BinaryTraceRecord::EventType event, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << t << nodeId << deviceId << event << p);
+  if (m_fd < 0 || m_fail)
+    {
+      return;
+    }
+  // The chunk size is a multiple of the page size, hence of the record
+  // size: a record never straddles two chunks.
+  if (m_chunkUsed == m_chunkSize && !MapNextChunk ())
+    {
+      return;
+    }
+
+  BinaryTraceRecord *record = reinterpret_cast<BinaryTraceRecord *> (m_chunk + m_chunkUsed);
+  std::memset (record, 0, sizeof (BinaryTraceRecord));
+  record->time = t.GetNanoSeconds ();
+  record->uid = p->GetUid ();
+  record->nodeId = nodeId;
+  record->deviceId = deviceId;
+  record->size = p->GetSize ();
+  record->event = event;
+
+  uint8_t data[DECODE_BYTES];
+  uint32_t length = p->CopyData (data, DECODE_BYTES);
+  Decode (*record, data, length, m_dataLinkType);
+
+  m_chunkUsed += sizeof (BinaryTraceRecord);
+  m_nRecords++;
+}
+
+void
+BinaryTraceFile::Decode (BinaryTraceRecord &record, const uint8_t *data,
+                         uint32_t length, uint32_t dataLinkType)
+{
+  uint32_t o;
+  switch (dataLinkType)
+    {
+    case LINK_PPP:
+      if (length < 2 || ReadU16 (data) != 0x0021)
+        {
+          return;
+        }
+      o = 2;
+      break;
+    case LINK_EN10MB:
+      if (length < 14 || ReadU16 (data + 12) != 0x0800)
+        {
+          return;
+        }
+      o = 14;
+      break;
+    case LINK_RAW:
+      o = 0;
+      break;
+    default:
+      return;
+    }
+
+  if (length < o + 20 || (data[o] >> 4) != 4)
+    {
+      return;
+    }
+  uint32_t ihl = (data[o] & 0x0f) * 4;
+  uint16_t totalLength = ReadU16 (data + o + 2);
+  record.tos = data[o + 1];
+  record.identification = ReadU16 (data + o + 4);
+  record.fragment = ReadU16 (data + o + 6);
+  record.ttl = data[o + 8];
+  record.protocol = data[o + 9];
+  record.source = ReadU32 (data + o + 12);
+  record.destination = ReadU32 (data + o + 16);
+  record.fields |= BinaryTraceRecord::HAS_IPV4;
+
+  // Only the first fragment carries the transport header
+  uint32_t l4 = o + ihl;
+  if ((record.fragment & 0x1fff) != 0 || ihl < 20)
+    {
+      return;
+    }
+  if (record.protocol == 6 && length >= l4 + 20)
+    {
+      uint32_t dataOffset = (data[l4 + 12] >> 4) * 4;
+      record.sourcePort = ReadU16 (data + l4);
+      record.destinationPort = ReadU16 (data + l4 + 2);
+      record.sequence = ReadU32 (data + l4 + 4);
+      record.ack = ReadU32 (data + l4 + 8);
+      record.tcpFlags = data[l4 + 13];
+      record.window = ReadU16 (data + l4 + 14);
+      record.payloadSize = (totalLength > ihl + dataOffset) ? totalLength - ihl - dataOffset : 0;
+      record.fields |= BinaryTraceRecord::HAS_TCP;
+    }
+  else if (record.protocol == 17 && length >= l4 + 8)
+    {
+      record.sourcePort = ReadU16 (data + l4);
+      record.destinationPort = ReadU16 (data + l4 + 2);
+      record.payloadSize = (totalLength > ihl + 8) ? totalLength - ihl - 8 : 0;
+      record.fields |= BinaryTraceRecord::HAS_UDP;
+    }
+}
+
+
+BinaryTraceReader::BinaryTraceReader ()
+  : m_fd (-1),
+    m_map (0),
+    m_mapSize (0),
+    m_nRecords (0),
+    m_dataLinkType (0),
+    m_records (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+BinaryTraceReader::~BinaryTraceReader ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+bool
+BinaryTraceReader::Open (std::string const &filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  Close ();
+
+  m_fd = open (filename.c_str (), O_RDONLY);
+  if (m_fd < 0)
+    {
+      return false;
+    }
+  struct stat st;
+  if (fstat (m_fd, &st) != 0 || static_cast<uint64_t> (st.st_size) < BinaryTraceFile::HEADER_SIZE)
+    {
+      Close ();
+      return false;
+    }
+  void *map = mmap (0, st.st_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+  if (map == MAP_FAILED)
+    {
+      Close ();
+      return false;
+    }
+  m_map = static_cast<uint8_t *> (map);
+  m_mapSize = st.st_size;
+
+  const BinaryTraceFileHeader *header = reinterpret_cast<const BinaryTraceFileHeader *> (m_map);
+  if (header->magic != BinaryTraceFile::MAGIC
+      || header->version != BinaryTraceFile::VERSION
+      || header->recordSize != sizeof (BinaryTraceRecord))
+    {
+      NS_LOG_WARN (filename << " is not a binary trace file");
+      Close ();
+      return false;
+    }
+  m_dataLinkType = header->dataLinkType;
+  m_records = reinterpret_cast<const BinaryTraceRecord *> (m_map + BinaryTraceFile::HEADER_SIZE);
+
+  uint64_t capacity = (m_mapSize - BinaryTraceFile::HEADER_SIZE) / sizeof (BinaryTraceRecord);
+  m_nRecords = header->nRecords;
+  if (m_nRecords == 0 || m_nRecords > capacity)
+    {
+      // The writer did not close the file: the last chunk is zero-filled
+      // past the final record.
+      m_nRecords = capacity;
+      while (m_nRecords > 0 && m_records[m_nRecords - 1].event == 0)
+        {
+          m_nRecords--;
+        }
+    }
+  return true;
+}
+
+void
+BinaryTraceReader::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_map != 0)
+    {
+      munmap (m_map, m_mapSize);
+      m_map = 0;
+    }
+  if (m_fd >= 0)
+    {
+      close (m_fd);
+      m_fd = -1;
+    }
+  m_mapSize = 0;
+  m_nRecords = 0;
+  m_records = 0;
+}
+
+uint64_t
+BinaryTraceReader::GetNRecords (void) const
+{
+  return m_nRecords;
+}
+
+uint32_t
+BinaryTraceReader::GetDataLinkType (void) const
+{
+  return m_dataLinkType;
+}
+
+const BinaryTraceRecord &
+BinaryTraceReader::GetRecord (uint64_t i) const
+{
+  NS_ASSERT_MSG (i < m_nRecords, "Record index " << i << " out of range");
+  return m_records[i];
+}
+
+void
+BinaryTraceReader::PrintAscii (std::ostream &os) const
+{
+  for (uint64_t i = 0; i < m_nRecords; ++i)
+    {
+      m_records[i].Print (os, m_dataLinkType);
+      os << "\n";
+    }
+}
+
+} // namespace ns3
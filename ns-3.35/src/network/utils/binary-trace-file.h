@@ -0,0 +1,267 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BINARY_TRACE_FILE_H
+#define BINARY_TRACE_FILE_H
+
+#include <stdint.h>
+#include <string>
+#include <ostream>
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ *
+ * \brief A fixed-size record of one packet event in a binary trace file.
+ *
+ * Each record summarizes the packet instead of storing its bytes: the
+ * link-layer header is skipped and the IPv4 and TCP/UDP header fields that
+ * matter for transport-level post-processing are decoded once, when the
+ * record is written.  Fields that could not be decoded are left to zero and
+ * the corresponding bit in \c fields is cleared.
+ *
+ * All fields are stored in host byte order.
+ */
+struct BinaryTraceRecord
+{
+  /// Event that produced the record; values match the ascii trace operations
+  enum EventType
+  {
+    ENQUEUE = '+',  //!< Packet enqueued in the device transmit queue
+    DEQUEUE = '-',  //!< Packet dequeued from the device transmit queue
+    DROP = 'd',     //!< Packet dropped by the device or its queue
+    RECEIVE = 'r'   //!< Packet received by the device
+  };
+
+  /// Bits of the \c fields member telling which headers were decoded
+  enum FieldFlags
+  {
+    HAS_IPV4 = 0x01,  //!< IPv4 header fields are valid
+    HAS_TCP = 0x02,   //!< TCP header fields are valid
+    HAS_UDP = 0x04    //!< UDP port fields are valid
+  };
+
+  int64_t time;         //!< Simulation time of the event, in nanoseconds
+  uint64_t uid;         //!< Packet uid
+  uint32_t nodeId;      //!< Node id of the traced device
+  uint32_t deviceId;    //!< Interface index of the traced device
+  uint32_t size;        //!< Packet size, link-layer header included
+  uint32_t source;      //!< IPv4 source address
+  uint32_t destination; //!< IPv4 destination address
+  uint16_t sourcePort;  //!< TCP/UDP source port
+  uint16_t destinationPort; //!< TCP/UDP destination port
+  uint32_t sequence;    //!< TCP sequence number
+  uint32_t ack;         //!< TCP acknowledgment number
+  uint16_t identification; //!< IPv4 identification
+  uint16_t window;      //!< TCP advertised window
+  uint16_t payloadSize; //!< Transport payload size, in bytes
+  uint8_t event;        //!< One of EventType
+  uint8_t protocol;     //!< IPv4 protocol number
+  uint8_t tos;          //!< IPv4 TOS byte; the two low bits are the ECN codepoint
+  uint8_t ttl;          //!< IPv4 TTL
+  uint8_t tcpFlags;     //!< TCP flags, including ECE and CWR
+  uint8_t fields;       //!< Combination of FieldFlags
+  uint16_t fragment;    //!< IPv4 flags and fragment offset, as on the wire
+  uint16_t reserved;    //!< Padding, always zero
+
+  /**
+   * \brief Print the record in the format used by the ascii trace sinks
+   * with a trace context.
+   *
+   * Only the headers summarized by the record are printed, so header
+   * options and the payload bytes present in a real ascii trace are absent.
+   *
+   * \param os the output stream
+   * \param dataLinkType the data link type of the file the record comes from
+   */
+  void Print (std::ostream &os, uint32_t dataLinkType) const;
+};
+
+/**
+ * \ingroup network
+ *
+ * \brief Write packet events into a compact binary trace file.
+ *
+ * The ascii trace sinks print every packet with Packet::Print, which is slow
+ * and produces very large files.  This class instead appends one fixed-size
+ * BinaryTraceRecord per event to a file that is grown one chunk at a time
+ * and written through a memory mapping, so a trace event costs a header
+ * decode and a 64-byte store.
+ *
+ * The file starts with a 64-byte header holding a magic number, the
+ * format version, the record size, the data link type and, once the file
+ * has been closed, the number of records.  Use BinaryTraceReader to read it
+ * back and BinaryTraceRecord::Print to convert it to the ascii format.
+ */
+class BinaryTraceFile : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  static const uint32_t MAGIC = 0x4e334254;   //!< "N3BT", in host byte order
+  static const uint16_t VERSION = 1;          //!< File format version
+  static const uint32_t HEADER_SIZE = 64;     //!< Size of the file header, in bytes
+
+  BinaryTraceFile ();
+  ~BinaryTraceFile ();
+
+  /**
+   * \brief Create a new binary trace file, truncating any existing one.
+   *
+   * \param filename the file name
+   * \param dataLinkType the pcap data link type of the traced packets, used
+   * to find the network header (only PPP, Ethernet and raw IP are decoded)
+   */
+  void Open (std::string const &filename, uint32_t dataLinkType);
+
+  /**
+   * \brief Flush the records, write the record count and release the file.
+   */
+  void Close (void);
+
+  /**
+   * \return true if the file could not be created or grown
+   */
+  bool Fail (void) const;
+
+  /**
+   * \brief Append the record of a packet event.
+   *
+   * \param t the event time
+   * \param nodeId the node id of the traced device
+   * \param deviceId the interface index of the traced device
+   * \param event the event type
+   * \param p the packet, starting with its link-layer header
+   */
+  void Write (Time t, uint32_t nodeId, uint32_t deviceId,
+              BinaryTraceRecord::EventType event, Ptr<const Packet> p);
+
+  /**
+   * \return the number of records written so far
+   */
+  uint64_t GetNRecords (void) const;
+
+  /**
+   * \brief Fill the transport fields of a record from the leading bytes of
+   * a packet.
+   *
+   * \param record the record to fill
+   * \param data the first bytes of the packet
+   * \param length the number of valid bytes in \p data
+   * \param dataLinkType the pcap data link type of the packet
+   */
+  static void Decode (BinaryTraceRecord &record, const uint8_t *data,
+                      uint32_t length, uint32_t dataLinkType);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Map the chunk following the current one, growing the file.
+   * \return false if the file could not be grown or mapped
+   */
+  bool MapNextChunk (void);
+
+  /**
+   * \brief Unmap the current chunk, if any.
+   */
+  void UnmapChunk (void);
+
+  std::string m_filename;       //!< File name
+  int m_fd;                     //!< File descriptor, -1 if closed
+  bool m_fail;                  //!< Whether an I/O operation failed
+  uint32_t m_dataLinkType;      //!< Data link type of the traced packets
+  uint32_t m_chunkSize;         //!< Size of a mapped chunk, in bytes
+  uint8_t *m_chunk;             //!< Start of the mapped chunk
+  uint64_t m_chunkOffset;       //!< File offset of the mapped chunk
+  uint32_t m_chunkUsed;         //!< Bytes used in the mapped chunk
+  uint64_t m_nRecords;          //!< Number of records written
+};
+
+/**
+ * \ingroup network
+ *
+ * \brief Read a binary trace file written by BinaryTraceFile.
+ *
+ * The whole file is mapped read-only, so records can be streamed or
+ * accessed at random without copies.
+ */
+class BinaryTraceReader
+{
+public:
+  BinaryTraceReader ();
+  ~BinaryTraceReader ();
+
+  /**
+   * \brief Open and map a binary trace file.
+   * \param filename the file name
+   * \return false if the file does not exist or is not a binary trace file
+   */
+  bool Open (std::string const &filename);
+
+  /**
+   * \brief Unmap and close the file.
+   */
+  void Close (void);
+
+  /**
+   * \return the number of records in the file
+   */
+  uint64_t GetNRecords (void) const;
+
+  /**
+   * \return the pcap data link type of the traced packets
+   */
+  uint32_t GetDataLinkType (void) const;
+
+  /**
+   * \param i the record index
+   * \return the i-th record
+   */
+  const BinaryTraceRecord & GetRecord (uint64_t i) const;
+
+  /**
+   * \brief Print every record in the ascii trace format, one per line.
+   * \param os the output stream
+   */
+  void PrintAscii (std::ostream &os) const;
+
+private:
+  /// Disallow copies, the mapping is owned by the reader
+  BinaryTraceReader (const BinaryTraceReader &);
+  /// Disallow assignment, the mapping is owned by the reader
+  BinaryTraceReader & operator = (const BinaryTraceReader &);
+
+  int m_fd;                             //!< File descriptor, -1 if closed
+  uint8_t *m_map;                       //!< Start of the mapping
+  uint64_t m_mapSize;                   //!< Size of the mapping
+  uint64_t m_nRecords;                  //!< Number of records
+  uint32_t m_dataLinkType;              //!< Data link type of the traced packets
+  const BinaryTraceRecord *m_records;   //!< First record
+};
+
+} // namespace ns3
+
+#endif /* BINARY_TRACE_FILE_H */
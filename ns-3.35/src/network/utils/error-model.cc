@@ -61,6 +61,7 @@
  */
 
 #include <cmath>
+#include <limits>
 
 #include "error-model.h"
 
@@ -77,6 +78,36 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("ErrorModel");
 
+/**
+ * Sample the number of error-free units before the next error, when each
+ * unit is errored independently with the given probability.  The gap
+ * follows a geometric distribution, sampled by inversion.
+ *
+ * \param ranvar a Uniform(0,1) random variable
+ * \param rate the per-unit error probability
+ * \return the number of error-free units before the next error
+ */
+static uint64_t
+SampleErrorGap (Ptr<RandomVariableStream> ranvar, double rate)
+{
+  const uint64_t never = std::numeric_limits<uint64_t>::max ();
+  if (rate <= 0.0)
+    {
+      return never;
+    }
+  if (rate >= 1.0)
+    {
+      return 0;
+    }
+  double u = 1.0 - ranvar->GetValue ();
+  if (u <= 0.0)
+    {
+      return never;
+    }
+  double gap = std::floor (std::log (u) / std::log1p (-rate));
+  return (gap >= static_cast<double> (never)) ? never : static_cast<uint64_t> (gap);
+}
+
 NS_OBJECT_ENSURE_REGISTERED (ErrorModel);
 
 TypeId ErrorModel::GetTypeId (void)
@@ -168,12 +199,21 @@ TypeId RateErrorModel::GetTypeId (void)
                    StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=1.0]"),
                    MakePointerAccessor (&RateErrorModel::m_ranvar),
                    MakePointerChecker<RandomVariableStream> ())
+    .AddAttribute ("SkipAhead",
+                   "Sample the gap to the next error from a geometric distribution "
+                   "instead of drawing the decision variable for every packet.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RateErrorModel::m_skipAhead),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
 
 RateErrorModel::RateErrorModel ()
+  : m_skipAhead (false),
+    m_gap (0),
+    m_gapRate (-1.0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -234,6 +274,22 @@ RateErrorModel::DoCorrupt (Ptr<Packet> p)
     {
       return false;
     }
+  if (m_skipAhead)
+    {
+      switch (m_unit)
+        {
+        case ERROR_UNIT_PACKET:
+          return DoCorruptSkip (1);
+        case ERROR_UNIT_BYTE:
+          return DoCorruptSkip (p->GetSize ());
+        case ERROR_UNIT_BIT:
+          return DoCorruptSkip (8 * static_cast<uint64_t> (p->GetSize ()));
+        default:
+          NS_ASSERT_MSG (false, "m_unit not supported yet");
+          break;
+        }
+      return false;
+    }
   switch (m_unit) 
     {
     case ERROR_UNIT_PACKET:
@@ -274,11 +330,32 @@ RateErrorModel::DoCorruptBit (Ptr<Packet> p)
   return (m_ranvar->GetValue () < per);
 }
 
+bool
+RateErrorModel::DoCorruptSkip (uint64_t units)
+{
+  NS_LOG_FUNCTION (this << units);
+  if (m_gapRate != m_rate)
+    {
+      m_gap = SampleErrorGap (m_ranvar, m_rate);
+      m_gapRate = m_rate;
+    }
+  if (m_gap >= units)
+    {
+      m_gap -= units;
+      return false;
+    }
+  // The error falls within this packet.  Units are errored independently,
+  // so the gap to the next error can be sampled afresh from the start of
+  // the next packet.
+  m_gap = SampleErrorGap (m_ranvar, m_rate);
+  return true;
+}
+
 void 
 RateErrorModel::DoReset (void) 
 { 
   NS_LOG_FUNCTION (this);
-  /* re-initialize any state; no-op for now */ 
+  m_gapRate = -1.0;
 }
 
 
@@ -306,12 +383,19 @@ TypeId BurstErrorModel::GetTypeId (void)
                    StringValue ("ns3::UniformRandomVariable[Min=1|Max=4]"),
                    MakePointerAccessor (&BurstErrorModel::m_burstSize),
                    MakePointerChecker<RandomVariableStream> ())
+    .AddAttribute ("SkipAhead",
+                   "Sample the gap to the next error event from a geometric distribution "
+                   "instead of drawing the decision variable for every packet.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&BurstErrorModel::m_skipAhead),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
 
-BurstErrorModel::BurstErrorModel () : m_counter (0), m_currentBurstSz (0)
+BurstErrorModel::BurstErrorModel () : m_counter (0), m_currentBurstSz (0),
+                                      m_skipAhead (false), m_gap (0), m_gapRate (-1.0)
 {
 
 }
@@ -366,9 +450,23 @@ BurstErrorModel::DoCorrupt (Ptr<Packet> p)
     {
       return false;
     }
-  double ranVar = m_burstStart ->GetValue();
+  bool burstStart;
+  if (m_skipAhead)
+    {
+      if (m_gapRate != m_burstRate)
+        {
+          m_gap = SampleErrorGap (m_burstStart, m_burstRate);
+          m_gapRate = m_burstRate;
+        }
+      burstStart = (m_gap == 0);
+      m_gap = burstStart ? SampleErrorGap (m_burstStart, m_burstRate) : m_gap - 1;
+    }
+  else
+    {
+      burstStart = (m_burstStart->GetValue () < m_burstRate);
+    }
 
-  if (ranVar < m_burstRate)
+  if (burstStart)
     {
       // get a new burst size for the new error event
       m_currentBurstSz = m_burstSize->GetInteger();     
@@ -407,7 +505,7 @@ BurstErrorModel::DoReset (void)
   NS_LOG_FUNCTION (this);
   m_counter = 0;
   m_currentBurstSz = 0;
-
+  m_gapRate = -1.0;
 }
 
 
@@ -174,8 +174,17 @@ private:
  * unit (which may be per-bit, per-byte, and per-packet).
  * Users can optionally provide a RandomVariableStream object; the default
  * is to use a Uniform(0,1) distribution.
-
- * Reset() on this model will do nothing
+ *
+ * With the SkipAhead attribute set, the model does not draw a random
+ * variate per packet.  It instead samples, from a geometric distribution,
+ * the number of error-free units before the next error, and counts it
+ * down as packets go by.  Since units are errored independently, this is
+ * statistically equivalent to the per-packet draw for every unit, but a
+ * packet costs a comparison and a subtraction unless it is corrupted.
+ * This mode requires the random variable to be Uniform(0,1).
+ *
+ * Reset() on this model will discard the pending gap in skip-ahead mode,
+ * and do nothing otherwise
  *
  * IsCorrupt() will not modify the packet data buffer
  */
@@ -254,12 +263,22 @@ private:
    * \returns true if the packet is corrupted
    */
   virtual bool DoCorruptBit (Ptr<Packet> p);
+  /**
+   * Corrupt a packet of the given number of units in skip-ahead mode.
+   * \param units the packet size, in error units
+   * \returns true if the packet is corrupted
+   */
+  bool DoCorruptSkip (uint64_t units);
   virtual void DoReset (void);
 
   enum ErrorUnit m_unit; //!< Error rate unit
   double m_rate; //!< Error rate
 
   Ptr<RandomVariableStream> m_ranvar; //!< rng stream
+
+  bool m_skipAhead;   //!< True if the gap to the next error is sampled
+  uint64_t m_gap;     //!< Error-free units left before the next error
+  double m_gapRate;   //!< Error rate m_gap was sampled with, negative if none
 };
 
 
@@ -293,6 +312,11 @@ private:
  * total number of packets that has been dropped does not exceed the 
  * burst size.
  *
+ * With the SkipAhead attribute set, the decision variable is not drawn per
+ * packet: the number of packets before the next error event is sampled
+ * from a geometric distribution instead, as in RateErrorModel.  This mode
+ * requires the decision variable to be Uniform(0,1).
+ *
  * IsCorrupt() will not modify the packet data buffer
  */
 class BurstErrorModel : public ErrorModel
@@ -351,6 +375,9 @@ private:
   uint32_t m_counter;
   uint32_t m_currentBurstSz;                  //!< the current burst size
 
+  bool m_skipAhead;   //!< True if the gap to the next error event is sampled
+  uint64_t m_gap;     //!< Packets left before the next error event
+  double m_gapRate;   //!< Burst rate m_gap was sampled with, negative if none
 };
 
 
@@ -18,6 +18,8 @@
  * Author: Stefano Avallone <stefano.avallone@.unina.it>
  */
 
+#include <limits>
+#include <algorithm>
 #include "ns3/abort.h"
 #include "ns3/queue-limits.h"
 #include "ns3/net-device-queue-interface.h"
@@ -43,6 +45,7 @@ NetDeviceQueue::GetTypeId (void)
 NetDeviceQueue::NetDeviceQueue ()
   : m_stoppedByDevice (false),
     m_stoppedByQueueLimits (false),
+    m_completionByDevice (false),
     NS_LOG_TEMPLATE_DEFINE ("NetDeviceQueueInterface")
 {
   NS_LOG_FUNCTION (this);
@@ -146,6 +149,13 @@ NetDeviceQueue::NotifyTransmittedBytes (uint32_t bytes)
     }
 }
 
+void
+NetDeviceQueue::SetCompletionByDevice (bool byDevice)
+{
+  NS_LOG_FUNCTION (this << byDevice);
+  m_completionByDevice = byDevice;
+}
+
 void
 NetDeviceQueue::ResetQueueLimits ()
 {
@@ -171,6 +181,23 @@ NetDeviceQueue::GetQueueLimits ()
   return m_queueLimits;
 }
 
+uint32_t
+NetDeviceQueue::GetAvailablePackets (void) const
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t available = (m_availablePackets ? m_availablePackets ()
+                                           : std::numeric_limits<uint32_t>::max ());
+  if (m_queueLimits && m_device)
+    {
+      // The queue is stopped by the queue limits once more than the available
+      // bytes are queued, hence one more packet than fits can be sent
+      int32_t bytes = m_queueLimits->Available ();
+      uint32_t packets = (bytes < 0 ? 0 : bytes / m_device->GetMtu () + 1);
+      available = std::min (available, packets);
+    }
+  return available;
+}
+
 
 NS_OBJECT_ENSURE_REGISTERED (NetDeviceQueueInterface);
 
@@ -28,6 +28,7 @@
 #include "ns3/log.h"
 #include "ns3/net-device.h"
 #include "ns3/object-factory.h"
+#include "ns3/queue-size.h"
 
 namespace ns3 {
 
@@ -131,6 +132,18 @@ public:
    */
   virtual void NotifyTransmittedBytes (uint32_t bytes);
 
+  /**
+   * \brief Set whether the device reports the transmitted bytes
+   * \param byDevice true if the device calls NotifyTransmittedBytes when the
+   *        transmission of a packet completes
+   *
+   * By default, the packets dequeued from the queue connected through
+   * ConnectQueueTraces are reported to the queue limits as transmitted.
+   * Devices that report the completion of their transmissions set this flag,
+   * so that the queue limits also account for the packet on the wire.
+   */
+  void SetCompletionByDevice (bool byDevice);
+
   /**
    * \brief Reset queue limits state
    */
@@ -148,6 +161,19 @@ public:
    */
   Ptr<QueueLimits> GetQueueLimits ();
 
+  /**
+   * \brief Estimate how many packets can be sent to the device before this
+   *        queue is stopped, assuming MTU-sized packets
+   *
+   * Queue discs use this estimate to size their bulk dequeues. Both the
+   * room left in the queue connected through ConnectQueueTraces and the
+   * queue limits, if any, are taken into account.
+   *
+   * \return the number of packets, or the largest uint32_t value if no
+   *         queue has been connected and no queue limits are set
+   */
+  uint32_t GetAvailablePackets (void) const;
+
   /**
    * \brief Perform the actions required by flow control and dynamic queue
    *        limits when a packet is enqueued in the queue of a netdevice
@@ -206,9 +232,11 @@ public:
 private:
   bool m_stoppedByDevice;         //!< True if the queue has been stopped by the device
   bool m_stoppedByQueueLimits;    //!< True if the queue has been stopped by a queue limits object
+  bool m_completionByDevice;      //!< True if the device reports the transmitted bytes
   Ptr<QueueLimits> m_queueLimits; //!< Queue limits object
   WakeCallback m_wakeCallback;    //!< Wake callback
   Ptr<NetDevice> m_device;        //!< the netdevice aggregated to the NetDeviceQueueInterface
+  std::function<uint32_t (void)> m_availablePackets; //!< Room left in the connected queue, in packets
 
   NS_LOG_TEMPLATE_DECLARE;        //!< redefinition of the log component
 };
@@ -335,6 +363,21 @@ NetDeviceQueue::ConnectQueueTraces (Ptr<QueueType> queue)
   queue->TraceConnectWithoutContext ("DropBeforeEnqueue",
                                      MakeCallback (&NetDeviceQueue::PacketDiscarded<QueueType>, this)
                                      .Bind (PeekPointer (queue)));
+
+  // The queue is stopped when it cannot store another MTU-sized packet
+  QueueType* q = PeekPointer (queue);
+  m_availablePackets = [this, q] ()
+    {
+      uint32_t max = q->GetMaxSize ().GetValue ();
+      uint32_t current = q->GetCurrentSize ().GetValue ();
+      uint32_t room = (current < max ? max - current : 0);
+      if (q->GetMaxSize ().GetUnit () == QueueSizeUnit::BYTES)
+        {
+          NS_ASSERT_MSG (m_device, "Aggregated NetDevice not set");
+          room /= m_device->GetMtu ();
+        }
+      return room;
+    };
 }
 
 template <typename QueueType>
@@ -366,8 +409,11 @@ NetDeviceQueue::PacketDequeued (QueueType* queue, Ptr<const typename QueueType::
 {
   NS_LOG_FUNCTION (this << queue << item);
 
-  // Inform BQL
-  NotifyTransmittedBytes (item->GetSize ());
+  // Inform BQL, unless the device does on transmission completion
+  if (!m_completionByDevice)
+    {
+      NotifyTransmittedBytes (item->GetSize ());
+    }
 
   NS_ASSERT_MSG (m_device, "Aggregated NetDevice not set");
   Ptr<Packet> p = Create<Packet> (m_device->GetMtu ());
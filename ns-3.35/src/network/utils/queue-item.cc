@@ -21,6 +21,8 @@
 #include "queue-item.h"
 #include "ns3/packet.h"
 #include "ns3/log.h"
+#include "ipv4-address.h"
+#include "ipv6-address.h"
 
 namespace ns3 {
 
@@ -77,7 +79,10 @@ QueueDiscItem::QueueDiscItem (Ptr<Packet> p, const Address& addr, uint16_t proto
   : QueueItem (p),
     m_address (addr),
     m_protocol (protocol),
-    m_txq (0)
+    m_txq (0),
+    m_segmentSize (0),
+    m_flowHashSet (false),
+    m_flowHash (0)
 {
   NS_LOG_FUNCTION (this << p << addr << protocol);
 }
@@ -146,4 +151,90 @@ QueueDiscItem::Hash (uint32_t perturbation) const
   return 0;
 }
 
+uint32_t
+QueueDiscItem::GetFlowHash (void) const
+{
+  if (!m_flowHashSet)
+    {
+      m_flowHash = Hash (0);
+      m_flowHashSet = true;
+    }
+  return m_flowHash;
+}
+
+QueueDiscItem::FiveTuple::FiveTuple ()
+  : protocol (0),
+    sourcePort (0),
+    destinationPort (0)
+{
+}
+
+bool
+QueueDiscItem::GetFiveTuple (FiveTuple &tuple) const
+{
+  return false;
+}
+
+void
+QueueDiscItem::SetSegmentSize (uint16_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  m_segmentSize = size;
+}
+
+uint16_t
+QueueDiscItem::GetSegmentSize (void) const
+{
+  return m_segmentSize;
+}
+
+void
+QueueDiscItem::Segment (std::vector<Ptr<QueueDiscItem> > &segments)
+{
+  NS_LOG_WARN ("The Segment method should be redefined by subclasses");
+  segments.push_back (this);
+}
+
+bool
+operator == (const QueueDiscItem::FiveTuple &t1, const QueueDiscItem::FiveTuple &t2)
+{
+  return t1.protocol == t2.protocol
+         && t1.sourcePort == t2.sourcePort
+         && t1.destinationPort == t2.destinationPort
+         && t1.source == t2.source
+         && t1.destination == t2.destination;
+}
+
+/**
+ * \brief Print an address and a port
+ * \param os the output stream
+ * \param address the address
+ * \param port the port
+ */
+static void
+PrintEndpoint (std::ostream &os, const Address &address, uint16_t port)
+{
+  if (Ipv4Address::IsMatchingType (address))
+    {
+      os << Ipv4Address::ConvertFrom (address) << ":" << port;
+    }
+  else if (Ipv6Address::IsMatchingType (address))
+    {
+      os << "[" << Ipv6Address::ConvertFrom (address) << "]:" << port;
+    }
+  else
+    {
+      os << address << ":" << port;
+    }
+}
+
+std::ostream& operator<< (std::ostream& os, const QueueDiscItem::FiveTuple &tuple)
+{
+  PrintEndpoint (os, tuple.source, tuple.sourcePort);
+  os << " -> ";
+  PrintEndpoint (os, tuple.destination, tuple.destinationPort);
+  os << " proto " << (uint16_t) tuple.protocol;
+  return os;
+}
+
 } // namespace ns3
@@ -24,6 +24,7 @@
 #include "ns3/simple-ref-count.h"
 #include <ns3/address.h>
 #include "ns3/nstime.h"
+#include <vector>
 
 namespace ns3 {
 
@@ -226,6 +227,69 @@ public:
    */
   virtual uint32_t Hash (uint32_t perturbation = 0) const;
 
+  /**
+   * \brief Get the hash of the flow of this item, without perturbation
+   *
+   * The hash is computed by the Hash method the first time and kept in the
+   * item, hence it is computed once whatever the number of queue discs that
+   * need it.
+   *
+   * \return the hash of the flow of this item
+   */
+  uint32_t GetFlowHash (void) const;
+
+  /// The 5-tuple of the flow of a packet
+  struct FiveTuple
+  {
+    Address source;            //!< Source address
+    Address destination;       //!< Destination address
+    uint8_t protocol;          //!< Protocol number
+    uint16_t sourcePort;       //!< Source port, 0 if the protocol has none
+    uint16_t destinationPort;  //!< Destination port, 0 if the protocol has none
+
+    /// constructor
+    FiveTuple ();
+  };
+
+  /**
+   * \brief Get the 5-tuple of the flow of this item
+   *
+   * This method just returns false. Subclasses should fill in the fields
+   * their Hash method computes the hash of.
+   *
+   * \param tuple the 5-tuple, set if this method returns true
+   * \return true if the packet carries a 5-tuple
+   */
+  virtual bool GetFiveTuple (FiveTuple &tuple) const;
+
+  /**
+   * \brief Set the size of the segments a super-segment is split into
+   *
+   * Items carrying a segmentation offload super-segment are split into
+   * segments of this payload size when handed to the device.
+   *
+   * \param size the payload size of the segments, 0 if the item must not be split
+   */
+  void SetSegmentSize (uint16_t size);
+
+  /**
+   * \brief Get the size of the segments a super-segment is split into
+   * \return the payload size of the segments, 0 if the item must not be split
+   */
+  uint16_t GetSegmentSize (void) const;
+
+  /**
+   * \brief Split a super-segment into the items to send to the device
+   *
+   * This method is called on items whose segment size is not null, after
+   * the header has been added to the packet.  It just appends this item to
+   * the given vector.  Subclasses should split the packet into segments of
+   * the segment size, with their own headers, ready to be sent.
+   *
+   * \param segments the vector the segments are appended to
+   */
+  virtual void Segment (std::vector<Ptr<QueueDiscItem> > &segments);
+
 private:
   /**
    * \brief Default constructor
@@ -251,8 +315,32 @@ private:
   uint16_t m_protocol;    //!< L3 Protocol number
   uint8_t m_txq;          //!< Transmission queue index
   Time m_tstamp;          //!< timestamp when the packet was enqueued
+  uint16_t m_segmentSize; //!< Payload size of the segments of a super-segment
+  mutable bool m_flowHashSet;   //!< Whether the flow hash has been computed
+  mutable uint32_t m_flowHash;  //!< Hash of the flow, if computed
 };
 
+/**
+ * \brief Equality operator.
+ *
+ * \param t1 the first 5-tuple
+ * \param t2 the second 5-tuple
+ * \returns true if the two 5-tuples are equal
+ */
+bool operator == (const QueueDiscItem::FiveTuple &t1, const QueueDiscItem::FiveTuple &t2);
+
+/**
+ * \brief Stream insertion operator.
+ *
+ * A 5-tuple is printed as "10.1.1.1:49153 -> 10.1.2.2:5001 proto 6", IPv6
+ * addresses being enclosed in brackets.
+ *
+ * \param os the stream
+ * \param tuple the 5-tuple
+ * \returns a reference to the stream
+ */
+std::ostream& operator<< (std::ostream& os, const QueueDiscItem::FiveTuple &tuple);
+
 } // namespace ns3
 
 #endif /* QUEUE_ITEM_H */
@@ -218,6 +218,54 @@ PointToPointHelper::EnableAsciiInternal (
   Config::Connect (oss.str (), MakeBoundCallback (&AsciiTraceHelper::DefaultDropSinkWithContext, stream));
 }
 
+void 
+PointToPointHelper::EnableBinaryInternal (
+  Ptr<BinaryTraceFile> file, 
+  std::string prefix, 
+  Ptr<NetDevice> nd,
+  bool explicitFilename)
+{
+  Ptr<PointToPointNetDevice> device = nd->GetObject<PointToPointNetDevice> ();
+  if (device == 0)
+    {
+      NS_LOG_INFO ("PointToPointHelper::EnableBinaryInternal(): Device " << device << 
+                   " not of type ns3::PointToPointNetDevice");
+      return;
+    }
+
+  //
+  // Unlike the ascii sinks, the binary sinks do not need packet printing,
+  // and every record carries the node and device ids: a shared file needs
+  // no trace context, so we always connect without context.
+  //
+  if (file == 0)
+    {
+      BinaryTraceHelper binaryTraceHelper;
+
+      std::string filename;
+      if (explicitFilename)
+        {
+          filename = prefix;
+        }
+      else
+        {
+          filename = binaryTraceHelper.GetFilenameFromDevice (prefix, device);
+        }
+
+      file = binaryTraceHelper.CreateFile (filename, PcapHelper::DLT_PPP);
+    }
+
+  uint32_t nodeid = nd->GetNode ()->GetId ();
+  uint32_t deviceid = nd->GetIfIndex ();
+  Ptr<Queue<Packet> > queue = device->GetQueue ();
+
+  device->TraceConnectWithoutContext ("MacRx", MakeBoundCallback (&BinaryTraceHelper::DefaultReceiveSink, file, nodeid, deviceid));
+  queue->TraceConnectWithoutContext ("Enqueue", MakeBoundCallback (&BinaryTraceHelper::DefaultEnqueueSink, file, nodeid, deviceid));
+  queue->TraceConnectWithoutContext ("Dequeue", MakeBoundCallback (&BinaryTraceHelper::DefaultDequeueSink, file, nodeid, deviceid));
+  queue->TraceConnectWithoutContext ("Drop", MakeBoundCallback (&BinaryTraceHelper::DefaultDropSink, file, nodeid, deviceid));
+  device->TraceConnectWithoutContext ("PhyRxDrop", MakeBoundCallback (&BinaryTraceHelper::DefaultDropSink, file, nodeid, deviceid));
+}
+
 NetDeviceContainer 
 PointToPointHelper::Install (NodeContainer c)
 {
@@ -37,11 +37,12 @@ class Node;
  * \brief Build a set of PointToPointNetDevice objects
  *
  * Normally we eschew multiple inheritance, however, the classes 
- * PcapUserHelperForDevice and AsciiTraceUserHelperForDevice are
- * "mixins".
+ * PcapUserHelperForDevice, AsciiTraceUserHelperForDevice and
+ * BinaryTraceHelperForDevice are "mixins".
  */
 class PointToPointHelper : public PcapHelperForDevice,
-	                   public AsciiTraceHelperForDevice
+	                   public AsciiTraceHelperForDevice,
+	                   public BinaryTraceHelperForDevice
 {
 public:
   /**
@@ -181,6 +182,23 @@ private:
     Ptr<NetDevice> nd,
     bool explicitFilename);
 
+  /**
+   * \brief Enable binary trace output on the indicated net device.
+   *
+   * NetDevice-specific implementation mechanism for hooking the trace and
+   * writing to the trace file.
+   *
+   * \param file The binary trace file to use, or null to create one per device.
+   * \param prefix Filename prefix to use for binary trace files.
+   * \param nd Net device for which you want to enable tracing.
+   * \param explicitFilename Treat the prefix as an explicit filename if true
+   */
+  virtual void EnableBinaryInternal (
+    Ptr<BinaryTraceFile> file,
+    std::string prefix,
+    Ptr<NetDevice> nd,
+    bool explicitFilename);
+
   ObjectFactory m_queueFactory;         //!< Queue Factory
   ObjectFactory m_channelFactory;       //!< Channel Factory
   ObjectFactory m_deviceFactory;        //!< Device Factory
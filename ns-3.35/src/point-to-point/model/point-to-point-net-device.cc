@@ -23,6 +23,8 @@
 #include "ns3/llc-snap-header.h"
 #include "ns3/error-model.h"
 #include "ns3/trace-source-accessor.h"
+#include "ns3/packet-burst.h"
+#include "ns3/net-device-queue-interface.h"
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
 #include "point-to-point-net-device.h"
@@ -215,9 +217,29 @@ PointToPointNetDevice::DoDispose ()
   m_receiveErrorModel = 0;
   m_currentPkt = 0;
   m_queue = 0;
+  m_txQueue = 0;
   NetDevice::DoDispose ();
 }
 
+void
+PointToPointNetDevice::NotifyNewAggregate (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_txQueue == 0)
+    {
+      Ptr<NetDeviceQueueInterface> ndqi = GetObject<NetDeviceQueueInterface> ();
+      if (ndqi != 0)
+        {
+          // The bytes of a packet are reported as transmitted to the queue
+          // limits (BQL) by TransmitComplete, rather than when the packet
+          // leaves the device queue
+          m_txQueue = ndqi->GetTxQueue (0);
+          m_txQueue->SetCompletionByDevice (true);
+        }
+    }
+  NetDevice::NotifyNewAggregate ();
+}
+
 void
 PointToPointNetDevice::SetDataRate (DataRate bps)
 {
@@ -279,6 +301,10 @@ PointToPointNetDevice::TransmitComplete (void)
   NS_ASSERT_MSG (m_currentPkt != 0, "PointToPointNetDevice::TransmitComplete(): m_currentPkt zero");
 
   m_phyTxEndTrace (m_currentPkt);
+  if (m_txQueue != 0)
+    {
+      m_txQueue->NotifyTransmittedBytes (m_currentPkt->GetSize ());
+    }
   m_currentPkt = 0;
 
   Ptr<Packet> p = m_queue->Dequeue ();
@@ -523,6 +549,14 @@ PointToPointNetDevice::Send (
       return false;
     }
 
+  return EnqueueAndTransmit (packet, protocolNumber);
+}
+
+bool
+PointToPointNetDevice::EnqueueAndTransmit (Ptr<Packet> packet, uint16_t protocolNumber)
+{
+  NS_LOG_FUNCTION (this << packet << protocolNumber);
+
   //
   // Stick a point to point protocol header on the packet in preparation for
   // shoving it out the door.
@@ -556,6 +590,40 @@ PointToPointNetDevice::Send (
   return false;
 }
 
+uint32_t
+PointToPointNetDevice::SendBatch (Ptr<PacketBurst> burst, const Address &dest, uint16_t protocolNumber)
+{
+  NS_LOG_FUNCTION (this << burst << dest << protocolNumber);
+
+  if (IsLinkUp () == false)
+    {
+      for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); i++)
+        {
+          m_macTxDropTrace (*i);
+        }
+      return burst->GetNPackets ();
+    }
+
+  //
+  // Same as calling Send on each packet, except that the link state is only
+  // checked once and that we stop as soon as the enqueued packets stop the
+  // transmission queue.
+  //
+  uint32_t nSent = 0;
+  for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); i++)
+    {
+      if (m_txQueue && m_txQueue->IsStopped ())
+        {
+          break;
+        }
+      nSent++;
+
+      NS_LOG_LOGIC ("UID is " << (*i)->GetUid ());
+      EnqueueAndTransmit (*i, protocolNumber);
+    }
+  return nSent;
+}
+
 bool
 PointToPointNetDevice::SendFrom (Ptr<Packet> packet, 
                                  const Address &source, 
@@ -36,6 +36,7 @@ namespace ns3 {
 template <typename Item> class Queue;
 class PointToPointChannel;
 class ErrorModel;
+class NetDeviceQueue;
 
 /**
  * \defgroup point-to-point Point-To-Point Network Device
@@ -177,6 +178,7 @@ public:
 
   virtual bool Send (Ptr<Packet> packet, const Address &dest, uint16_t protocolNumber);
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber);
+  virtual uint32_t SendBatch (Ptr<PacketBurst> burst, const Address &dest, uint16_t protocolNumber);
 
   virtual Ptr<Node> GetNode (void) const;
   virtual void SetNode (Ptr<Node> node);
@@ -224,6 +226,12 @@ private:
    */
   virtual void DoDispose (void);
 
+  /**
+   * \brief Keep the transmission queue of the NetDeviceQueueInterface, when
+   *        aggregated, to report the completed transmissions to its queue limits
+   */
+  virtual void NotifyNewAggregate (void);
+
 private:
 
   /**
@@ -250,6 +258,18 @@ private:
    */
   bool ProcessHeader (Ptr<Packet> p, uint16_t& param);
 
+  /**
+   * Add the point to point header to a packet, enqueue it and start its
+   * transmission if the channel is ready.  Shared by Send and SendBatch,
+   * which check the link state first.
+   *
+   * \param packet the packet to send
+   * \param protocolNumber protocol number
+   * \returns false if the packet was dropped by the queue or could not be
+   * transmitted, true otherwise
+   */
+  bool EnqueueAndTransmit (Ptr<Packet> packet, uint16_t protocolNumber);
+
   /**
    * Start Sending a Packet Down the Wire.
    *
@@ -456,6 +476,7 @@ private:
   uint32_t m_mtu;
 
   Ptr<Packet> m_currentPkt; //!< Current packet processed
+  Ptr<NetDeviceQueue> m_txQueue; //!< Transmission queue of the aggregated NetDeviceQueueInterface
 
   /**
    * \brief PPP to Ethernet protocol number mapping
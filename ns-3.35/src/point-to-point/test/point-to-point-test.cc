@@ -24,6 +24,8 @@
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/dynamic-queue-limits.h"
+#include "ns3/data-rate.h"
 
 #include <string>
 
@@ -130,6 +132,99 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \brief Test the byte queue limits of a PointToPoint device
+ *
+ * The transmitted bytes are reported to the queue limits when the
+ * transmission completes, hence the packet on the wire keeps the
+ * transmission queue stopped while the queue limits are exceeded.
+ */
+class PointToPointBqlTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointBqlTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Send a packet and check the state of the transmission queue
+   *
+   * \param device the sending device
+   */
+  void SendAndCheck (Ptr<PointToPointNetDevice> device);
+  /**
+   * \brief Check the state of the transmission queue after the transmission
+   *
+   * \param device the sending device
+   */
+  void CheckCompleted (Ptr<PointToPointNetDevice> device);
+};
+
+PointToPointBqlTest::PointToPointBqlTest ()
+  : TestCase ("PointToPoint byte queue limits")
+{
+}
+
+void
+PointToPointBqlTest::SendAndCheck (Ptr<PointToPointNetDevice> device)
+{
+  Ptr<NetDeviceQueue> txq = device->GetObject<NetDeviceQueueInterface> ()->GetTxQueue (0);
+  bool sent = device->Send (Create<Packet> (1000), device->GetBroadcast (), 0x800);
+  NS_TEST_EXPECT_MSG_EQ (sent, true, "The packet should have been sent");
+  NS_TEST_EXPECT_MSG_EQ (device->GetQueue ()->GetNPackets (), 0, "The packet should be on the wire");
+  NS_TEST_EXPECT_MSG_EQ (txq->IsStopped (), true,
+                         "The packet on the wire should exceed the queue limits");
+}
+
+void
+PointToPointBqlTest::CheckCompleted (Ptr<PointToPointNetDevice> device)
+{
+  Ptr<NetDeviceQueue> txq = device->GetObject<NetDeviceQueueInterface> ()->GetTxQueue (0);
+  NS_TEST_EXPECT_MSG_EQ (txq->IsStopped (), false,
+                         "The transmission queue should be woken up after the transmission");
+}
+
+void
+PointToPointBqlTest::DoRun (void)
+{
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetDataRate (DataRate ("8Mbps"));
+  Ptr<Queue<Packet> > queueA = CreateObject<DropTailQueue<Packet> > ();
+  devA->SetQueue (queueA);
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+
+  Ptr<NetDeviceQueueInterface> ndqi = CreateObject<NetDeviceQueueInterface> ();
+  ndqi->GetTxQueue (0)->ConnectQueueTraces (queueA);
+  devA->AggregateObject (ndqi);
+  ndqi->GetTxQueue (0)->SetQueueLimits (CreateObject<DynamicQueueLimits> ());
+
+  // a 1002 byte frame takes about 1 ms at 8 Mbps
+  Simulator::Schedule (Seconds (1.0), &PointToPointBqlTest::SendAndCheck, this, devA);
+  Simulator::Schedule (Seconds (1.01), &PointToPointBqlTest::CheckCompleted, this, devA);
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
 /**
  * \brief TestSuite for PointToPoint module
  */
@@ -146,6 +241,7 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+  AddTestCase (new PointToPointBqlTest, TestCase::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite; //!< The testsuite
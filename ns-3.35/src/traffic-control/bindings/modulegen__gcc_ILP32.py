@@ -4128,38 +4128,66 @@ def register_Ns3QueueDiscStats_methods(root_module, cls):
                    'uint64_t', 
                    [param('std::string', 'reason')], 
                    is_const=True)
+    ## queue-disc.h (module 'traffic-control'): std::map< std::string, unsigned long long > ns3::QueueDisc::Stats::GetNDroppedBytesAfterDequeue() const [member function]
+    cls.add_method('GetNDroppedBytesAfterDequeue', 
+                   'std::map< std::string, unsigned long long >', 
+                   [], 
+                   is_const=True)
+    ## queue-disc.h (module 'traffic-control'): std::map< std::string, unsigned long long > ns3::QueueDisc::Stats::GetNDroppedBytesBeforeEnqueue() const [member function]
+    cls.add_method('GetNDroppedBytesBeforeEnqueue', 
+                   'std::map< std::string, unsigned long long >', 
+                   [], 
+                   is_const=True)
     ## queue-disc.h (module 'traffic-control'): uint32_t ns3::QueueDisc::Stats::GetNDroppedPackets(std::string reason) const [member function]
     cls.add_method('GetNDroppedPackets', 
                    'uint32_t', 
                    [param('std::string', 'reason')], 
                    is_const=True)
+    ## queue-disc.h (module 'traffic-control'): std::map< std::string, unsigned int > ns3::QueueDisc::Stats::GetNDroppedPacketsAfterDequeue() const [member function]
+    cls.add_method('GetNDroppedPacketsAfterDequeue', 
+                   'std::map< std::string, unsigned int >', 
+                   [], 
+                   is_const=True)
+    ## queue-disc.h (module 'traffic-control'): std::map< std::string, unsigned int > ns3::QueueDisc::Stats::GetNDroppedPacketsBeforeEnqueue() const [member function]
+    cls.add_method('GetNDroppedPacketsBeforeEnqueue', 
+                   'std::map< std::string, unsigned int >', 
+                   [], 
+                   is_const=True)
     ## queue-disc.h (module 'traffic-control'): uint64_t ns3::QueueDisc::Stats::GetNMarkedBytes(std::string reason) const [member function]
     cls.add_method('GetNMarkedBytes', 
                    'uint64_t', 
                    [param('std::string', 'reason')], 
                    is_const=True)
+    ## queue-disc.h (module 'traffic-control'): std::map< std::string, unsigned long long > ns3::QueueDisc::Stats::GetNMarkedBytes() const [member function]
+    cls.add_method('GetNMarkedBytes', 
+                   'std::map< std::string, unsigned long long >', 
+                   [], 
+                   is_const=True)
     ## queue-disc.h (module 'traffic-control'): uint32_t ns3::QueueDisc::Stats::GetNMarkedPackets(std::string reason) const [member function]
     cls.add_method('GetNMarkedPackets', 
                    'uint32_t', 
                    [param('std::string', 'reason')], 
                    is_const=True)
+    ## queue-disc.h (module 'traffic-control'): std::map< std::string, unsigned int > ns3::QueueDisc::Stats::GetNMarkedPackets() const [member function]
+    cls.add_method('GetNMarkedPackets', 
+                   'std::map< std::string, unsigned int >', 
+                   [], 
+                   is_const=True)
+    ## queue-disc.h (module 'traffic-control'): static uint32_t ns3::QueueDisc::Stats::GetReasonId(std::string const & reason) [member function]
+    cls.add_method('GetReasonId', 
+                   'uint32_t', 
+                   [param('std::string const &', 'reason')], 
+                   is_static=True)
+    ## queue-disc.h (module 'traffic-control'): static std::string const & ns3::QueueDisc::Stats::GetReasonName(uint32_t id) [member function]
+    cls.add_method('GetReasonName', 
+                   'std::string const &', 
+                   [param('uint32_t', 'id')], 
+                   is_static=True)
     ## queue-disc.h (module 'traffic-control'): void ns3::QueueDisc::Stats::Print(std::ostream & os) const [member function]
     cls.add_method('Print', 
                    'void', 
                    [param('std::ostream &', 'os')], 
                    is_const=True)
-    ## queue-disc.h (module 'traffic-control'): ns3::QueueDisc::Stats::nDroppedBytesAfterDequeue [variable]
-    cls.add_instance_attribute('nDroppedBytesAfterDequeue', 'std::map< std::string, unsigned long long >', is_const=False)
-    ## queue-disc.h (module 'traffic-control'): ns3::QueueDisc::Stats::nDroppedBytesBeforeEnqueue [variable]
-    cls.add_instance_attribute('nDroppedBytesBeforeEnqueue', 'std::map< std::string, unsigned long long >', is_const=False)
-    ## queue-disc.h (module 'traffic-control'): ns3::QueueDisc::Stats::nDroppedPacketsAfterDequeue [variable]
-    cls.add_instance_attribute('nDroppedPacketsAfterDequeue', 'std::map< std::string, unsigned int >', is_const=False)
-    ## queue-disc.h (module 'traffic-control'): ns3::QueueDisc::Stats::nDroppedPacketsBeforeEnqueue [variable]
-    cls.add_instance_attribute('nDroppedPacketsBeforeEnqueue', 'std::map< std::string, unsigned int >', is_const=False)
-    ## queue-disc.h (module 'traffic-control'): ns3::QueueDisc::Stats::nMarkedBytes [variable]
-    cls.add_instance_attribute('nMarkedBytes', 'std::map< std::string, unsigned long long >', is_const=False)
-    ## queue-disc.h (module 'traffic-control'): ns3::QueueDisc::Stats::nMarkedPackets [variable]
-    cls.add_instance_attribute('nMarkedPackets', 'std::map< std::string, unsigned int >', is_const=False)
     ## queue-disc.h (module 'traffic-control'): ns3::QueueDisc::Stats::nTotalDequeuedBytes [variable]
     cls.add_instance_attribute('nTotalDequeuedBytes', 'uint64_t', is_const=False)
     ## queue-disc.h (module 'traffic-control'): ns3::QueueDisc::Stats::nTotalDequeuedPackets [variable]
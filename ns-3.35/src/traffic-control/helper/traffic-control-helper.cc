@@ -25,6 +25,7 @@
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
 #include "ns3/traffic-control-layer.h"
+#include "ns3/shared-buffer-manager.h"
 #include "traffic-control-helper.h"
 
 namespace ns3 {
@@ -241,6 +242,19 @@ TrafficControlHelper::Install (Ptr<NetDevice> d)
         }
     }
 
+  // All the root queue discs of a node draw from the same shared buffer
+  if (m_sharedBufferFactory.GetTypeId ().GetUid () && container.GetN () > 0)
+    {
+      Ptr<Node> node = d->GetNode ();
+      Ptr<SharedBufferManager> buffer = node->GetObject<SharedBufferManager> ();
+      if (!buffer)
+        {
+          buffer = m_sharedBufferFactory.Create<SharedBufferManager> ();
+          node->AggregateObject (buffer);
+        }
+      buffer->AddQueueDisc (m_queueDiscs[0]);
+    }
+
   return container;
 }
 
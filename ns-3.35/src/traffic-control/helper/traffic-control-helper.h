@@ -239,6 +239,18 @@ public:
   template <typename... Args>
   void SetQueueLimits (std::string type, Args&&... args);
 
+  /**
+   * Helper function used to make the root queue discs installed on the devices
+   * of a node draw their packets from a shared buffer. The SharedBufferManager
+   * aggregated to the node is used, or created with the given attributes and
+   * aggregated to the node if there is none.
+   *
+   * \tparam Args \deduced Template type parameter pack for the sequence of name-value pairs.
+   * \param args A sequence of name-value pairs of the attributes to set.
+   */
+  template <typename... Args>
+  void SetSharedBuffer (Args&&... args);
+
   /**
    * \param c set of devices
    * \returns a QueueDisc container with the root queue discs installed on the devices
@@ -252,7 +264,8 @@ public:
    * internal queues, classes) configured with the methods provided by this
    * class and installs them on each device in the given container. Additionally,
    * if configured, a queue limits object is installed on each transmission queue
-   * of the devices.
+   * of the devices, and the root queue discs are added to the shared buffer of
+   * their node.
    */
   QueueDiscContainer Install (NetDeviceContainer c);
 
@@ -263,7 +276,8 @@ public:
    * This method creates the queue discs (along with their packet filters,
    * internal queues, classes) configured with the methods provided by this
    * class and installs them on the given device. Additionally, if configured,
-   * a queue limits object is installed on each transmission queue of the device.
+   * a queue limits object is installed on each transmission queue of the device,
+   * and the root queue disc is added to the shared buffer of the node.
    */
   QueueDiscContainer Install (Ptr<NetDevice> d);
 
@@ -344,6 +358,8 @@ private:
   std::vector<Ptr<QueueDisc> > m_queueDiscs;
   /// Factory to create a queue limits object
   ObjectFactory m_queueLimitsFactory;
+  /// Factory to create a shared buffer manager
+  ObjectFactory m_sharedBufferFactory;
 };
 
 } // namespace ns3
@@ -410,6 +426,14 @@ TrafficControlHelper::SetQueueLimits (std::string type, Args&&... args)
   m_queueLimitsFactory.Set (args...);
 }
 
+template <typename... Args>
+void
+TrafficControlHelper::SetSharedBuffer (Args&&... args)
+{
+  m_sharedBufferFactory.SetTypeId ("ns3::SharedBufferManager");
+  m_sharedBufferFactory.Set (args...);
+}
+
 } // namespace ns3
 
 #endif /* TRAFFIC_CONTROL_HELPER_H */
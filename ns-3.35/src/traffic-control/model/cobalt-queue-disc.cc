@@ -42,6 +42,15 @@ NS_LOG_COMPONENT_DEFINE ("CobaltQueueDisc");
 
 NS_OBJECT_ENSURE_REGISTERED (CobaltQueueDisc);
 
+/// Interned CobaltQueueDisc::OVERLIMIT_DROP
+static const QueueDiscReason g_overlimitDrop (CobaltQueueDisc::OVERLIMIT_DROP);
+/// Interned CobaltQueueDisc::TARGET_EXCEEDED_DROP
+static const QueueDiscReason g_targetExceededDrop (CobaltQueueDisc::TARGET_EXCEEDED_DROP);
+/// Interned CobaltQueueDisc::CE_THRESHOLD_EXCEEDED_MARK
+static const QueueDiscReason g_ceThresholdExceededMark (CobaltQueueDisc::CE_THRESHOLD_EXCEEDED_MARK);
+/// Interned CobaltQueueDisc::FORCED_MARK
+static const QueueDiscReason g_forcedMark (CobaltQueueDisc::FORCED_MARK);
+
 TypeId CobaltQueueDisc::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::CobaltQueueDisc")
@@ -345,7 +354,7 @@ CobaltQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
       int64_t now = CoDelGetTime ();
       // Call this to update Blue's drop probability
       CobaltQueueFull (now);
-      DropBeforeEnqueue (item, OVERLIMIT_DROP);
+      DropBeforeEnqueue (item, g_overlimitDrop);
       return false;
     }
 
@@ -391,7 +400,7 @@ CobaltQueueDisc::DoDequeue (void)
 
       if (drop)
         {
-          DropAfterDequeue (item, TARGET_EXCEEDED_DROP);
+          DropAfterDequeue (item, g_targetExceededDrop);
         }
       else
         {
@@ -469,7 +478,7 @@ bool CobaltQueueDisc::CobaltShouldDrop (Ptr<QueueDiscItem> item, int64_t now)
             {
               NS_LOG_DEBUG ("CE packet " << static_cast<uint16_t> (tosByte & 0x3));
             }
-          if (CoDelTimeAfter (sojournTime, Time2CoDel (m_ceThreshold)) && Mark (item, CE_THRESHOLD_EXCEEDED_MARK))
+          if (CoDelTimeAfter (sojournTime, Time2CoDel (m_ceThreshold)) && Mark (item, g_ceThresholdExceededMark))
             {
               NS_LOG_LOGIC ("Marking due to CeThreshold " << m_ceThreshold.GetSeconds ());
             }
@@ -498,7 +507,7 @@ bool CobaltQueueDisc::CobaltShouldDrop (Ptr<QueueDiscItem> item, int64_t now)
     {
       /* Check for marking possibility only if BLUE decides NOT to drop. */
       /* Check if router and packet, both have ECN enabled. Only if this is true, mark the packet. */
-      isMarked = (m_useEcn && Mark (item, FORCED_MARK));
+      isMarked = (m_useEcn && Mark (item, g_forcedMark));
       drop = !isMarked;
 
       m_count = max (m_count, m_count + 1);
@@ -522,7 +531,7 @@ bool CobaltQueueDisc::CobaltShouldDrop (Ptr<QueueDiscItem> item, int64_t now)
   // If CE threshold is enabled then isMarked flag is used to determine whether
   // packet is marked and if the packet is marked then a second attempt at marking should be suppressed.
   // If UseL4S attribute is enabled then ECT0 packets should not be marked.
-  if (!isMarked && !m_useL4s && m_useEcn && CoDelTimeAfter (sojournTime, Time2CoDel (m_ceThreshold)) && Mark (item, CE_THRESHOLD_EXCEEDED_MARK))
+  if (!isMarked && !m_useL4s && m_useEcn && CoDelTimeAfter (sojournTime, Time2CoDel (m_ceThreshold)) && Mark (item, g_ceThresholdExceededMark))
     {
       NS_LOG_LOGIC ("Marking due to CeThreshold " << m_ceThreshold.GetSeconds ());
     }
@@ -67,6 +67,15 @@ static uint32_t CoDelGetTime (void)
 
 NS_OBJECT_ENSURE_REGISTERED (CoDelQueueDisc);
 
+/// Interned CoDelQueueDisc::OVERLIMIT_DROP
+static const QueueDiscReason g_overlimitDrop (CoDelQueueDisc::OVERLIMIT_DROP);
+/// Interned CoDelQueueDisc::CE_THRESHOLD_EXCEEDED_MARK
+static const QueueDiscReason g_ceThresholdExceededMark (CoDelQueueDisc::CE_THRESHOLD_EXCEEDED_MARK);
+/// Interned CoDelQueueDisc::TARGET_EXCEEDED_MARK
+static const QueueDiscReason g_targetExceededMark (CoDelQueueDisc::TARGET_EXCEEDED_MARK);
+/// Interned CoDelQueueDisc::TARGET_EXCEEDED_DROP
+static const QueueDiscReason g_targetExceededDrop (CoDelQueueDisc::TARGET_EXCEEDED_DROP);
+
 TypeId CoDelQueueDisc::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::CoDelQueueDisc")
@@ -175,7 +184,7 @@ CoDelQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
   if (GetCurrentSize () + item > GetMaxSize ())
     {
       NS_LOG_LOGIC ("Queue full -- dropping pkt");
-      DropBeforeEnqueue (item, OVERLIMIT_DROP);
+      DropBeforeEnqueue (item, g_overlimitDrop);
       return false;
     }
 
@@ -259,7 +268,7 @@ CoDelQueueDisc::DoDequeue (void)
               NS_LOG_DEBUG ("CE packet " << static_cast<uint16_t> (tosByte & 0x3));
             }
 
-          if (CoDelTimeAfter (ldelay, Time2CoDel (m_ceThreshold)) && Mark (item, CE_THRESHOLD_EXCEEDED_MARK))
+          if (CoDelTimeAfter (ldelay, Time2CoDel (m_ceThreshold)) && Mark (item, g_ceThresholdExceededMark))
             {
               NS_LOG_LOGIC ("Marking due to CeThreshold " << m_ceThreshold.GetSeconds ());
             }
@@ -299,7 +308,7 @@ CoDelQueueDisc::DoDequeue (void)
               // A large amount of packets in queue might result in drop
               // rates so high that the next drop should happen now,
               // hence the while loop.
-              if (m_useEcn && Mark (item, TARGET_EXCEEDED_MARK))
+              if (m_useEcn && Mark (item, g_targetExceededMark))
                 {
                   isMarked = true;
                   NS_LOG_LOGIC ("Sojourn time is still above target and it's time for next drop or mark; marking " << item);
@@ -309,7 +318,7 @@ CoDelQueueDisc::DoDequeue (void)
                   goto end;
                 }
               NS_LOG_LOGIC ("Sojourn time is still above target and it's time for next drop; dropping " << item);
-              DropAfterDequeue (item, TARGET_EXCEEDED_DROP);
+              DropAfterDequeue (item, g_targetExceededDrop);
 
               item = GetInternalQueue (0)->Dequeue ();
 
@@ -343,7 +352,7 @@ CoDelQueueDisc::DoDequeue (void)
       NS_LOG_LOGIC ("Not in dropping state; decide if we have to enter the state and drop the first packet");
       if (okToDrop)
         {
-          if (m_useEcn && Mark (item, TARGET_EXCEEDED_MARK))
+          if (m_useEcn && Mark (item, g_targetExceededMark))
             {
               isMarked = true;
               NS_LOG_LOGIC ("Sojourn time goes above target, marking the first packet " << item << " and entering the dropping state");
@@ -352,7 +361,7 @@ CoDelQueueDisc::DoDequeue (void)
             {
               // Drop the first packet and enter dropping state unless the queue is empty
               NS_LOG_LOGIC ("Sojourn time goes above target, dropping the first packet " << item << " and entering the dropping state");
-              DropAfterDequeue (item, TARGET_EXCEEDED_DROP);
+              DropAfterDequeue (item, g_targetExceededDrop);
               item = GetInternalQueue (0)->Dequeue ();
               if (item)
                 {
@@ -391,7 +400,7 @@ CoDelQueueDisc::DoDequeue (void)
   // according to the target delay above. If the ns-3 code were to do the same here,
   // it would result in two counts of mark in the queue statistics. Therefore, we
   // use the isMarked flag to suppress a second attempt at marking.
-  if (!isMarked && item && !m_useL4s && m_useEcn && CoDelTimeAfter (ldelay, Time2CoDel (m_ceThreshold)) && Mark (item, CE_THRESHOLD_EXCEEDED_MARK))
+  if (!isMarked && item && !m_useL4s && m_useEcn && CoDelTimeAfter (ldelay, Time2CoDel (m_ceThreshold)) && Mark (item, g_ceThresholdExceededMark))
     {
       NS_LOG_LOGIC ("Marking due to CeThreshold " << m_ceThreshold.GetSeconds ());
     }
@@ -0,0 +1,346 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/uinteger.h"
+#include "ns3/object-factory.h"
+#include "ns3/drop-tail-queue.h"
+#include "dwrr-queue-disc.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("DwrrQueueDisc");
+
+NS_OBJECT_ENSURE_REGISTERED (DwrrQueueDisc);
+
+/// Interned DwrrQueueDisc::LIMIT_EXCEEDED_DROP
+static const QueueDiscReason g_limitExceededDrop (DwrrQueueDisc::LIMIT_EXCEEDED_DROP);
+/// Interned DwrrQueueDisc::THRESHOLD_MARK
+static const QueueDiscReason g_thresholdMark (DwrrQueueDisc::THRESHOLD_MARK);
+/// Interned DwrrQueueDisc::THRESHOLD_DROP
+static const QueueDiscReason g_thresholdDrop (DwrrQueueDisc::THRESHOLD_DROP);
+
+TypeId DwrrQueueDisc::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::DwrrQueueDisc")
+    .SetParent<QueueDisc> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<DwrrQueueDisc> ()
+    .AddAttribute ("MaxSize",
+                   "The max queue size",
+                   QueueSizeValue (QueueSize ("1000p")),
+                   MakeQueueSizeAccessor (&QueueDisc::SetMaxSize,
+                                          &QueueDisc::GetMaxSize),
+                   MakeQueueSizeChecker ())
+    .AddAttribute ("Classes",
+                   "The number of classes",
+                   UintegerValue (8),
+                   MakeUintegerAccessor (&DwrrQueueDisc::m_nClasses),
+                   MakeUintegerChecker<uint32_t> (1, MAX_CLASSES))
+    .AddAttribute ("DefaultClass",
+                   "The class of the packets with an unmapped DSCP",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&DwrrQueueDisc::m_defaultClass),
+                   MakeUintegerChecker<uint32_t> (0, MAX_CLASSES - 1))
+    .AddAttribute ("Quantum",
+                   "The bytes a class can send per round, unless set for the class",
+                   UintegerValue (1500),
+                   MakeUintegerAccessor (&DwrrQueueDisc::m_quantum),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("MarkingThreshold",
+                   "The class queue length from which the packets are marked, "
+                   "unless set for the class, no marking if zero",
+                   QueueSizeValue (QueueSize ("0p")),
+                   MakeQueueSizeAccessor (&DwrrQueueDisc::m_threshold),
+                   MakeQueueSizeChecker ())
+  ;
+  return tid;
+}
+
+DwrrQueueDisc::DwrrQueueDisc ()
+  : QueueDisc (QueueDiscSizePolicy::MULTIPLE_QUEUES),
+    m_strictActive (0),
+    m_rrActive (0),
+    m_rrCurrent (0)
+{
+  NS_LOG_FUNCTION (this);
+  for (auto &c : m_classes)
+    {
+      c.quantum = 0;
+      c.deficit = 0;
+      c.strict = false;
+      c.hasThreshold = false;
+      c.markLimit = 0;
+      c.markInBytes = false;
+    }
+  m_dscpClass.fill (MAX_CLASSES);
+}
+
+DwrrQueueDisc::~DwrrQueueDisc ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+DwrrQueueDisc::SetDscpClass (uint8_t dscp, uint32_t cls)
+{
+  NS_LOG_FUNCTION (this << +dscp << cls);
+  NS_ASSERT (dscp < 64 && cls < MAX_CLASSES);
+  m_dscpClass[dscp] = cls;
+}
+
+uint32_t
+DwrrQueueDisc::GetDscpClass (uint8_t dscp) const
+{
+  NS_ASSERT (dscp < 64);
+  return m_dscpClass[dscp] < m_nClasses ? m_dscpClass[dscp] : m_defaultClass;
+}
+
+void
+DwrrQueueDisc::SetQuantum (uint32_t cls, uint32_t quantum)
+{
+  NS_LOG_FUNCTION (this << cls << quantum);
+  NS_ASSERT (cls < MAX_CLASSES);
+  m_classes[cls].quantum = quantum;
+}
+
+uint32_t
+DwrrQueueDisc::GetQuantum (uint32_t cls) const
+{
+  NS_ASSERT (cls < MAX_CLASSES);
+  return m_classes[cls].quantum ? m_classes[cls].quantum : m_quantum;
+}
+
+void
+DwrrQueueDisc::SetStrictPriority (uint32_t cls, bool strict)
+{
+  NS_LOG_FUNCTION (this << cls << strict);
+  NS_ASSERT (cls < MAX_CLASSES);
+  NS_ABORT_MSG_IF (GetNPackets () > 0, "Cannot change the scheduling of a class with packets queued");
+  m_classes[cls].strict = strict;
+}
+
+void
+DwrrQueueDisc::SetMarkingThreshold (uint32_t cls, QueueSize threshold)
+{
+  NS_LOG_FUNCTION (this << cls << threshold);
+  NS_ASSERT (cls < MAX_CLASSES);
+  Class &c = m_classes[cls];
+  c.hasThreshold = true;
+  c.threshold = threshold;
+  c.markLimit = threshold.GetValue ();
+  c.markInBytes = (threshold.GetUnit () == QueueSizeUnit::BYTES);
+}
+
+uint32_t
+DwrrQueueDisc::Classify (Ptr<const QueueDiscItem> item) const
+{
+  uint8_t tosByte;
+  if (item->GetUint8Value (QueueItem::IP_DSFIELD, tosByte))
+    {
+      uint8_t cls = m_dscpClass[tosByte >> 2];
+      if (cls < m_nClasses)
+        {
+          return cls;
+        }
+    }
+  return m_defaultClass;
+}
+
+uint32_t
+DwrrQueueDisc::NextRoundRobinClass (void) const
+{
+  NS_ASSERT (m_rrActive != 0);
+  // the active classes after the current one, if any, otherwise wrap around
+  uint32_t after = m_rrCurrent + 1 < MAX_CLASSES ? m_rrActive & ~((1u << (m_rrCurrent + 1)) - 1) : 0;
+  return __builtin_ctz (after ? after : m_rrActive);
+}
+
+bool
+DwrrQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  if (GetCurrentSize () + item > GetMaxSize ())
+    {
+      NS_LOG_LOGIC ("Queue full -- dropping pkt");
+      DropBeforeEnqueue (item, g_limitExceededDrop);
+      return false;
+    }
+
+  uint32_t cls = Classify (item);
+  Class &c = m_classes[cls];
+  Ptr<InternalQueue> queue = GetInternalQueue (cls);
+
+  if (c.markLimit > 0
+      && (c.markInBytes ? queue->GetNBytes () : queue->GetNPackets ()) >= c.markLimit
+      && !Mark (item, g_thresholdMark))
+    {
+      NS_LOG_LOGIC ("Above the threshold of class " << cls << ", not ECN capable -- dropping pkt");
+      DropBeforeEnqueue (item, g_thresholdDrop);
+      return false;
+    }
+
+  // If Queue::Enqueue fails, QueueDisc::DropBeforeEnqueue is called by the
+  // internal queue because QueueDisc::AddInternalQueue sets the trace callback
+  if (!queue->Enqueue (item))
+    {
+      return false;
+    }
+
+  uint32_t bit = 1u << cls;
+  if (c.strict)
+    {
+      m_strictActive |= bit;
+    }
+  else if (!(m_rrActive & bit))
+    {
+      // a class gets its quantum when the round reaches it, unless it is
+      // the only active class
+      if (m_rrActive == 0)
+        {
+          m_rrCurrent = cls;
+          c.deficit = GetQuantum (cls);
+        }
+      m_rrActive |= bit;
+    }
+
+  NS_LOG_LOGIC ("Number packets class " << cls << ": " << queue->GetNPackets ());
+  return true;
+}
+
+Ptr<QueueDiscItem>
+DwrrQueueDisc::DoDequeue (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Ptr<QueueDiscItem> item;
+
+  if (m_strictActive)
+    {
+      uint32_t cls = __builtin_ctz (m_strictActive);
+      Ptr<InternalQueue> queue = GetInternalQueue (cls);
+      item = queue->Dequeue ();
+      if (queue->IsEmpty ())
+        {
+          m_strictActive &= ~(1u << cls);
+        }
+      NS_LOG_LOGIC ("Popped from strict priority class " << cls << ": " << item);
+      return item;
+    }
+
+  while (m_rrActive)
+    {
+      Class &c = m_classes[m_rrCurrent];
+      Ptr<InternalQueue> queue = GetInternalQueue (m_rrCurrent);
+      Ptr<const QueueDiscItem> head = queue->Peek ();
+      NS_ASSERT (head != 0);
+
+      if (head->GetSize () <= c.deficit)
+        {
+          item = queue->Dequeue ();
+          c.deficit -= item->GetSize ();
+          NS_LOG_LOGIC ("Popped from class " << m_rrCurrent << ": " << item);
+          if (queue->IsEmpty ())
+            {
+              c.deficit = 0;
+              m_rrActive &= ~(1u << m_rrCurrent);
+              if (m_rrActive)
+                {
+                  m_rrCurrent = NextRoundRobinClass ();
+                  m_classes[m_rrCurrent].deficit += GetQuantum (m_rrCurrent);
+                }
+            }
+          return item;
+        }
+
+      // the class used its quantum, move on to the next one
+      m_rrCurrent = NextRoundRobinClass ();
+      m_classes[m_rrCurrent].deficit += GetQuantum (m_rrCurrent);
+    }
+
+  NS_LOG_LOGIC ("Queue empty");
+  return item;
+}
+
+bool
+DwrrQueueDisc::CheckConfig (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (GetNQueueDiscClasses () > 0)
+    {
+      NS_LOG_ERROR ("DwrrQueueDisc cannot have classes");
+      return false;
+    }
+
+  if (GetNPacketFilters () > 0)
+    {
+      NS_LOG_ERROR ("DwrrQueueDisc needs no packet filter");
+      return false;
+    }
+
+  if (GetNInternalQueues () == 0)
+    {
+      // create a DropTail queue per class, each as large as the queue disc
+      ObjectFactory factory;
+      factory.SetTypeId ("ns3::DropTailQueue<QueueDiscItem>");
+      factory.Set ("MaxSize", QueueSizeValue (GetMaxSize ()));
+      for (uint32_t i = 0; i < m_nClasses; i++)
+        {
+          AddInternalQueue (factory.Create<InternalQueue> ());
+        }
+    }
+
+  if (GetNInternalQueues () != m_nClasses)
+    {
+      NS_LOG_ERROR ("DwrrQueueDisc needs an internal queue per class");
+      return false;
+    }
+
+  if (m_defaultClass >= m_nClasses)
+    {
+      NS_LOG_ERROR ("Invalid default class " << m_defaultClass);
+      return false;
+    }
+
+  for (uint8_t dscp = 0; dscp < 64; dscp++)
+    {
+      if (m_dscpClass[dscp] != MAX_CLASSES && m_dscpClass[dscp] >= m_nClasses)
+        {
+          NS_LOG_ERROR ("Invalid class " << +m_dscpClass[dscp] << " for DSCP " << +dscp);
+          return false;
+        }
+    }
+
+  return true;
+}
+
+void
+DwrrQueueDisc::InitializeParams (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (auto &c : m_classes)
+    {
+      if (!c.hasThreshold)
+        {
+          c.markLimit = m_threshold.GetValue ();
+          c.markInBytes = (m_threshold.GetUnit () == QueueSizeUnit::BYTES);
+        }
+    }
+}
+
+} // namespace ns3
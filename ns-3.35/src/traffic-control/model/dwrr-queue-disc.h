@@ -0,0 +1,160 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef DWRR_QUEUE_DISC_H
+#define DWRR_QUEUE_DISC_H
+
+#include <array>
+#include "ns3/queue-disc.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief Strict priority and deficit weighted round robin scheduler
+ *
+ * The egress scheduler of a data center switch port.  The packets are
+ * classified by their DSCP into up to 32 classes, each an internal
+ * DropTail queue: the DSCP values are mapped to classes with SetDscpClass,
+ * and the packets with an unmapped DSCP, or without a DS field, go to the
+ * DefaultClass.  The classification is a table lookup, no packet filter is
+ * used.
+ *
+ * The classes set as strict priority with SetStrictPriority are served
+ * first, the lowest index first.  The other classes share the remaining
+ * capacity in proportion to their quantum (see SetQuantum), following the
+ * deficit round robin algorithm.  The active classes are kept in bitmaps,
+ * so that selecting the class to serve takes constant time whatever the
+ * number of classes.
+ *
+ * Each class can have an ECN marking threshold (see SetMarkingThreshold,
+ * the MarkingThreshold attribute applies to the other classes): a packet
+ * joining a class queue holding at least the threshold is marked, or
+ * dropped if it is not ECN capable.  The queue disc as a whole drops
+ * the packets beyond MaxSize.
+ */
+class DwrrQueueDisc : public QueueDisc {
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * \brief DwrrQueueDisc constructor
+   */
+  DwrrQueueDisc ();
+
+  virtual ~DwrrQueueDisc ();
+
+  /// Maximum number of classes
+  static const uint32_t MAX_CLASSES = 32;
+
+  /**
+   * \brief Map a DSCP value to a class
+   * \param dscp the DSCP value
+   * \param cls the class
+   */
+  void SetDscpClass (uint8_t dscp, uint32_t cls);
+
+  /**
+   * \brief Get the class of a DSCP value
+   * \param dscp the DSCP value
+   * \return the class
+   */
+  uint32_t GetDscpClass (uint8_t dscp) const;
+
+  /**
+   * \brief Set the quantum of a class
+   * \param cls the class
+   * \param quantum the bytes the class can send per round, zero for the Quantum attribute
+   */
+  void SetQuantum (uint32_t cls, uint32_t quantum);
+
+  /**
+   * \brief Get the quantum of a class
+   * \param cls the class
+   * \return the bytes the class can send per round
+   */
+  uint32_t GetQuantum (uint32_t cls) const;
+
+  /**
+   * \brief Set whether a class is served with strict priority
+   * \param cls the class
+   * \param strict true for strict priority, false for round robin
+   */
+  void SetStrictPriority (uint32_t cls, bool strict);
+
+  /**
+   * \brief Set the ECN marking threshold of a class
+   * \param cls the class
+   * \param threshold the threshold, in packets or bytes, overriding the
+   *        MarkingThreshold attribute, zero for none
+   */
+  void SetMarkingThreshold (uint32_t cls, QueueSize threshold);
+
+  // Reasons for dropping packets
+  static constexpr const char* LIMIT_EXCEEDED_DROP = "Queue disc limit exceeded";  //!< Packet dropped due to queue disc limit exceeded
+  static constexpr const char* THRESHOLD_DROP = "Threshold drop";  //!< Non-ECN-capable packet dropped above the threshold
+  // Reasons for marking packets
+  static constexpr const char* THRESHOLD_MARK = "Threshold mark";  //!< Packet marked above the threshold
+
+private:
+  virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
+  virtual Ptr<QueueDiscItem> DoDequeue (void);
+  virtual bool CheckConfig (void);
+  virtual void InitializeParams (void);
+
+  /**
+   * \brief Classify a packet
+   * \param item the packet
+   * \return the class of the packet
+   */
+  uint32_t Classify (Ptr<const QueueDiscItem> item) const;
+
+  /**
+   * \brief Get the next active round robin class after the current one
+   * \return the next class
+   */
+  uint32_t NextRoundRobinClass (void) const;
+
+  /// Configuration and state of a class
+  struct Class
+  {
+    uint32_t quantum;          //!< Bytes the class can send per round, zero for the default
+    uint32_t deficit;          //!< Bytes the class can still send in this round
+    bool strict;               //!< Served with strict priority
+    bool hasThreshold;         //!< Whether the class has its own marking threshold
+    QueueSize threshold;       //!< Marking threshold of the class
+    uint32_t markLimit;        //!< Resolved marking threshold, zero for none
+    bool markInBytes;          //!< Whether markLimit is in bytes
+  };
+
+  uint32_t m_nClasses;                     //!< Number of classes
+  uint32_t m_defaultClass;                 //!< Class of the unmapped packets
+  uint32_t m_quantum;                      //!< Default quantum
+  QueueSize m_threshold;                   //!< Default marking threshold
+  std::array<Class, MAX_CLASSES> m_classes; //!< The classes
+  std::array<uint8_t, 64> m_dscpClass;     //!< Class of each DSCP, MAX_CLASSES if unmapped
+  uint32_t m_strictActive;                 //!< Bitmap of the strict priority classes with packets
+  uint32_t m_rrActive;                     //!< Bitmap of the round robin classes with packets
+  uint32_t m_rrCurrent;                    //!< Round robin class being served
+};
+
+} // namespace ns3
+
+#endif /* DWRR_QUEUE_DISC_H */
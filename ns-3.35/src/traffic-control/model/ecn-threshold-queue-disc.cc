@@ -0,0 +1,250 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/object-factory.h"
+#include "ns3/drop-tail-queue.h"
+#include "ns3/socket.h"
+#include "ecn-threshold-queue-disc.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EcnThresholdQueueDisc");
+
+NS_OBJECT_ENSURE_REGISTERED (EcnThresholdQueueDisc);
+
+/// Interned EcnThresholdQueueDisc::LIMIT_EXCEEDED_DROP
+static const QueueDiscReason g_limitExceededDrop (EcnThresholdQueueDisc::LIMIT_EXCEEDED_DROP);
+/// Interned EcnThresholdQueueDisc::THRESHOLD_MARK
+static const QueueDiscReason g_thresholdMark (EcnThresholdQueueDisc::THRESHOLD_MARK);
+/// Interned EcnThresholdQueueDisc::THRESHOLD_DROP
+static const QueueDiscReason g_thresholdDrop (EcnThresholdQueueDisc::THRESHOLD_DROP);
+
+TypeId EcnThresholdQueueDisc::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::EcnThresholdQueueDisc")
+    .SetParent<QueueDisc> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<EcnThresholdQueueDisc> ()
+    .AddAttribute ("MaxSize",
+                   "The max queue size",
+                   QueueSizeValue (QueueSize ("1000p")),
+                   MakeQueueSizeAccessor (&QueueDisc::SetMaxSize,
+                                          &QueueDisc::GetMaxSize),
+                   MakeQueueSizeChecker ())
+    .AddAttribute ("MarkingThreshold",
+                   "The queue length (K) from which the packets are marked, "
+                   "in packets or bytes",
+                   QueueSizeValue (QueueSize ("65p")),
+                   MakeQueueSizeAccessor (&EcnThresholdQueueDisc::m_threshold),
+                   MakeQueueSizeChecker ())
+    .AddAttribute ("MarkOnDequeue",
+                   "Mark the packets when they are dequeued rather than enqueued",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&EcnThresholdQueueDisc::m_markOnDequeue),
+                   MakeBooleanChecker ())
+    .AddAttribute ("Bands",
+                   "The number of bands, dequeued in strict priority order",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&EcnThresholdQueueDisc::m_nBands),
+                   MakeUintegerChecker<uint32_t> (1, 16))
+    .AddAttribute ("Priomap", "The priority to band mapping.",
+                   PriomapValue (Priomap{{0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}}),
+                   MakePriomapAccessor (&EcnThresholdQueueDisc::m_prio2band),
+                   MakePriomapChecker ())
+  ;
+  return tid;
+}
+
+EcnThresholdQueueDisc::EcnThresholdQueueDisc ()
+  : QueueDisc (QueueDiscSizePolicy::MULTIPLE_QUEUES)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+EcnThresholdQueueDisc::~EcnThresholdQueueDisc ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+EcnThresholdQueueDisc::SetBandThreshold (uint32_t band, QueueSize threshold)
+{
+  NS_LOG_FUNCTION (this << band << threshold);
+  m_bandThresholds[band] = threshold;
+  if (band < m_thresholds.size ())
+    {
+      m_thresholds[band] = threshold.GetValue ();
+      m_inBytes[band] = (threshold.GetUnit () == QueueSizeUnit::BYTES);
+    }
+}
+
+QueueSize
+EcnThresholdQueueDisc::GetBandThreshold (uint32_t band) const
+{
+  std::map<uint32_t, QueueSize>::const_iterator it = m_bandThresholds.find (band);
+  return it != m_bandThresholds.end () ? it->second : m_threshold;
+}
+
+bool
+EcnThresholdQueueDisc::AboveThreshold (uint32_t band)
+{
+  Ptr<InternalQueue> queue = GetInternalQueue (band);
+  return (m_inBytes[band] ? queue->GetNBytes () : queue->GetNPackets ()) >= m_thresholds[band];
+}
+
+bool
+EcnThresholdQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  if (GetCurrentSize () + item > GetMaxSize ())
+    {
+      NS_LOG_LOGIC ("Queue full -- dropping pkt");
+      DropBeforeEnqueue (item, g_limitExceededDrop);
+      return false;
+    }
+
+  uint32_t band = 0;
+  if (m_nBands > 1)
+    {
+      SocketPriorityTag priorityTag;
+      if (item->GetPacket ()->PeekPacketTag (priorityTag))
+        {
+          band = m_prio2band[priorityTag.GetPriority () & 0x0f];
+        }
+      else
+        {
+          band = m_prio2band[0];
+        }
+    }
+
+  if (!m_markOnDequeue && AboveThreshold (band) && !Mark (item, g_thresholdMark))
+    {
+      NS_LOG_LOGIC ("Above the threshold, not ECN capable -- dropping pkt");
+      DropBeforeEnqueue (item, g_thresholdDrop);
+      return false;
+    }
+
+  bool retval = GetInternalQueue (band)->Enqueue (item);
+
+  // If Queue::Enqueue fails, QueueDisc::DropBeforeEnqueue is called by the
+  // internal queue because QueueDisc::AddInternalQueue sets the trace callback
+
+  NS_LOG_LOGIC ("Number packets band " << band << ": " << GetInternalQueue (band)->GetNPackets ());
+
+  return retval;
+}
+
+Ptr<QueueDiscItem>
+EcnThresholdQueueDisc::DoDequeue (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Ptr<QueueDiscItem> item;
+
+  for (uint32_t i = 0; i < GetNInternalQueues (); i++)
+    {
+      while ((item = GetInternalQueue (i)->Dequeue ()) != 0)
+        {
+          if (m_markOnDequeue && AboveThreshold (i) && !Mark (item, g_thresholdMark))
+            {
+              NS_LOG_LOGIC ("Above the threshold, not ECN capable -- dropping pkt");
+              DropAfterDequeue (item, g_thresholdDrop);
+              continue;
+            }
+          NS_LOG_LOGIC ("Popped from band " << i << ": " << item);
+          return item;
+        }
+    }
+
+  NS_LOG_LOGIC ("Queue empty");
+  return item;
+}
+
+bool
+EcnThresholdQueueDisc::CheckConfig (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (GetNQueueDiscClasses () > 0)
+    {
+      NS_LOG_ERROR ("EcnThresholdQueueDisc cannot have classes");
+      return false;
+    }
+
+  if (GetNPacketFilters () > 0)
+    {
+      NS_LOG_ERROR ("EcnThresholdQueueDisc needs no packet filter");
+      return false;
+    }
+
+  if (GetNInternalQueues () == 0)
+    {
+      // create a DropTail queue per band, each as large as the queue disc
+      ObjectFactory factory;
+      factory.SetTypeId ("ns3::DropTailQueue<QueueDiscItem>");
+      factory.Set ("MaxSize", QueueSizeValue (GetMaxSize ()));
+      for (uint32_t i = 0; i < m_nBands; i++)
+        {
+          AddInternalQueue (factory.Create<InternalQueue> ());
+        }
+    }
+
+  if (GetNInternalQueues () != m_nBands)
+    {
+      NS_LOG_ERROR ("EcnThresholdQueueDisc needs an internal queue per band");
+      return false;
+    }
+
+  for (uint8_t prio = 0; prio < 16; prio++)
+    {
+      if (m_prio2band[prio] >= m_nBands)
+        {
+          NS_LOG_ERROR ("Invalid band " << m_prio2band[prio] << " for priority " << +prio);
+          return false;
+        }
+    }
+
+  for (std::map<uint32_t, QueueSize>::const_iterator it = m_bandThresholds.begin ();
+       it != m_bandThresholds.end (); it++)
+    {
+      if (it->first >= m_nBands)
+        {
+          NS_LOG_ERROR ("Threshold set for the nonexistent band " << it->first);
+          return false;
+        }
+    }
+
+  return true;
+}
+
+void
+EcnThresholdQueueDisc::InitializeParams (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_thresholds.assign (m_nBands, m_threshold.GetValue ());
+  m_inBytes.assign (m_nBands, m_threshold.GetUnit () == QueueSizeUnit::BYTES);
+  for (std::map<uint32_t, QueueSize>::const_iterator it = m_bandThresholds.begin ();
+       it != m_bandThresholds.end (); it++)
+    {
+      m_thresholds[it->first] = it->second.GetValue ();
+      m_inBytes[it->first] = (it->second.GetUnit () == QueueSizeUnit::BYTES);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,105 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ECN_THRESHOLD_QUEUE_DISC_H
+#define ECN_THRESHOLD_QUEUE_DISC_H
+
+#include <map>
+#include <vector>
+#include "ns3/queue-disc.h"
+#include "ns3/prio-queue-disc.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief Mark packets when the instantaneous queue length exceeds a threshold
+ *
+ * This is the marking scheme the DCTCP switches use: a packet is marked
+ * (or dropped if it is not ECN capable) when the queue it joins already
+ * holds at least K packets or bytes.  It behaves as a RedQueueDisc with
+ * QW = 1 and MinTh = MaxTh = K, at the cost of a single comparison per
+ * packet.  With MarkOnDequeue, the packets are rather marked when they
+ * leave the queue and at least K packets or bytes are queued behind them,
+ * which signals congestion one queueing delay earlier.
+ *
+ * The queue disc has one or more bands, each a DropTail internal queue.
+ * A packet is assigned a band by its priority (modulo 16) through the
+ * Priomap, and the bands are dequeued in strict priority order, band 0
+ * first.  Each band has the MarkingThreshold, unless a specific threshold
+ * is set with SetBandThreshold, and the threshold is checked against the
+ * length of the band.  No packet filter can be provided.
+ */
+class EcnThresholdQueueDisc : public QueueDisc {
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * \brief EcnThresholdQueueDisc constructor
+   */
+  EcnThresholdQueueDisc ();
+
+  virtual ~EcnThresholdQueueDisc ();
+
+  /**
+   * \brief Set the marking threshold of a band
+   * \param band the band
+   * \param threshold the threshold, in packets or bytes
+   */
+  void SetBandThreshold (uint32_t band, QueueSize threshold);
+
+  /**
+   * \brief Get the marking threshold of a band
+   * \param band the band
+   * \return the threshold, in packets or bytes
+   */
+  QueueSize GetBandThreshold (uint32_t band) const;
+
+  // Reasons for dropping packets
+  static constexpr const char* LIMIT_EXCEEDED_DROP = "Queue disc limit exceeded";  //!< Packet dropped due to queue disc limit exceeded
+  static constexpr const char* THRESHOLD_DROP = "Threshold drop";  //!< Non-ECN-capable packet dropped above the threshold
+  // Reasons for marking packets
+  static constexpr const char* THRESHOLD_MARK = "Threshold mark";  //!< Packet marked above the threshold
+
+private:
+  virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
+  virtual Ptr<QueueDiscItem> DoDequeue (void);
+  virtual bool CheckConfig (void);
+  virtual void InitializeParams (void);
+
+  /**
+   * \brief Check whether a band is at or above its marking threshold
+   * \param band the band
+   * \return true if the band holds at least its threshold
+   */
+  bool AboveThreshold (uint32_t band);
+
+  uint32_t m_nBands;                        //!< Number of bands
+  QueueSize m_threshold;                    //!< Default marking threshold
+  bool m_markOnDequeue;                     //!< Mark on dequeue rather than on enqueue
+  Priomap m_prio2band;                      //!< Priority to band mapping
+  std::map<uint32_t, QueueSize> m_bandThresholds; //!< Thresholds set for specific bands
+  std::vector<uint32_t> m_thresholds;       //!< Threshold of each band, in its unit
+  std::vector<bool> m_inBytes;              //!< Whether the threshold of each band is in bytes
+};
+
+} // namespace ns3
+
+#endif /* ECN_THRESHOLD_QUEUE_DISC_H */
@@ -29,6 +29,9 @@ NS_LOG_COMPONENT_DEFINE ("FifoQueueDisc");
 
 NS_OBJECT_ENSURE_REGISTERED (FifoQueueDisc);
 
+/// Interned FifoQueueDisc::LIMIT_EXCEEDED_DROP
+static const QueueDiscReason g_limitExceededDrop (FifoQueueDisc::LIMIT_EXCEEDED_DROP);
+
 TypeId FifoQueueDisc::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::FifoQueueDisc")
@@ -64,7 +67,7 @@ FifoQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
   if (GetCurrentSize () + item > GetMaxSize ())
     {
       NS_LOG_LOGIC ("Queue full -- dropping pkt");
-      DropBeforeEnqueue (item, LIMIT_EXCEEDED_DROP);
+      DropBeforeEnqueue (item, g_limitExceededDrop);
       return false;
     }
 
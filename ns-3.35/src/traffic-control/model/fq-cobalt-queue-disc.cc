@@ -112,6 +112,11 @@ FqCobaltFlow::GetIndex (void) const
 
 NS_OBJECT_ENSURE_REGISTERED (FqCobaltQueueDisc);
 
+/// Interned FqCobaltQueueDisc::UNCLASSIFIED_DROP
+static const QueueDiscReason g_unclassifiedDrop (FqCobaltQueueDisc::UNCLASSIFIED_DROP);
+/// Interned FqCobaltQueueDisc::OVERLIMIT_DROP
+static const QueueDiscReason g_overlimitDrop (FqCobaltQueueDisc::OVERLIMIT_DROP);
+
 TypeId FqCobaltQueueDisc::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::FqCobaltQueueDisc")
@@ -274,7 +279,7 @@ FqCobaltQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
       else
         {
           NS_LOG_ERROR ("No filter has been able to classify this packet, drop it.");
-          DropBeforeEnqueue (item, UNCLASSIFIED_DROP);
+          DropBeforeEnqueue (item, g_unclassifiedDrop);
           return false;
         }
     }
@@ -519,7 +524,7 @@ FqCobaltQueueDisc::FqCobaltDrop (void)
     {
       NS_LOG_DEBUG ("Drop packet (overflow); count: " << count << " len: " << len << " threshold: " << threshold);
       item = qd->GetInternalQueue (0)->Dequeue ();
-      DropAfterDequeue (item, OVERLIMIT_DROP);
+      DropAfterDequeue (item, g_overlimitDrop);
       len += item->GetSize ();
     }
   while (++count < m_dropBatchSize && len < threshold);
@@ -106,6 +106,11 @@ FqCoDelFlow::GetIndex (void) const
 
 NS_OBJECT_ENSURE_REGISTERED (FqCoDelQueueDisc);
 
+/// Interned FqCoDelQueueDisc::UNCLASSIFIED_DROP
+static const QueueDiscReason g_unclassifiedDrop (FqCoDelQueueDisc::UNCLASSIFIED_DROP);
+/// Interned FqCoDelQueueDisc::OVERLIMIT_DROP
+static const QueueDiscReason g_overlimitDrop (FqCoDelQueueDisc::OVERLIMIT_DROP);
+
 TypeId FqCoDelQueueDisc::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::FqCoDelQueueDisc")
@@ -248,7 +253,7 @@ FqCoDelQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
       else
         {
           NS_LOG_ERROR ("No filter has been able to classify this packet, drop it.");
-          DropBeforeEnqueue (item, UNCLASSIFIED_DROP);
+          DropBeforeEnqueue (item, g_unclassifiedDrop);
           return false;
         }
     }
@@ -488,7 +493,7 @@ FqCoDelQueueDisc::FqCoDelDrop (void)
     {
       NS_LOG_DEBUG ("Drop packet (overflow); count: " << count << " len: " << len << " threshold: " << threshold);
       item = qd->GetInternalQueue (0)->Dequeue ();
-      DropAfterDequeue (item, OVERLIMIT_DROP);
+      DropAfterDequeue (item, g_overlimitDrop);
       len += item->GetSize ();
     } while (++count < m_dropBatchSize && len < threshold);
 
@@ -112,6 +112,11 @@ FqPieFlow::GetIndex (void) const
 
 NS_OBJECT_ENSURE_REGISTERED (FqPieQueueDisc);
 
+/// Interned FqPieQueueDisc::UNCLASSIFIED_DROP
+static const QueueDiscReason g_unclassifiedDrop (FqPieQueueDisc::UNCLASSIFIED_DROP);
+/// Interned FqPieQueueDisc::OVERLIMIT_DROP
+static const QueueDiscReason g_overlimitDrop (FqPieQueueDisc::OVERLIMIT_DROP);
+
 TypeId FqPieQueueDisc::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::FqPieQueueDisc")
@@ -304,7 +309,7 @@ FqPieQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
       else
         {
           NS_LOG_ERROR ("No filter has been able to classify this packet, drop it.");
-          DropBeforeEnqueue (item, UNCLASSIFIED_DROP);
+          DropBeforeEnqueue (item, g_unclassifiedDrop);
           return false;
         }
     }
@@ -554,7 +559,7 @@ FqPieQueueDisc::FqPieDrop (void)
     {
       NS_LOG_DEBUG ("Drop packet (overflow); count: " << count << " len: " << len << " threshold: " << threshold);
       item = qd->GetInternalQueue (0)->Dequeue ();
-      DropAfterDequeue (item, OVERLIMIT_DROP);
+      DropAfterDequeue (item, g_overlimitDrop);
       len += item->GetSize ();
     }
   while (++count < m_dropBatchSize && len < threshold);
@@ -32,6 +32,9 @@ NS_LOG_COMPONENT_DEFINE ("PfifoFastQueueDisc");
 
 NS_OBJECT_ENSURE_REGISTERED (PfifoFastQueueDisc);
 
+/// Interned PfifoFastQueueDisc::LIMIT_EXCEEDED_DROP
+static const QueueDiscReason g_limitExceededDrop (PfifoFastQueueDisc::LIMIT_EXCEEDED_DROP);
+
 TypeId PfifoFastQueueDisc::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::PfifoFastQueueDisc")
@@ -69,7 +72,7 @@ PfifoFastQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
   if (GetCurrentSize () >= GetMaxSize ())
     {
       NS_LOG_LOGIC ("Queue disc limit exceeded -- dropping packet");
-      DropBeforeEnqueue (item, LIMIT_EXCEEDED_DROP);
+      DropBeforeEnqueue (item, g_limitExceededDrop);
       return false;
     }
 
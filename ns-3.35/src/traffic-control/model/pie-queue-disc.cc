@@ -40,6 +40,15 @@ NS_LOG_COMPONENT_DEFINE ("PieQueueDisc");
 
 NS_OBJECT_ENSURE_REGISTERED (PieQueueDisc);
 
+/// Interned PieQueueDisc::FORCED_DROP
+static const QueueDiscReason g_forcedDrop (PieQueueDisc::FORCED_DROP);
+/// Interned PieQueueDisc::UNFORCED_MARK
+static const QueueDiscReason g_unforcedMark (PieQueueDisc::UNFORCED_MARK);
+/// Interned PieQueueDisc::UNFORCED_DROP
+static const QueueDiscReason g_unforcedDrop (PieQueueDisc::UNFORCED_DROP);
+/// Interned PieQueueDisc::CE_THRESHOLD_EXCEEDED_MARK
+static const QueueDiscReason g_ceThresholdExceededMark (PieQueueDisc::CE_THRESHOLD_EXCEEDED_MARK);
+
 TypeId PieQueueDisc::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::PieQueueDisc")
@@ -201,7 +210,7 @@ PieQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
   if (nQueued + item > GetMaxSize ())
     {
       // Drops due to queue limit: reactive
-      DropBeforeEnqueue (item, FORCED_DROP);
+      DropBeforeEnqueue (item, g_forcedDrop);
       m_accuProb = 0;
       return false;
     }
@@ -209,10 +218,10 @@ PieQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
   // If L4S is enabled and packet is ECT1 then directly enqueue the packet.
   else if ((m_activeThreshold == Time::Max () || m_active) && !isEct1 && DropEarly (item, nQueued.GetValue ()))
     {
-      if (!m_useEcn || m_dropProb >= m_markEcnTh || !Mark (item, UNFORCED_MARK))
+      if (!m_useEcn || m_dropProb >= m_markEcnTh || !Mark (item, g_unforcedMark))
         {
           // Early probability drop: proactive
-          DropBeforeEnqueue (item, UNFORCED_DROP);
+          DropBeforeEnqueue (item, g_unforcedDrop);
           m_accuProb = 0;
           return false;
         }
@@ -497,7 +506,7 @@ PieQueueDisc::DoDequeue ()
             {
               NS_LOG_DEBUG ("CE packet " << static_cast<uint16_t> (tosByte & 0x3));
             }
-          if ((Now () - item->GetTimeStamp () > m_ceThreshold) && Mark (item, CE_THRESHOLD_EXCEEDED_MARK))
+          if ((Now () - item->GetTimeStamp () > m_ceThreshold) && Mark (item, g_ceThresholdExceededMark))
             {
               NS_LOG_LOGIC ("Marking due to CeThreshold " << m_ceThreshold.GetSeconds ());
             }
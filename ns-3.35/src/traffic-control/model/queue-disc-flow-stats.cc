@@ -0,0 +1,470 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <iomanip>
+#include "ns3/log.h"
+#include "ns3/enum.h"
+#include "ns3/uinteger.h"
+#include "queue-disc-flow-stats.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("QueueDiscFlowStats");
+
+NS_OBJECT_ENSURE_REGISTERED (QueueDiscFlowStats);
+
+TypeId
+QueueDiscFlowStats::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::QueueDiscFlowStats")
+    .SetParent<Object> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<QueueDiscFlowStats> ()
+    .AddAttribute ("Mode",
+                   "Whether to keep exact counters for the most recently seen flows "
+                   "or estimated counters for all the flows",
+                   EnumValue (LRU),
+                   MakeEnumAccessor (&QueueDiscFlowStats::m_mode),
+                   MakeEnumChecker (LRU, "LRU",
+                                    COUNT_MIN, "COUNT_MIN"))
+    .AddAttribute ("MaxFlows",
+                   "The maximum number of flows kept",
+                   UintegerValue (1024),
+                   MakeUintegerAccessor (&QueueDiscFlowStats::m_maxFlows),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("SketchWidth",
+                   "The number of counters per row of the count-min sketch",
+                   UintegerValue (4096),
+                   MakeUintegerAccessor (&QueueDiscFlowStats::m_sketchWidth),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("SketchDepth",
+                   "The number of rows of the count-min sketch",
+                   UintegerValue (4),
+                   MakeUintegerAccessor (&QueueDiscFlowStats::m_sketchDepth),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+QueueDiscFlowStats::Counters::Counters ()
+  : enqueuedPackets (0),
+    enqueuedBytes (0),
+    markedPackets (0),
+    markedBytes (0),
+    droppedPackets (0),
+    droppedBytes (0)
+{
+}
+
+QueueDiscFlowStats::FlowKey::FlowKey ()
+  : flowHash (0)
+{
+}
+
+std::size_t
+QueueDiscFlowStats::FlowKeyHash::operator() (const FlowKey &key) const
+{
+  return key.flowHash;
+}
+
+bool
+QueueDiscFlowStats::FlowKeyEqual::operator() (const FlowKey &k1, const FlowKey &k2) const
+{
+  return k1.flowHash == k2.flowHash && k1.tuple == k2.tuple;
+}
+
+QueueDiscFlowStats::QueueDiscFlowStats ()
+  : m_head (NONE),
+    m_tail (NONE),
+    m_heavyHitterMin (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+QueueDiscFlowStats::~QueueDiscFlowStats ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+QueueDiscFlowStats::FlowKey
+QueueDiscFlowStats::GetFlowKey (Ptr<const QueueDiscItem> item)
+{
+  FlowKey key;
+  key.flowHash = item->GetFlowHash ();
+  item->GetFiveTuple (key.tuple);
+  return key;
+}
+
+void
+QueueDiscFlowStats::RecordEnqueue (Ptr<const QueueDiscItem> item)
+{
+  Record (item, ENQUEUED);
+}
+
+void
+QueueDiscFlowStats::RecordMark (Ptr<const QueueDiscItem> item)
+{
+  Record (item, MARKED);
+}
+
+void
+QueueDiscFlowStats::RecordDrop (Ptr<const QueueDiscItem> item)
+{
+  Record (item, DROPPED);
+}
+
+void
+QueueDiscFlowStats::Add (Counters &counters, CounterId id, uint32_t bytes)
+{
+  switch (id)
+    {
+    case ENQUEUED:
+      counters.enqueuedPackets++;
+      counters.enqueuedBytes += bytes;
+      break;
+    case MARKED:
+      counters.markedPackets++;
+      counters.markedBytes += bytes;
+      break;
+    case DROPPED:
+      counters.droppedPackets++;
+      counters.droppedBytes += bytes;
+      break;
+    }
+}
+
+void
+QueueDiscFlowStats::Record (Ptr<const QueueDiscItem> item, CounterId id)
+{
+  NS_LOG_FUNCTION (this << item << id);
+
+  FlowKey key = GetFlowKey (item);
+  uint32_t bytes = item->GetSize ();
+
+  if (m_mode == LRU)
+    {
+      Add (m_entries[LruLookup (key)].counters, id, bytes);
+      return;
+    }
+
+  if (m_sketch.empty ())
+    {
+      m_sketch.resize (static_cast<std::size_t> (m_sketchWidth) * m_sketchDepth);
+    }
+  for (uint32_t row = 0; row < m_sketchDepth; row++)
+    {
+      Add (m_sketch[SketchIndex (key.flowHash, row)], id, bytes);
+    }
+  if (id != MARKED)
+    {
+      TrackHeavyHitter (key);
+    }
+}
+
+uint32_t
+QueueDiscFlowStats::LruLookup (const FlowKey &key)
+{
+  auto it = m_index.find (key);
+  if (it != m_index.end ())
+    {
+      if (it->second != m_head)
+        {
+          LruUnlink (it->second);
+          LruPushFront (it->second);
+        }
+      return it->second;
+    }
+
+  uint32_t index;
+  if (m_entries.size () < m_maxFlows)
+    {
+      index = m_entries.size ();
+      m_entries.push_back (Entry ());
+    }
+  else
+    {
+      // make room by evicting the least recently seen flow
+      index = m_tail;
+      Entry &evicted = m_entries[index];
+      NS_LOG_LOGIC ("Evicting flow " << evicted.key.tuple);
+      m_evicted.enqueuedPackets += evicted.counters.enqueuedPackets;
+      m_evicted.enqueuedBytes += evicted.counters.enqueuedBytes;
+      m_evicted.markedPackets += evicted.counters.markedPackets;
+      m_evicted.markedBytes += evicted.counters.markedBytes;
+      m_evicted.droppedPackets += evicted.counters.droppedPackets;
+      m_evicted.droppedBytes += evicted.counters.droppedBytes;
+      m_index.erase (evicted.key);
+      LruUnlink (index);
+    }
+
+  Entry &entry = m_entries[index];
+  entry.key = key;
+  entry.counters = Counters ();
+  m_index[key] = index;
+  LruPushFront (index);
+  return index;
+}
+
+void
+QueueDiscFlowStats::LruUnlink (uint32_t index)
+{
+  Entry &entry = m_entries[index];
+  if (entry.prev != NONE)
+    {
+      m_entries[entry.prev].next = entry.next;
+    }
+  else
+    {
+      m_head = entry.next;
+    }
+  if (entry.next != NONE)
+    {
+      m_entries[entry.next].prev = entry.prev;
+    }
+  else
+    {
+      m_tail = entry.prev;
+    }
+}
+
+void
+QueueDiscFlowStats::LruPushFront (uint32_t index)
+{
+  Entry &entry = m_entries[index];
+  entry.prev = NONE;
+  entry.next = m_head;
+  if (m_head != NONE)
+    {
+      m_entries[m_head].prev = index;
+    }
+  else
+    {
+      m_tail = index;
+    }
+  m_head = index;
+}
+
+uint32_t
+QueueDiscFlowStats::SketchIndex (uint32_t flowHash, uint32_t row) const
+{
+  // a different mix of the flow hash for each row (murmur3 finalizer)
+  uint32_t h = flowHash ^ (row * 0x9e3779b9);
+  h ^= h >> 16;
+  h *= 0x85ebca6b;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35;
+  h ^= h >> 16;
+  return row * m_sketchWidth + h % m_sketchWidth;
+}
+
+uint64_t
+QueueDiscFlowStats::SketchBytes (uint32_t flowHash) const
+{
+  uint64_t bytes = UINT64_MAX;
+  for (uint32_t row = 0; row < m_sketchDepth; row++)
+    {
+      const Counters &counters = m_sketch[SketchIndex (flowHash, row)];
+      bytes = std::min (bytes, counters.enqueuedBytes + counters.droppedBytes);
+    }
+  return bytes;
+}
+
+void
+QueueDiscFlowStats::TrackHeavyHitter (const FlowKey &key)
+{
+  if (m_index.find (key) != m_index.end ())
+    {
+      return;
+    }
+  if (m_heavyHitters.size () < m_maxFlows)
+    {
+      m_index[key] = m_heavyHitters.size ();
+      m_heavyHitters.push_back (key);
+      return;
+    }
+
+  // The counters only grow, hence m_heavyHitterMin remains a lower bound of
+  // the bytes of the heavy hitters, and the heavy hitters are only scanned
+  // when the flow may have more bytes than one of them
+  uint64_t bytes = SketchBytes (key.flowHash);
+  if (bytes <= m_heavyHitterMin)
+    {
+      return;
+    }
+  uint32_t minSlot = 0;
+  uint64_t min = UINT64_MAX;
+  uint64_t secondMin = UINT64_MAX;
+  for (uint32_t slot = 0; slot < m_heavyHitters.size (); slot++)
+    {
+      uint64_t b = SketchBytes (m_heavyHitters[slot].flowHash);
+      if (b < min)
+        {
+          secondMin = min;
+          min = b;
+          minSlot = slot;
+        }
+      else if (b < secondMin)
+        {
+          secondMin = b;
+        }
+    }
+  if (bytes <= min)
+    {
+      m_heavyHitterMin = min;
+      return;
+    }
+  NS_LOG_LOGIC ("Flow " << key.tuple << " replaces flow " << m_heavyHitters[minSlot].tuple);
+  m_index.erase (m_heavyHitters[minSlot]);
+  m_heavyHitters[minSlot] = key;
+  m_index[key] = minSlot;
+  m_heavyHitterMin = std::min (bytes, secondMin);
+}
+
+QueueDiscFlowStats::Counters
+QueueDiscFlowStats::GetFlow (const FlowKey &key) const
+{
+  if (m_mode == LRU)
+    {
+      auto it = m_index.find (key);
+      return (it != m_index.end () ? m_entries[it->second].counters : Counters ());
+    }
+
+  Counters estimate;
+  if (m_sketch.empty ())
+    {
+      return estimate;
+    }
+  for (uint32_t row = 0; row < m_sketchDepth; row++)
+    {
+      const Counters &counters = m_sketch[SketchIndex (key.flowHash, row)];
+      if (row == 0)
+        {
+          estimate = counters;
+          continue;
+        }
+      estimate.enqueuedPackets = std::min (estimate.enqueuedPackets, counters.enqueuedPackets);
+      estimate.enqueuedBytes = std::min (estimate.enqueuedBytes, counters.enqueuedBytes);
+      estimate.markedPackets = std::min (estimate.markedPackets, counters.markedPackets);
+      estimate.markedBytes = std::min (estimate.markedBytes, counters.markedBytes);
+      estimate.droppedPackets = std::min (estimate.droppedPackets, counters.droppedPackets);
+      estimate.droppedBytes = std::min (estimate.droppedBytes, counters.droppedBytes);
+    }
+  return estimate;
+}
+
+QueueDiscFlowStats::Counters
+QueueDiscFlowStats::GetFlow (Ptr<const QueueDiscItem> item) const
+{
+  return GetFlow (GetFlowKey (item));
+}
+
+std::vector<std::pair<QueueDiscFlowStats::FlowKey, QueueDiscFlowStats::Counters> >
+QueueDiscFlowStats::GetFlows (void) const
+{
+  std::vector<std::pair<FlowKey, Counters> > flows;
+  if (m_mode == LRU)
+    {
+      for (uint32_t index = m_head; index != NONE; index = m_entries[index].next)
+        {
+          flows.push_back (std::make_pair (m_entries[index].key, m_entries[index].counters));
+        }
+    }
+  else
+    {
+      for (auto &key : m_heavyHitters)
+        {
+          flows.push_back (std::make_pair (key, GetFlow (key)));
+        }
+    }
+  std::stable_sort (flows.begin (), flows.end (),
+                    [] (const std::pair<FlowKey, Counters> &a, const std::pair<FlowKey, Counters> &b)
+                    {
+                      return a.second.enqueuedBytes + a.second.droppedBytes
+                             > b.second.enqueuedBytes + b.second.droppedBytes;
+                    });
+  return flows;
+}
+
+const QueueDiscFlowStats::Counters&
+QueueDiscFlowStats::GetEvicted (void) const
+{
+  return m_evicted;
+}
+
+/**
+ * \brief Print the counters of a flow on a line
+ * \param os the output stream
+ * \param counters the counters
+ */
+static void
+PrintCounters (std::ostream &os, const QueueDiscFlowStats::Counters &counters)
+{
+  os << " enqueued " << counters.enqueuedPackets << " / " << counters.enqueuedBytes
+     << " marked " << counters.markedPackets << " / " << counters.markedBytes
+     << " dropped " << counters.droppedPackets << " / " << counters.droppedBytes
+     << std::endl;
+}
+
+void
+QueueDiscFlowStats::Print (std::ostream &os) const
+{
+  os << "#Flow, packets / bytes enqueued, marked and dropped"
+     << (m_mode == COUNT_MIN ? " (upper bounds)" : "") << std::endl;
+  std::ios::fmtflags flags = os.flags ();
+  for (auto &flow : GetFlows ())
+    {
+      if (flow.first.tuple.source.IsInvalid ())
+        {
+          // the packets of the flow carry no 5-tuple
+          os << "hash 0x" << std::hex << std::setw (8) << std::setfill ('0') << flow.first.flowHash;
+          os.flags (flags);
+          os << std::setfill (' ');
+        }
+      else
+        {
+          os << flow.first.tuple;
+        }
+      PrintCounters (os, flow.second);
+    }
+  if (m_evicted.enqueuedPackets + m_evicted.droppedPackets > 0)
+    {
+      os << "evicted";
+      PrintCounters (os, m_evicted);
+    }
+}
+
+void
+QueueDiscFlowStats::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_entries.clear ();
+  m_index.clear ();
+  m_head = NONE;
+  m_tail = NONE;
+  m_evicted = Counters ();
+  m_sketch.clear ();
+  m_heavyHitters.clear ();
+  m_heavyHitterMin = 0;
+}
+
+std::ostream & operator << (std::ostream &os, const QueueDiscFlowStats &stats)
+{
+  stats.Print (os);
+  return os;
+}
+
+} // namespace ns3
@@ -0,0 +1,281 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef QUEUE_DISC_FLOW_STATS_H
+#define QUEUE_DISC_FLOW_STATS_H
+
+#include <vector>
+#include <unordered_map>
+#include <ostream>
+#include "ns3/object.h"
+#include "ns3/queue-item.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief Per-flow counters of the packets enqueued, marked and dropped by a
+ *        queue disc
+ *
+ * A queue disc given a QueueDiscFlowStats object (see QueueDisc::SetFlowStats)
+ * reports to it every packet it enqueues, marks or drops.  A flow is identified
+ * by the 5-tuple of its packets (see QueueDiscItem::GetFiveTuple), so that
+ * flows whose hash (see QueueDiscItem::GetFlowHash) collides are counted
+ * apart, and it is printed as such.  The memory used is bounded whatever the
+ * number of flows, according to the Mode attribute:
+ *
+ * - LRU: exact counters are kept for the MaxFlows most recently seen flows.
+ *   When a new flow needs room, the counters of the least recently seen flow
+ *   are added to the counters of the evicted flows (see GetEvicted).
+ * - COUNT_MIN: the counters of all the flows are estimated by a count-min
+ *   sketch of SketchDepth rows of SketchWidth counters, indexed by the flow
+ *   hash, which never underestimates them.  The MaxFlows flows with the most bytes enqueued
+ *   or dropped are kept, to be listed by GetFlows and Print.
+ *
+ * Recording a packet reads its 5-tuple, then is a hash table lookup (LRU) or
+ * SketchDepth counter updates (COUNT_MIN).  Note that the packets dropped after dequeue are
+ * counted as both enqueued and dropped.
+ */
+class QueueDiscFlowStats : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  QueueDiscFlowStats ();
+  virtual ~QueueDiscFlowStats ();
+
+  /// How the memory used by the counters is bounded
+  enum Mode
+  {
+    LRU,         //!< Exact counters for the most recently seen flows
+    COUNT_MIN    //!< Estimated counters for all the flows
+  };
+
+  /// The counters of a flow
+  struct Counters
+  {
+    uint32_t enqueuedPackets;  //!< Packets enqueued
+    uint64_t enqueuedBytes;    //!< Bytes enqueued
+    uint32_t markedPackets;    //!< Packets marked
+    uint64_t markedBytes;      //!< Bytes marked
+    uint32_t droppedPackets;   //!< Packets dropped
+    uint64_t droppedBytes;     //!< Bytes dropped
+
+    /// constructor
+    Counters ();
+  };
+
+  /// Identifies a flow
+  struct FlowKey
+  {
+    uint32_t flowHash;               //!< The hash of the flow
+    QueueDiscItem::FiveTuple tuple;  //!< The 5-tuple of the flow, empty if its packets carry none
+
+    /// constructor
+    FlowKey ();
+  };
+
+  /**
+   * \brief Get the key of the flow of an item
+   * \param item the item
+   * \return the key of the flow of the item
+   */
+  static FlowKey GetFlowKey (Ptr<const QueueDiscItem> item);
+
+  /**
+   * \brief Record a packet enqueued
+   * \param item the item
+   */
+  void RecordEnqueue (Ptr<const QueueDiscItem> item);
+  /**
+   * \brief Record a packet marked
+   * \param item the item
+   */
+  void RecordMark (Ptr<const QueueDiscItem> item);
+  /**
+   * \brief Record a packet dropped
+   * \param item the item
+   */
+  void RecordDrop (Ptr<const QueueDiscItem> item);
+
+  /**
+   * \brief Get the counters of a flow
+   * \param key the key of the flow
+   * \return the counters of the flow (zero if an LRU table does not keep it,
+   *         an upper bound in COUNT_MIN mode)
+   */
+  Counters GetFlow (const FlowKey &key) const;
+
+  /**
+   * \brief Get the counters of the flow of an item
+   * \param item the item
+   * \return the counters of the flow (zero if an LRU table does not keep it,
+   *         an upper bound in COUNT_MIN mode)
+   */
+  Counters GetFlow (Ptr<const QueueDiscItem> item) const;
+
+  /**
+   * \brief Get the flows kept, with the most bytes enqueued or dropped first
+   * \return the key and the counters of each flow
+   */
+  std::vector<std::pair<FlowKey, Counters> > GetFlows (void) const;
+
+  /**
+   * \return the sum of the counters of the flows evicted from an LRU table
+   */
+  const Counters& GetEvicted (void) const;
+
+  /**
+   * \brief Print the counters, one line per flow, with the most bytes
+   *        enqueued or dropped first
+   * \param os output stream in which the data should be printed.
+   */
+  void Print (std::ostream &os) const;
+
+  /**
+   * \brief Remove all the flows and reset all the counters
+   */
+  void Clear (void);
+
+private:
+  /// Identifies a counter of the Counters structure
+  enum CounterId
+  {
+    ENQUEUED,
+    MARKED,
+    DROPPED
+  };
+
+  /// Hashes a flow key by its flow hash
+  struct FlowKeyHash
+  {
+    /**
+     * \param key the key of the flow
+     * \return the hash of the flow
+     */
+    std::size_t operator() (const FlowKey &key) const;
+  };
+
+  /// Compares the flow keys
+  struct FlowKeyEqual
+  {
+    /**
+     * \param k1 the first key
+     * \param k2 the second key
+     * \return true if both keys identify the same flow
+     */
+    bool operator() (const FlowKey &k1, const FlowKey &k2) const;
+  };
+
+  /**
+   * \brief Add a packet to a counter of its flow
+   * \param item the item
+   * \param id the counter
+   */
+  void Record (Ptr<const QueueDiscItem> item, CounterId id);
+
+  /**
+   * \brief Add a packet to a counter
+   * \param counters the counters
+   * \param id the counter
+   * \param bytes the size of the packet
+   */
+  static void Add (Counters &counters, CounterId id, uint32_t bytes);
+
+  /**
+   * \brief Get the entry of a flow in the LRU table, creating it if needed,
+   *        and make it the most recently seen
+   * \param key the key of the flow
+   * \return the index of the entry
+   */
+  uint32_t LruLookup (const FlowKey &key);
+
+  /**
+   * \brief Unlink an entry from the LRU list
+   * \param index the index of the entry
+   */
+  void LruUnlink (uint32_t index);
+
+  /**
+   * \brief Link an entry at the head (most recently seen) of the LRU list
+   * \param index the index of the entry
+   */
+  void LruPushFront (uint32_t index);
+
+  /**
+   * \brief Get the counter of a row of the sketch for a flow
+   * \param flowHash the hash of the flow
+   * \param row the row
+   * \return the index of the counter
+   */
+  uint32_t SketchIndex (uint32_t flowHash, uint32_t row) const;
+
+  /**
+   * \param flowHash the hash of the flow
+   * \return the bytes enqueued or dropped by the flow, as estimated by the
+   *         sketch
+   */
+  uint64_t SketchBytes (uint32_t flowHash) const;
+
+  /**
+   * \brief Keep a flow among the flows with the most bytes, if it is one of them
+   * \param key the key of the flow
+   */
+  void TrackHeavyHitter (const FlowKey &key);
+
+  static const uint32_t NONE = 0xffffffff;  //!< No entry
+
+  /// An entry of the LRU table
+  struct Entry
+  {
+    FlowKey key;         //!< The key of the flow
+    Counters counters;   //!< The counters of the flow
+    uint32_t prev;       //!< The more recently seen entry, NONE for the head
+    uint32_t next;       //!< The less recently seen entry, NONE for the tail
+  };
+
+  Mode m_mode;                                    //!< How the memory is bounded
+  uint32_t m_maxFlows;                            //!< Maximum number of flows kept
+  uint32_t m_sketchWidth;                         //!< Counters per row of the sketch
+  uint32_t m_sketchDepth;                         //!< Rows of the sketch
+  std::vector<Entry> m_entries;                   //!< The entries of the LRU table
+  /// Entry of each flow (LRU) or slot of each heavy hitter (COUNT_MIN)
+  std::unordered_map<FlowKey, uint32_t, FlowKeyHash, FlowKeyEqual> m_index;
+  uint32_t m_head;                                //!< The most recently seen entry
+  uint32_t m_tail;                                //!< The least recently seen entry
+  Counters m_evicted;                             //!< Sum of the counters of the evicted flows
+  std::vector<Counters> m_sketch;                 //!< The counters of the sketch, row by row
+  std::vector<FlowKey> m_heavyHitters;            //!< The flows with the most bytes
+  uint64_t m_heavyHitterMin;                      //!< Lower bound of the bytes of the heavy hitters
+};
+
+/**
+ * \brief Stream insertion operator.
+ *
+ * \param os the stream
+ * \param stats the per-flow counters
+ * \returns a reference to the stream
+ */
+std::ostream& operator<< (std::ostream& os, const QueueDiscFlowStats &stats);
+
+} // namespace ns3
+
+#endif /* QUEUE_DISC_FLOW_STATS_H */
@@ -17,9 +17,11 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
 #include "ns3/log.h"
 #include "ns3/abort.h"
 #include "ns3/uinteger.h"
+#include "ns3/boolean.h"
 #include "ns3/pointer.h"
 #include "ns3/object-vector.h"
 #include "ns3/packet.h"
@@ -27,8 +29,11 @@
 #include "ns3/unused.h"
 #include "ns3/simulator.h"
 #include "queue-disc.h"
+#include "shared-buffer-manager.h"
+#include "queue-disc-flow-stats.h"
 #include "ns3/net-device-queue-interface.h"
 #include "ns3/queue.h"
+#include "ns3/packet-burst.h"
 
 namespace ns3 {
 
@@ -84,6 +89,126 @@ QueueDiscClass::SetQueueDisc (Ptr<QueueDisc> qd)
   m_queueDisc = qd;
 }
 
+QueueDisc::OccupancyHistogram::OccupancyHistogram ()
+  : byteBinSize (1500),
+    sojournBinWidth (MicroSeconds (10))
+{
+}
+
+/**
+ * \brief Get the first bin at which a histogram reaches a quantile
+ * \param bins the histogram
+ * \param q the quantile, between 0 and 1
+ * \return the index of the bin
+ */
+template <typename T>
+static uint32_t
+GetQuantileBin (const std::vector<T> &bins, double q)
+{
+  double total = 0;
+  for (typename std::vector<T>::const_iterator it = bins.begin (); it != bins.end (); it++)
+    {
+      total += *it;
+    }
+  double cumulated = 0;
+  for (uint32_t i = 0; i < bins.size (); i++)
+    {
+      cumulated += bins[i];
+      if (bins[i] > 0 && cumulated >= q * total)
+        {
+          return i;
+        }
+    }
+  return 0;
+}
+
+/**
+ * \brief Print the cumulative distribution of a histogram
+ * \param os output stream in which the data should be printed.
+ * \param bins the histogram
+ * \param width the width of the bins
+ */
+template <typename T>
+static void
+PrintDistribution (std::ostream &os, const std::vector<T> &bins, double width)
+{
+  double total = 0;
+  for (typename std::vector<T>::const_iterator it = bins.begin (); it != bins.end (); it++)
+    {
+      total += *it;
+    }
+  double cumulated = 0;
+  for (uint32_t i = 0; i < bins.size (); i++)
+    {
+      if (bins[i] > 0)
+        {
+          cumulated += bins[i];
+          os << i * width << " " << cumulated / total << std::endl;
+        }
+    }
+}
+
+Time
+QueueDisc::OccupancyHistogram::GetDuration (void) const
+{
+  int64_t duration = 0;
+  for (std::vector<int64_t>::const_iterator it = packets.begin (); it != packets.end (); it++)
+    {
+      duration += *it;
+    }
+  return TimeStep (duration);
+}
+
+double
+QueueDisc::OccupancyHistogram::GetMeanPackets (void) const
+{
+  double area = 0;
+  double duration = 0;
+  for (uint32_t i = 0; i < packets.size (); i++)
+    {
+      area += static_cast<double> (i) * packets[i];
+      duration += packets[i];
+    }
+  return duration > 0 ? area / duration : 0;
+}
+
+uint32_t
+QueueDisc::OccupancyHistogram::GetPacketsQuantile (double q) const
+{
+  return GetQuantileBin (packets, q);
+}
+
+uint32_t
+QueueDisc::OccupancyHistogram::GetBytesQuantile (double q) const
+{
+  return (GetQuantileBin (bytes, q) + 1) * byteBinSize;
+}
+
+Time
+QueueDisc::OccupancyHistogram::GetSojournQuantile (double q) const
+{
+  return sojournBinWidth * (GetQuantileBin (sojourn, q) + 1);
+}
+
+void
+QueueDisc::OccupancyHistogram::Print (std::ostream &os) const
+{
+  os << "# Packets queued, fraction of time" << std::endl;
+  PrintDistribution (os, packets, 1);
+  os << "# Bytes queued (lower bound), fraction of time" << std::endl;
+  PrintDistribution (os, bytes, byteBinSize);
+  os << "# Sojourn time (lower bound, s), fraction of packets" << std::endl;
+  PrintDistribution (os, sojourn, sojournBinWidth.GetSeconds ());
+}
+
+void
+QueueDisc::OccupancyHistogram::Clear (void)
+{
+  packets.clear ();
+  bytes.clear ();
+  sojourn.clear ();
+}
+
 QueueDisc::Stats::Stats ()
   : nTotalReceivedPackets (0),
     nTotalReceivedBytes (0),
@@ -106,22 +231,125 @@ QueueDisc::Stats::Stats ()
 {
 }
 
+/**
+ * \brief The reasons interned so far, shared by all the queue discs
+ */
+struct QueueDiscReasonTable
+{
+  std::map<std::string, uint32_t> ids;  //!< Id of each reason
+  std::deque<std::string> names;        //!< Reason of each id, never moved once added
+};
+
+/**
+ * \return the table of the interned reasons
+ */
+static QueueDiscReasonTable &
+GetReasonTable (void)
+{
+  static QueueDiscReasonTable table;
+  return table;
+}
+
+QueueDiscReason::QueueDiscReason (const char* name)
+  : m_name (name),
+    m_id (QueueDisc::Stats::GetReasonId (name))
+{
+}
+
+const char*
+QueueDiscReason::GetName (void) const
+{
+  return m_name;
+}
+
+uint32_t
+QueueDiscReason::GetId (void) const
+{
+  return m_id;
+}
+
+/// Interned QueueDisc::INTERNAL_QUEUE_DROP
+static const QueueDiscReason g_internalQueueDrop (QueueDisc::INTERNAL_QUEUE_DROP);
+/// Interned QueueDisc::SHARED_BUFFER_DROP
+static const QueueDiscReason g_sharedBufferDrop (QueueDisc::SHARED_BUFFER_DROP);
+/// Interned QueueDisc::SHARED_BUFFER_MARK
+static const QueueDiscReason g_sharedBufferMark (QueueDisc::SHARED_BUFFER_MARK);
+
+/**
+ * \brief Add a packet to the counters of a reason
+ * \param packets the packet counters, indexed by reason id
+ * \param bytes the byte counters, indexed by reason id
+ * \param id the id of the reason
+ * \param size the size of the packet
+ */
+static void
+AddToReasonCounters (std::vector<uint32_t> &packets, std::vector<uint64_t> &bytes,
+                     uint32_t id, uint32_t size)
+{
+  if (id >= packets.size ())
+    {
+      packets.resize (id + 1, 0);
+      bytes.resize (id + 1, 0);
+    }
+  packets[id]++;
+  bytes[id] += size;
+}
+
+uint32_t
+QueueDisc::Stats::GetReasonId (const std::string &reason)
+{
+  QueueDiscReasonTable &table = GetReasonTable ();
+  auto it = table.ids.find (reason);
+  if (it != table.ids.end ())
+    {
+      return it->second;
+    }
+  uint32_t id = table.names.size ();
+  table.ids[reason] = id;
+  table.names.push_back (reason);
+  return id;
+}
+
+const std::string &
+QueueDisc::Stats::GetReasonName (uint32_t id)
+{
+  QueueDiscReasonTable &table = GetReasonTable ();
+  NS_ASSERT (id < table.names.size ());
+  return table.names[id];
+}
+
+bool
+QueueDisc::Stats::FindReasonId (const std::string &reason, uint32_t &id)
+{
+  QueueDiscReasonTable &table = GetReasonTable ();
+  auto it = table.ids.find (reason);
+  if (it == table.ids.end ())
+    {
+      return false;
+    }
+  id = it->second;
+  return true;
+}
+
 uint32_t
 QueueDisc::Stats::GetNDroppedPackets (std::string reason) const
 {
+  uint32_t id;
+  if (!FindReasonId (reason, id))
+    {
+      return 0;
+    }
+
   uint32_t count = 0;
-  auto it = nDroppedPacketsBeforeEnqueue.find (reason);
 
-  if (it != nDroppedPacketsBeforeEnqueue.end ())
+  if (id < nDroppedPacketsBeforeEnqueue.size ())
     {
-      count += it->second;
+      count += nDroppedPacketsBeforeEnqueue[id];
     }
 
-  it = nDroppedPacketsAfterDequeue.find (reason);
-
-  if (it != nDroppedPacketsAfterDequeue.end ())
+  if (id < nDroppedPacketsAfterDequeue.size ())
     {
-      count += it->second;
+      count += nDroppedPacketsAfterDequeue[id];
     }
 
   return count;
@@ -130,19 +358,22 @@ QueueDisc::Stats::GetNDroppedPackets (std::string reason) const
 uint64_t
 QueueDisc::Stats::GetNDroppedBytes (std::string reason) const
 {
+  uint32_t id;
+  if (!FindReasonId (reason, id))
+    {
+      return 0;
+    }
+
   uint64_t count = 0;
-  auto it = nDroppedBytesBeforeEnqueue.find (reason);
 
-  if (it != nDroppedBytesBeforeEnqueue.end ())
+  if (id < nDroppedBytesBeforeEnqueue.size ())
     {
-      count += it->second;
+      count += nDroppedBytesBeforeEnqueue[id];
     }
 
-  it = nDroppedBytesAfterDequeue.find (reason);
-
-  if (it != nDroppedBytesAfterDequeue.end ())
+  if (id < nDroppedBytesAfterDequeue.size ())
     {
-      count += it->second;
+      count += nDroppedBytesAfterDequeue[id];
     }
 
   return count;
@@ -151,11 +382,10 @@ QueueDisc::Stats::GetNDroppedBytes (std::string reason) const
 uint32_t
 QueueDisc::Stats::GetNMarkedPackets (std::string reason) const
 {
-  auto it = nMarkedPackets.find (reason);
-
-  if (it != nMarkedPackets.end ())
+  uint32_t id;
+  if (FindReasonId (reason, id) && id < nMarkedPackets.size ())
     {
-      return it->second;
+      return nMarkedPackets[id];
     }
 
   return 0;
@@ -164,22 +394,95 @@ QueueDisc::Stats::GetNMarkedPackets (std::string reason) const
 uint64_t
 QueueDisc::Stats::GetNMarkedBytes (std::string reason) const
 {
-  auto it = nMarkedBytes.find (reason);
-
-  if (it != nMarkedBytes.end ())
+  uint32_t id;
+  if (FindReasonId (reason, id) && id < nMarkedBytes.size ())
     {
-      return it->second;
+      return nMarkedBytes[id];
     }
 
   return 0;
 }
 
+template <typename T>
+std::map<std::string, T>
+QueueDisc::Stats::GetReasonMap (const std::vector<uint32_t> &packets, const std::vector<T> &counters)
+{
+  NS_ASSERT (packets.size () == counters.size ());
+
+  std::map<std::string, T> map;
+  for (uint32_t id = 0; id < packets.size (); id++)
+    {
+      if (packets[id] > 0)
+        {
+          map[GetReasonName (id)] = counters[id];
+        }
+    }
+  return map;
+}
+
+std::map<std::string, uint32_t>
+QueueDisc::Stats::GetNDroppedPacketsBeforeEnqueue (void) const
+{
+  return GetReasonMap (nDroppedPacketsBeforeEnqueue, nDroppedPacketsBeforeEnqueue);
+}
+
+std::map<std::string, uint32_t>
+QueueDisc::Stats::GetNDroppedPacketsAfterDequeue (void) const
+{
+  return GetReasonMap (nDroppedPacketsAfterDequeue, nDroppedPacketsAfterDequeue);
+}
+
+std::map<std::string, uint64_t>
+QueueDisc::Stats::GetNDroppedBytesBeforeEnqueue (void) const
+{
+  return GetReasonMap (nDroppedPacketsBeforeEnqueue, nDroppedBytesBeforeEnqueue);
+}
+
+std::map<std::string, uint64_t>
+QueueDisc::Stats::GetNDroppedBytesAfterDequeue (void) const
+{
+  return GetReasonMap (nDroppedPacketsAfterDequeue, nDroppedBytesAfterDequeue);
+}
+
+std::map<std::string, uint32_t>
+QueueDisc::Stats::GetNMarkedPackets (void) const
+{
+  return GetReasonMap (nMarkedPackets, nMarkedPackets);
+}
+
+std::map<std::string, uint64_t>
+QueueDisc::Stats::GetNMarkedBytes (void) const
+{
+  return GetReasonMap (nMarkedPackets, nMarkedBytes);
+}
+
 void
-QueueDisc::Stats::Print (std::ostream &os) const
+QueueDisc::Stats::PrintReasons (std::ostream &os, const std::vector<uint32_t> &packets,
+                                const std::vector<uint64_t> &bytes)
 {
-  std::map<std::string, uint32_t>::const_iterator itp;
-  std::map<std::string, uint64_t>::const_iterator itb;
+  NS_ASSERT (packets.size () == bytes.size ());
+
+  // only the reasons that occurred, sorted by name
+  std::vector<std::pair<std::string, uint32_t> > reasons;
+  for (uint32_t id = 0; id < packets.size (); id++)
+    {
+      if (packets[id] > 0)
+        {
+          reasons.push_back (std::make_pair (GetReasonName (id), id));
+        }
+    }
+  std::sort (reasons.begin (), reasons.end ());
 
+  for (auto it = reasons.begin (); it != reasons.end (); it++)
+    {
+      os << std::endl << "  " << it->first << ": "
+         << packets[it->second] << " / " << bytes[it->second];
+    }
+}
+
+void
+QueueDisc::Stats::Print (std::ostream &os) const
+{
   os << std::endl << "Packets/Bytes received: "
                   << nTotalReceivedPackets << " / "
                   << nTotalReceivedBytes
@@ -199,35 +502,13 @@ QueueDisc::Stats::Print (std::ostream &os) const
                   << nTotalDroppedPacketsBeforeEnqueue << " / "
                   << nTotalDroppedBytesBeforeEnqueue;
 
-  itp = nDroppedPacketsBeforeEnqueue.begin ();
-  itb = nDroppedBytesBeforeEnqueue.begin ();
-
-  while (itp != nDroppedPacketsBeforeEnqueue.end () &&
-         itb != nDroppedBytesBeforeEnqueue.end ())
-    {
-      NS_ASSERT (itp->first.compare (itb->first) == 0);
-      os << std::endl << "  " << itp->first << ": "
-         << itp->second << " / " << itb->second;
-      itp++;
-      itb++;
-    }
+  PrintReasons (os, nDroppedPacketsBeforeEnqueue, nDroppedBytesBeforeEnqueue);
 
   os << std::endl << "Packets/Bytes dropped after dequeue: "
                   << nTotalDroppedPacketsAfterDequeue << " / "
                   << nTotalDroppedBytesAfterDequeue;
 
-  itp = nDroppedPacketsAfterDequeue.begin ();
-  itb = nDroppedBytesAfterDequeue.begin ();
-
-  while (itp != nDroppedPacketsAfterDequeue.end () &&
-         itb != nDroppedBytesAfterDequeue.end ())
-    {
-      NS_ASSERT (itp->first.compare (itb->first) == 0);
-      os << std::endl << "  " << itp->first << ": "
-         << itp->second << " / " << itb->second;
-      itp++;
-      itb++;
-    }
+  PrintReasons (os, nDroppedPacketsAfterDequeue, nDroppedBytesAfterDequeue);
 
   os << std::endl << "Packets/Bytes sent: "
                   << nTotalSentPackets << " / "
@@ -236,18 +517,7 @@ QueueDisc::Stats::Print (std::ostream &os) const
                   << nTotalMarkedPackets << " / "
                   << nTotalMarkedBytes;
 
-  itp = nMarkedPackets.begin ();
-  itb = nMarkedBytes.begin ();
-
-  while (itp != nMarkedPackets.end () &&
-         itb != nMarkedBytes.end ())
-    {
-      NS_ASSERT (itp->first.compare (itb->first) == 0);
-      os << std::endl << "  " << itp->first << ": "
-         << itp->second << " / " << itb->second;
-      itp++;
-      itb++;
-    }
+  PrintReasons (os, nMarkedPackets, nMarkedBytes);
 
   os << std::endl;
 }
@@ -270,6 +540,28 @@ TypeId QueueDisc::GetTypeId (void)
                    MakeUintegerAccessor (&QueueDisc::SetQuota,
                                          &QueueDisc::GetQuota),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("BulkDequeue",
+                   "Whether a qdisc run dequeues up to Quota packets and sends them to "
+                   "a single queue device at once, rather than one at a time",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&QueueDisc::m_bulkDequeue),
+                   MakeBooleanChecker ())
+    .AddAttribute ("RecordOccupancy",
+                   "Whether to keep the time-weighted histograms of the queue length "
+                   "and the histogram of the sojourn time",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&QueueDisc::m_recordOccupancy),
+                   MakeBooleanChecker ())
+    .AddAttribute ("OccupancyByteBin",
+                   "The size of the ranges of the histogram of the bytes queued",
+                   UintegerValue (1500),
+                   MakeUintegerAccessor (&QueueDisc::m_occupancyByteBin),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("SojournBinWidth",
+                   "The width of the ranges of the histogram of the sojourn time",
+                   TimeValue (MicroSeconds (10)),
+                   MakeTimeAccessor (&QueueDisc::m_sojournBinWidth),
+                   MakeTimeChecker (TimeStep (1)))
     .AddAttribute ("InternalQueueList", "The list of internal queues.",
                    ObjectVectorValue (),
                    MakeObjectVectorAccessor (&QueueDisc::m_queues),
@@ -323,10 +615,13 @@ QueueDisc::QueueDisc (QueueDiscSizePolicy policy)
   :  m_nPackets (0),
      m_nBytes (0),
      m_maxSize (QueueSize ("1p")),         // to avoid that setting the mode at construction time is ignored
+     m_sharedBufferPort (0),
+     m_bulkDequeue (false),
      m_running (false),
      m_peeked (false),
      m_sizePolicy (policy),
-     m_prohibitChangeMode (false)
+     m_prohibitChangeMode (false),
+     m_recordOccupancy (false)
 {
   NS_LOG_FUNCTION (this << (uint16_t)policy);
 
@@ -337,11 +632,11 @@ QueueDisc::QueueDisc (QueueDiscSizePolicy policy)
   // why the packet is dropped.
   m_internalQueueDbeFunctor = [this] (Ptr<const QueueDiscItem> item)
     {
-      return DropBeforeEnqueue (item, INTERNAL_QUEUE_DROP);
+      return DropBeforeEnqueue (item, g_internalQueueDrop);
     };
   m_internalQueueDadFunctor = [this] (Ptr<const QueueDiscItem> item)
     {
-      return DropAfterDequeue (item, INTERNAL_QUEUE_DROP);
+      return DropAfterDequeue (item, g_internalQueueDrop);
     };
 
   // These lambdas call the DropBeforeEnqueue or DropAfterDequeue methods of this
@@ -352,18 +647,19 @@ QueueDisc::QueueDisc (QueueDiscSizePolicy policy)
   // the packet is dropped.
   m_childQueueDiscDbeFunctor = [this] (Ptr<const QueueDiscItem> item, const char* r)
     {
-      return DropBeforeEnqueue (item,
-                                m_childQueueDiscDropMsg.assign (CHILD_QUEUE_DISC_DROP).append (r).data ());
+      uint32_t id = GetChildReasonId (m_childDropReasonIds, CHILD_QUEUE_DISC_DROP, r);
+      return DropBeforeEnqueue (item, Stats::GetReasonName (id).c_str (), id);
     };
   m_childQueueDiscDadFunctor = [this] (Ptr<const QueueDiscItem> item, const char* r)
     {
-      return DropAfterDequeue (item,
-                               m_childQueueDiscDropMsg.assign (CHILD_QUEUE_DISC_DROP).append (r).data ());
+      uint32_t id = GetChildReasonId (m_childDropReasonIds, CHILD_QUEUE_DISC_DROP, r);
+      return DropAfterDequeue (item, Stats::GetReasonName (id).c_str (), id);
     };
   m_childQueueDiscMarkFunctor = [this] (Ptr<const QueueDiscItem> item, const char* r)
     {
+      uint32_t id = GetChildReasonId (m_childMarkReasonIds, CHILD_QUEUE_DISC_MARK, r);
       return Mark (const_cast<QueueDiscItem *> (PeekPointer (item)),
-                   m_childQueueDiscMarkMsg.assign (CHILD_QUEUE_DISC_MARK).append (r).data ());
+                   Stats::GetReasonName (id).c_str (), id);
     };
 }
 
@@ -387,8 +683,12 @@ QueueDisc::DoDispose (void)
   m_filters.clear ();
   m_classes.clear ();
   m_devQueueIface = 0;
+  m_sharedBuffer = 0;
+  m_flowStats = 0;
   m_send = nullptr;
+  m_sendBatch = nullptr;
   m_requeued = 0;
+  m_requeuedBatch.clear ();
   m_internalQueueDbeFunctor = nullptr;
   m_internalQueueDadFunctor = nullptr;
   m_childQueueDiscDbeFunctor = nullptr;
@@ -407,6 +707,10 @@ QueueDisc::DoInitialize (void)
   NS_UNUSED (ok); // suppress compiler warning
   InitializeParams ();
 
+  m_stats.occupancy.byteBinSize = m_occupancyByteBin;
+  m_stats.occupancy.sojournBinWidth = m_sojournBinWidth;
+  m_lastOccupancyChange = Simulator::Now ();
+
   // Check the configuration and initialize the parameters of the child queue discs
   for (std::vector<Ptr<QueueDiscClass> >::iterator cl = m_classes.begin ();
        cl != m_classes.end (); cl++)
@@ -425,13 +729,24 @@ QueueDisc::GetStats (void)
   NS_ASSERT (m_stats.nTotalDroppedBytes == m_stats.nTotalDroppedBytesBeforeEnqueue
              + m_stats.nTotalDroppedBytesAfterDequeue);
 
+  if (m_recordOccupancy)
+    {
+      RecordOccupancy ();
+    }
+
   // the total number of sent packets is only updated here to avoid to increase it
   // after a dequeue and then having to decrease it if the packet is dropped after
   // dequeue or requeued
   m_stats.nTotalSentPackets = m_stats.nTotalDequeuedPackets - (m_requeued ? 1 : 0)
+                              - m_requeuedBatch.size ()
                               - m_stats.nTotalDroppedPacketsAfterDequeue;
   m_stats.nTotalSentBytes = m_stats.nTotalDequeuedBytes - (m_requeued ? m_requeued->GetSize () : 0)
                             - m_stats.nTotalDroppedBytesAfterDequeue;
+  for (std::deque<Ptr<QueueDiscItem> >::const_iterator i = m_requeuedBatch.begin ();
+       i != m_requeuedBatch.end (); i++)
+    {
+      m_stats.nTotalSentBytes -= (*i)->GetSize ();
+    }
 
   return m_stats;
 }
@@ -549,6 +864,34 @@ QueueDisc::GetNetDeviceQueueInterface (void) const
   return m_devQueueIface;
 }
 
+void
+QueueDisc::SetSharedBuffer (Ptr<SharedBufferManager> buffer, uint32_t port)
+{
+  NS_LOG_FUNCTION (this << buffer << port);
+  NS_ABORT_MSG_IF (GetNPackets () > 0 || m_requeued, "Cannot draw from a shared buffer with packets queued");
+  m_sharedBuffer = buffer;
+  m_sharedBufferPort = port;
+}
+
+Ptr<SharedBufferManager>
+QueueDisc::GetSharedBuffer (void) const
+{
+  return m_sharedBuffer;
+}
+
+void
+QueueDisc::SetFlowStats (Ptr<QueueDiscFlowStats> flowStats)
+{
+  NS_LOG_FUNCTION (this << flowStats);
+  m_flowStats = flowStats;
+}
+
+Ptr<QueueDiscFlowStats>
+QueueDisc::GetFlowStats (void) const
+{
+  return m_flowStats;
+}
+
 void
 QueueDisc::SetSendCallback (SendCallback func)
 {
@@ -563,6 +906,20 @@ QueueDisc::GetSendCallback (void) const
   return m_send;
 }
 
+void
+QueueDisc::SetSendBatchCallback (SendBatchCallback func)
+{
+  NS_LOG_FUNCTION (this);
+  m_sendBatch = func;
+}
+
+QueueDisc::SendBatchCallback
+QueueDisc::GetSendBatchCallback (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_sendBatch;
+}
+
 void
 QueueDisc::SetQuota (const uint32_t quota)
 {
@@ -691,14 +1048,65 @@ QueueDisc::GetWakeMode (void) const
   return WAKE_ROOT;
 }
 
+void
+QueueDisc::ResetOccupancy (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_stats.occupancy.Clear ();
+  m_lastOccupancyChange = Simulator::Now ();
+}
+
+void
+QueueDisc::RecordOccupancy (void)
+{
+  Time now = Simulator::Now ();
+  int64_t elapsed = (now - m_lastOccupancyChange).GetTimeStep ();
+  m_lastOccupancyChange = now;
+  if (elapsed == 0)
+    {
+      return;
+    }
+
+  OccupancyHistogram &occupancy = m_stats.occupancy;
+  uint32_t nPackets = m_nPackets;
+  if (nPackets >= occupancy.packets.size ())
+    {
+      occupancy.packets.resize (nPackets + 1, 0);
+    }
+  occupancy.packets[nPackets] += elapsed;
+
+  uint32_t bin = m_nBytes / occupancy.byteBinSize;
+  if (bin >= occupancy.bytes.size ())
+    {
+      occupancy.bytes.resize (bin + 1, 0);
+    }
+  occupancy.bytes[bin] += elapsed;
+}
+
 void
 QueueDisc::PacketEnqueued (Ptr<const QueueDiscItem> item)
 {
+  if (m_recordOccupancy)
+    {
+      RecordOccupancy ();
+    }
+
   m_nPackets++;
   m_nBytes += item->GetSize ();
   m_stats.nTotalEnqueuedPackets++;
   m_stats.nTotalEnqueuedBytes += item->GetSize ();
 
+  if (m_flowStats)
+    {
+      m_flowStats->RecordEnqueue (item);
+    }
+
+  if (m_sharedBuffer)
+    {
+      m_sharedBuffer->PacketEnqueued (m_sharedBufferPort, SharedBufferManager::GetPriorityClass (item),
+                                      item->GetSize ());
+    }
+
   NS_LOG_LOGIC ("m_traceEnqueue (p)");
   m_traceEnqueue (item);
 }
@@ -713,11 +1121,30 @@ QueueDisc::PacketDequeued (Ptr<const QueueDiscItem> item)
   // the packet will be actually dequeued.
   if (!m_peeked)
     {
+      if (m_recordOccupancy)
+        {
+          RecordOccupancy ();
+          OccupancyHistogram &occupancy = m_stats.occupancy;
+          uint32_t bin = (Simulator::Now () - item->GetTimeStamp ()).GetTimeStep ()
+                         / occupancy.sojournBinWidth.GetTimeStep ();
+          if (bin >= occupancy.sojourn.size ())
+            {
+              occupancy.sojourn.resize (bin + 1, 0);
+            }
+          occupancy.sojourn[bin]++;
+        }
+
       m_nPackets--;
       m_nBytes -= item->GetSize ();
       m_stats.nTotalDequeuedPackets++;
       m_stats.nTotalDequeuedBytes += item->GetSize ();
 
+      if (m_sharedBuffer)
+        {
+          m_sharedBuffer->PacketDequeued (m_sharedBufferPort, SharedBufferManager::GetPriorityClass (item),
+                                          item->GetSize ());
+        }
+
       m_sojourn (Simulator::Now () - item->GetTimeStamp ());
 
       NS_LOG_LOGIC ("m_traceDequeue (p)");
@@ -725,36 +1152,37 @@ QueueDisc::PacketDequeued (Ptr<const QueueDiscItem> item)
     }
 }
 
+void
+QueueDisc::DropBeforeEnqueue (Ptr<const QueueDiscItem> item, const QueueDiscReason &reason)
+{
+  DropBeforeEnqueue (item, reason.GetName (), reason.GetId ());
+}
+
 void
 QueueDisc::DropBeforeEnqueue (Ptr<const QueueDiscItem> item, const char* reason)
+{
+  uint32_t id = Stats::GetReasonId (reason);
+  DropBeforeEnqueue (item, Stats::GetReasonName (id).c_str (), id);
+}
+
+void
+QueueDisc::DropBeforeEnqueue (Ptr<const QueueDiscItem> item, const char* reason, uint32_t reasonId)
 {
   NS_LOG_FUNCTION (this << item << reason);
 
+  if (m_flowStats)
+    {
+      m_flowStats->RecordDrop (item);
+    }
+
   m_stats.nTotalDroppedPackets++;
   m_stats.nTotalDroppedBytes += item->GetSize ();
   m_stats.nTotalDroppedPacketsBeforeEnqueue++;
   m_stats.nTotalDroppedBytesBeforeEnqueue += item->GetSize ();
 
-  // update the number of packets dropped for the given reason
-  std::map<std::string, uint32_t>::iterator itp = m_stats.nDroppedPacketsBeforeEnqueue.find (reason);
-  if (itp != m_stats.nDroppedPacketsBeforeEnqueue.end ())
-    {
-      itp->second++;
-    }
-  else
-    {
-      m_stats.nDroppedPacketsBeforeEnqueue[reason] = 1;
-    }
-  // update the amount of bytes dropped for the given reason
-  std::map<std::string, uint64_t>::iterator itb = m_stats.nDroppedBytesBeforeEnqueue.find (reason);
-  if (itb != m_stats.nDroppedBytesBeforeEnqueue.end ())
-    {
-      itb->second += item->GetSize ();
-    }
-  else
-    {
-      m_stats.nDroppedBytesBeforeEnqueue[reason] = item->GetSize ();
-    }
+  // update the number of packets and bytes dropped for the given reason
+  AddToReasonCounters (m_stats.nDroppedPacketsBeforeEnqueue, m_stats.nDroppedBytesBeforeEnqueue,
+                       reasonId, item->GetSize ());
 
   NS_LOG_DEBUG ("Total packets/bytes dropped before enqueue: "
                 << m_stats.nTotalDroppedPacketsBeforeEnqueue << " / "
@@ -764,36 +1192,37 @@ QueueDisc::DropBeforeEnqueue (Ptr<const QueueDiscItem> item, const char* reason)
   m_traceDropBeforeEnqueue (item, reason);
 }
 
+void
+QueueDisc::DropAfterDequeue (Ptr<const QueueDiscItem> item, const QueueDiscReason &reason)
+{
+  DropAfterDequeue (item, reason.GetName (), reason.GetId ());
+}
+
 void
 QueueDisc::DropAfterDequeue (Ptr<const QueueDiscItem> item, const char* reason)
+{
+  uint32_t id = Stats::GetReasonId (reason);
+  DropAfterDequeue (item, Stats::GetReasonName (id).c_str (), id);
+}
+
+void
+QueueDisc::DropAfterDequeue (Ptr<const QueueDiscItem> item, const char* reason, uint32_t reasonId)
 {
   NS_LOG_FUNCTION (this << item << reason);
 
+  if (m_flowStats)
+    {
+      m_flowStats->RecordDrop (item);
+    }
+
   m_stats.nTotalDroppedPackets++;
   m_stats.nTotalDroppedBytes += item->GetSize ();
   m_stats.nTotalDroppedPacketsAfterDequeue++;
   m_stats.nTotalDroppedBytesAfterDequeue += item->GetSize ();
 
-  // update the number of packets dropped for the given reason
-  std::map<std::string, uint32_t>::iterator itp = m_stats.nDroppedPacketsAfterDequeue.find (reason);
-  if (itp != m_stats.nDroppedPacketsAfterDequeue.end ())
-    {
-      itp->second++;
-    }
-  else
-    {
-      m_stats.nDroppedPacketsAfterDequeue[reason] = 1;
-    }
-  // update the amount of bytes dropped for the given reason
-  std::map<std::string, uint64_t>::iterator itb = m_stats.nDroppedBytesAfterDequeue.find (reason);
-  if (itb != m_stats.nDroppedBytesAfterDequeue.end ())
-    {
-      itb->second += item->GetSize ();
-    }
-  else
-    {
-      m_stats.nDroppedBytesAfterDequeue[reason] = item->GetSize ();
-    }
+  // update the number of packets and bytes dropped for the given reason
+  AddToReasonCounters (m_stats.nDroppedPacketsAfterDequeue, m_stats.nDroppedBytesAfterDequeue,
+                       reasonId, item->GetSize ());
 
   // if in the context of a peek request a dequeued packet is dropped, we need
   // to update the statistics and fire the dequeue trace before firing the drop
@@ -814,8 +1243,37 @@ QueueDisc::DropAfterDequeue (Ptr<const QueueDiscItem> item, const char* reason)
   m_traceDropAfterDequeue (item, reason);
 }
 
+uint32_t
+QueueDisc::GetChildReasonId (std::vector<std::pair<const char*, uint32_t> > &cache,
+                             const char* prefix, const char* childReason)
+{
+  for (auto it = cache.begin (); it != cache.end (); it++)
+    {
+      if (it->first == childReason)
+        {
+          return it->second;
+        }
+    }
+  uint32_t id = Stats::GetReasonId (std::string (prefix).append (childReason));
+  cache.push_back (std::make_pair (childReason, id));
+  return id;
+}
+
+bool
+QueueDisc::Mark (Ptr<QueueDiscItem> item, const QueueDiscReason &reason)
+{
+  return Mark (item, reason.GetName (), reason.GetId ());
+}
+
 bool
 QueueDisc::Mark (Ptr<QueueDiscItem> item, const char* reason)
+{
+  uint32_t id = Stats::GetReasonId (reason);
+  return Mark (item, Stats::GetReasonName (id).c_str (), id);
+}
+
+bool
+QueueDisc::Mark (Ptr<QueueDiscItem> item, const char* reason, uint32_t reasonId)
 {
   NS_LOG_FUNCTION (this << item << reason);
 
@@ -826,29 +1284,17 @@ QueueDisc::Mark (Ptr<QueueDiscItem> item, const char* reason)
       return false;
     }
 
+  if (m_flowStats)
+    {
+      m_flowStats->RecordMark (item);
+    }
+
   m_stats.nTotalMarkedPackets++;
   m_stats.nTotalMarkedBytes += item->GetSize ();
 
-  // update the number of packets marked for the given reason
-  std::map<std::string, uint32_t>::iterator itp = m_stats.nMarkedPackets.find (reason);
-  if (itp != m_stats.nMarkedPackets.end ())
-    {
-      itp->second++;
-    }
-  else
-    {
-      m_stats.nMarkedPackets[reason] = 1;
-    }
-  // update the amount of bytes marked for the given reason
-  std::map<std::string, uint64_t>::iterator itb = m_stats.nMarkedBytes.find (reason);
-  if (itb != m_stats.nMarkedBytes.end ())
-    {
-      itb->second += item->GetSize ();
-    }
-  else
-    {
-      m_stats.nMarkedBytes[reason] = item->GetSize ();
-    }
+  // update the number of packets and bytes marked for the given reason
+  AddToReasonCounters (m_stats.nMarkedPackets, m_stats.nMarkedBytes,
+                       reasonId, item->GetSize ());
 
   NS_LOG_DEBUG ("Total packets/bytes marked: "
                 << m_stats.nTotalMarkedPackets << " / "
@@ -865,11 +1311,29 @@ QueueDisc::Enqueue (Ptr<QueueDiscItem> item)
   m_stats.nTotalReceivedPackets++;
   m_stats.nTotalReceivedBytes += item->GetSize ();
 
+  // the packet is only accounted in the shared buffer (by PacketEnqueued) and
+  // marked if DoEnqueue does not drop it
+  bool sharedBufferMark = false;
+  if (m_sharedBuffer)
+    {
+      if (!m_sharedBuffer->CanAdmit (m_sharedBufferPort, SharedBufferManager::GetPriorityClass (item),
+                                     item->GetSize ()))
+        {
+          DropBeforeEnqueue (item, g_sharedBufferDrop);
+          return false;
+        }
+      sharedBufferMark = m_sharedBuffer->IsAboveMarkingThreshold ();
+    }
+
   bool retval = DoEnqueue (item);
 
   if (retval)
     {
       item->SetTimeStamp (Simulator::Now ());
+      if (sharedBufferMark)
+        {
+          Mark (item, g_sharedBufferMark);
+        }
     }
 
   // DoEnqueue may return false because:
@@ -900,20 +1364,11 @@ QueueDisc::Dequeue (void)
   // The QueueDisc::DoPeek method dequeues a packet and keeps it as a requeued
   // packet. Thus, first check whether a peeked packet exists. Otherwise, call
   // the private DoDequeue method.
-  Ptr<QueueDiscItem> item = m_requeued;
+  Ptr<QueueDiscItem> item;
 
-  if (item)
+  if (m_requeued)
     {
-      m_requeued = 0;
-      if (m_peeked)
-        {
-          // If the packet was requeued because a peek operation was requested
-          // (which is the case here because DequeuePacket calls Dequeue only
-          // when m_requeued is null), we need to explicitly call PacketDequeued
-          // to update statistics about dequeued packets and fire the dequeue trace.
-          m_peeked = false;
-          PacketDequeued (item);
-        }
+      item = TakeRequeued ();
     }
   else
     {
@@ -959,13 +1414,25 @@ QueueDisc::Run (void)
   if (RunBegin ())
     {
       uint32_t quota = m_quota;
-      while (Restart ())
+      // Linux only tries bulk dequeues for queue discs attached to a single
+      // device queue, as all the packets of a batch go to the same queue
+      if (m_bulkDequeue && m_sendBatch
+          && (!m_devQueueIface || m_devQueueIface->GetNTxQueues () == 1))
         {
-          quota -= 1;
-          if (quota <= 0)
+          while (quota > 0 && RestartBatch (quota))
             {
-              /// \todo netif_schedule (q);
-              break;
+            }
+        }
+      else
+        {
+          while (Restart ())
+            {
+              quota -= 1;
+              if (quota <= 0)
+                {
+                  /// \todo netif_schedule (q);
+                  break;
+                }
             }
         }
       RunEnd ();
@@ -1006,6 +1473,40 @@ QueueDisc::Restart (void)
   return Transmit (item);
 }
 
+bool
+QueueDisc::RestartBatch (uint32_t &quota)
+{
+  NS_LOG_FUNCTION (this << quota);
+
+  // Do not dequeue more packets than the device can take before stopping its
+  // queue (the device queue is not stopped here, so it can take at least one)
+  uint32_t limit = quota;
+  if (m_devQueueIface)
+    {
+      limit = std::max<uint32_t> (1, std::min (limit, m_devQueueIface->GetTxQueue (0)->GetAvailablePackets ()));
+    }
+
+  std::vector<Ptr<QueueDiscItem> > batch;
+  while (batch.size () < limit)
+    {
+      Ptr<QueueDiscItem> item = DequeuePacket ();
+      if (item == 0)
+        {
+          break;
+        }
+      batch.push_back (item);
+    }
+
+  if (batch.empty ())
+    {
+      NS_LOG_LOGIC ("No packet to send");
+      return false;
+    }
+
+  quota -= batch.size ();
+  return TransmitBatch (batch);
+}
+
 Ptr<QueueDiscItem>
 QueueDisc::DequeuePacket ()
 {
@@ -1021,16 +1522,7 @@ QueueDisc::DequeuePacket ()
         // If the device does not support flow control, the device queue is never stopped
         if (!m_devQueueIface || !m_devQueueIface->GetTxQueue (m_requeued->GetTxQueueIndex ())->IsStopped ())
           {
-            item = m_requeued;
-            m_requeued = 0;
-            if (m_peeked)
-              {
-                // If the packet was requeued because a peek operation was requested
-                // we need to explicitly call PacketDequeued to update statistics
-                // about dequeued packets and fire the dequeue trace.
-                m_peeked = false;
-                PacketDequeued (item);
-              }
+            item = TakeRequeued ();
           }
     }
   else
@@ -1055,20 +1547,72 @@ QueueDisc::DequeuePacket ()
   return item;
 }
 
+Ptr<QueueDiscItem>
+QueueDisc::TakeRequeued (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Ptr<QueueDiscItem> item = m_requeued;
+  NS_ASSERT (item);
+  m_requeued = 0;
+  if (!m_requeuedBatch.empty ())
+    {
+      m_requeued = m_requeuedBatch.front ();
+      m_requeuedBatch.pop_front ();
+    }
+  if (m_peeked)
+    {
+      // If the packet was requeued because a peek operation was requested
+      // we need to explicitly call PacketDequeued to update statistics
+      // about dequeued packets and fire the dequeue trace.
+      m_peeked = false;
+      PacketDequeued (item);
+    }
+  else if (m_sharedBuffer)
+    {
+      // the packet was held in the shared buffer since it was requeued
+      m_sharedBuffer->PacketDequeued (m_sharedBufferPort, SharedBufferManager::GetPriorityClass (item),
+                                      item->GetSize ());
+    }
+  return item;
+}
+
 void
 QueueDisc::Requeue (Ptr<QueueDiscItem> item)
 {
   NS_LOG_FUNCTION (this << item);
+  // the packet was dequeued before the packets still requeued, if any
+  if (m_requeued != 0)
+    {
+      m_requeuedBatch.push_front (m_requeued);
+    }
   m_requeued = item;
   /// \todo netif_schedule (q);
 
   m_stats.nTotalRequeuedPackets++;
   m_stats.nTotalRequeuedBytes += item->GetSize ();
 
+  // the packet occupies the shared buffer until it is dequeued again
+  if (m_sharedBuffer)
+    {
+      m_sharedBuffer->PacketEnqueued (m_sharedBufferPort, SharedBufferManager::GetPriorityClass (item),
+                                      item->GetSize ());
+    }
+
   NS_LOG_LOGIC ("m_traceRequeue (p)");
   m_traceRequeue (item);
 }
 
+void
+QueueDisc::RequeueBatch (const std::vector<Ptr<QueueDiscItem> > &batch, std::size_t first)
+{
+  NS_LOG_FUNCTION (this << first);
+  for (std::size_t i = batch.size (); i > first; i--)
+    {
+      Requeue (batch[i - 1]);
+    }
+}
+
 bool
 QueueDisc::Transmit (Ptr<QueueDiscItem> item)
 {
@@ -1090,6 +1634,35 @@ QueueDisc::Transmit (Ptr<QueueDiscItem> item)
       SocketPriorityTag priorityTag;
       item->GetPacket ()->RemovePacketTag (priorityTag);
     }
+
+  if (item->GetSegmentSize () > 0)
+    {
+      std::vector<Ptr<QueueDiscItem> > segments;
+      Segment (item, segments);
+      // as in Run, the segments are sent in a batch if bulk dequeue is enabled
+      // and the device has a single queue
+      if (m_bulkDequeue && m_sendBatch
+          && (!m_devQueueIface || m_devQueueIface->GetNTxQueues () == 1))
+        {
+          return TransmitBatch (segments);
+        }
+      NS_ASSERT_MSG (m_send, "Send callback not set");
+      // the segments that do not fit in the device queue are requeued
+      bool stopped = false;
+      for (std::size_t i = 0; i < segments.size (); i++)
+        {
+          if (m_devQueueIface && m_devQueueIface->GetTxQueue (item->GetTxQueueIndex ())->IsStopped ())
+            {
+              RequeueBatch (segments, i);
+              stopped = true;
+              break;
+            }
+          m_send (segments[i]);
+        }
+      return !stopped && GetNPackets () > 0
+             && !(m_devQueueIface && m_devQueueIface->GetTxQueue (item->GetTxQueueIndex ())->IsStopped ());
+    }
+
   NS_ASSERT_MSG (m_send, "Send callback not set");
   m_send (item);
 
@@ -1118,4 +1691,100 @@ QueueDisc::Transmit (Ptr<QueueDiscItem> item)
   return true;
 }
 
+bool
+QueueDisc::TransmitBatch (const std::vector<Ptr<QueueDiscItem> > &batch)
+{
+  NS_LOG_FUNCTION (this << batch.size ());
+  NS_ASSERT_MSG (m_sendBatch, "Send batch callback not set");
+  // Batches are only built for single queue devices (see Run and Transmit)
+  NS_ASSERT (!m_devQueueIface || m_devQueueIface->GetNTxQueues () == 1);
+
+  for (std::size_t i = 0; i < batch.size (); i++)
+    {
+      if (batch[i]->GetSegmentSize () > 0)
+        {
+          // Transmit the batch with the super-segments replaced by their segments
+          std::vector<Ptr<QueueDiscItem> > segments (batch.begin (), batch.begin () + i);
+          for (; i < batch.size (); i++)
+            {
+              if (batch[i]->GetSegmentSize () > 0)
+                {
+                  Segment (batch[i], segments);
+                }
+              else
+                {
+                  segments.push_back (batch[i]);
+                }
+            }
+          return TransmitBatch (segments);
+        }
+    }
+
+  // Consecutive packets with the same destination and protocol are handed to
+  // the device in a single burst. The device stops accepting packets when its
+  // queue is stopped and the remaining packets are requeued.
+  std::size_t nSent = 0;
+  while (nSent < batch.size ())
+    {
+      Ptr<PacketBurst> burst = CreateObject<PacketBurst> ();
+      const Address &address = batch[nSent]->GetAddress ();
+      uint16_t protocol = batch[nSent]->GetProtocol ();
+      std::size_t end = nSent;
+      while (end < batch.size () && batch[end]->GetProtocol () == protocol
+             && batch[end]->GetAddress () == address)
+        {
+          // a single queue device makes no use of the priority tag
+          SocketPriorityTag priorityTag;
+          batch[end]->GetPacket ()->RemovePacketTag (priorityTag);
+          burst->AddPacket (batch[end]->GetPacket ());
+          end++;
+        }
+
+      uint32_t nAccepted = m_sendBatch (burst, address, protocol);
+      NS_ASSERT (nAccepted <= end - nSent);
+      nSent += nAccepted;
+      if (nSent < end)
+        {
+          break;
+        }
+    }
+
+  RequeueBatch (batch, nSent);
+
+  // if packets were requeued, the queue disc is empty or the device queue is
+  // now stopped, return false so that the Run method exits
+  if (nSent < batch.size () || GetNPackets () == 0
+      || (m_devQueueIface && m_devQueueIface->GetTxQueue (batch.back ()->GetTxQueueIndex ())->IsStopped ()))
+    {
+      return false;
+    }
+
+  return true;
+}
+
+void
+QueueDisc::Segment (Ptr<QueueDiscItem> item, std::vector<Ptr<QueueDiscItem> > &segments)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  std::size_t first = segments.size ();
+  item->Segment (segments);
+
+  uint32_t nSegments = segments.size () - first;
+  uint64_t bytes = 0;
+  for (std::size_t i = first; i < segments.size (); i++)
+    {
+      bytes += segments[i]->GetSize ();
+    }
+  NS_ASSERT (nSegments > 0 && bytes >= item->GetSize ());
+  uint64_t extraBytes = bytes - item->GetSize ();
+
+  m_stats.nTotalReceivedPackets += nSegments - 1;
+  m_stats.nTotalReceivedBytes += extraBytes;
+  m_stats.nTotalEnqueuedPackets += nSegments - 1;
+  m_stats.nTotalEnqueuedBytes += extraBytes;
+  m_stats.nTotalDequeuedPackets += nSegments - 1;
+  m_stats.nTotalDequeuedBytes += extraBytes;
+}
+
 } // namespace ns3
@@ -25,7 +25,9 @@
 #include "ns3/traced-callback.h"
 #include "ns3/queue-item.h"
 #include "ns3/queue-size.h"
+#include "ns3/nstime.h"
 #include <vector>
+#include <deque>
 #include <map>
 #include <functional>
 #include <string>
@@ -36,6 +38,43 @@ namespace ns3 {
 class QueueDisc;
 template <typename Item> class Queue;
 class NetDeviceQueueInterface;
+class PacketBurst;
+class SharedBufferManager;
+class QueueDiscFlowStats;
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief A reason why a queue disc drops or marks packets, interned once
+ *
+ * A queue disc defines a static QueueDiscReason for each of its reason
+ * constants. The reason is interned when the object is constructed, so that
+ * a drop or a mark passes the id of its reason and only updates the counters
+ * indexed by that id.
+ */
+class QueueDiscReason
+{
+public:
+  /**
+   * \brief Constructor
+   * \param name the reason, a string constant
+   */
+  explicit QueueDiscReason (const char* name);
+
+  /**
+   * \return the reason
+   */
+  const char* GetName (void) const;
+
+  /**
+   * \return the id of the reason, the same for all the queue discs
+   */
+  uint32_t GetId (void) const;
+
+private:
+  const char* m_name;   //!< The reason
+  uint32_t m_id;        //!< The id of the reason
+};
 
 /**
  * \ingroup traffic-control
@@ -168,6 +207,23 @@ enum QueueDiscSizePolicy
  * queue disc, the reason is "(Dropped by child queue disc) " followed by the
  * reason why the child queue disc dropped the packet.
  *
+ * The reasons are interned into small integer ids (see Stats::GetReasonId),
+ * and the per-reason counters are vectors indexed by these ids. The reason
+ * constants of the queue discs are interned once, as static QueueDiscReason
+ * objects, so that a drop or a mark only costs an array update. The reasons
+ * of a child queue disc are interned by the parent the first time they are
+ * seen.
+ *
+ * A QueueDiscFlowStats object can be set on a queue disc (see SetFlowStats)
+ * to count the packets enqueued, marked and dropped by each flow, e.g., to
+ * find out which flows suffer the marks and drops of a bottleneck.
+ *
+ * If the RecordOccupancy attribute is set, the queue disc also keeps, in the
+ * occupancy member of its statistics, the time spent with each number of
+ * packets and bytes queued and the distribution of the sojourn times. These
+ * histograms are updated as the packets are enqueued and dequeued, hence they
+ * capture every change of the queue length without any sampling event.
+ *
  * The QueueDisc base class provides the SojournTime trace source, which provides
  * the sojourn time of every packet dequeued from a queue disc, including packets
  * that are dropped or requeued after being dequeued. The sojourn time is taken
@@ -181,6 +237,60 @@ enum QueueDiscSizePolicy
 class QueueDisc : public Object {
 public:
 
+  /// \brief Time-weighted histograms of the queue disc occupancy
+  struct OccupancyHistogram
+  {
+    /// Time (in time steps) spent with each number of packets queued
+    std::vector<int64_t> packets;
+    /// Time (in time steps) spent with each range of ByteBinSize bytes queued
+    std::vector<int64_t> bytes;
+    /// Number of packets with a sojourn time in each range of SojournBinWidth
+    std::vector<uint32_t> sojourn;
+    /// Size of the ranges of the byte histogram
+    uint32_t byteBinSize;
+    /// Width of the ranges of the sojourn time histogram
+    Time sojournBinWidth;
+
+    /// constructor
+    OccupancyHistogram ();
+
+    /**
+     * \return the time covered by the histograms
+     */
+    Time GetDuration (void) const;
+    /**
+     * \return the time-weighted mean number of packets queued
+     */
+    double GetMeanPackets (void) const;
+    /**
+     * \brief Get a quantile of the number of packets queued
+     * \param q the quantile, between 0 and 1
+     * \return the smallest number of packets queued at least q of the time
+     */
+    uint32_t GetPacketsQuantile (double q) const;
+    /**
+     * \brief Get a quantile of the number of bytes queued
+     * \param q the quantile, between 0 and 1
+     * \return the upper bound of the first range queued at least q of the time
+     */
+    uint32_t GetBytesQuantile (double q) const;
+    /**
+     * \brief Get a quantile of the sojourn time
+     * \param q the quantile, between 0 and 1
+     * \return the upper bound of the first range including q of the packets
+     */
+    Time GetSojournQuantile (double q) const;
+    /**
+     * \brief Print the cumulative distributions, one line per non-empty range.
+     * \param os output stream in which the data should be printed.
+     */
+    void Print (std::ostream &os) const;
+    /**
+     * \brief Remove all the samples
+     */
+    void Clear (void);
+  };
+
   /// \brief Structure that keeps the queue disc statistics
   struct Stats
   {
@@ -204,34 +314,36 @@ public:
     uint32_t nTotalDroppedPackets;
     /// Total packets dropped before enqueue
     uint32_t nTotalDroppedPacketsBeforeEnqueue;
-    /// Packets dropped before enqueue, for each reason
-    std::map<std::string, uint32_t> nDroppedPacketsBeforeEnqueue;
+    /// Packets dropped before enqueue, indexed by reason id
+    std::vector<uint32_t> nDroppedPacketsBeforeEnqueue;
     /// Total packets dropped after dequeue
     uint32_t nTotalDroppedPacketsAfterDequeue;
-    /// Packets dropped after dequeue, for each reason
-    std::map<std::string, uint32_t> nDroppedPacketsAfterDequeue;
+    /// Packets dropped after dequeue, indexed by reason id
+    std::vector<uint32_t> nDroppedPacketsAfterDequeue;
     /// Total dropped bytes
     uint64_t nTotalDroppedBytes;
     /// Total bytes dropped before enqueue
     uint64_t nTotalDroppedBytesBeforeEnqueue;
-    /// Bytes dropped before enqueue, for each reason
-    std::map<std::string, uint64_t> nDroppedBytesBeforeEnqueue;
+    /// Bytes dropped before enqueue, indexed by reason id
+    std::vector<uint64_t> nDroppedBytesBeforeEnqueue;
     /// Total bytes dropped after dequeue
     uint64_t nTotalDroppedBytesAfterDequeue;
-    /// Bytes dropped after dequeue, for each reason
-    std::map<std::string, uint64_t> nDroppedBytesAfterDequeue;
+    /// Bytes dropped after dequeue, indexed by reason id
+    std::vector<uint64_t> nDroppedBytesAfterDequeue;
     /// Total requeued packets
     uint32_t nTotalRequeuedPackets;
     /// Total requeued bytes
     uint64_t nTotalRequeuedBytes;
     /// Total marked packets
     uint32_t nTotalMarkedPackets;
-    /// Marked packets, for each reason
-    std::map<std::string, uint32_t> nMarkedPackets;
+    /// Marked packets, indexed by reason id
+    std::vector<uint32_t> nMarkedPackets;
     /// Total marked bytes
     uint32_t nTotalMarkedBytes;
-    /// Marked bytes, for each reason
-    std::map<std::string, uint64_t> nMarkedBytes;
+    /// Marked bytes, indexed by reason id
+    std::vector<uint64_t> nMarkedBytes;
+    /// Occupancy histograms, empty unless RecordOccupancy is set -- call GetStats first
+    OccupancyHistogram occupancy;
 
     /// constructor
     Stats ();
@@ -260,11 +372,80 @@ public:
      * \return the amount of bytes marked for the given reason
      */
     uint64_t GetNMarkedBytes (std::string reason) const;
+    /**
+     * \brief Get the number of packets dropped before enqueue for each reason
+     * \return the number of packets dropped before enqueue, keyed by reason
+     */
+    std::map<std::string, uint32_t> GetNDroppedPacketsBeforeEnqueue (void) const;
+    /**
+     * \brief Get the number of packets dropped after dequeue for each reason
+     * \return the number of packets dropped after dequeue, keyed by reason
+     */
+    std::map<std::string, uint32_t> GetNDroppedPacketsAfterDequeue (void) const;
+    /**
+     * \brief Get the amount of bytes dropped before enqueue for each reason
+     * \return the amount of bytes dropped before enqueue, keyed by reason
+     */
+    std::map<std::string, uint64_t> GetNDroppedBytesBeforeEnqueue (void) const;
+    /**
+     * \brief Get the amount of bytes dropped after dequeue for each reason
+     * \return the amount of bytes dropped after dequeue, keyed by reason
+     */
+    std::map<std::string, uint64_t> GetNDroppedBytesAfterDequeue (void) const;
+    /**
+     * \brief Get the number of packets marked for each reason
+     * \return the number of packets marked, keyed by reason
+     */
+    std::map<std::string, uint32_t> GetNMarkedPackets (void) const;
+    /**
+     * \brief Get the amount of bytes marked for each reason
+     * \return the amount of bytes marked, keyed by reason
+     */
+    std::map<std::string, uint64_t> GetNMarkedBytes (void) const;
     /**
      * \brief Print the statistics.
      * \param os output stream in which the data should be printed.
      */
     void Print (std::ostream &os) const;
+
+    /**
+     * \brief Get the id of a reason, interning the reason if it is new
+     * \param reason the reason why packets were dropped or marked
+     * \return the id of the reason, the same for all the queue discs
+     */
+    static uint32_t GetReasonId (const std::string &reason);
+    /**
+     * \brief Get the reason with the given id
+     * \param id the id of the reason
+     * \return the reason
+     */
+    static const std::string & GetReasonName (uint32_t id);
+
+  private:
+    /**
+     * \brief Look up the id of a reason, without interning it
+     * \param reason the reason
+     * \param [out] id the id of the reason, if found
+     * \return true if the reason has an id
+     */
+    static bool FindReasonId (const std::string &reason, uint32_t &id);
+    /**
+     * \brief Key the counters of the reasons that occurred by reason
+     * \param packets the packet counters, indexed by reason id
+     * \param counters the counters to key, indexed by reason id
+     * \return the counters of the reasons with a packet, keyed by reason
+     */
+    template <typename T>
+    static std::map<std::string, T> GetReasonMap (const std::vector<uint32_t> &packets,
+                                                  const std::vector<T> &counters);
+    /**
+     * \brief Print the counters of each reason, in alphabetical order
+     * \param os output stream
+     * \param packets the packet counters, indexed by reason id
+     * \param bytes the byte counters, indexed by reason id
+     */
+    static void PrintReasons (std::ostream &os, const std::vector<uint32_t> &packets,
+                              const std::vector<uint64_t> &bytes);
   };
 
   /**
@@ -337,6 +518,11 @@ public:
    */
   const Stats& GetStats (void);
 
+  /**
+   * \brief Restart the occupancy histograms, e.g., at the start of a measurement
+   */
+  void ResetOccupancy (void);
+
   /**
    * \param ndqi the NetDeviceQueueInterface aggregated to the receiving object.
    *
@@ -353,6 +539,38 @@ public:
    */
   Ptr<NetDeviceQueueInterface> GetNetDeviceQueueInterface (void) const;
 
+  /**
+   * \brief Draw the packets of this queue disc from a shared buffer
+   * \param buffer the shared buffer manager
+   * \param port the index of the port of this queue disc
+   *
+   * Called by SharedBufferManager::AddQueueDisc. The shared buffer is
+   * checked before the packets are handed to DoEnqueue, and the packets
+   * it does not admit are dropped as SHARED_BUFFER_DROP. A packet is only
+   * accounted in the buffer, and marked as SHARED_BUFFER_MARK if the buffer
+   * was above its marking threshold, once DoEnqueue has stored it. The
+   * requeued packets remain accounted until they are dequeued again. This
+   * method must only be called on a root queue disc.
+   */
+  void SetSharedBuffer (Ptr<SharedBufferManager> buffer, uint32_t port);
+
+  /**
+   * \return the shared buffer the packets are drawn from, if any
+   */
+  Ptr<SharedBufferManager> GetSharedBuffer (void) const;
+
+  /**
+   * \brief Count the packets enqueued, marked and dropped by this queue disc
+   *        per flow
+   * \param flowStats the per-flow counters, null to stop counting
+   */
+  void SetFlowStats (Ptr<QueueDiscFlowStats> flowStats);
+
+  /**
+   * \return the per-flow counters of this queue disc, if any
+   */
+  Ptr<QueueDiscFlowStats> GetFlowStats (void) const;
+
   /// Callback invoked to send a packet to the receiving object when Run is called
   typedef std::function<void (Ptr<QueueDiscItem>)> SendCallback;
 
@@ -372,6 +590,27 @@ public:
    */
   SendCallback GetSendCallback (void) const;
 
+  /**
+   * Callback invoked to send a burst of packets, all having the same destination
+   * address and protocol number, to the receiving object when Run is called.
+   * It returns the number of packets consumed from the front of the burst.
+   */
+  typedef std::function<uint32_t (Ptr<PacketBurst>, const Address &, uint16_t)> SendBatchCallback;
+
+  /**
+   * \param func the callback to send a burst of packets to the receiving object.
+   *
+   * Set the callback used by the TransmitBatch method (called eventually by the
+   * Run method when bulk dequeue is enabled) to send packets to the receiving
+   * object.
+   */
+  void SetSendBatchCallback (SendBatchCallback func);
+
+  /**
+   * \return the callback to send a burst of packets to the receiving object.
+   */
+  SendBatchCallback GetSendBatchCallback (void) const;
+
   /**
    * \brief Set the maximum number of dequeue operations following a packet enqueue
    * \param quota the maximum number of dequeue operations following a packet enqueue.
@@ -516,6 +755,8 @@ public:
   static constexpr const char* INTERNAL_QUEUE_DROP = "Dropped by internal queue";    //!< Packet dropped by an internal queue
   static constexpr const char* CHILD_QUEUE_DISC_DROP = "(Dropped by child queue disc) "; //!< Packet dropped by a child queue disc
   static constexpr const char* CHILD_QUEUE_DISC_MARK = "(Marked by child queue disc) "; //!< Packet marked by a child queue disc
+  static constexpr const char* SHARED_BUFFER_DROP = "Shared buffer limit exceeded"; //!< Packet not admitted by the shared buffer
+  static constexpr const char* SHARED_BUFFER_MARK = "Shared buffer above marking threshold"; //!< Packet marked by the shared buffer
 
 protected:
   /**
@@ -542,6 +783,16 @@ protected:
    *  This method must be called by subclasses to record that a packet was
    *  dropped before enqueue for the specified reason
    */
+  void DropBeforeEnqueue (Ptr<const QueueDiscItem> item, const QueueDiscReason &reason);
+
+  /**
+   *  \brief Perform the actions required when the queue disc is notified of
+   *         a packet dropped before enqueue
+   *  \param item item that was dropped
+   *  \param reason the reason why the item was dropped
+   *  The reason is looked up by name at every drop: a reason constant should
+   *  rather be passed as a static QueueDiscReason
+   */
   void DropBeforeEnqueue (Ptr<const QueueDiscItem> item, const char* reason);
 
   /**
@@ -552,6 +803,16 @@ protected:
    *  This method must be called by subclasses to record that a packet was
    *  dropped after dequeue for the specified reason
    */
+  void DropAfterDequeue (Ptr<const QueueDiscItem> item, const QueueDiscReason &reason);
+
+  /**
+   *  \brief Perform the actions required when the queue disc is notified of
+   *         a packet dropped after dequeue
+   *  \param item item that was dropped
+   *  \param reason the reason why the item was dropped
+   *  The reason is looked up by name at every drop: a reason constant should
+   *  rather be passed as a static QueueDiscReason
+   */
   void DropAfterDequeue (Ptr<const QueueDiscItem> item, const char* reason);
 
   /**
@@ -561,9 +822,60 @@ protected:
    *  \param reason the reason why the item has to be marked
    *  \return true if the item was successfully marked, false otherwise
    */
+  bool Mark (Ptr<QueueDiscItem> item, const QueueDiscReason &reason);
+
+  /**
+   *  \brief Marks the given packet and, if successful, updates the counters
+   *         associated with the given reason
+   *  \param item item that has to be marked
+   *  \param reason the reason why the item has to be marked
+   *  \return true if the item was successfully marked, false otherwise
+   *  The reason is looked up by name at every mark: a reason constant should
+   *  rather be passed as a static QueueDiscReason
+   */
   bool Mark (Ptr<QueueDiscItem> item, const char* reason);
 
 private:
+  /**
+   * \brief Record a packet dropped before enqueue
+   * \param item item that was dropped
+   * \param reason the reason why the item was dropped, a stable string
+   * \param reasonId the id of the reason
+   */
+  void DropBeforeEnqueue (Ptr<const QueueDiscItem> item, const char* reason, uint32_t reasonId);
+
+  /**
+   * \brief Record a packet dropped after dequeue
+   * \param item item that was dropped
+   * \param reason the reason why the item was dropped, a stable string
+   * \param reasonId the id of the reason
+   */
+  void DropAfterDequeue (Ptr<const QueueDiscItem> item, const char* reason, uint32_t reasonId);
+
+  /**
+   * \brief Mark a packet and, if successful, record it
+   * \param item item that has to be marked
+   * \param reason the reason why the item has to be marked, a stable string
+   * \param reasonId the id of the reason
+   * \return true if the item was successfully marked, false otherwise
+   */
+  bool Mark (Ptr<QueueDiscItem> item, const char* reason, uint32_t reasonId);
+
+  /**
+   * \brief Get the id of the reason of a packet dropped or marked by a child
+   *
+   * The reasons passed by the child queue discs are string constants or
+   * interned names, hence the id is cached by pointer and the name is only
+   * built and interned the first time the child reason is seen.
+   *
+   * \param cache the ids of the child reasons seen
+   * \param prefix the prefix of the reasons of this queue disc
+   * \param childReason the reason passed by the child queue disc
+   * \return the id of the reason of this queue disc
+   */
+  static uint32_t GetChildReasonId (std::vector<std::pair<const char*, uint32_t> > &cache,
+                                    const char* prefix, const char* childReason);
+
   /**
    * \brief Copy constructor
    * \param o object to copy
@@ -655,19 +967,45 @@ private:
    */
   bool Restart (void);
 
+  /**
+   * Modelled after the Linux function qdisc_restart (net/sched/sch_generic.c)
+   * when bulk dequeue is enabled. Dequeue up to quota packets (by calling
+   * DequeuePacket) and send them to the device at once (by calling TransmitBatch).
+   * \param quota the remaining quota, decreased by the number of dequeued packets
+   * \return true if all the packets are successfully sent to the device.
+   */
+  bool RestartBatch (uint32_t &quota);
+
   /**
    * Modelled after the Linux function dequeue_skb (net/sched/sch_generic.c)
    * \return the requeued packet, if any, or the packet dequeued by the queue disc, otherwise.
    */
   Ptr<QueueDiscItem> DequeuePacket (void);
 
+  /**
+   * Remove the packet at the head of the requeued packets. A peeked packet is
+   * accounted as dequeued, and a requeued packet is released from the shared
+   * buffer, if any.
+   * \return the packet
+   */
+  Ptr<QueueDiscItem> TakeRequeued (void);
+
   /**
    * Modelled after the Linux function dev_requeue_skb (net/sched/sch_generic.c)
-   * Requeues a packet whose transmission failed.
+   * Requeues a packet whose transmission failed. The packet is put back at the
+   * head of the requeued packets, as it was dequeued before them.
    * \param item the packet to requeue
    */
   void Requeue (Ptr<QueueDiscItem> item);
 
+  /**
+   * Requeues the packets of a batch whose transmission failed, starting from
+   * the given one, at the head of the requeued packets and in their order.
+   * \param batch the packets
+   * \param first the index of the first packet to requeue
+   */
+  void RequeueBatch (const std::vector<Ptr<QueueDiscItem> > &batch, std::size_t first);
+
   /**
    * Modelled after the Linux function sch_direct_xmit (net/sched/sch_generic.c)
    * Sends a packet to the device if the device queue is not stopped, and requeues
@@ -677,6 +1015,28 @@ private:
    */
   bool Transmit (Ptr<QueueDiscItem> item);
 
+  /**
+   * Modelled after the Linux function sch_direct_xmit (net/sched/sch_generic.c)
+   * when called with a list of packets. Sends the packets to the device, grouping
+   * consecutive packets with the same destination address and protocol number in
+   * a burst, and requeues the packets that the device did not accept.
+   * Only used for devices with a single queue, as in Linux.
+   * \param batch the packets to transmit
+   * \return true if all the packets were accepted, the device queue is not stopped
+   *         and the queue disc is not empty
+   */
+  bool TransmitBatch (const std::vector<Ptr<QueueDiscItem> > &batch);
+
+  /**
+   * Modelled after the Linux function validate_xmit_skb (net/core/dev.c)
+   * Splits a super-segment into the packets to send to the device. As in
+   * Linux, the statistics count each segment as a received, enqueued and
+   * dequeued packet, so that they stay consistent when segments are requeued.
+   * \param item the super-segment, whose header has been added
+   * \param segments the vector the segments are appended to
+   */
+  void Segment (Ptr<QueueDiscItem> item, std::vector<Ptr<QueueDiscItem> > &segments);
+
   /**
    *  \brief Perform the actions required when the queue disc is notified of
    *         a packet enqueue
@@ -691,6 +1051,11 @@ private:
    */
   void PacketDequeued (Ptr<const QueueDiscItem> item);
 
+  /**
+   * \brief Add the time spent with the current occupancy to the histograms
+   */
+  void RecordOccupancy (void);
+
   static const uint32_t DEFAULT_QUOTA = 64; //!< Default quota (as in /proc/sys/net/core/dev_weight)
 
   std::vector<Ptr<InternalQueue> > m_queues;    //!< Internal queues
@@ -705,14 +1070,26 @@ private:
   Stats m_stats;                    //!< The collected statistics
   uint32_t m_quota;                 //!< Maximum number of packets dequeued in a qdisc run
   Ptr<NetDeviceQueueInterface> m_devQueueIface;   //!< NetDevice queue interface
+  Ptr<SharedBufferManager> m_sharedBuffer;  //!< Shared buffer the packets are drawn from
+  uint32_t m_sharedBufferPort;      //!< Port of this queue disc in the shared buffer
+  Ptr<QueueDiscFlowStats> m_flowStats;  //!< Per-flow counters, if any
   SendCallback m_send;              //!< Callback used to send a packet to the receiving object
+  SendBatchCallback m_sendBatch;    //!< Callback used to send a burst of packets to the receiving object
+  bool m_bulkDequeue;               //!< Whether a qdisc run dequeues its quota in a single batch
   bool m_running;                   //!< The queue disc is performing multiple dequeue operations
   Ptr<QueueDiscItem> m_requeued;    //!< The last packet that failed to be transmitted
+  std::deque<Ptr<QueueDiscItem> > m_requeuedBatch; //!< Packets requeued after m_requeued
   bool m_peeked;                    //!< A packet was dequeued because Peek was called
-  std::string m_childQueueDiscDropMsg;  //!< Reason why a packet was dropped by a child queue disc
-  std::string m_childQueueDiscMarkMsg;  //!< Reason why a packet was marked by a child queue disc
+  /// Drop reasons of the child queue discs and the id of the reason of this queue disc
+  std::vector<std::pair<const char*, uint32_t> > m_childDropReasonIds;
+  /// Mark reasons of the child queue discs and the id of the reason of this queue disc
+  std::vector<std::pair<const char*, uint32_t> > m_childMarkReasonIds;
   QueueDiscSizePolicy m_sizePolicy;     //!< The queue disc size policy
   bool m_prohibitChangeMode;            //!< True if changing mode is prohibited
+  bool m_recordOccupancy;               //!< Whether to keep the occupancy histograms
+  uint32_t m_occupancyByteBin;          //!< Size of the ranges of the byte histogram
+  Time m_sojournBinWidth;               //!< Width of the ranges of the sojourn time histogram
+  Time m_lastOccupancyChange;           //!< Time up to which the occupancy is recorded
 
   /// Traced callback: fired when a packet is enqueued
   TracedCallback<Ptr<const QueueDiscItem> > m_traceEnqueue;
@@ -71,6 +71,15 @@ NS_LOG_COMPONENT_DEFINE ("RedQueueDisc");
 
 NS_OBJECT_ENSURE_REGISTERED (RedQueueDisc);
 
+/// Interned RedQueueDisc::UNFORCED_MARK
+static const QueueDiscReason g_unforcedMark (RedQueueDisc::UNFORCED_MARK);
+/// Interned RedQueueDisc::UNFORCED_DROP
+static const QueueDiscReason g_unforcedDrop (RedQueueDisc::UNFORCED_DROP);
+/// Interned RedQueueDisc::FORCED_MARK
+static const QueueDiscReason g_forcedMark (RedQueueDisc::FORCED_MARK);
+/// Interned RedQueueDisc::FORCED_DROP
+static const QueueDiscReason g_forcedDrop (RedQueueDisc::FORCED_DROP);
+
 TypeId RedQueueDisc::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::RedQueueDisc")
@@ -218,6 +227,19 @@ TypeId RedQueueDisc::GetTypeId (void)
                    BooleanValue (true),
                    MakeBooleanAccessor (&RedQueueDisc::m_useHardDrop),
                    MakeBooleanChecker ())
+    .AddAttribute ("UseFixedPoint",
+                   "True to compute the average queue length and the drop probability "
+                   "in fixed point arithmetic",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RedQueueDisc::m_useFixedPoint),
+                   MakeBooleanChecker ())
+    .AddAttribute ("Cautious",
+                   "0 for default RED, 1 and 2 for the experimental modes not dropping or "
+                   "dropping less while the queue is much below the average (floating point "
+                   "only), 3 to use IdlePktSize in the packet time constant",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&RedQueueDisc::m_cautious),
+                   MakeUintegerChecker<uint32_t> (0, 3))
   ;
 
   return tid;
@@ -364,7 +386,20 @@ RedQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
       m_idle = 0;
     }
 
-  m_qAvg = Estimator (nQueued, m + 1, m_qAvg, m_qW);
+  bool aboveMinTh;
+  bool forced;
+  if (m_useFixedPoint)
+    {
+      EstimatorFixed (nQueued, m);
+      aboveMinTh = (m_qAvgFixed >= m_minThFixed);
+      forced = (m_qAvgFixed >= m_forcedThFixed);
+    }
+  else
+    {
+      m_qAvg = Estimator (nQueued, m + 1, m_qAvg, m_qW);
+      aboveMinTh = (m_qAvg >= m_minTh);
+      forced = (!m_isGentle && m_qAvg >= m_maxTh) || (m_isGentle && m_qAvg >= 2 * m_maxTh);
+    }
 
   NS_LOG_DEBUG ("\t bytesInQueue  " << GetInternalQueue (0)->GetNBytes () << "\tQavg " << m_qAvg);
   NS_LOG_DEBUG ("\t packetsInQueue  " << GetInternalQueue (0)->GetNPackets () << "\tQavg " << m_qAvg);
@@ -373,10 +408,9 @@ RedQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
   m_countBytes += item->GetSize ();
 
   uint32_t dropType = DTYPE_NONE;
-  if (m_qAvg >= m_minTh && nQueued > 1)
+  if (aboveMinTh && nQueued > 1)
     {
-      if ((!m_isGentle && m_qAvg >= m_maxTh) ||
-          (m_isGentle && m_qAvg >= 2 * m_maxTh))
+      if (forced)
         {
           NS_LOG_DEBUG ("adding DROP FORCED MARK");
           dropType = DTYPE_FORCED;
@@ -393,7 +427,7 @@ RedQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
           m_countBytes = item->GetSize ();
           m_old = 1;
         }
-      else if (DropEarly (item, nQueued))
+      else if (m_useFixedPoint ? DropEarlyFixed (item) : DropEarly (item, nQueued))
         {
           NS_LOG_LOGIC ("DropEarly returns 1");
           dropType = DTYPE_UNFORCED;
@@ -408,20 +442,20 @@ RedQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
 
   if (dropType == DTYPE_UNFORCED)
     {
-      if (!m_useEcn || !Mark (item, UNFORCED_MARK))
+      if (!m_useEcn || !Mark (item, g_unforcedMark))
         {
           NS_LOG_DEBUG ("\t Dropping due to Prob Mark " << m_qAvg);
-          DropBeforeEnqueue (item, UNFORCED_DROP);
+          DropBeforeEnqueue (item, g_unforcedDrop);
           return false;
         }
       NS_LOG_DEBUG ("\t Marking due to Prob Mark " << m_qAvg);
     }
   else if (dropType == DTYPE_FORCED)
     {
-      if (m_useHardDrop || !m_useEcn || !Mark (item, FORCED_MARK))
+      if (m_useHardDrop || !m_useEcn || !Mark (item, g_forcedMark))
         {
           NS_LOG_DEBUG ("\t Dropping due to Hard Mark " << m_qAvg);
-          DropBeforeEnqueue (item, FORCED_DROP);
+          DropBeforeEnqueue (item, g_forcedDrop);
           if (m_isNs1Compat)
             {
               m_count = 0;
@@ -455,7 +489,6 @@ RedQueueDisc::InitializeParams (void)
   NS_LOG_FUNCTION (this);
   NS_LOG_INFO ("Initializing RED params.");
 
-  m_cautious = 0;
   m_ptc = m_linkBandwidth.GetBitRate () / (8.0 * m_meanPktSize);
 
   if (m_isARED)
@@ -571,6 +604,113 @@ RedQueueDisc::InitializeParams (void)
                              << "; lInterm " << m_lInterm << "; va " << m_vA <<  "; cur_max_p "
                              << m_curMaxP << "; v_b " << m_vB <<  "; m_vC "
                              << m_vC << "; m_vD " <<  m_vD);
+
+  if (m_useFixedPoint)
+    {
+      InitializeFixedPoint ();
+    }
+}
+
+/// One in fixed point, i.e., the number of fractional bits is 32
+static const uint64_t FIXED_ONE = static_cast<uint64_t> (1) << 32;
+
+/**
+ * \brief Convert a non-negative number to fixed point
+ * \param x the number
+ * \return the number in fixed point
+ */
+static inline uint64_t
+ToFixed (double x)
+{
+  return static_cast<uint64_t> (x * FIXED_ONE + 0.5);
+}
+
+/**
+ * \brief Multiply two fixed point numbers, the result not exceeding 64 bits
+ * \param a the first number
+ * \param b the second number
+ * \return the product in fixed point
+ */
+static inline uint64_t
+MulFixed (uint64_t a, uint64_t b)
+{
+  uint64_t aHigh = a >> 32;
+  uint64_t aLow = a & 0xffffffff;
+  uint64_t bHigh = b >> 32;
+  uint64_t bLow = b & 0xffffffff;
+  return ((aHigh * bHigh) << 32) + aHigh * bLow + aLow * bHigh + ((aLow * bLow) >> 32);
+}
+
+void
+RedQueueDisc::InitializeFixedPoint (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_qAvgFixed = 0;
+  m_minThFixed = ToFixed (m_minTh);
+  m_maxThFixed = ToFixed (m_maxTh);
+  m_forcedThFixed = ToFixed (m_isGentle ? 2 * m_maxTh : m_maxTh);
+  m_qWFixed = ToFixed (m_qW);
+  m_vAFixed = ToFixed (m_vA);
+  m_curMaxPFixed = ToFixed (m_curMaxP);
+  if (m_isGentle)
+    {
+      m_vCFixed = ToFixed (m_vC);
+      m_vDFixed = static_cast<int64_t> (m_vD * FIXED_ONE);
+    }
+
+  // the decay over an idle period during which m packets could have been
+  // sent is the product of the entries matching the bits of m, much like
+  // the Stab table of the Linux sch_red
+  double decay = 1.0 - m_qW;
+  for (uint32_t i = 0; i < m_idleDecay.size (); i++)
+    {
+      m_idleDecay[i] = ToFixed (decay);
+      decay *= decay;
+    }
+}
+
+void
+RedQueueDisc::EstimatorFixed (uint32_t nQueued, uint32_t m)
+{
+  NS_LOG_FUNCTION (this << nQueued << m);
+
+  for (uint32_t i = 0; m != 0 && m_qAvgFixed != 0; i++, m >>= 1)
+    {
+      if (m & 1)
+        {
+          m_qAvgFixed = MulFixed (m_qAvgFixed, m_idleDecay[i]);
+        }
+    }
+
+  // qAvg = qAvg * (1 - qW) + nQueued * qW
+  uint64_t sample = static_cast<uint64_t> (nQueued) << 32;
+  if (sample >= m_qAvgFixed)
+    {
+      m_qAvgFixed += MulFixed (sample - m_qAvgFixed, m_qWFixed);
+    }
+  else
+    {
+      m_qAvgFixed -= MulFixed (m_qAvgFixed - sample, m_qWFixed);
+    }
+
+  // the adaptive algorithms work on the floating point average, they only
+  // change the maximum probability every now and then
+  m_qAvg = static_cast<double> (m_qAvgFixed) / FIXED_ONE;
+  double curMaxP = m_curMaxP;
+  Time now = Simulator::Now ();
+  if (m_isAdaptMaxP && now > m_lastSet + m_interval)
+    {
+      UpdateMaxP (m_qAvg);
+    }
+  else if (m_isFengAdaptive)
+    {
+      UpdateMaxPFeng (m_qAvg);
+    }
+  if (m_curMaxP != curMaxP)
+    {
+      m_curMaxPFixed = ToFixed (m_curMaxP);
+    }
 }
 
 // Updating m_curMaxP, following the pseudocode
@@ -709,6 +849,86 @@ RedQueueDisc::DropEarly (Ptr<QueueDiscItem> item, uint32_t qSize)
   return 0; // no drop/mark
 }
 
+// Fixed point version of DropEarly, CalculatePNew and ModifyP
+uint32_t
+RedQueueDisc::DropEarlyFixed (Ptr<QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  uint64_t p;
+  if (m_isGentle && m_qAvgFixed >= m_maxThFixed)
+    {
+      int64_t gentle = static_cast<int64_t> (MulFixed (m_qAvgFixed, m_vCFixed)) + m_vDFixed;
+      p = gentle > 0 ? gentle : 0;
+    }
+  else if (!m_isGentle && m_qAvgFixed >= m_maxThFixed)
+    {
+      p = FIXED_ONE;
+    }
+  else
+    {
+      // m_vA * m_qAvg + m_vB, i.e., m_vA * (m_qAvg - m_minTh)
+      p = MulFixed (m_qAvgFixed - m_minThFixed, m_vAFixed);
+      if (m_isNonlinear)
+        {
+          p = MulFixed (p, p) * 3 / 2;
+        }
+      p = MulFixed (p, m_curMaxPFixed);
+    }
+  if (p > FIXED_ONE)
+    {
+      p = FIXED_ONE;
+    }
+
+  bool bytes = (GetMaxSize ().GetUnit () == QueueSizeUnit::BYTES);
+  uint64_t count1 = bytes ? m_countBytes / m_meanPktSize : m_count;
+
+  // The drop probability is p / (1 - count1 * p), or p / (2 - count1 * p)
+  // with m_isWait (zero if count1 * p < 1), capped at one.  Rather than
+  // dividing, the random number is multiplied by the denominator and
+  // compared against p.
+  uint64_t countP = count1 < (FIXED_ONE >> 1) ? count1 * p : 2 * FIXED_ONE;
+  uint64_t den;
+  if (m_isWait)
+    {
+      den = countP < 2 * FIXED_ONE ? 2 * FIXED_ONE - countP : 0;
+    }
+  else
+    {
+      den = countP < FIXED_ONE ? FIXED_ONE - countP : 0;
+    }
+
+  // draw the random number in any case, as the floating point engine does
+  uint64_t u = ToFixed (m_uv->GetValue ());
+  bool drop;
+  if (m_isWait && countP < FIXED_ONE)
+    {
+      drop = false;
+    }
+  else if (den == 0 || p >= den)
+    {
+      drop = true;
+    }
+  else if (bytes)
+    {
+      // the probability is scaled by the size of the packet
+      drop = (MulFixed (u, den) * m_meanPktSize <= p * item->GetSize ());
+    }
+  else
+    {
+      drop = (MulFixed (u, den) <= p);
+    }
+
+  if (drop)
+    {
+      NS_LOG_LOGIC ("Drop or mark; u " << u << "; p " << p << "; den " << den);
+      m_count = 0;
+      m_countBytes = 0;
+      return 1;
+    }
+  return 0;
+}
+
 // Returns a probability using these function parameters for the DropEarly function
 double
 RedQueueDisc::CalculatePNew (void)
@@ -886,6 +1106,13 @@ RedQueueDisc::CheckConfig (void)
       NS_LOG_ERROR ("m_isAdaptMaxP and m_isFengAdaptive cannot be simultaneously true");
     }
 
+  // DropEarlyFixed has no counterpart of the queue checks of DropEarly
+  if (m_useFixedPoint && (m_cautious == 1 || m_cautious == 2))
+    {
+      NS_LOG_ERROR ("The cautious modes 1 and 2 are not available with UseFixedPoint");
+      return false;
+    }
+
   return true;
 }
 
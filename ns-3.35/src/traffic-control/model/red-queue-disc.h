@@ -66,6 +66,7 @@
 #include "ns3/boolean.h"
 #include "ns3/data-rate.h"
 #include "ns3/random-variable-stream.h"
+#include <array>
 
 namespace ns3 {
 
@@ -75,6 +76,18 @@ class TraceContainer;
  * \ingroup traffic-control
  *
  * \brief A RED packet queue disc
+ *
+ * With the UseFixedPoint attribute, the average queue length and the drop
+ * probability are computed in integer arithmetic, as in the Linux sch_red:
+ * the average and the thresholds are in Q32.32, the queue weight and the
+ * probabilities in Q0.32, the decay over an idle period is the product of
+ * the precomputed powers of (1 - QW) matching the bits of the number of
+ * idle packets, and the random draw is compared against the probability
+ * without division.  The decisions are those of the floating point engine
+ * up to rounding, for every variant (Gentle, ARED, Feng's adaptive RED and
+ * NLRED); the cautious modes 1 and 2 (see the Cautious attribute) are only
+ * available in floating point, and CheckConfig rejects them with
+ * UseFixedPoint.
  */
 class RedQueueDisc : public QueueDisc
 {
@@ -258,6 +271,22 @@ private:
    * \returns Prob. of packet drop
    */
   double ModifyP (double p, uint32_t size);
+  /**
+   * \brief Initialize the fixed point parameters from the floating point ones
+   */
+  void InitializeFixedPoint (void);
+  /**
+   * \brief Compute the average queue size in fixed point
+   * \param nQueued number of queued packets
+   * \param m simulated number of packets arrival during idle period
+   */
+  void EstimatorFixed (uint32_t nQueued, uint32_t m);
+  /**
+   * \brief Check in fixed point if a packet needs to be dropped due to probability mark
+   * \param item queue item
+   * \returns 0 for no drop/mark, 1 for drop
+   */
+  uint32_t DropEarlyFixed (Ptr<QueueDiscItem> item);
 
   // ** Variables supplied by user
   uint32_t m_meanPktSize;   //!< Avg pkt size
@@ -286,6 +315,7 @@ private:
   Time m_linkDelay;         //!< Link delay
   bool m_useEcn;            //!< True if ECN is used (packets are marked instead of being dropped)
   bool m_useHardDrop;       //!< True if packets are always dropped above max threshold
+  bool m_useFixedPoint;     //!< True to compute the average and the probabilities in fixed point
 
   // ** Variables maintained by RED
   double m_vA;              //!< 1.0 / (m_maxTh - m_minTh)
@@ -311,6 +341,18 @@ private:
   uint32_t m_cautious;
   Time m_idleTime;          //!< Start of current idle period
 
+  // ** Fixed point state, Q32.32 for the queue lengths and Q0.32 for the rest
+  uint64_t m_qAvgFixed;     //!< Average queue length
+  uint64_t m_minThFixed;    //!< m_minTh
+  uint64_t m_maxThFixed;    //!< m_maxTh
+  uint64_t m_forcedThFixed; //!< Average from which the packets are dropped or marked unconditionally
+  uint64_t m_qWFixed;       //!< m_qW
+  uint64_t m_vAFixed;       //!< m_vA
+  uint64_t m_vCFixed;       //!< m_vC
+  int64_t m_vDFixed;        //!< m_vD
+  uint64_t m_curMaxPFixed;  //!< m_curMaxP
+  std::array<uint64_t, 32> m_idleDecay; //!< (1 - m_qW) to the power of each power of two
+
   Ptr<UniformRandomVariable> m_uv;  //!< rng stream
 };
 
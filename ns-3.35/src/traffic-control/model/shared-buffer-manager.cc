@@ -0,0 +1,210 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/socket.h"
+#include "shared-buffer-manager.h"
+#include "queue-disc.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SharedBufferManager");
+
+NS_OBJECT_ENSURE_REGISTERED (SharedBufferManager);
+
+TypeId
+SharedBufferManager::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::SharedBufferManager")
+    .SetParent<Object> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<SharedBufferManager> ()
+    .AddAttribute ("BufferSize",
+                   "The size of the shared buffer, in bytes",
+                   UintegerValue (4 * 1024 * 1024),
+                   MakeUintegerAccessor (&SharedBufferManager::m_bufferSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("Alpha",
+                   "The class queues can hold Alpha times the free buffer",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&SharedBufferManager::m_alpha),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("PortAlpha",
+                   "The ports can hold PortAlpha times the free buffer, no limit if zero",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&SharedBufferManager::m_portAlpha),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("ReservedBytes",
+                   "The bytes of each class queue admitted whatever the thresholds",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&SharedBufferManager::m_reserved),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("MarkingThreshold",
+                   "The buffer occupancy, in bytes, from which the admitted packets "
+                   "are marked, no marking if zero",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&SharedBufferManager::m_markingThreshold),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddTraceSource ("Occupancy",
+                     "Number of bytes in the shared buffer",
+                     MakeTraceSourceAccessor (&SharedBufferManager::m_occupancy),
+                     "ns3::TracedValueCallback::Uint32")
+  ;
+  return tid;
+}
+
+SharedBufferManager::SharedBufferManager ()
+  : m_occupancy (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_classAlpha.fill (-1.0);
+}
+
+SharedBufferManager::~SharedBufferManager ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint32_t
+SharedBufferManager::AddQueueDisc (Ptr<QueueDisc> qd)
+{
+  NS_LOG_FUNCTION (this << qd);
+  uint32_t port = m_ports.size ();
+  PortOccupancy occupancy;
+  occupancy.total = 0;
+  occupancy.classes.fill (0);
+  m_ports.push_back (occupancy);
+  qd->SetSharedBuffer (this, port);
+  return port;
+}
+
+uint32_t
+SharedBufferManager::GetNPorts (void) const
+{
+  return m_ports.size ();
+}
+
+void
+SharedBufferManager::SetClassAlpha (uint8_t cls, double alpha)
+{
+  NS_LOG_FUNCTION (this << +cls << alpha);
+  NS_ASSERT (cls < N_CLASSES && alpha >= 0);
+  m_classAlpha[cls] = alpha;
+}
+
+uint8_t
+SharedBufferManager::GetPriorityClass (Ptr<const QueueDiscItem> item)
+{
+  SocketPriorityTag priorityTag;
+  if (item->GetPacket ()->PeekPacketTag (priorityTag))
+    {
+      return priorityTag.GetPriority () & (N_CLASSES - 1);
+    }
+  return 0;
+}
+
+bool
+SharedBufferManager::CanAdmit (uint32_t port, uint8_t cls, uint32_t size) const
+{
+  NS_ASSERT (port < m_ports.size () && cls < N_CLASSES);
+  uint32_t used = m_occupancy;
+  if (static_cast<uint64_t> (used) + size > m_bufferSize)
+    {
+      NS_LOG_LOGIC ("No room for " << size << " bytes in the buffer");
+      return false;
+    }
+
+  const PortOccupancy &occupancy = m_ports[port];
+  uint32_t queued = occupancy.classes[cls] + size;
+  if (queued <= m_reserved)
+    {
+      return true;
+    }
+
+  double free = m_bufferSize - used;
+  double alpha = m_classAlpha[cls] < 0 ? m_alpha : m_classAlpha[cls];
+  if (queued > alpha * free)
+    {
+      NS_LOG_LOGIC ("Class " << +cls << " of port " << port << " above its threshold");
+      return false;
+    }
+  if (m_portAlpha > 0 && occupancy.total + size > m_portAlpha * free)
+    {
+      NS_LOG_LOGIC ("Port " << port << " above its threshold");
+      return false;
+    }
+  return true;
+}
+
+bool
+SharedBufferManager::IsAboveMarkingThreshold (void) const
+{
+  return m_markingThreshold > 0 && m_occupancy >= m_markingThreshold;
+}
+
+void
+SharedBufferManager::PacketEnqueued (uint32_t port, uint8_t cls, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << port << +cls << size);
+  NS_ASSERT (port < m_ports.size () && cls < N_CLASSES);
+  m_ports[port].total += size;
+  m_ports[port].classes[cls] += size;
+  m_occupancy += size;
+}
+
+void
+SharedBufferManager::PacketDequeued (uint32_t port, uint8_t cls, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << port << +cls << size);
+  NS_ASSERT (port < m_ports.size () && cls < N_CLASSES);
+  NS_ASSERT (m_ports[port].classes[cls] >= size);
+  m_ports[port].total -= size;
+  m_ports[port].classes[cls] -= size;
+  m_occupancy -= size;
+}
+
+uint32_t
+SharedBufferManager::GetOccupancy (void) const
+{
+  return m_occupancy;
+}
+
+uint32_t
+SharedBufferManager::GetPortOccupancy (uint32_t port) const
+{
+  NS_ASSERT (port < m_ports.size ());
+  return m_ports[port].total;
+}
+
+uint32_t
+SharedBufferManager::GetClassOccupancy (uint32_t port, uint8_t cls) const
+{
+  NS_ASSERT (port < m_ports.size () && cls < N_CLASSES);
+  return m_ports[port].classes[cls];
+}
+
+uint32_t
+SharedBufferManager::GetClassThreshold (uint8_t cls) const
+{
+  NS_ASSERT (cls < N_CLASSES);
+  double alpha = m_classAlpha[cls] < 0 ? m_alpha : m_classAlpha[cls];
+  uint32_t used = m_occupancy;
+  return used < m_bufferSize ? static_cast<uint32_t> (alpha * (m_bufferSize - used)) : 0;
+}
+
+} // namespace ns3
@@ -0,0 +1,174 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SHARED_BUFFER_MANAGER_H
+#define SHARED_BUFFER_MANAGER_H
+
+#include <array>
+#include <vector>
+#include "ns3/object.h"
+#include "ns3/traced-value.h"
+
+namespace ns3 {
+
+class QueueDisc;
+class QueueDiscItem;
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief Packet buffer shared by the queue discs of the ports of a node
+ *
+ * Models the shared buffer of a switch chip with Broadcom-style dynamic
+ * thresholds.  Each root queue disc added to the manager is a port, and
+ * the packets of a port are split in 16 priority classes according to
+ * their priority (as set by the SocketPriorityTag, modulo 16).  A packet
+ * of a given class is admitted by a port if the buffer has room for it
+ * and the class queue of the port, including the packet, does not exceed
+ * Alpha times the free buffer.  Each class can have its own alpha (see
+ * SetClassAlpha), and if PortAlpha is not zero the port as a whole is
+ * also limited to PortAlpha times the free buffer.  The first
+ * ReservedBytes of each class queue are admitted whatever the thresholds,
+ * as long as the buffer has room.  As the thresholds shrink when the
+ * buffer fills up, a congested port cannot take the whole buffer, while
+ * a single active port can still use most of it.
+ *
+ * If MarkingThreshold is not zero, the packets admitted while the buffer
+ * holds at least that many bytes are ECN marked.  Admission and marking
+ * are a few comparisons against counters, whatever the number of ports.
+ *
+ * The queue discs keep their own MaxSize, which should be large enough
+ * for the shared buffer to be the limiting factor.  The drops and marks
+ * are counted by each queue disc as QueueDisc::SHARED_BUFFER_DROP and
+ * QueueDisc::SHARED_BUFFER_MARK.
+ */
+class SharedBufferManager : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  SharedBufferManager ();
+  virtual ~SharedBufferManager ();
+
+  /// Number of priority classes per port
+  static const uint8_t N_CLASSES = 16;
+
+  /**
+   * \brief Add the root queue disc of a port
+   * \param qd the queue disc
+   * \return the index of the port
+   */
+  uint32_t AddQueueDisc (Ptr<QueueDisc> qd);
+
+  /**
+   * \return the number of ports
+   */
+  uint32_t GetNPorts (void) const;
+
+  /**
+   * \brief Set the alpha of a priority class
+   * \param cls the priority class
+   * \param alpha the alpha, overriding the Alpha attribute
+   */
+  void SetClassAlpha (uint8_t cls, double alpha);
+
+  /**
+   * \brief Get the priority class of a packet
+   * \param item the packet
+   * \return the priority class
+   */
+  static uint8_t GetPriorityClass (Ptr<const QueueDiscItem> item);
+
+  /**
+   * \brief Check whether a port can admit a packet
+   * \param port the port
+   * \param cls the priority class of the packet
+   * \param size the size of the packet
+   * \return true if the packet is admitted
+   */
+  bool CanAdmit (uint32_t port, uint8_t cls, uint32_t size) const;
+
+  /**
+   * \return true if the packets admitted now have to be marked
+   */
+  bool IsAboveMarkingThreshold (void) const;
+
+  /**
+   * \brief Account for a packet stored by a port
+   * \param port the port
+   * \param cls the priority class of the packet
+   * \param size the size of the packet
+   */
+  void PacketEnqueued (uint32_t port, uint8_t cls, uint32_t size);
+
+  /**
+   * \brief Account for a packet released by a port
+   * \param port the port
+   * \param cls the priority class of the packet
+   * \param size the size of the packet
+   */
+  void PacketDequeued (uint32_t port, uint8_t cls, uint32_t size);
+
+  /**
+   * \return the number of bytes in the buffer
+   */
+  uint32_t GetOccupancy (void) const;
+
+  /**
+   * \param port the port
+   * \return the number of bytes stored by the port
+   */
+  uint32_t GetPortOccupancy (uint32_t port) const;
+
+  /**
+   * \param port the port
+   * \param cls the priority class
+   * \return the number of bytes of the class stored by the port
+   */
+  uint32_t GetClassOccupancy (uint32_t port, uint8_t cls) const;
+
+  /**
+   * \brief Get the current limit of the class queues
+   * \param cls the priority class
+   * \return the number of bytes a class queue can hold now
+   */
+  uint32_t GetClassThreshold (uint8_t cls) const;
+
+private:
+  /// Occupancy of a port
+  struct PortOccupancy
+  {
+    uint32_t total;                             //!< Bytes stored by the port
+    std::array<uint32_t, N_CLASSES> classes;    //!< Bytes stored by each class
+  };
+
+  uint32_t m_bufferSize;                        //!< Size of the buffer, in bytes
+  double m_alpha;                               //!< Default alpha of the classes
+  std::array<double, N_CLASSES> m_classAlpha;   //!< Alpha of each class, negative for the default
+  double m_portAlpha;                           //!< Alpha of the ports, zero for no port limit
+  uint32_t m_reserved;                          //!< Bytes reserved to each class queue
+  uint32_t m_markingThreshold;                  //!< Occupancy from which to mark, zero for none
+  std::vector<PortOccupancy> m_ports;           //!< Occupancy of each port
+  TracedValue<uint32_t> m_occupancy;            //!< Bytes in the buffer
+};
+
+} // namespace ns3
+
+#endif /* SHARED_BUFFER_MANAGER_H */
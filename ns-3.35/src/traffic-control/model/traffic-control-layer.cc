@@ -22,9 +22,11 @@
 #include "ns3/log.h"
 #include "ns3/object-map.h"
 #include "ns3/packet.h"
+#include "ns3/packet-burst.h"
 #include "ns3/socket.h"
 #include "ns3/queue-disc.h"
 #include <tuple>
+#include <algorithm>
 
 namespace ns3 {
 
@@ -71,7 +73,10 @@ TrafficControlLayer::DoDispose (void)
   NS_LOG_FUNCTION (this);
   m_node = 0;
   m_handlers.clear ();
+  m_dispatch.clear ();
+  m_anyDeviceDispatch.Clear ();
   m_netDevices.clear ();
+  m_sendTable.clear ();
   Object::DoDispose ();
 }
 
@@ -107,11 +112,49 @@ TrafficControlLayer::RegisterProtocolHandler (Node::ProtocolHandler handler,
   entry.promiscuous = false;
 
   m_handlers.push_back (entry);
+  UpdateDispatchTables ();
 
   NS_LOG_DEBUG ("Handler for NetDevice: " << device << " registered for protocol " <<
                 protocolType << ".");
 }
 
+void
+TrafficControlLayer::UpdateDispatchTables (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  // Devices with no handler of their own use the table of the handlers
+  // registered for any device
+  uint32_t nDevices = 0;
+  for (ProtocolHandlerList::const_iterator i = m_handlers.begin (); i != m_handlers.end (); i++)
+    {
+      if (i->device != 0)
+        {
+          nDevices = std::max (nDevices, i->device->GetIfIndex () + 1);
+        }
+    }
+  m_anyDeviceDispatch.Clear ();
+  m_dispatch.assign (nDevices, ProtocolDispatchTable ());
+
+  // Handlers are visited in registration order and appended, so that each
+  // table calls its handlers in the same order as a scan of m_handlers would
+  for (ProtocolHandlerList::const_iterator i = m_handlers.begin (); i != m_handlers.end (); i++)
+    {
+      if (i->device == 0)
+        {
+          m_anyDeviceDispatch.Add (i->protocol, i->handler);
+          for (uint32_t index = 0; index < nDevices; index++)
+            {
+              m_dispatch[index].Add (i->protocol, i->handler);
+            }
+        }
+      else
+        {
+          m_dispatch[i->device->GetIfIndex ()].Add (i->protocol, i->handler);
+        }
+    }
+}
+
 void
 TrafficControlLayer::ScanDevices (void)
 {
@@ -186,16 +229,58 @@ TrafficControlLayer::ScanDevices (void)
               ndi->second.m_queueDiscsToWake.push_back (ndi->second.m_rootQueueDisc);
             }
 
-          // set the NetDeviceQueueInterface object and the SendCallback on the queue discs
+          // set the NetDeviceQueueInterface object and the send callbacks on the queue discs
           // into which packets are enqueued and dequeued by calling Run
           for (auto& q : ndi->second.m_queueDiscsToWake)
             {
               q->SetNetDeviceQueueInterface (ndqi);
               q->SetSendCallback ([dev] (Ptr<QueueDiscItem> item)
                                   { dev->Send (item->GetPacket (), item->GetAddress (), item->GetProtocol ()); });
+              q->SetSendBatchCallback ([dev] (Ptr<PacketBurst> burst, const Address &dest, uint16_t protocol)
+                                       { return dev->SendBatch (burst, dest, protocol); });
             }
         }
     }
+
+  UpdateSendTable ();
+}
+
+void
+TrafficControlLayer::UpdateSendTable (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_sendTable.clear ();
+  if (m_node == 0)
+    {
+      return;
+    }
+
+  // The entries are pointers to the values of m_netDevices, which stay valid
+  // until the corresponding element is erased
+  for (uint32_t i = 0; i < m_node->GetNDevices (); i++)
+    {
+      Ptr<NetDevice> dev = m_node->GetDevice (i);
+      std::map<Ptr<NetDevice>, NetDeviceInfo>::iterator ndi = m_netDevices.find (dev);
+      SendEntry entry;
+      entry.device = PeekPointer (dev);
+      entry.info = (ndi != m_netDevices.end () ? &ndi->second : nullptr);
+      m_sendTable.push_back (entry);
+    }
+}
+
+TrafficControlLayer::NetDeviceInfo *
+TrafficControlLayer::GetDeviceInfo (Ptr<NetDevice> device)
+{
+  uint32_t index = device->GetIfIndex ();
+  if (index < m_sendTable.size () && m_sendTable[index].device == PeekPointer (device))
+    {
+      return m_sendTable[index].info;
+    }
+
+  // a device added after the traffic control layer was initialized
+  std::map<Ptr<NetDevice>, NetDeviceInfo>::iterator ndi = m_netDevices.find (device);
+  return (ndi != m_netDevices.end () ? &ndi->second : nullptr);
 }
 
 void
@@ -209,6 +294,7 @@ TrafficControlLayer::SetRootQueueDiscOnDevice (Ptr<NetDevice> device, Ptr<QueueD
     {
       // No entry found for this device. Create one.
       m_netDevices[device] = {qDisc, nullptr, QueueDiscVector ()};
+      UpdateSendTable ();
     }
   else
     {
@@ -257,6 +343,7 @@ TrafficControlLayer::DeleteRootQueueDiscOnDevice (Ptr<NetDevice> device)
     {
       q->SetNetDeviceQueueInterface (nullptr);
       q->SetSendCallback (nullptr);
+      q->SetSendBatchCallback (nullptr);
     }
   ndi->second.m_queueDiscsToWake.clear ();
 
@@ -273,6 +360,7 @@ TrafficControlLayer::DeleteRootQueueDiscOnDevice (Ptr<NetDevice> device)
     {
       // remove the empty entry
       m_netDevices.erase (ndi);
+      UpdateSendTable ();
     }
 }
 
@@ -314,24 +402,19 @@ TrafficControlLayer::Receive (Ptr<NetDevice> device, Ptr<const Packet> p,
 {
   NS_LOG_FUNCTION (this << device << p << protocol << from << to << packetType);
 
-  bool found = false;
+  uint32_t index = device->GetIfIndex ();
+  const ProtocolDispatchTable &table = index < m_dispatch.size () ? m_dispatch[index] : m_anyDeviceDispatch;
+  const std::vector<Node::ProtocolHandler> &handlers = table.Lookup (protocol);
 
-  for (ProtocolHandlerList::iterator i = m_handlers.begin ();
-       i != m_handlers.end (); i++)
+  bool found = false;
+  for (std::vector<Node::ProtocolHandler>::const_iterator i = handlers.begin ();
+       i != handlers.end (); i++)
     {
-      if (i->device == 0
-          || (i->device != 0 && i->device == device))
-        {
-          if (i->protocol == 0
-              || i->protocol == protocol)
-            {
-              NS_LOG_DEBUG ("Found handler for packet " << p << ", protocol " <<
-                            protocol << " and NetDevice " << device <<
-                            ". Send packet up");
-              i->handler (device, p, protocol, from, to, packetType);
-              found = true;
-            }
-        }
+      NS_LOG_DEBUG ("Found handler for packet " << p << ", protocol " <<
+                    protocol << " and NetDevice " << device <<
+                    ". Send packet up");
+      (*i) (device, p, protocol, from, to, packetType);
+      found = true;
     }
 
   NS_ABORT_MSG_IF (!found, "Handler for protocol " << p << " and device " << device <<
@@ -347,11 +430,11 @@ TrafficControlLayer::Send (Ptr<NetDevice> device, Ptr<QueueDiscItem> item)
                 item->GetProtocol ());
 
   Ptr<NetDeviceQueueInterface> devQueueIface;
-  std::map<Ptr<NetDevice>, NetDeviceInfo>::iterator ndi = m_netDevices.find (device);
+  NetDeviceInfo *ndi = GetDeviceInfo (device);
 
-  if (ndi != m_netDevices.end ())
+  if (ndi != nullptr)
     {
-      devQueueIface = ndi->second.m_ndqi;
+      devQueueIface = ndi->m_ndqi;
     }
 
   // determine the transmission queue of the device where the packet will be enqueued
@@ -369,7 +452,7 @@ TrafficControlLayer::Send (Ptr<NetDevice> device, Ptr<QueueDiscItem> item)
 
   NS_ASSERT (!devQueueIface || txq < devQueueIface->GetNTxQueues ());
 
-  if (ndi == m_netDevices.end () || ndi->second.m_rootQueueDisc == 0)
+  if (ndi == nullptr || ndi->m_rootQueueDisc == 0)
     {
       // The device has no attached queue disc, thus add the header to the packet and
       // send it directly to the device if the selected queue is not stopped
@@ -382,6 +465,19 @@ TrafficControlLayer::Send (Ptr<NetDevice> device, Ptr<QueueDiscItem> item)
               SocketPriorityTag priorityTag;
               item->GetPacket ()->RemovePacketTag (priorityTag);
             }
+          if (item->GetSegmentSize () > 0)
+            {
+              // split a super-segment and send all the segments: there is no
+              // queue disc to requeue them, and the device queue drops (and
+              // traces) the segments that do not fit in it
+              std::vector<Ptr<QueueDiscItem> > segments;
+              item->Segment (segments);
+              for (auto& segment : segments)
+                {
+                  device->Send (segment->GetPacket (), segment->GetAddress (), segment->GetProtocol ());
+                }
+              return;
+            }
           device->Send (item->GetPacket (), item->GetAddress (), item->GetProtocol ());
         }
     }
@@ -391,7 +487,7 @@ TrafficControlLayer::Send (Ptr<NetDevice> device, Ptr<QueueDiscItem> item)
       // selected for the packet and try to dequeue packets from such queue disc
       item->SetTxQueueIndex (txq);
 
-      Ptr<QueueDisc> qDisc = ndi->second.m_queueDiscsToWake[txq];
+      Ptr<QueueDisc> qDisc = ndi->m_queueDiscsToWake[txq];
       NS_ASSERT (qDisc);
       qDisc->Enqueue (item);
       qDisc->Run ();
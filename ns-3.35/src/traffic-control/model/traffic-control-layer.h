@@ -234,9 +234,35 @@ private:
     QueueDiscVector m_queueDiscsToWake;   //!< the vector of queue discs to wake
   };
 
+  /**
+   * \brief Entry of the transmit table
+   */
+  struct SendEntry
+  {
+    NetDevice *device;    //!< the device having the interface index of the entry
+    NetDeviceInfo *info;  //!< the information stored for the device, if any
+  };
+
   /// Typedef for protocol handlers container
   typedef std::vector<struct ProtocolHandlerEntry> ProtocolHandlerList;
 
+  /**
+   * \brief Rebuild the per-device dispatch tables from m_handlers.
+   */
+  void UpdateDispatchTables (void);
+
+  /**
+   * \brief Rebuild the transmit table from the devices of the node and m_netDevices.
+   */
+  void UpdateSendTable (void);
+
+  /**
+   * \brief Get the information stored for a device
+   * \param device the device
+   * \return the information stored for the device, or a null pointer
+   */
+  NetDeviceInfo *GetDeviceInfo (Ptr<NetDevice> device);
+
   /**
    * \brief Required by the object map accessor
    * \return the number of devices in the m_netDevices map
@@ -253,7 +279,13 @@ private:
   Ptr<Node> m_node;
   /// Map storing the required information for each device with a queue disc installed
   std::map<Ptr<NetDevice>, NetDeviceInfo> m_netDevices;
+  /// Transmit table, indexed by the interface index of the devices of the node
+  std::vector<SendEntry> m_sendTable;
   ProtocolHandlerList m_handlers;  //!< List of upper-layer handlers
+  /// Dispatch tables, indexed by the interface index of the devices with a registered handler
+  std::vector<ProtocolDispatchTable> m_dispatch;
+  /// Dispatch table of the handlers registered for any device
+  ProtocolDispatchTable m_anyDeviceDispatch;
 };
 
 } // namespace ns3
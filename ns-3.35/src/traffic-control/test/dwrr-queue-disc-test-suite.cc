@@ -0,0 +1,240 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/dwrr-queue-disc.h"
+#include "ns3/queue.h"
+#include "ns3/packet.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Dwrr Queue Disc Test Item
+ */
+class DwrrQueueDiscTestItem : public QueueDiscItem {
+public:
+  /**
+   * Constructor
+   *
+   * \param p packet
+   * \param addr address
+   * \param dscp the DSCP of the packet
+   * \param ecnCapable ECN capable flag
+   */
+  DwrrQueueDiscTestItem (Ptr<Packet> p, const Address & addr, uint8_t dscp, bool ecnCapable);
+  virtual ~DwrrQueueDiscTestItem ();
+  virtual void AddHeader (void);
+  virtual bool Mark (void);
+  virtual bool GetUint8Value (Uint8Values field, uint8_t &value) const;
+
+private:
+  DwrrQueueDiscTestItem ();
+  /**
+   * \brief Copy constructor
+   * Disable default implementation to avoid misuse
+   */
+  DwrrQueueDiscTestItem (const DwrrQueueDiscTestItem &);
+  /**
+   * \brief Assignment operator
+   * \return this object
+   * Disable default implementation to avoid misuse
+   */
+  DwrrQueueDiscTestItem &operator = (const DwrrQueueDiscTestItem &);
+  uint8_t m_dscp;           ///< DSCP of the packet
+  bool m_ecnCapablePacket;  ///< ECN capable packet?
+};
+
+DwrrQueueDiscTestItem::DwrrQueueDiscTestItem (Ptr<Packet> p, const Address & addr, uint8_t dscp, bool ecnCapable)
+  : QueueDiscItem (p, addr, 0),
+    m_dscp (dscp),
+    m_ecnCapablePacket (ecnCapable)
+{
+}
+
+DwrrQueueDiscTestItem::~DwrrQueueDiscTestItem ()
+{
+}
+
+void
+DwrrQueueDiscTestItem::AddHeader (void)
+{
+}
+
+bool
+DwrrQueueDiscTestItem::Mark (void)
+{
+  return m_ecnCapablePacket;
+}
+
+bool
+DwrrQueueDiscTestItem::GetUint8Value (Uint8Values field, uint8_t &value) const
+{
+  if (field == IP_DSFIELD)
+    {
+      value = m_dscp << 2;
+      return true;
+    }
+  return false;
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Dwrr Queue Disc Test Case
+ */
+class DwrrQueueDiscTestCase : public TestCase
+{
+public:
+  DwrrQueueDiscTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * Enqueue packets
+   * \param queue the queue disc
+   * \param nPkt the number of packets
+   * \param dscp the DSCP of the packets
+   * \param ecnCapable ECN capable flag
+   */
+  void Enqueue (Ptr<DwrrQueueDisc> queue, uint32_t nPkt, uint8_t dscp, bool ecnCapable = true);
+  /**
+   * Create a queue disc with DSCP 10, 20 and 46 mapped to classes 1, 2 and 3
+   * \return the queue disc
+   */
+  Ptr<DwrrQueueDisc> CreateQueueDisc (void);
+};
+
+DwrrQueueDiscTestCase::DwrrQueueDiscTestCase ()
+  : TestCase ("Sanity check on the dwrr queue disc implementation")
+{
+}
+
+void
+DwrrQueueDiscTestCase::Enqueue (Ptr<DwrrQueueDisc> queue, uint32_t nPkt, uint8_t dscp, bool ecnCapable)
+{
+  Address dest;
+  for (uint32_t i = 0; i < nPkt; i++)
+    {
+      queue->Enqueue (Create<DwrrQueueDiscTestItem> (Create<Packet> (1000), dest, dscp, ecnCapable));
+    }
+}
+
+Ptr<DwrrQueueDisc>
+DwrrQueueDiscTestCase::CreateQueueDisc (void)
+{
+  Ptr<DwrrQueueDisc> queue = CreateObject<DwrrQueueDisc> ();
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("Classes", UintegerValue (4)), true,
+                         "Verify that we can actually set the attribute Classes");
+  queue->SetDscpClass (10, 1);
+  queue->SetDscpClass (20, 2);
+  queue->SetDscpClass (46, 3);
+  return queue;
+}
+
+void
+DwrrQueueDiscTestCase::DoRun (void)
+{
+  // test 1: classification by DSCP
+  Ptr<DwrrQueueDisc> queue = CreateQueueDisc ();
+  queue->Initialize ();
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNInternalQueues (), 4, "There should be an internal queue per class");
+  Enqueue (queue, 1, 0);
+  Enqueue (queue, 2, 10);
+  Enqueue (queue, 3, 20);
+  Enqueue (queue, 4, 46);
+  Enqueue (queue, 5, 34);
+  NS_TEST_EXPECT_MSG_EQ (queue->GetInternalQueue (0)->GetNPackets (), 6, "Unmapped DSCPs should go to the default class");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetInternalQueue (1)->GetNPackets (), 2, "DSCP 10 should go to class 1");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetInternalQueue (2)->GetNPackets (), 3, "DSCP 20 should go to class 2");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetInternalQueue (3)->GetNPackets (), 4, "DSCP 46 should go to class 3");
+
+  // test 2: the round robin classes share the link in proportion to their quantum
+  queue = CreateQueueDisc ();
+  queue->SetQuantum (1, 1000);
+  queue->SetQuantum (2, 3000);
+  queue->Initialize ();
+  Enqueue (queue, 40, 10);
+  Enqueue (queue, 40, 20);
+  for (uint32_t i = 0; i < 40; i++)
+    {
+      NS_TEST_EXPECT_MSG_NE (queue->Dequeue (), 0, "A packet should have been dequeued");
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetInternalQueue (1)->GetNPackets (), 30, "Class 1 should have sent 10 packets");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetInternalQueue (2)->GetNPackets (), 10, "Class 2 should have sent 30 packets");
+  uint32_t nDequeued = 0;
+  while (queue->Dequeue () != 0)
+    {
+      nDequeued++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (nDequeued, 40, "All the packets should have been dequeued");
+
+  // test 3: the strict priority classes are served first
+  queue = CreateQueueDisc ();
+  queue->SetStrictPriority (3, true);
+  queue->Initialize ();
+  Enqueue (queue, 2, 10);
+  Enqueue (queue, 2, 46);
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      queue->Dequeue ();
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetInternalQueue (3)->GetNPackets (), 0, "The strict priority class should be served first");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetInternalQueue (1)->GetNPackets (), 2, "The round robin class should wait");
+  Enqueue (queue, 1, 46);
+  queue->Dequeue ();
+  NS_TEST_EXPECT_MSG_EQ (queue->GetInternalQueue (3)->GetNPackets (), 0, "The strict priority class should be served first");
+
+  // test 4: per class marking thresholds
+  queue = CreateQueueDisc ();
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MarkingThreshold", QueueSizeValue (QueueSize ("4p"))), true,
+                         "Verify that we can actually set the attribute MarkingThreshold");
+  queue->SetMarkingThreshold (1, QueueSize ("2000B"));
+  queue->SetMarkingThreshold (3, QueueSize ("0p"));
+  queue->Initialize ();
+  Enqueue (queue, 5, 10);
+  Enqueue (queue, 5, 20);
+  Enqueue (queue, 5, 46);
+  QueueDisc::Stats st = queue->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (st.GetNMarkedPackets (DwrrQueueDisc::THRESHOLD_MARK), 4,
+                         "3 packets of class 1 and 1 packet of class 2 should have been marked");
+  Enqueue (queue, 5, 20, false);
+  st = queue->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (st.GetNDroppedPackets (DwrrQueueDisc::THRESHOLD_DROP), 5,
+                         "The packets not ECN capable should have been dropped above the threshold");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Dwrr Queue Disc Test Suite
+ */
+static class DwrrQueueDiscTestSuite : public TestSuite
+{
+public:
+  DwrrQueueDiscTestSuite ()
+    : TestSuite ("dwrr-queue-disc", UNIT)
+  {
+    AddTestCase (new DwrrQueueDiscTestCase (), TestCase::QUICK);
+  }
+} g_dwrrQueueDiscTestSuite; ///< the test suite
@@ -0,0 +1,262 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/ecn-threshold-queue-disc.h"
+#include "ns3/queue.h"
+#include "ns3/packet.h"
+#include "ns3/socket.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Ecn Threshold Queue Disc Test Item
+ */
+class EcnThresholdQueueDiscTestItem : public QueueDiscItem {
+public:
+  /**
+   * Constructor
+   *
+   * \param p packet
+   * \param addr address
+   * \param ecnCapable ECN capable flag
+   */
+  EcnThresholdQueueDiscTestItem (Ptr<Packet> p, const Address & addr, bool ecnCapable);
+  virtual ~EcnThresholdQueueDiscTestItem ();
+  virtual void AddHeader (void);
+  virtual bool Mark (void);
+
+private:
+  EcnThresholdQueueDiscTestItem ();
+  /**
+   * \brief Copy constructor
+   * Disable default implementation to avoid misuse
+   */
+  EcnThresholdQueueDiscTestItem (const EcnThresholdQueueDiscTestItem &);
+  /**
+   * \brief Assignment operator
+   * \return this object
+   * Disable default implementation to avoid misuse
+   */
+  EcnThresholdQueueDiscTestItem &operator = (const EcnThresholdQueueDiscTestItem &);
+  bool m_ecnCapablePacket; ///< ECN capable packet?
+};
+
+EcnThresholdQueueDiscTestItem::EcnThresholdQueueDiscTestItem (Ptr<Packet> p, const Address & addr, bool ecnCapable)
+  : QueueDiscItem (p, addr, 0),
+    m_ecnCapablePacket (ecnCapable)
+{
+}
+
+EcnThresholdQueueDiscTestItem::~EcnThresholdQueueDiscTestItem ()
+{
+}
+
+void
+EcnThresholdQueueDiscTestItem::AddHeader (void)
+{
+}
+
+bool
+EcnThresholdQueueDiscTestItem::Mark (void)
+{
+  return m_ecnCapablePacket;
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Ecn Threshold Queue Disc Test Case
+ */
+class EcnThresholdQueueDiscTestCase : public TestCase
+{
+public:
+  EcnThresholdQueueDiscTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * Enqueue packets
+   * \param queue the queue disc
+   * \param size the packet size
+   * \param nPkt the number of packets
+   * \param ecnCapable ECN capable flag
+   * \param priority the priority of the packets
+   */
+  void Enqueue (Ptr<EcnThresholdQueueDisc> queue, uint32_t size, uint32_t nPkt,
+                bool ecnCapable, uint8_t priority = 0);
+  /**
+   * Create a queue disc
+   * \param maxSize the max size of the queue disc
+   * \param threshold the marking threshold
+   * \param markOnDequeue whether to mark on dequeue
+   * \return the queue disc
+   */
+  Ptr<EcnThresholdQueueDisc> CreateQueueDisc (QueueSize maxSize, QueueSize threshold,
+                                              bool markOnDequeue);
+};
+
+EcnThresholdQueueDiscTestCase::EcnThresholdQueueDiscTestCase ()
+  : TestCase ("Sanity check on the ecn threshold queue disc implementation")
+{
+}
+
+void
+EcnThresholdQueueDiscTestCase::Enqueue (Ptr<EcnThresholdQueueDisc> queue, uint32_t size,
+                                        uint32_t nPkt, bool ecnCapable, uint8_t priority)
+{
+  Address dest;
+  for (uint32_t i = 0; i < nPkt; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (size);
+      SocketPriorityTag priorityTag;
+      priorityTag.SetPriority (priority);
+      p->AddPacketTag (priorityTag);
+      queue->Enqueue (Create<EcnThresholdQueueDiscTestItem> (p, dest, ecnCapable));
+    }
+}
+
+Ptr<EcnThresholdQueueDisc>
+EcnThresholdQueueDiscTestCase::CreateQueueDisc (QueueSize maxSize, QueueSize threshold,
+                                                bool markOnDequeue)
+{
+  Ptr<EcnThresholdQueueDisc> queue = CreateObject<EcnThresholdQueueDisc> ();
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MaxSize", QueueSizeValue (maxSize)), true,
+                         "Verify that we can actually set the attribute MaxSize");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MarkingThreshold", QueueSizeValue (threshold)), true,
+                         "Verify that we can actually set the attribute MarkingThreshold");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MarkOnDequeue", BooleanValue (markOnDequeue)), true,
+                         "Verify that we can actually set the attribute MarkOnDequeue");
+  return queue;
+}
+
+void
+EcnThresholdQueueDiscTestCase::DoRun (void)
+{
+  uint32_t pktSize = 1000;
+
+  // test 1: the packets arriving with 5 packets or more queued are marked
+  Ptr<EcnThresholdQueueDisc> queue = CreateQueueDisc (QueueSize ("20p"), QueueSize ("5p"), false);
+  queue->Initialize ();
+  Enqueue (queue, pktSize, 10, true);
+  QueueDisc::Stats st = queue->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (st.GetNMarkedPackets (EcnThresholdQueueDisc::THRESHOLD_MARK), 5,
+                         "The last 5 packets should have been marked");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 10, "All the packets should have been enqueued");
+  Enqueue (queue, pktSize, 15, true);
+  st = queue->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (st.GetNDroppedPackets (EcnThresholdQueueDisc::LIMIT_EXCEEDED_DROP), 5,
+                         "The packets beyond the max size should have been dropped");
+
+  // test 2: the packets not ECN capable are dropped instead
+  queue = CreateQueueDisc (QueueSize ("20p"), QueueSize ("5p"), false);
+  queue->Initialize ();
+  Enqueue (queue, pktSize, 10, false);
+  st = queue->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (st.GetNMarkedPackets (EcnThresholdQueueDisc::THRESHOLD_MARK), 0,
+                         "No packet should have been marked");
+  NS_TEST_EXPECT_MSG_EQ (st.GetNDroppedPackets (EcnThresholdQueueDisc::THRESHOLD_DROP), 5,
+                         "The last 5 packets should have been dropped");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 5, "The queue should hold the threshold");
+
+  // test 3: threshold in bytes
+  queue = CreateQueueDisc (QueueSize ("20000B"), QueueSize ("3000B"), false);
+  queue->Initialize ();
+  Enqueue (queue, pktSize, 10, true);
+  st = queue->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (st.GetNMarkedPackets (EcnThresholdQueueDisc::THRESHOLD_MARK), 7,
+                         "The packets arriving with 3000 bytes or more queued should have been marked");
+
+  // test 4: marking on dequeue, with the packets queued behind
+  queue = CreateQueueDisc (QueueSize ("20p"), QueueSize ("5p"), true);
+  queue->Initialize ();
+  Enqueue (queue, pktSize, 10, true);
+  st = queue->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (st.GetNMarkedPackets (EcnThresholdQueueDisc::THRESHOLD_MARK), 0,
+                         "No packet should be marked on enqueue");
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      NS_TEST_EXPECT_MSG_NE (queue->Dequeue (), 0, "A packet should have been dequeued");
+    }
+  st = queue->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (st.GetNMarkedPackets (EcnThresholdQueueDisc::THRESHOLD_MARK), 5,
+                         "The first 5 packets should have been marked on dequeue");
+  NS_TEST_EXPECT_MSG_EQ (queue->Dequeue (), 0, "The queue disc should be empty");
+
+  // test 5: marking on dequeue drops the packets not ECN capable
+  queue = CreateQueueDisc (QueueSize ("20p"), QueueSize ("5p"), true);
+  queue->Initialize ();
+  Enqueue (queue, pktSize, 10, false);
+  uint32_t nDequeued = 0;
+  while (queue->Dequeue () != 0)
+    {
+      nDequeued++;
+    }
+  st = queue->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (st.GetNDroppedPackets (EcnThresholdQueueDisc::THRESHOLD_DROP), 5,
+                         "The first 5 packets should have been dropped on dequeue");
+  NS_TEST_EXPECT_MSG_EQ (nDequeued, 5, "The last 5 packets should have been dequeued");
+
+  // test 6: per-band thresholds and strict priority
+  queue = CreateQueueDisc (QueueSize ("20p"), QueueSize ("5p"), false);
+  Priomap prio2band{{0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}};
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("Bands", UintegerValue (2)), true,
+                         "Verify that we can actually set the attribute Bands");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("Priomap", PriomapValue (prio2band)), true,
+                         "Verify that we can actually set the attribute Priomap");
+  queue->SetBandThreshold (1, QueueSize ("2p"));
+  queue->Initialize ();
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNInternalQueues (), 2, "There should be an internal queue per band");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetBandThreshold (0), QueueSize ("5p"), "Band 0 should have the default threshold");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetBandThreshold (1), QueueSize ("2p"), "Band 1 should have its own threshold");
+  Enqueue (queue, pktSize, 4, true, 1);
+  Enqueue (queue, pktSize, 4, true, 0);
+  st = queue->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (st.GetNMarkedPackets (EcnThresholdQueueDisc::THRESHOLD_MARK), 2,
+                         "Only the packets of band 1 should have been marked");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetInternalQueue (0)->GetNPackets (), 4, "Band 0 should hold 4 packets");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetInternalQueue (1)->GetNPackets (), 4, "Band 1 should hold 4 packets");
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      queue->Dequeue ();
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetInternalQueue (0)->GetNPackets (), 0, "Band 0 should be served first");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetInternalQueue (1)->GetNPackets (), 4, "Band 1 should not be served yet");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Ecn Threshold Queue Disc Test Suite
+ */
+static class EcnThresholdQueueDiscTestSuite : public TestSuite
+{
+public:
+  EcnThresholdQueueDiscTestSuite ()
+    : TestSuite ("ecn-threshold-queue-disc", UNIT)
+  {
+    AddTestCase (new EcnThresholdQueueDiscTestCase (), TestCase::QUICK);
+  }
+} g_ecnThresholdQueueDiscTestSuite; ///< the test suite
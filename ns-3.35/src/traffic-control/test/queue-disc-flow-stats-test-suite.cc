@@ -0,0 +1,299 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/queue-disc-flow-stats.h"
+#include "ns3/fifo-queue-disc.h"
+#include "ns3/packet.h"
+#include "ns3/enum.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+#include "ns3/ipv4-address.h"
+#include <sstream>
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Flow Stats Test Item
+ */
+class FlowStatsTestItem : public QueueDiscItem {
+public:
+  /**
+   * Constructor
+   *
+   * \param p packet
+   * \param hash the hash of the flow of the packet
+   * \param port the source port of the flow of the packet
+   */
+  FlowStatsTestItem (Ptr<Packet> p, uint32_t hash, uint16_t port);
+  virtual ~FlowStatsTestItem ();
+  virtual void AddHeader (void);
+  virtual bool Mark (void);
+  virtual uint32_t Hash (uint32_t perturbation) const;
+  virtual bool GetFiveTuple (FiveTuple &tuple) const;
+
+private:
+  uint32_t m_hash; ///< the hash of the flow of the packet
+  uint16_t m_port; ///< the source port of the flow of the packet
+};
+
+FlowStatsTestItem::FlowStatsTestItem (Ptr<Packet> p, uint32_t hash, uint16_t port)
+  : QueueDiscItem (p, Address (), 0),
+    m_hash (hash),
+    m_port (port)
+{
+}
+
+FlowStatsTestItem::~FlowStatsTestItem ()
+{
+}
+
+void
+FlowStatsTestItem::AddHeader (void)
+{
+}
+
+bool
+FlowStatsTestItem::Mark (void)
+{
+  return false;
+}
+
+uint32_t
+FlowStatsTestItem::Hash (uint32_t perturbation) const
+{
+  return m_hash;
+}
+
+bool
+FlowStatsTestItem::GetFiveTuple (FiveTuple &tuple) const
+{
+  tuple.source = Ipv4Address ("10.1.1.1");
+  tuple.destination = Ipv4Address ("10.1.2.2");
+  tuple.protocol = 6;
+  tuple.sourcePort = m_port;
+  tuple.destinationPort = 5001;
+  return true;
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Queue Disc Flow Stats Test Case
+ */
+class QueueDiscFlowStatsTestCase : public TestCase
+{
+public:
+  QueueDiscFlowStatsTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Create an item of the flow whose hash and source port are given
+   * \param flow the hash and the source port of the flow
+   * \param bytes the size of the packet
+   * \return the item
+   */
+  static Ptr<QueueDiscItem> Item (uint16_t flow, uint32_t bytes);
+  /// Check the counters of the LRU table, including the evicted flows
+  void TestLru (void);
+  /// Check that the flows whose hash collides are counted apart and printed by their 5-tuple
+  void TestCollision (void);
+  /// Check that the count-min sketch bounds the counters and keeps the heavy hitters
+  void TestCountMin (void);
+  /// Check that a queue disc reports its packets to its flow stats
+  void TestQueueDisc (void);
+};
+
+QueueDiscFlowStatsTestCase::QueueDiscFlowStatsTestCase ()
+  : TestCase ("Sanity check on the per-flow counters of the queue discs")
+{
+}
+
+Ptr<QueueDiscItem>
+QueueDiscFlowStatsTestCase::Item (uint16_t flow, uint32_t bytes)
+{
+  return Create<FlowStatsTestItem> (Create<Packet> (bytes), flow, flow);
+}
+
+void
+QueueDiscFlowStatsTestCase::TestLru (void)
+{
+  Ptr<QueueDiscFlowStats> stats = CreateObject<QueueDiscFlowStats> ();
+  stats->SetAttribute ("MaxFlows", UintegerValue (3));
+
+  stats->RecordEnqueue (Item (1, 100));
+  stats->RecordEnqueue (Item (2, 200));
+  stats->RecordMark (Item (2, 200));
+  stats->RecordEnqueue (Item (3, 300));
+  stats->RecordDrop (Item (1, 100));
+
+  QueueDiscFlowStats::Counters c = stats->GetFlow (Item (2, 0));
+  NS_TEST_EXPECT_MSG_EQ (c.enqueuedPackets, 1, "Flow 2 enqueued one packet");
+  NS_TEST_EXPECT_MSG_EQ (c.markedBytes, 200, "Flow 2 had 200 bytes marked");
+  c = stats->GetFlow (Item (1, 0));
+  NS_TEST_EXPECT_MSG_EQ (c.droppedPackets, 1, "Flow 1 had one packet dropped");
+
+  // flow 2 is now the least recently seen flow and makes room for flow 4
+  stats->RecordEnqueue (Item (4, 400));
+  std::vector<std::pair<QueueDiscFlowStats::FlowKey, QueueDiscFlowStats::Counters> > flows = stats->GetFlows ();
+  NS_TEST_ASSERT_MSG_EQ (flows.size (), 3, "Only three flows should be kept");
+  NS_TEST_EXPECT_MSG_EQ (flows[0].first.tuple.sourcePort, 4, "Flow 4 has the most bytes");
+  NS_TEST_EXPECT_MSG_EQ (flows[1].first.tuple.sourcePort, 3, "Flow 3 comes second");
+  NS_TEST_EXPECT_MSG_EQ (flows[2].first.tuple.sourcePort, 1, "Flow 1 comes last");
+  c = stats->GetFlow (Item (2, 0));
+  NS_TEST_EXPECT_MSG_EQ (c.enqueuedPackets, 0, "Flow 2 should have been evicted");
+  c = stats->GetEvicted ();
+  NS_TEST_EXPECT_MSG_EQ (c.enqueuedBytes, 200, "The bytes of flow 2 should be counted as evicted");
+  NS_TEST_EXPECT_MSG_EQ (c.markedPackets, 1, "The mark of flow 2 should be counted as evicted");
+
+  stats->Clear ();
+  NS_TEST_EXPECT_MSG_EQ (stats->GetFlows ().size (), 0, "No flow should be kept after Clear");
+  c = stats->GetEvicted ();
+  NS_TEST_EXPECT_MSG_EQ (c.enqueuedPackets, 0, "The evicted counters should be reset by Clear");
+}
+
+void
+QueueDiscFlowStatsTestCase::TestCollision (void)
+{
+  for (auto mode : {QueueDiscFlowStats::LRU, QueueDiscFlowStats::COUNT_MIN})
+    {
+      Ptr<QueueDiscFlowStats> stats = CreateObject<QueueDiscFlowStats> ();
+      stats->SetAttribute ("Mode", EnumValue (mode));
+
+      // two flows with the same hash
+      Ptr<QueueDiscItem> item1 = Create<FlowStatsTestItem> (Create<Packet> (100), 5, 49153);
+      Ptr<QueueDiscItem> item2 = Create<FlowStatsTestItem> (Create<Packet> (300), 5, 49154);
+      stats->RecordEnqueue (item1);
+      stats->RecordEnqueue (item2);
+      stats->RecordDrop (item2);
+
+      std::vector<std::pair<QueueDiscFlowStats::FlowKey, QueueDiscFlowStats::Counters> > flows = stats->GetFlows ();
+      NS_TEST_ASSERT_MSG_EQ (flows.size (), 2, "The flows whose hash collides should be kept apart");
+      // the sketch counters of the two flows are shared, hence only an LRU
+      // table can tell their counters apart
+      if (mode == QueueDiscFlowStats::LRU)
+        {
+          NS_TEST_EXPECT_MSG_EQ (flows[0].first.tuple.sourcePort, 49154, "The second flow has the most bytes");
+          NS_TEST_EXPECT_MSG_EQ (flows[1].first.tuple.sourcePort, 49153, "The first flow comes second");
+          NS_TEST_EXPECT_MSG_EQ (stats->GetFlow (item1).enqueuedBytes, 100, "The first flow enqueued 100 bytes");
+          NS_TEST_EXPECT_MSG_EQ (stats->GetFlow (item1).droppedPackets, 0, "The first flow had no packet dropped");
+          NS_TEST_EXPECT_MSG_EQ (stats->GetFlow (item2).enqueuedBytes, 300, "The second flow enqueued 300 bytes");
+          NS_TEST_EXPECT_MSG_EQ (stats->GetFlow (item2).droppedPackets, 1, "The second flow had one packet dropped");
+        }
+
+      std::ostringstream oss;
+      stats->Print (oss);
+      NS_TEST_EXPECT_MSG_NE (oss.str ().find ("10.1.1.1:49153 -> 10.1.2.2:5001 proto 6"), std::string::npos,
+                             "The first flow should be printed by its 5-tuple");
+      NS_TEST_EXPECT_MSG_NE (oss.str ().find ("10.1.1.1:49154 -> 10.1.2.2:5001 proto 6"), std::string::npos,
+                             "The second flow should be printed by its 5-tuple");
+    }
+}
+
+void
+QueueDiscFlowStatsTestCase::TestCountMin (void)
+{
+  Ptr<QueueDiscFlowStats> stats = CreateObject<QueueDiscFlowStats> ();
+  stats->SetAttribute ("Mode", EnumValue (QueueDiscFlowStats::COUNT_MIN));
+  stats->SetAttribute ("MaxFlows", UintegerValue (2));
+  stats->SetAttribute ("SketchWidth", UintegerValue (64));
+  stats->SetAttribute ("SketchDepth", UintegerValue (3));
+
+  // two elephants among many mice
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      stats->RecordEnqueue (Item (1000 + i, 100));
+      stats->RecordEnqueue (Item (7, 1500));
+      stats->RecordEnqueue (Item (9, 1000));
+      if (i % 10 == 0)
+        {
+          stats->RecordDrop (Item (9, 1000));
+        }
+    }
+
+  QueueDiscFlowStats::Counters c = stats->GetFlow (Item (7, 0));
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (c.enqueuedPackets, 100, "The sketch should not underestimate a flow");
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (c.enqueuedBytes, 150000, "The sketch should not underestimate a flow");
+  c = stats->GetFlow (Item (9, 0));
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (c.droppedPackets, 10, "The sketch should not underestimate a flow");
+  c = stats->GetFlow (Item (1042, 0));
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (c.enqueuedPackets, 1, "The sketch should not underestimate a flow");
+
+  std::vector<std::pair<QueueDiscFlowStats::FlowKey, QueueDiscFlowStats::Counters> > flows = stats->GetFlows ();
+  NS_TEST_ASSERT_MSG_EQ (flows.size (), 2, "The two heavy hitters should be kept");
+  NS_TEST_EXPECT_MSG_EQ (flows[0].first.tuple.sourcePort, 7, "Flow 7 has the most bytes");
+  NS_TEST_EXPECT_MSG_EQ (flows[1].first.tuple.sourcePort, 9, "Flow 9 comes second");
+}
+
+void
+QueueDiscFlowStatsTestCase::TestQueueDisc (void)
+{
+  Ptr<FifoQueueDisc> qdisc = CreateObject<FifoQueueDisc> ();
+  qdisc->SetMaxSize (QueueSize ("2p"));
+  Ptr<QueueDiscFlowStats> stats = CreateObject<QueueDiscFlowStats> ();
+  qdisc->SetFlowStats (stats);
+  qdisc->Initialize ();
+
+  qdisc->Enqueue (Item (1, 500));
+  qdisc->Enqueue (Item (2, 600));
+  bool enqueued = qdisc->Enqueue (Item (2, 700));
+  NS_TEST_EXPECT_MSG_EQ (enqueued, false, "The third packet should be dropped");
+
+  QueueDiscFlowStats::Counters c = stats->GetFlow (Item (1, 0));
+  NS_TEST_EXPECT_MSG_EQ (c.enqueuedBytes, 500, "Flow 1 enqueued 500 bytes");
+  NS_TEST_EXPECT_MSG_EQ (c.droppedPackets, 0, "Flow 1 had no packet dropped");
+  c = stats->GetFlow (Item (2, 0));
+  NS_TEST_EXPECT_MSG_EQ (c.enqueuedPackets, 1, "Flow 2 enqueued one packet");
+  NS_TEST_EXPECT_MSG_EQ (c.droppedBytes, 700, "Flow 2 had 700 bytes dropped");
+
+  qdisc->SetFlowStats (0);
+  qdisc->Enqueue (Item (2, 800));
+  c = stats->GetFlow (Item (2, 0));
+  NS_TEST_EXPECT_MSG_EQ (c.droppedPackets, 1, "Packets should not be counted without flow stats");
+
+  qdisc->Dispose ();
+}
+
+void
+QueueDiscFlowStatsTestCase::DoRun (void)
+{
+  TestLru ();
+  TestCollision ();
+  TestCountMin ();
+  TestQueueDisc ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Queue Disc Flow Stats Test Suite
+ */
+static class QueueDiscFlowStatsTestSuite : public TestSuite
+{
+public:
+  QueueDiscFlowStatsTestSuite ()
+    : TestSuite ("queue-disc-flow-stats", UNIT)
+  {
+    AddTestCase (new QueueDiscFlowStatsTestCase (), TestCase::QUICK);
+  }
+} g_queueDiscFlowStatsTestSuite; ///< the test suite
@@ -24,7 +24,9 @@
 #include "ns3/drop-tail-queue.h"
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
+#include "ns3/boolean.h"
 #include <map>
+#include <sstream>
 
 using namespace ns3;
 
@@ -555,6 +557,132 @@ QueueDiscTracesTestCase::DoRun (void)
   CheckDroppedBeforeEnqueue (child, 1, pktSizeUnit * 5);
   CheckDroppedAfterDequeue (child, 2, pktSizeUnit * 3);
 
+  // Check the counters of each reason. The root queue disc builds the reasons
+  // of the drops notified by the child queue disc in the same buffer
+  QueueDisc::Stats childStats = child->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (childStats.GetNDroppedPackets (TestChildQueueDisc::BEFORE_ENQUEUE), 1,
+                         "Verify that the packets dropped before enqueue are counted by reason");
+  NS_TEST_EXPECT_MSG_EQ (childStats.GetNDroppedBytes (TestChildQueueDisc::AFTER_DEQUEUE), pktSizeUnit * 3,
+                         "Verify that the bytes dropped after dequeue are counted by reason");
+  NS_TEST_EXPECT_MSG_EQ (childStats.GetNDroppedPackets ("Unknown reason"), 0,
+                         "Verify that no packet is counted for an unknown reason");
+
+  // The counters of each reason are also available keyed by reason
+  std::map<std::string, uint32_t> dbePackets = childStats.GetNDroppedPacketsBeforeEnqueue ();
+  NS_TEST_EXPECT_MSG_EQ (dbePackets.size (), 1, "Verify that only the reasons that occurred are keyed");
+  NS_TEST_EXPECT_MSG_EQ (dbePackets[TestChildQueueDisc::BEFORE_ENQUEUE], 1,
+                         "Verify the packets dropped before enqueue keyed by reason");
+  std::map<std::string, uint64_t> dadBytes = childStats.GetNDroppedBytesAfterDequeue ();
+  NS_TEST_EXPECT_MSG_EQ (dadBytes.size (), 1, "Verify that only the reasons that occurred are keyed");
+  NS_TEST_EXPECT_MSG_EQ (dadBytes[TestChildQueueDisc::AFTER_DEQUEUE], pktSizeUnit * 3,
+                         "Verify the bytes dropped after dequeue keyed by reason");
+  NS_TEST_EXPECT_MSG_EQ (childStats.GetNMarkedPackets ().size (), 0, "Verify that no mark is keyed");
+  QueueDiscReason reason (TestChildQueueDisc::BEFORE_ENQUEUE);
+  NS_TEST_EXPECT_MSG_EQ (QueueDisc::Stats::GetReasonName (reason.GetId ()), TestChildQueueDisc::BEFORE_ENQUEUE,
+                         "Verify that a static reason shares the id of the reason");
+
+  QueueDisc::Stats rootStats = root->GetStats ();
+  std::string dbeReason = std::string (QueueDisc::CHILD_QUEUE_DISC_DROP) + TestChildQueueDisc::BEFORE_ENQUEUE;
+  std::string dadReason = std::string (QueueDisc::CHILD_QUEUE_DISC_DROP) + TestChildQueueDisc::AFTER_DEQUEUE;
+  NS_TEST_EXPECT_MSG_EQ (rootStats.GetNDroppedPackets (dbeReason), 1,
+                         "Verify that the drops of the child queue disc are counted by reason");
+  NS_TEST_EXPECT_MSG_EQ (rootStats.GetNDroppedPackets (dadReason), 2,
+                         "Verify that the drops of the child queue disc are counted by reason");
+
+  std::ostringstream oss;
+  rootStats.Print (oss);
+  NS_TEST_EXPECT_MSG_NE (oss.str ().find ("  " + dadReason + ": 2 / 300"), std::string::npos,
+                         "Verify that the counters of each reason are printed");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Queue Disc Occupancy Test Case
+ *
+ * Two packets are enqueued at 1 ms and 2 ms and dequeued at 4 ms and 5 ms,
+ * and the occupancy histograms are checked at 10 ms: the queue disc is empty
+ * 6 ms, holds one packet 2 ms and two packets 2 ms, and both packets stay
+ * 3 ms.
+ */
+class QueueDiscOccupancyTestCase : public TestCase
+{
+public:
+  QueueDiscOccupancyTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Enqueue a packet
+   * \param qd the queue disc
+   * \param size the size of the packet
+   */
+  void Enqueue (Ptr<QueueDisc> qd, uint32_t size);
+  /**
+   * Dequeue a packet
+   * \param qd the queue disc
+   */
+  void Dequeue (Ptr<QueueDisc> qd);
+};
+
+QueueDiscOccupancyTestCase::QueueDiscOccupancyTestCase ()
+  : TestCase ("Sanity check on the queue disc occupancy histograms")
+{
+}
+
+void
+QueueDiscOccupancyTestCase::Enqueue (Ptr<QueueDisc> qd, uint32_t size)
+{
+  Address dest;
+  qd->Enqueue (Create<qdTestItem> (Create<Packet> (size), dest));
+}
+
+void
+QueueDiscOccupancyTestCase::Dequeue (Ptr<QueueDisc> qd)
+{
+  Ptr<QueueDiscItem> item = qd->Dequeue ();
+  NS_TEST_EXPECT_MSG_NE (item, 0, "Verify that a packet is dequeued");
+}
+
+void
+QueueDiscOccupancyTestCase::DoRun (void)
+{
+  Ptr<QueueDisc> qd = CreateObject<TestChildQueueDisc> ();
+  qd->SetAttribute ("RecordOccupancy", BooleanValue (true));
+  qd->Initialize ();
+
+  Simulator::Schedule (MilliSeconds (1), &QueueDiscOccupancyTestCase::Enqueue, this, qd, 1000);
+  Simulator::Schedule (MilliSeconds (2), &QueueDiscOccupancyTestCase::Enqueue, this, qd, 1000);
+  Simulator::Schedule (MilliSeconds (4), &QueueDiscOccupancyTestCase::Dequeue, this, qd);
+  Simulator::Schedule (MilliSeconds (5), &QueueDiscOccupancyTestCase::Dequeue, this, qd);
+  Simulator::Stop (MilliSeconds (10));
+  Simulator::Run ();
+
+  const QueueDisc::OccupancyHistogram &occupancy = qd->GetStats ().occupancy;
+  NS_TEST_EXPECT_MSG_EQ (occupancy.GetDuration (), MilliSeconds (10),
+                         "Verify that the histograms cover the whole simulation");
+  NS_TEST_EXPECT_MSG_EQ_TOL (occupancy.GetMeanPackets (), 0.6, 1e-9,
+                             "Verify the time-weighted mean number of packets");
+  NS_TEST_EXPECT_MSG_EQ (occupancy.GetPacketsQuantile (0.5), 0, "Verify the median number of packets");
+  NS_TEST_EXPECT_MSG_EQ (occupancy.GetPacketsQuantile (0.7), 1, "Verify the 70th percentile of packets");
+  NS_TEST_EXPECT_MSG_EQ (occupancy.GetPacketsQuantile (0.9), 2, "Verify the 90th percentile of packets");
+  NS_TEST_EXPECT_MSG_EQ (occupancy.GetBytesQuantile (0.8), 1500, "Verify the 80th percentile of bytes");
+  NS_TEST_EXPECT_MSG_EQ (occupancy.GetBytesQuantile (0.9), 3000, "Verify the 90th percentile of bytes");
+  NS_TEST_EXPECT_MSG_EQ (occupancy.GetSojournQuantile (0.99), MicroSeconds (3010),
+                         "Verify the sojourn time of the packets");
+
+  std::ostringstream oss;
+  occupancy.Print (oss);
+  NS_TEST_EXPECT_MSG_NE (oss.str ().find ("\n1 0.8\n"), std::string::npos,
+                         "Verify that the cumulative distributions are printed");
+
+  qd->ResetOccupancy ();
+  NS_TEST_EXPECT_MSG_EQ (qd->GetStats ().occupancy.GetDuration (), Seconds (0),
+                         "Verify that the histograms are cleared");
+
   Simulator::Destroy ();
 }
 
@@ -572,5 +700,6 @@ public:
     : TestSuite ("queue-disc-traces", UNIT)
   {
     AddTestCase (new QueueDiscTracesTestCase (), TestCase::QUICK);
+    AddTestCase (new QueueDiscOccupancyTestCase (), TestCase::QUICK);
   }
 } g_queueDiscTracesTestSuite; ///< the test suite
@@ -515,6 +515,130 @@ RedQueueDiscTestCase::DoRun (void)
 
 }
 
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Red Queue Disc Fixed Point Test Case
+ *
+ * The same traffic, alternating growing queue and idle periods, is offered
+ * to a floating point and a fixed point RED queue disc using the same
+ * random stream, for several RED variants in packet and byte mode, and
+ * the numbers of drops are compared.
+ */
+class RedQueueDiscFixedPointTestCase : public TestCase
+{
+public:
+  RedQueueDiscFixedPointTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * Enqueue three packets and dequeue two, or dequeue three packets
+   * \param queue the queue disc
+   * \param size the size of the packets
+   * \param grow whether the queue grows
+   */
+  void Round (Ptr<RedQueueDisc> queue, uint32_t size, bool grow);
+  /**
+   * Run the traffic on a queue disc
+   * \param variant the attribute enabling the RED variant
+   * \param mode the mode
+   * \param fixedPoint whether to use the fixed point engine
+   * \return the statistics of the queue disc
+   */
+  QueueDisc::Stats RunVariant (std::string variant, QueueSizeUnit mode, bool fixedPoint);
+};
+
+RedQueueDiscFixedPointTestCase::RedQueueDiscFixedPointTestCase ()
+  : TestCase ("Check that the fixed point red queue takes the same decisions")
+{
+}
+
+void
+RedQueueDiscFixedPointTestCase::Round (Ptr<RedQueueDisc> queue, uint32_t size, bool grow)
+{
+  Address dest;
+  if (grow)
+    {
+      for (uint32_t i = 0; i < 3; i++)
+        {
+          queue->Enqueue (Create<RedQueueDiscTestItem> (Create<Packet> (size), dest, false));
+        }
+    }
+  for (uint32_t i = 0; i < (grow ? 2 : 3); i++)
+    {
+      queue->Dequeue ();
+    }
+}
+
+QueueDisc::Stats
+RedQueueDiscFixedPointTestCase::RunVariant (std::string variant, QueueSizeUnit mode, bool fixedPoint)
+{
+  uint32_t pktSize = 500;
+  uint32_t modeSize = (mode == QueueSizeUnit::BYTES ? pktSize : 1);
+  Ptr<RedQueueDisc> queue = CreateObject<RedQueueDisc> ();
+  queue->SetAttribute ("MinTh", DoubleValue (20 * modeSize));
+  queue->SetAttribute ("MaxTh", DoubleValue (60 * modeSize));
+  queue->SetAttribute ("MaxSize", QueueSizeValue (QueueSize (mode, 100 * modeSize)));
+  queue->SetAttribute ("QW", DoubleValue (0.02));
+  queue->SetAttribute ("LInterm", DoubleValue (10));
+  queue->SetAttribute ("UseFixedPoint", BooleanValue (fixedPoint));
+  if (variant == "Cautious")
+    {
+      // the only cautious mode of the fixed point engine, applied to the
+      // idle periods
+      queue->SetAttribute ("Cautious", UintegerValue (3));
+      queue->SetAttribute ("IdlePktSize", UintegerValue (pktSize / 2));
+    }
+  else if (!variant.empty ())
+    {
+      queue->SetAttribute (variant, BooleanValue (true));
+    }
+  if (variant == "Gentle")
+    {
+      queue->SetAttribute ("Wait", BooleanValue (false));
+    }
+  else
+    {
+      queue->SetAttribute ("Gentle", BooleanValue (false));
+    }
+  queue->AssignStreams (1);
+  queue->Initialize ();
+
+  // the queue grows for 150 ms out of 200 ms and is idle for the last 50 ms
+  for (uint32_t i = 0; i < 2000; i++)
+    {
+      Simulator::Schedule (MilliSeconds (i), &RedQueueDiscFixedPointTestCase::Round,
+                           this, queue, pktSize, i % 200 < 150);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+  return queue->GetStats ();
+}
+
+void
+RedQueueDiscFixedPointTestCase::DoRun (void)
+{
+  std::vector<std::string> variants = {"", "Gentle", "ARED", "FengAdaptive", "NLRED", "Cautious"};
+  for (const auto &variant : variants)
+    {
+      for (QueueSizeUnit mode : {QueueSizeUnit::PACKETS, QueueSizeUnit::BYTES})
+        {
+          QueueDisc::Stats floating = RunVariant (variant, mode, false);
+          QueueDisc::Stats fixed = RunVariant (variant, mode, true);
+          double unforced = floating.GetNDroppedPackets (RedQueueDisc::UNFORCED_DROP);
+          double forced = floating.GetNDroppedPackets (RedQueueDisc::FORCED_DROP);
+          NS_TEST_EXPECT_MSG_GT (unforced, 0, "There should be dropped packets due to probability mark");
+          NS_TEST_EXPECT_MSG_EQ_TOL (double (fixed.GetNDroppedPackets (RedQueueDisc::UNFORCED_DROP)),
+                                     unforced, 2 + unforced * 0.02,
+                                     "The " << variant << " fixed point red should drop as many packets due to probability mark");
+          NS_TEST_EXPECT_MSG_EQ_TOL (double (fixed.GetNDroppedPackets (RedQueueDisc::FORCED_DROP)),
+                                     forced, 2 + forced * 0.02,
+                                     "The " << variant << " fixed point red should drop as many packets due to hard mark");
+        }
+    }
+}
+
 /**
  * \ingroup traffic-control-test
  * \ingroup tests
@@ -528,5 +652,6 @@ public:
     : TestSuite ("red-queue-disc", UNIT)
   {
     AddTestCase (new RedQueueDiscTestCase (), TestCase::QUICK);
+    AddTestCase (new RedQueueDiscFixedPointTestCase (), TestCase::QUICK);
   }
 } g_redQueueTestSuite; ///< the test suite
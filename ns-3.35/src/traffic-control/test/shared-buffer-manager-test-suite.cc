@@ -0,0 +1,293 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/shared-buffer-manager.h"
+#include "ns3/fifo-queue-disc.h"
+#include "ns3/traffic-control-layer.h"
+#include "ns3/traffic-control-helper.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/socket.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
+#include "ns3/packet-burst.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Shared Buffer Test Item
+ */
+class SharedBufferTestItem : public QueueDiscItem {
+public:
+  /**
+   * Constructor
+   *
+   * \param p packet
+   * \param addr address
+   */
+  SharedBufferTestItem (Ptr<Packet> p, const Address & addr);
+  virtual ~SharedBufferTestItem ();
+  virtual void AddHeader (void);
+  virtual bool Mark (void);
+
+private:
+  SharedBufferTestItem ();
+  /**
+   * \brief Copy constructor
+   * Disable default implementation to avoid misuse
+   */
+  SharedBufferTestItem (const SharedBufferTestItem &);
+  /**
+   * \brief Assignment operator
+   * \return this object
+   * Disable default implementation to avoid misuse
+   */
+  SharedBufferTestItem &operator = (const SharedBufferTestItem &);
+};
+
+SharedBufferTestItem::SharedBufferTestItem (Ptr<Packet> p, const Address & addr)
+  : QueueDiscItem (p, addr, 0)
+{
+}
+
+SharedBufferTestItem::~SharedBufferTestItem ()
+{
+}
+
+void
+SharedBufferTestItem::AddHeader (void)
+{
+}
+
+bool
+SharedBufferTestItem::Mark (void)
+{
+  return true;
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Shared Buffer Manager Test Case
+ */
+class SharedBufferManagerTestCase : public TestCase
+{
+public:
+  SharedBufferManagerTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * Enqueue packets
+   * \param queue the queue disc
+   * \param nPkt the number of packets
+   * \param priority the priority of the packets
+   * \return the number of packets enqueued
+   */
+  uint32_t Enqueue (Ptr<QueueDisc> queue, uint32_t nPkt, uint8_t priority);
+  /**
+   * Create a queue disc large enough not to drop any packet
+   * \return the queue disc
+   */
+  Ptr<QueueDisc> CreateQueueDisc (void);
+};
+
+SharedBufferManagerTestCase::SharedBufferManagerTestCase ()
+  : TestCase ("Sanity check on the shared buffer manager implementation")
+{
+}
+
+uint32_t
+SharedBufferManagerTestCase::Enqueue (Ptr<QueueDisc> queue, uint32_t nPkt, uint8_t priority)
+{
+  Address dest;
+  uint32_t nEnqueued = 0;
+  for (uint32_t i = 0; i < nPkt; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (1000);
+      SocketPriorityTag priorityTag;
+      priorityTag.SetPriority (priority);
+      p->AddPacketTag (priorityTag);
+      if (queue->Enqueue (Create<SharedBufferTestItem> (p, dest)))
+        {
+          nEnqueued++;
+        }
+    }
+  return nEnqueued;
+}
+
+Ptr<QueueDisc>
+SharedBufferManagerTestCase::CreateQueueDisc (void)
+{
+  Ptr<QueueDisc> queue = CreateObject<FifoQueueDisc> ();
+  queue->SetMaxSize (QueueSize ("1000p"));
+  queue->Initialize ();
+  return queue;
+}
+
+void
+SharedBufferManagerTestCase::DoRun (void)
+{
+  // test 1: the first port takes alpha / (1 + alpha) of the buffer, the
+  // second one what the dynamic threshold leaves
+  Ptr<SharedBufferManager> buffer = CreateObject<SharedBufferManager> ();
+  buffer->SetAttribute ("BufferSize", UintegerValue (10000));
+  buffer->SetAttribute ("Alpha", DoubleValue (1.0));
+  Ptr<QueueDisc> port0 = CreateQueueDisc ();
+  Ptr<QueueDisc> port1 = CreateQueueDisc ();
+  NS_TEST_EXPECT_MSG_EQ (buffer->AddQueueDisc (port0), 0, "The first port should have index 0");
+  NS_TEST_EXPECT_MSG_EQ (buffer->AddQueueDisc (port1), 1, "The second port should have index 1");
+  NS_TEST_EXPECT_MSG_EQ (port0->GetSharedBuffer (), buffer, "The queue disc should draw from the buffer");
+
+  uint32_t nEnqueued = Enqueue (port0, 10, 0);
+  NS_TEST_EXPECT_MSG_EQ (nEnqueued, 5, "The first port should hold half of the buffer");
+  nEnqueued = Enqueue (port1, 10, 0);
+  NS_TEST_EXPECT_MSG_EQ (nEnqueued, 3, "The second port should be limited by the free buffer");
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetOccupancy (), 8000, "The buffer should hold 8000 bytes");
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetPortOccupancy (1), 3000, "The second port should hold 3000 bytes");
+  NS_TEST_EXPECT_MSG_EQ (port0->GetStats ().GetNDroppedPackets (QueueDisc::SHARED_BUFFER_DROP), 5,
+                         "The packets not admitted should be counted as shared buffer drops");
+
+  port0->Dequeue ();
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetOccupancy (), 7000, "The dequeued packet should release its bytes");
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetClassOccupancy (0, 0), 4000, "The first port should hold 4000 bytes");
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetClassThreshold (0), 3000, "The threshold should be the free buffer");
+
+  // test 2: per class alpha and marking on the buffer occupancy
+  buffer = CreateObject<SharedBufferManager> ();
+  buffer->SetAttribute ("BufferSize", UintegerValue (10000));
+  buffer->SetAttribute ("Alpha", DoubleValue (0.5));
+  buffer->SetAttribute ("MarkingThreshold", UintegerValue (3000));
+  buffer->SetClassAlpha (1, 4.0);
+  port0 = CreateQueueDisc ();
+  buffer->AddQueueDisc (port0);
+
+  nEnqueued = Enqueue (port0, 10, 0);
+  NS_TEST_EXPECT_MSG_EQ (nEnqueued, 3, "Class 0 should be limited by its alpha");
+  NS_TEST_EXPECT_MSG_EQ (port0->GetStats ().GetNMarkedPackets (QueueDisc::SHARED_BUFFER_MARK), 0,
+                         "No packet should be marked below the marking threshold");
+  // the priority is taken modulo 16
+  nEnqueued = Enqueue (port0, 10, 17);
+  NS_TEST_EXPECT_MSG_EQ (nEnqueued, 6, "Class 1 should be limited by its own alpha");
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetClassOccupancy (0, 1), 6000, "Class 1 should hold 6000 bytes");
+  NS_TEST_EXPECT_MSG_EQ (port0->GetStats ().GetNMarkedPackets (QueueDisc::SHARED_BUFFER_MARK), 6,
+                         "The packets admitted above the marking threshold should be marked");
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetClassThreshold (0), 500, "The threshold should be half of the free buffer");
+
+  // test 3: reserved bytes and port limit
+  buffer = CreateObject<SharedBufferManager> ();
+  buffer->SetAttribute ("BufferSize", UintegerValue (10000));
+  buffer->SetAttribute ("Alpha", DoubleValue (0.0));
+  buffer->SetAttribute ("ReservedBytes", UintegerValue (2000));
+  port0 = CreateQueueDisc ();
+  buffer->AddQueueDisc (port0);
+  nEnqueued = Enqueue (port0, 5, 0);
+  NS_TEST_EXPECT_MSG_EQ (nEnqueued, 2, "Only the reserved bytes should be admitted");
+  nEnqueued = Enqueue (port0, 5, 1);
+  NS_TEST_EXPECT_MSG_EQ (nEnqueued, 2, "Each class should have its reserved bytes");
+
+  buffer = CreateObject<SharedBufferManager> ();
+  buffer->SetAttribute ("BufferSize", UintegerValue (10000));
+  buffer->SetAttribute ("Alpha", DoubleValue (8.0));
+  buffer->SetAttribute ("PortAlpha", DoubleValue (1.0));
+  port0 = CreateQueueDisc ();
+  buffer->AddQueueDisc (port0);
+  nEnqueued = Enqueue (port0, 3, 0);
+  nEnqueued += Enqueue (port0, 5, 1);
+  NS_TEST_EXPECT_MSG_EQ (nEnqueued, 5, "The port should be limited by the port alpha");
+
+  // test 4: the packets dropped by the queue disc itself are neither marked
+  // nor accounted, and the requeued packets stay in the buffer until sent
+  buffer = CreateObject<SharedBufferManager> ();
+  buffer->SetAttribute ("BufferSize", UintegerValue (100000));
+  buffer->SetAttribute ("Alpha", DoubleValue (8.0));
+  buffer->SetAttribute ("MarkingThreshold", UintegerValue (1));
+  port0 = CreateObject<FifoQueueDisc> ();
+  port0->SetMaxSize (QueueSize ("4p"));
+  port0->SetAttribute ("BulkDequeue", BooleanValue (true));
+  uint32_t nSent = 0;
+  port0->SetSendCallback ([&nSent] (Ptr<QueueDiscItem> item) { nSent++; });
+  // the device only accepts the first packet of each burst
+  port0->SetSendBatchCallback ([&nSent] (Ptr<PacketBurst> burst, const Address &dest, uint16_t protocol)
+                               { nSent++; return 1; });
+  port0->Initialize ();
+  buffer->AddQueueDisc (port0);
+
+  nEnqueued = Enqueue (port0, 6, 0);
+  NS_TEST_EXPECT_MSG_EQ (nEnqueued, 4, "The queue disc should be limited by its own size");
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetOccupancy (), 4000, "The dropped packets should not be accounted");
+  NS_TEST_EXPECT_MSG_EQ (port0->GetStats ().GetNMarkedPackets (QueueDisc::SHARED_BUFFER_MARK), 3,
+                         "Only the packets stored above the marking threshold should be marked");
+
+  port0->Run ();
+  NS_TEST_EXPECT_MSG_EQ (nSent, 1, "One packet should be sent by the first run");
+  NS_TEST_EXPECT_MSG_EQ (port0->GetStats ().nTotalRequeuedPackets, 3, "Three packets should be requeued");
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetOccupancy (), 3000, "The requeued packets should remain in the buffer");
+  for (uint32_t i = 0; i < 10 && nSent < 4; i++)
+    {
+      port0->Run ();
+    }
+  NS_TEST_EXPECT_MSG_EQ (nSent, 4, "All the packets should be sent");
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetOccupancy (), 0, "The sent packets should release the buffer");
+  port0->Dispose ();
+
+  // test 5: the helper adds the root queue discs of a node to the same buffer
+  Ptr<Node> node = CreateObject<Node> ();
+  node->AggregateObject (CreateObject<TrafficControlLayer> ());
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      node->AddDevice (device);
+      devices.Add (device);
+    }
+  TrafficControlHelper tch;
+  tch.SetRootQueueDisc ("ns3::FifoQueueDisc");
+  tch.SetSharedBuffer ("BufferSize", UintegerValue (20000));
+  QueueDiscContainer qdiscs = tch.Install (devices);
+  buffer = node->GetObject<SharedBufferManager> ();
+  NS_TEST_ASSERT_MSG_NE (buffer, 0, "A shared buffer should be aggregated to the node");
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetNPorts (), 2, "Both devices should draw from the buffer");
+  NS_TEST_EXPECT_MSG_EQ (qdiscs.Get (1)->GetSharedBuffer (), buffer, "The queue discs should draw from the buffer");
+  UintegerValue bufferSize;
+  buffer->GetAttribute ("BufferSize", bufferSize);
+  NS_TEST_EXPECT_MSG_EQ (bufferSize.Get (), 20000, "The buffer should have the configured size");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Shared Buffer Manager Test Suite
+ */
+static class SharedBufferManagerTestSuite : public TestSuite
+{
+public:
+  SharedBufferManagerTestSuite ()
+    : TestSuite ("shared-buffer-manager", UNIT)
+  {
+    AddTestCase (new SharedBufferManagerTestCase (), TestCase::QUICK);
+  }
+} g_sharedBufferManagerTestSuite; ///< the test suite
@@ -24,6 +24,7 @@
 
 #include "ns3/test.h"
 #include "ns3/uinteger.h"
+#include "ns3/boolean.h"
 #include "ns3/pointer.h"
 #include "ns3/string.h"
 #include "ns3/double.h"
@@ -32,11 +33,17 @@
 #include "ns3/node-container.h"
 #include "ns3/traffic-control-layer.h"
 #include "ns3/traffic-control-helper.h"
+#include "ns3/fifo-queue-disc.h"
+#include "ns3/packet-burst.h"
 #include "ns3/simple-net-device-helper.h"
 #include "ns3/data-rate.h"
 #include "ns3/net-device-queue-interface.h"
 #include "ns3/queue.h"
 #include "ns3/config.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/drop-tail-queue.h"
+#include "ns3/mac48-address.h"
 
 using namespace ns3;
 
@@ -106,8 +113,12 @@ public:
    * Constructor
    *
    * \param tt the test type
+   * \param deviceQueueLength the size of the device queue
+   * \param totalTxPackets the number of packets to transmit
+   * \param bulkDequeue whether the queue disc dequeues packets in batches
    */
-  TcFlowControlTestCase (QueueSizeUnit tt, uint32_t deviceQueueLength, uint32_t totalTxPackets);
+  TcFlowControlTestCase (QueueSizeUnit tt, uint32_t deviceQueueLength, uint32_t totalTxPackets,
+                         bool bulkDequeue = false);
   virtual ~TcFlowControlTestCase ();
 private:
   virtual void DoRun (void);
@@ -138,14 +149,34 @@ private:
    * \param msg the message to print if a different number of packets are stored
    */
   void CheckPacketsInQueueDisc (Ptr<NetDevice> dev, uint16_t nPackets, const std::string msg);
+  /**
+   * Receive a packet and check that the packets are received in the order they were sent
+   * \param dev the receiving device
+   * \param p the packet
+   * \param protocol the protocol number
+   * \param from the sender address
+   * \param to the destination address
+   * \param type the packet type
+   * \return true
+   */
+  bool Receive (Ptr<NetDevice> dev, Ptr<const Packet> p, uint16_t protocol, const Address &from,
+                const Address &to, NetDevice::PacketType type);
   QueueSizeUnit m_type;       //!< the test type
   uint32_t m_deviceQueueLength;
   uint32_t m_totalTxPackets;
+  bool m_bulkDequeue;         //!< whether the queue disc dequeues packets in batches
+  uint32_t m_nRxPackets;      //!< the number of packets received
+  uint64_t m_lastRxUid;       //!< the uid of the last packet received
 };
 
-TcFlowControlTestCase::TcFlowControlTestCase (QueueSizeUnit tt, uint32_t deviceQueueLength, uint32_t totalTxPackets)
-  : TestCase ("Test the operation of the flow control mechanism"),
-    m_type (tt), m_deviceQueueLength(deviceQueueLength), m_totalTxPackets(totalTxPackets)
+TcFlowControlTestCase::TcFlowControlTestCase (QueueSizeUnit tt, uint32_t deviceQueueLength, uint32_t totalTxPackets,
+                                              bool bulkDequeue)
+  : TestCase (std::string ("Test the operation of the flow control mechanism")
+              + (bulkDequeue ? " with bulk dequeue" : "")),
+    m_type (tt), m_deviceQueueLength(deviceQueueLength), m_totalTxPackets(totalTxPackets),
+    m_bulkDequeue (bulkDequeue),
+    m_nRxPackets (0),
+    m_lastRxUid (0)
 {
 }
 
@@ -188,6 +219,19 @@ TcFlowControlTestCase::CheckPacketsInQueueDisc (Ptr<NetDevice> dev, uint16_t nPa
   NS_TEST_EXPECT_MSG_EQ (qdisc->GetNPackets (), nPackets, msg);
 }
 
+bool
+TcFlowControlTestCase::Receive (Ptr<NetDevice> dev, Ptr<const Packet> p, uint16_t protocol, const Address &from,
+                                const Address &to, NetDevice::PacketType type)
+{
+  // the packets are created in the order they are sent
+  if (m_nRxPackets > 0)
+    {
+      NS_TEST_EXPECT_MSG_GT (p->GetUid (), m_lastRxUid, "Packets must be received in order");
+    }
+  m_nRxPackets++;
+  m_lastRxUid = p->GetUid ();
+  return true;
+}
 
 void
 TcFlowControlTestCase::DoRun (void)
@@ -201,6 +245,8 @@ TcFlowControlTestCase::DoRun (void)
   SimpleNetDeviceHelper simple;
 
   NetDeviceContainer rxDevC = simple.Install (n.Get (1));
+  // the packets are sent to a null address, hence received in promiscuous mode
+  rxDevC.Get (0)->SetPromiscReceiveCallback (MakeCallback (&TcFlowControlTestCase::Receive, this));
 
   simple.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("1Mb/s")));
   simple.SetQueue ("ns3::DropTailQueue", "MaxSize",
@@ -213,7 +259,8 @@ TcFlowControlTestCase::DoRun (void)
   txDev->SetMtu (2500);
 
   TrafficControlHelper tch = TrafficControlHelper::Default ();
-  tch.Install (txDev);
+  QueueDiscContainer qdiscs = tch.Install (txDev);
+  qdiscs.Get (0)->SetAttribute ("BulkDequeue", BooleanValue (m_bulkDequeue));
 
   // transmit 10 packets at time 0
   Simulator::Schedule (Time (Seconds (0)), &TcFlowControlTestCase::SendPackets,
@@ -361,6 +408,296 @@ TcFlowControlTestCase::DoRun (void)
     }
 
   Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_nRxPackets, m_totalTxPackets, "All the packets must be received");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check that the packets of a batch that the device does not accept are
+ *        sent in order, when the next batch does not drain the requeued packets
+ */
+class TcBulkDequeueRequeueTestCase : public TestCase
+{
+public:
+  TcBulkDequeueRequeueTestCase ();
+  virtual ~TcBulkDequeueRequeueTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+TcBulkDequeueRequeueTestCase::TcBulkDequeueRequeueTestCase ()
+  : TestCase ("Test the order of the packets requeued by a bulk dequeue")
+{
+}
+
+TcBulkDequeueRequeueTestCase::~TcBulkDequeueRequeueTestCase ()
+{
+}
+
+void
+TcBulkDequeueRequeueTestCase::DoRun (void)
+{
+  Ptr<QueueDisc> qdisc = CreateObject<FifoQueueDisc> ();
+  qdisc->SetAttribute ("BulkDequeue", BooleanValue (true));
+  std::vector<uint64_t> sent;
+  qdisc->SetSendCallback ([&sent] (Ptr<QueueDiscItem> item)
+                          { sent.push_back (item->GetPacket ()->GetUid ()); });
+  // the device only accepts the first packet of each burst
+  qdisc->SetSendBatchCallback ([&sent] (Ptr<PacketBurst> burst, const Address &dest, uint16_t protocol)
+                               { sent.push_back (burst->GetPackets ().front ()->GetUid ()); return 1; });
+  qdisc->Initialize ();
+
+  std::vector<uint64_t> uids;
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      Ptr<QueueDiscItem> item = Create<QueueDiscTestItem> (Create<Packet> (1000));
+      uids.push_back (item->GetPacket ()->GetUid ());
+      qdisc->Enqueue (item);
+    }
+
+  // the first run sends one packet and requeues nine of them
+  qdisc->Run ();
+  NS_TEST_EXPECT_MSG_EQ (sent.size (), 1, "One packet must be sent by the first run");
+  // the second run only dequeues two of the requeued packets and requeues one
+  qdisc->SetQuota (2);
+  qdisc->Run ();
+  NS_TEST_EXPECT_MSG_EQ (sent.size (), 2, "One packet must be sent by the second run");
+  qdisc->SetQuota (64);
+  for (uint32_t i = 0; i < 10 && sent.size () < uids.size (); i++)
+    {
+      qdisc->Run ();
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (sent.size (), uids.size (), "All the packets must be sent");
+  for (std::size_t i = 0; i < uids.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (sent[i], uids[i], "Packets must be sent in order");
+    }
+
+  qdisc->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check that the packets sent through the traffic control layer reach
+ *        the root queue disc of their device, or the device itself if it has
+ *        none, while root queue discs are removed and devices are added
+ */
+class TcSendTableTestCase : public TestCase
+{
+public:
+  TcSendTableTestCase ();
+  virtual ~TcSendTableTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Add a device to a node
+   * \param node the node
+   * \param channel the channel to attach the device to
+   * \param queueInterface whether to aggregate a queue interface to the device
+   * \return the device
+   */
+  static Ptr<NetDevice> AddDevice (Ptr<Node> node, Ptr<SimpleChannel> channel, bool queueInterface);
+  /**
+   * Send packets through the traffic control layer
+   * \param dev the device to send the packets to
+   * \param nPackets the number of packets to send
+   */
+  static void SendPackets (Ptr<NetDevice> dev, uint16_t nPackets);
+  /**
+   * Check the number of packets received by a queue disc
+   * \param qdisc the queue disc
+   * \param nPackets the expected number of packets
+   * \param msg the message to print if a different number of packets was received
+   */
+  void CheckQueueDisc (Ptr<QueueDisc> qdisc, uint32_t nPackets, const std::string msg);
+  /**
+   * Remove the root queue disc of a device
+   * \param dev the device
+   */
+  static void DeleteRootQueueDisc (Ptr<NetDevice> dev);
+  /**
+   * Add a device without queue interface after the initialization of the
+   * traffic control layer
+   * \param node the node
+   * \param channel the channel to attach the device to
+   */
+  void AddLateDevice (Ptr<Node> node, Ptr<SimpleChannel> channel);
+  /**
+   * Send packets through the traffic control layer to the device added by
+   * AddLateDevice
+   * \param nPackets the number of packets to send
+   */
+  void SendPacketsToLateDevice (uint16_t nPackets);
+  /**
+   * Count the packets received from each sender
+   * \param dev the receiving device
+   * \param p the packet
+   * \param protocol the protocol number
+   * \param from the sender address
+   * \param to the destination address
+   * \param type the packet type
+   * \return true
+   */
+  bool Receive (Ptr<NetDevice> dev, Ptr<const Packet> p, uint16_t protocol, const Address &from,
+                const Address &to, NetDevice::PacketType type);
+  std::map<Mac48Address, uint32_t> m_nRxPackets;  //!< the number of packets received from each sender
+  Ptr<NetDevice> m_lateDevice;                    //!< the device added by AddLateDevice
+};
+
+TcSendTableTestCase::TcSendTableTestCase ()
+  : TestCase ("Test that the packets reach the root queue disc of their device")
+{
+}
+
+TcSendTableTestCase::~TcSendTableTestCase ()
+{
+}
+
+Ptr<NetDevice>
+TcSendTableTestCase::AddDevice (Ptr<Node> node, Ptr<SimpleChannel> channel, bool queueInterface)
+{
+  Ptr<SimpleNetDevice> dev = CreateObject<SimpleNetDevice> ();
+  dev->SetAddress (Mac48Address::Allocate ());
+  node->AddDevice (dev);
+  dev->SetChannel (channel);
+  Ptr<Queue<Packet> > queue = CreateObject<DropTailQueue<Packet> > ();
+  dev->SetQueue (queue);
+  if (queueInterface)
+    {
+      Ptr<NetDeviceQueueInterface> ndqi = CreateObject<NetDeviceQueueInterface> ();
+      ndqi->GetTxQueue (0)->ConnectQueueTraces (queue);
+      dev->AggregateObject (ndqi);
+    }
+  return dev;
+}
+
+void
+TcSendTableTestCase::SendPackets (Ptr<NetDevice> dev, uint16_t nPackets)
+{
+  Ptr<TrafficControlLayer> tc = dev->GetNode ()->GetObject<TrafficControlLayer> ();
+  for (uint16_t i = 0; i < nPackets; i++)
+    {
+      tc->Send (dev, Create<QueueDiscTestItem> (Create<Packet> (1000)));
+    }
+}
+
+void
+TcSendTableTestCase::CheckQueueDisc (Ptr<QueueDisc> qdisc, uint32_t nPackets, const std::string msg)
+{
+  NS_TEST_EXPECT_MSG_EQ (qdisc->GetStats ().nTotalReceivedPackets, nPackets, msg);
+}
+
+void
+TcSendTableTestCase::DeleteRootQueueDisc (Ptr<NetDevice> dev)
+{
+  dev->GetNode ()->GetObject<TrafficControlLayer> ()->DeleteRootQueueDiscOnDevice (dev);
+}
+
+void
+TcSendTableTestCase::AddLateDevice (Ptr<Node> node, Ptr<SimpleChannel> channel)
+{
+  m_lateDevice = AddDevice (node, channel, false);
+}
+
+void
+TcSendTableTestCase::SendPacketsToLateDevice (uint16_t nPackets)
+{
+  SendPackets (m_lateDevice, nPackets);
+}
+
+bool
+TcSendTableTestCase::Receive (Ptr<NetDevice> dev, Ptr<const Packet> p, uint16_t protocol, const Address &from,
+                              const Address &to, NetDevice::PacketType type)
+{
+  m_nRxPackets[Mac48Address::ConvertFrom (from)]++;
+  return true;
+}
+
+void
+TcSendTableTestCase::DoRun (void)
+{
+  NodeContainer n;
+  n.Create (2);
+
+  n.Get (0)->AggregateObject (CreateObject<TrafficControlLayer> ());
+  n.Get (1)->AggregateObject (CreateObject<TrafficControlLayer> ());
+
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  Ptr<NetDevice> rxDev = AddDevice (n.Get (1), channel, true);
+  // the packets are sent to a null address, hence received in promiscuous mode
+  rxDev->SetPromiscReceiveCallback (MakeCallback (&TcSendTableTestCase::Receive, this));
+
+  // a device with a queue interface keeps its entry when its root queue
+  // disc is removed, a device without one loses it
+  Ptr<NetDevice> dev0 = AddDevice (n.Get (0), channel, true);
+  Ptr<NetDevice> dev1 = AddDevice (n.Get (0), channel, false);
+  Ptr<NetDevice> dev2 = AddDevice (n.Get (0), channel, false);
+  Ptr<NetDevice> dev3 = AddDevice (n.Get (0), channel, true);
+
+  TrafficControlHelper tch;
+  tch.SetRootQueueDisc ("ns3::FifoQueueDisc");
+  NetDeviceContainer devices;
+  devices.Add (dev0);
+  devices.Add (dev1);
+  devices.Add (dev2);
+  devices.Add (dev3);
+  QueueDiscContainer qdiscs = tch.Install (devices);
+
+  // before the initialization of the traffic control layer
+  DeleteRootQueueDisc (dev2);
+
+  Simulator::Schedule (Seconds (1), &TcSendTableTestCase::SendPackets, dev0, 1);
+  Simulator::Schedule (Seconds (1), &TcSendTableTestCase::SendPackets, dev1, 2);
+  Simulator::Schedule (Seconds (1), &TcSendTableTestCase::SendPackets, dev2, 3);
+  Simulator::Schedule (Seconds (1), &TcSendTableTestCase::SendPackets, dev3, 4);
+  Simulator::Schedule (Seconds (1.5), &TcSendTableTestCase::CheckQueueDisc, this, qdiscs.Get (0), 1,
+                       "The packets sent to the first device must reach its root queue disc");
+  Simulator::Schedule (Seconds (1.5), &TcSendTableTestCase::CheckQueueDisc, this, qdiscs.Get (1), 2,
+                       "The packets sent to the second device must reach its root queue disc");
+  Simulator::Schedule (Seconds (1.5), &TcSendTableTestCase::CheckQueueDisc, this, qdiscs.Get (2), 0,
+                       "A removed root queue disc must not receive packets");
+  Simulator::Schedule (Seconds (1.5), &TcSendTableTestCase::CheckQueueDisc, this, qdiscs.Get (3), 4,
+                       "The packets sent to the fourth device must reach its root queue disc");
+
+  // after the initialization of the traffic control layer, remove root
+  // queue discs and add a device
+  Simulator::Schedule (Seconds (2), &TcSendTableTestCase::DeleteRootQueueDisc, dev1);
+  Simulator::Schedule (Seconds (2), &TcSendTableTestCase::DeleteRootQueueDisc, dev3);
+  Simulator::Schedule (Seconds (2), &TcSendTableTestCase::AddLateDevice, this, n.Get (0), channel);
+  Simulator::Schedule (Seconds (3), &TcSendTableTestCase::SendPackets, dev0, 1);
+  Simulator::Schedule (Seconds (3), &TcSendTableTestCase::SendPackets, dev1, 1);
+  Simulator::Schedule (Seconds (3), &TcSendTableTestCase::SendPackets, dev3, 1);
+  Simulator::Schedule (Seconds (3), &TcSendTableTestCase::SendPacketsToLateDevice, this, 5);
+  Simulator::Schedule (Seconds (3.5), &TcSendTableTestCase::CheckQueueDisc, this, qdiscs.Get (0), 2,
+                       "The packets sent to the first device must still reach its root queue disc");
+  Simulator::Schedule (Seconds (3.5), &TcSendTableTestCase::CheckQueueDisc, this, qdiscs.Get (1), 2,
+                       "A removed root queue disc must not receive packets");
+  Simulator::Schedule (Seconds (3.5), &TcSendTableTestCase::CheckQueueDisc, this, qdiscs.Get (3), 4,
+                       "A removed root queue disc must not receive packets");
+
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_nRxPackets[Mac48Address::ConvertFrom (dev0->GetAddress ())], 2,
+                         "All the packets sent to the first device must be received");
+  NS_TEST_EXPECT_MSG_EQ (m_nRxPackets[Mac48Address::ConvertFrom (dev1->GetAddress ())], 3,
+                         "All the packets sent to the second device must be received");
+  NS_TEST_EXPECT_MSG_EQ (m_nRxPackets[Mac48Address::ConvertFrom (dev2->GetAddress ())], 3,
+                         "All the packets sent to the third device must be received");
+  NS_TEST_EXPECT_MSG_EQ (m_nRxPackets[Mac48Address::ConvertFrom (dev3->GetAddress ())], 5,
+                         "All the packets sent to the fourth device must be received");
+  NS_TEST_EXPECT_MSG_EQ (m_nRxPackets[Mac48Address::ConvertFrom (m_lateDevice->GetAddress ())], 5,
+                         "All the packets sent to the added device must be received");
+
+  m_lateDevice = 0;
   Simulator::Destroy ();
 }
 
@@ -385,9 +722,15 @@ public:
     AddTestCase (new TcFlowControlTestCase (QueueSizeUnit::PACKETS, 1, 1), TestCase::QUICK);
     AddTestCase (new TcFlowControlTestCase (QueueSizeUnit::PACKETS, 2, 1), TestCase::QUICK);
     AddTestCase (new TcFlowControlTestCase (QueueSizeUnit::PACKETS, 5, 1), TestCase::QUICK);
+    AddTestCase (new TcFlowControlTestCase (QueueSizeUnit::PACKETS, 1, 10, true), TestCase::QUICK);
+    AddTestCase (new TcFlowControlTestCase (QueueSizeUnit::PACKETS, 5, 10, true), TestCase::QUICK);
+    AddTestCase (new TcFlowControlTestCase (QueueSizeUnit::PACKETS, 15, 10, true), TestCase::QUICK);
 
     // TODO: Right now, this test only works for 5000B and 10 packets (it's hard coded). Should
     // also be made parametric.
     AddTestCase (new TcFlowControlTestCase (QueueSizeUnit::BYTES, 5000, 10), TestCase::QUICK);
+    AddTestCase (new TcFlowControlTestCase (QueueSizeUnit::BYTES, 5000, 10, true), TestCase::QUICK);
+    AddTestCase (new TcBulkDequeueRequeueTestCase (), TestCase::QUICK);
+    AddTestCase (new TcSendTableTestCase (), TestCase::QUICK);
   }
 } g_tcFlowControlTestSuite; ///< the test suite
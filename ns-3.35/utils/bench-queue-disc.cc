@@ -0,0 +1,146 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the enqueue and dequeue operations
+// of the RED queue disc, with the floating point and the fixed point engines,
+// for various numbers of packets 'n'.  The queue is kept between the
+// thresholds, so that every enqueue computes a drop probability.
+// Sample usage:  ./waf --run 'bench-queue-disc --n=1000000'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/packet.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/red-queue-disc.h"
+#include <iostream>
+#include <limits>
+#include <algorithm>
+
+using namespace ns3;
+
+/// Queue disc item used to benchmark the queue discs
+class BenchQueueDiscItem : public QueueDiscItem
+{
+public:
+  /**
+   * Constructor
+   * \param p the packet
+   */
+  BenchQueueDiscItem (Ptr<Packet> p)
+    : QueueDiscItem (p, Address (), 0)
+  {
+  }
+  virtual void AddHeader (void)
+  {
+  }
+  virtual bool Mark (void)
+  {
+    return false;
+  }
+};
+
+/**
+ * Create, fill and run a RED queue disc
+ * \param n the number of packets to enqueue and dequeue
+ * \param variant the attribute enabling the RED variant, if any
+ * \param fixedPoint whether to use the fixed point engine
+ * \return the elapsed time, in milliseconds
+ */
+static uint64_t
+BenchRed (uint32_t n, std::string variant, bool fixedPoint)
+{
+  Ptr<RedQueueDisc> queue = CreateObject<RedQueueDisc> ();
+  queue->SetAttribute ("MinTh", DoubleValue (20));
+  queue->SetAttribute ("MaxTh", DoubleValue (60));
+  queue->SetAttribute ("MaxSize", QueueSizeValue (QueueSize ("100p")));
+  queue->SetAttribute ("UseFixedPoint", BooleanValue (fixedPoint));
+  if (!variant.empty ())
+    {
+      queue->SetAttribute (variant, BooleanValue (true));
+    }
+  queue->Initialize ();
+
+  // bring the average queue length between the thresholds
+  for (uint32_t i = 0; i < 5000; i++)
+    {
+      queue->Enqueue (Create<BenchQueueDiscItem> (Create<Packet> (500)));
+      if (queue->GetNPackets () > 40)
+        {
+          queue->Dequeue ();
+        }
+    }
+
+  SystemWallClockMs time;
+  time.Start ();
+  Ptr<QueueDiscItem> item = Create<BenchQueueDiscItem> (Create<Packet> (500));
+  for (uint32_t i = 0; i < n; i++)
+    {
+      if (!queue->Enqueue (item))
+        {
+          item = Create<BenchQueueDiscItem> (Create<Packet> (500));
+          continue;
+        }
+      item = queue->Dequeue ();
+    }
+  return time.End ();
+}
+
+/**
+ * Run the benchmark of a RED variant with both engines
+ * \param n the number of packets
+ * \param minIterations the number of runs to take the best time of
+ * \param variant the attribute enabling the RED variant, if any
+ */
+static void
+RunBench (uint32_t n, uint32_t minIterations, std::string variant)
+{
+  for (bool fixedPoint : {false, true})
+    {
+      uint64_t minDelay = std::numeric_limits<uint64_t>::max ();
+      for (uint32_t i = 0; i < minIterations; i++)
+        {
+          minDelay = std::min (minDelay, BenchRed (n, variant, fixedPoint));
+        }
+      double ns = minDelay * 1e6 / n;
+      std::cout << ns << " ns/packet"
+                << " (" << minDelay << " ms elapsed)\t"
+                << (variant.empty () ? "RED" : variant)
+                << (fixedPoint ? " fixed point" : " floating point")
+                << std::endl;
+    }
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 1000000;
+  uint32_t minIterations = 1;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the enqueue and dequeue of the RED queue disc");
+  cmd.AddValue ("n", "number of packets", n);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.Parse (argc, argv);
+
+  std::cout << "Running bench-queue-disc with n=" << n << std::endl;
+
+  RunBench (n, minIterations, "");
+  RunBench (n, minIterations, "ARED");
+  RunBench (n, minIterations, "FengAdaptive");
+  RunBench (n, minIterations, "NLRED");
+
+  return 0;
+}
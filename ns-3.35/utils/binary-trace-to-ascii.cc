@@ -0,0 +1,63 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program converts a binary trace file, as written by the
+// EnableBinary family of trace helpers, to the ascii trace format.
+// Sample usage:
+//   ./waf --run 'binary-trace-to-ascii --input=trace-0-1.btr --output=trace-0-1.tr'
+// Without --output, the ascii trace is written to the standard output.
+
+#include "ns3/command-line.h"
+#include "ns3/binary-trace-file.h"
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using namespace ns3;
+
+int
+main (int argc, char *argv[])
+{
+  std::string input;
+  std::string output;
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("input", "binary trace file to read", input);
+  cmd.AddValue ("output", "ascii trace file to write (default: standard output)", output);
+  cmd.Parse (argc, argv);
+
+  BinaryTraceReader reader;
+  if (input.empty () || !reader.Open (input))
+    {
+      std::cerr << "Unable to read binary trace file '" << input << "'" << std::endl;
+      return 1;
+    }
+
+  if (output.empty ())
+    {
+      reader.PrintAscii (std::cout);
+      return 0;
+    }
+
+  std::ofstream os (output.c_str ());
+  if (!os)
+    {
+      std::cerr << "Unable to write '" << output << "'" << std::endl;
+      return 1;
+    }
+  reader.PrintAscii (os);
+  return 0;
+}